@@ -0,0 +1,76 @@
+/*
+ * alloc_counter.cpp - Replacement global operator new/delete
+ *
+ * Only the single-object forms are replaced: the array and nothrow forms
+ * forward to them in the default library, so they are counted too. Memory
+ * comes from malloc/aligned_alloc, so the deletes free it.
+ */
+
+#include "alloc_counter.hpp"
+
+#ifdef NETMON_COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local uint64_t t_allocations = 0;
+
+}  // namespace
+
+uint64_t thread_allocation_count() {
+    return t_allocations;
+}
+
+void* operator new(std::size_t size) {
+    ++t_allocations;
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        if (void* p = std::malloc(size)) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    ++t_allocations;
+    auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    size = size == 0 ? align : (size + align - 1) & ~(align - 1);
+    for (;;) {
+        if (void* p = std::aligned_alloc(align, size)) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#endif  // NETMON_COUNT_ALLOCATIONS
@@ -0,0 +1,25 @@
+/*
+ * alloc_counter.hpp - Per-thread heap allocation counting
+ *
+ * With NETMON_COUNT_ALLOCATIONS defined, alloc_counter.cpp replaces the
+ * global operator new so that every heap allocation bumps a thread-local
+ * counter. The benchmark mode reads it around its packet loop to report
+ * allocations per packet. The replacement applies to the whole program,
+ * capture included, so it is a build option (off by default) rather than
+ * something a release binary pays for; without it the count stays 0.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#ifdef NETMON_COUNT_ALLOCATIONS
+constexpr bool ALLOCATION_COUNTING = true;
+
+// Allocations made by the calling thread since it started
+uint64_t thread_allocation_count();
+#else
+constexpr bool ALLOCATION_COUNTING = false;
+
+inline uint64_t thread_allocation_count() { return 0; }
+#endif
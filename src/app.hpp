@@ -5,22 +5,40 @@
  * window layout, packet capture, and the main event loop. Owns the PacketStore,
  * PacketCapture, Sidebar, and all Panel instances.
  *
- * Also manages the DescriptionDatabase for traffic categorisation and
- * Watchlist for alert monitoring.
+ * Also manages the DescriptionDatabase for traffic categorisation,
+ * Watchlist for alert monitoring, and the optional metrics endpoint.
  *
  * The event loop polls for keyboard input (non-blocking), updates statistics,
- * and renders all UI components. Handles global keys (F1-F4 panel switching,
+ * and renders all UI components. With --no-ui there is no curses UI at all:
+ * capture starts on the given interface and runs until SIGINT/SIGTERM.
+ * With --replay, a columnar export is loaded instead of capturing live, and
+ * --bench runs the pipeline benchmark and exits. Handles global keys (F1-F7 panel switching,
  * Tab for focus, q to quit) and delegates other keys to the focused component.
  */
 
 #pragma once
 
+#include "attack_detector.hpp"
 #include "capture.hpp"
 #include "descriptions.hpp"
+#include "dns_cache.hpp"
+#include "dns_tracker.hpp"
+#include "exporter.hpp"
+#include "flow_export.hpp"
+#include "http_tracker.hpp"
+#include "ip_reassembly.hpp"
+#include "metrics.hpp"
+#include "metrics_server.hpp"
+#include "options.hpp"
 #include "packet_store.hpp"
 #include "panel.hpp"
 #include "process_mapper.hpp"
+#include "quic.hpp"
+#include "recorder.hpp"
 #include "sidebar.hpp"
+#include "tcp_analytics.hpp"
+#include "tcp_reassembly.hpp"
+#include "trigger_capture.hpp"
 #include "ui.hpp"
 #include "watchlist.hpp"
 #include <array>
@@ -29,7 +47,7 @@
 
 class App {
 public:
-    App();
+    explicit App(const Options& options = Options{});
     ~App();
 
     // Non-copyable
@@ -45,6 +63,8 @@ private:
     // Focus state
     enum class Focus { SIDEBAR, PANEL };
 
+    Options options_;
+
     // Core components
     UI ui_;
     PacketStore store_;
@@ -56,8 +76,49 @@ private:
     Watchlist watchlist_;
     ProcessMapper process_mapper_;
 
-    // Panels
-    std::array<std::unique_ptr<Panel>, 4> panels_;
+    // External monitoring
+    MetricsRegistry metrics_;
+    MetricsServer metrics_server_;
+
+    // Raw frame recording (--record)
+    PcapngRecorder recorder_;
+
+    // Pre/post-alert packet windows (--trigger-dir)
+    TriggerCapture trigger_;
+
+    // NDJSON/CSV record export (--export); later captures append
+    RecordExporter exporter_;
+    uint32_t exports_started_ = 0;
+
+    // IPFIX / NetFlow v9 export (--flow-export)
+    FlowExporter flow_exporter_;
+
+    // Passive DNS and query timing, kept across captures (--dns-cache-size, --dns-pending)
+    std::unique_ptr<DnsCache> dns_cache_;
+    std::unique_ptr<DnsTracker> dns_tracker_;
+
+    // TCP RTT, retransmission and window analysis, kept across captures (--tcp-flows)
+    std::unique_ptr<TcpAnalyzer> tcp_analyzer_;
+
+    // HTTP status and time-to-first-byte per host, kept across captures (--http-flows)
+    std::unique_ptr<HttpTracker> http_tracker_;
+
+    // Fragment and split ClientHello / HTTP head reassembly, fresh for each capture
+    std::unique_ptr<IpReassembler> ip_reassembler_;
+    std::unique_ptr<TcpReassembler> reassembler_;
+    ReassemblyConfig reassembly_config() const;
+    FragmentConfig fragment_config() const;
+
+    // QUIC Initial decryption, fresh for each capture
+    std::unique_ptr<QuicDissector> quic_;
+    QuicConfig quic_config() const;
+
+    // SYN flood, scan and sweep detection, fresh for each capture (--detect-window)
+    std::unique_ptr<AttackDetector> detector_;
+    DetectionConfig detection_config() const;
+
+    // Panels (index 7 is the hidden F12 diagnostics panel)
+    std::array<std::unique_ptr<Panel>, 8> panels_;
     size_t active_panel_ = 0;
 
     // Windows
@@ -74,6 +135,19 @@ private:
     std::chrono::steady_clock::time_point last_alert_time_{};
     bool process_enabled_ = false;
 
+    // Once a second: rates, baselines, and alerts for rate anomalies
+    void update_rates();
+
+    // Headless mode (--no-ui)
+    void run_headless();
+
+    // Pipeline benchmark (--bench)
+    void run_bench();
+
+    // Offline replay of a columnar export (--replay)
+    bool load_replay(const std::string& path);
+    std::string replay_status_;
+
     // Event handling
     void handle_key(int key);
     void handle_resize();
@@ -86,7 +160,9 @@ private:
     void render_status_bar();
 
     // Capture control
-    void start_capture(const std::string& interface_name);
+    bool start_capture(const std::string& interface_name);
+    bool start_exporter();
+    bool start_flow_exporter();
     void stop_capture();
 
     // Panel switching
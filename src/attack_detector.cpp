@@ -0,0 +1,311 @@
+/*
+ * attack_detector.cpp - SYN flood, port scan, host sweep and RST storm detection
+ */
+
+#include "attack_detector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// What a sketch counter or Bloom entry is keyed on, besides the address
+enum Tag : uint64_t {
+    SYNS_SENT = 1,
+    SYNS_RECEIVED,
+    SYNACKS_RECEIVED,   // Answers to a source's SYNs
+    SYNACKS_SENT,       // Answers from a target
+    PORTS,
+    HOSTS,
+    RSTS_RECEIVED,
+    PORT_PAIR,
+    HOST_PAIR,
+    ALERTED,
+};
+
+int64_t to_us(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+}
+
+// splitmix64 finaliser
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t address_hash(const std::array<uint8_t, 16>& addr, uint8_t version) {
+    uint64_t high, low;
+    std::memcpy(&high, addr.data(), 8);
+    std::memcpy(&low, addr.data() + 8, 8);
+    return mix(high ^ mix(low ^ version));
+}
+
+uint64_t key(uint64_t address, Tag tag, uint64_t extra = 0) {
+    return mix(address ^ mix((static_cast<uint64_t>(tag) << 56) ^ extra));
+}
+
+// Probe i of a hash, by double hashing
+size_t probe(uint64_t hash, size_t i) {
+    uint64_t step = (hash >> 32) | 1;
+    return static_cast<size_t>((hash & 0xffffffffULL) + i * step);
+}
+
+size_t power_of_two(size_t n) {
+    size_t size = 64;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+uint32_t percent(uint32_t part, uint32_t whole) {
+    return whole == 0 ? 0 : static_cast<uint32_t>(std::min<uint64_t>(part, whole) * 100 / whole);
+}
+
+}  // namespace
+
+const char* detection_name(DetectionKind kind) {
+    switch (kind) {
+        case DetectionKind::SYN_FLOOD: return "syn-flood";
+        case DetectionKind::SYN_FLOOD_TARGET: return "syn-flood-target";
+        case DetectionKind::PORT_SCAN: return "port-scan";
+        case DetectionKind::HOST_SWEEP: return "host-sweep";
+        case DetectionKind::RST_STORM: return "rst-storm";
+        default: return "unknown";
+    }
+}
+
+std::string DetectionEvent::describe(std::chrono::seconds window) const {
+    std::string within = " in " + std::to_string(window.count()) + "s";
+    std::string answers = ", " + std::to_string(percent(answered, attempts)) + "% answered";
+    switch (kind) {
+        case DetectionKind::SYN_FLOOD:
+            return "SYN flood: " + std::to_string(count) + " SYNs sent" + within + answers;
+        case DetectionKind::SYN_FLOOD_TARGET:
+            return "SYN flood target: " + std::to_string(count) + " SYNs received" + within +
+                   answers;
+        case DetectionKind::PORT_SCAN:
+            return "Port scan: " + std::to_string(count) + " ports" + within + answers;
+        case DetectionKind::HOST_SWEEP:
+            return "Host sweep: " + std::to_string(count) + " hosts" + within + answers;
+        case DetectionKind::RST_STORM:
+            return "RST storm: " + std::to_string(count) + " RSTs received" + within;
+        default:
+            return detection_name(kind);
+    }
+}
+
+void AttackDetector::Sketch::init(size_t width) {
+    size_t size = power_of_two(width);
+    counters.assign(size * DEPTH, 0);
+    mask = size - 1;
+}
+
+uint32_t AttackDetector::Sketch::add(uint64_t hash) {
+    // Conservative update: raise only the rows at the minimum
+    size_t width = mask + 1;
+    std::array<uint32_t*, DEPTH> cells;
+    uint32_t least = UINT32_MAX;
+    for (size_t i = 0; i < DEPTH; ++i) {
+        cells[i] = &counters[i * width + (probe(hash, i) & mask)];
+        least = std::min(least, *cells[i]);
+    }
+    if (least == UINT32_MAX) {
+        return least;
+    }
+    for (uint32_t* cell : cells) {
+        *cell = std::max(*cell, least + 1);
+    }
+    return least + 1;
+}
+
+uint32_t AttackDetector::Sketch::estimate(uint64_t hash) const {
+    size_t width = mask + 1;
+    uint32_t least = UINT32_MAX;
+    for (size_t i = 0; i < DEPTH; ++i) {
+        least = std::min(least, counters[i * width + (probe(hash, i) & mask)]);
+    }
+    return least;
+}
+
+void AttackDetector::Bloom::init(size_t bit_count) {
+    size_t size = power_of_two(bit_count);
+    bits.assign(size / 64, 0);
+    mask = size - 1;
+}
+
+bool AttackDetector::Bloom::insert(uint64_t hash) {
+    bool added = false;
+    for (size_t i = 0; i < 3; ++i) {
+        size_t bit = probe(hash, i) & mask;
+        uint64_t flag = 1ULL << (bit & 63);
+        if (!(bits[bit >> 6] & flag)) {
+            bits[bit >> 6] |= flag;
+            added = true;
+        }
+    }
+    return added;
+}
+
+bool AttackDetector::Bloom::contains(uint64_t hash) const {
+    for (size_t i = 0; i < 3; ++i) {
+        size_t bit = probe(hash, i) & mask;
+        if (!(bits[bit >> 6] & (1ULL << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AttackDetector::Epoch::clear() {
+    std::fill(counts.counters.begin(), counts.counters.end(), 0);
+    std::fill(pairs.bits.begin(), pairs.bits.end(), 0);
+    std::fill(alerted.bits.begin(), alerted.bits.end(), 0);
+}
+
+AttackDetector::AttackDetector(const DetectionConfig& config)
+    : config_(config),
+      window_us_(std::chrono::duration_cast<std::chrono::microseconds>(config.window).count()) {
+    if (window_us_ <= 0) {
+        return;
+    }
+    // Pairs outnumber any one counter, so their filter gets more room
+    size_t width = std::max<size_t>(config.sketch_width, 64);
+    for (Epoch& epoch : epochs_) {
+        epoch.counts.init(width);
+        epoch.pairs.init(width * 64);
+        epoch.alerted.init(width * 4);
+    }
+}
+
+std::optional<DetectionEvent> AttackDetector::on_packet(const PacketInfo& info) {
+    if (window_us_ <= 0 || info.protocol != PROTO_TCP || info.is_fragment()) {
+        return std::nullopt;
+    }
+    bool syn = info.tcp_flags & TCP_SYN;
+    bool ack = info.tcp_flags & TCP_ACK;
+    bool rst = info.tcp_flags & TCP_RST;
+    if (!syn && !rst) {
+        return std::nullopt;
+    }
+
+    stats_.packets++;
+    advance(to_us(info.timestamp));
+    uint64_t src = address_hash(info.src_addr, info.ip_version);
+    uint64_t dst = address_hash(info.dst_addr, info.ip_version);
+    Epoch& epoch = epochs_[current_];
+
+    if (syn && ack) {
+        add(key(dst, SYNACKS_RECEIVED));
+        add(key(src, SYNACKS_SENT));
+        return std::nullopt;
+    }
+    if (rst) {
+        add(key(dst, RSTS_RECEIVED));
+        return check(DetectionKind::RST_STORM, info, dst, windowed(key(dst, RSTS_RECEIVED)), 0, 0);
+    }
+
+    // A connection attempt. A pair the previous epoch already counted is
+    // still in the window through its weighted count; counting it again
+    // would double it.
+    add(key(src, SYNS_SENT));
+    add(key(dst, SYNS_RECEIVED));
+    const Bloom& counted = epochs_[current_ ^ 1].pairs;
+    uint64_t port_pair = key(src, PORT_PAIR, info.dst_port);
+    if (epoch.pairs.insert(port_pair) && !counted.contains(port_pair)) {
+        add(key(src, PORTS));
+    }
+    uint64_t host_pair = key(src, HOST_PAIR, dst);
+    if (epoch.pairs.insert(host_pair) && !counted.contains(host_pair)) {
+        add(key(src, HOSTS));
+    }
+
+    uint32_t sent = windowed(key(src, SYNS_SENT));
+    uint32_t answered = windowed(key(src, SYNACKS_RECEIVED));
+    if (auto event = check(DetectionKind::SYN_FLOOD, info, src, sent, sent, answered)) {
+        return event;
+    }
+    if (auto event = check(DetectionKind::PORT_SCAN, info, src, windowed(key(src, PORTS)), sent,
+                           answered)) {
+        return event;
+    }
+    if (auto event = check(DetectionKind::HOST_SWEEP, info, src, windowed(key(src, HOSTS)), sent,
+                           answered)) {
+        return event;
+    }
+    uint32_t received = windowed(key(dst, SYNS_RECEIVED));
+    return check(DetectionKind::SYN_FLOOD_TARGET, info, dst, received, received,
+                 windowed(key(dst, SYNACKS_SENT)));
+}
+
+void AttackDetector::advance(int64_t now_us) {
+    if (epoch_start_us_ < 0) {
+        epoch_start_us_ = now_us;
+    }
+    int64_t elapsed = now_us - epoch_start_us_;
+    if (elapsed >= 2 * window_us_) {
+        // Idle past both epochs: nothing overlaps any more
+        epochs_[0].clear();
+        epochs_[1].clear();
+        epoch_start_us_ = now_us;
+        elapsed = 0;
+    } else if (elapsed >= window_us_) {
+        current_ ^= 1;
+        epochs_[current_].clear();
+        epoch_start_us_ += window_us_;
+        elapsed -= window_us_;
+    }
+    // Packets slightly out of order count as the epoch's start
+    elapsed = std::max<int64_t>(elapsed, 0);
+    previous_weight_ = 1.0 - static_cast<double>(elapsed) / static_cast<double>(window_us_);
+}
+
+uint32_t AttackDetector::windowed(uint64_t hash) const {
+    uint32_t current = epochs_[current_].counts.estimate(hash);
+    uint32_t previous = epochs_[current_ ^ 1].counts.estimate(hash);
+    return current + static_cast<uint32_t>(std::lround(previous * previous_weight_));
+}
+
+uint32_t AttackDetector::add(uint64_t hash) {
+    return epochs_[current_].counts.add(hash);
+}
+
+uint32_t AttackDetector::threshold(DetectionKind kind) const {
+    switch (kind) {
+        case DetectionKind::SYN_FLOOD:
+        case DetectionKind::SYN_FLOOD_TARGET: return config_.syn_flood;
+        case DetectionKind::PORT_SCAN: return config_.port_scan;
+        case DetectionKind::HOST_SWEEP: return config_.host_sweep;
+        case DetectionKind::RST_STORM: return config_.rst_storm;
+        default: return UINT32_MAX;
+    }
+}
+
+std::optional<DetectionEvent> AttackDetector::check(DetectionKind kind, const PacketInfo& info,
+                                                    uint64_t address, uint32_t count,
+                                                    uint32_t attempts, uint32_t answered) {
+    if (count < threshold(kind)) {
+        return std::nullopt;
+    }
+    // Mostly answered attempts are a busy client or server, not an attack
+    if (attempts > 0 && answered >= config_.answered_ratio * attempts) {
+        return std::nullopt;
+    }
+    uint64_t once = key(address, ALERTED, static_cast<uint64_t>(kind));
+    if (epochs_[0].alerted.contains(once) || epochs_[1].alerted.contains(once)) {
+        return std::nullopt;
+    }
+    epochs_[current_].alerted.insert(once);
+    stats_.alerts[static_cast<size_t>(kind)]++;
+
+    DetectionEvent event;
+    event.kind = kind;
+    bool source = kind == DetectionKind::SYN_FLOOD || kind == DetectionKind::PORT_SCAN ||
+                  kind == DetectionKind::HOST_SWEEP;
+    event.address = source ? info.src_ip : info.dst_ip;
+    event.count = count;
+    event.attempts = attempts;
+    event.answered = answered;
+    return event;
+}
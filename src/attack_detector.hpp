@@ -0,0 +1,134 @@
+/*
+ * attack_detector.hpp - SYN flood, port scan, host sweep and RST storm detection
+ *
+ * Watches TCP connection attempts for behaviour no static watchlist
+ * pattern can describe:
+ *
+ *   - SYN flood: a source sending, or a target receiving, at least
+ *     syn_flood SYNs in the window with fewer than answered_ratio of them
+ *     answered by a SYN-ACK.
+ *   - Port scan: a source trying at least port_scan distinct destination
+ *     ports, mostly unanswered.
+ *   - Host sweep: a source trying at least host_sweep distinct destination
+ *     hosts, mostly unanswered.
+ *   - RST storm: a host receiving at least rst_storm RSTs (refused or
+ *     torn-down connections).
+ *
+ * Nothing is kept per address. Counts live in count-min sketches (with
+ * conservative update) keyed by address and counter kind, and "distinct"
+ * counts go up only when a Bloom filter has not seen the (source, port)
+ * or (source, host) pair before, so memory is fixed by sketch_width
+ * however many addresses appear. Epochs are one window long, and a count
+ * is the current epoch's plus the previous epoch's weighted by how much of
+ * it still overlaps a window ending now. A pair already seen in the
+ * previous epoch is not counted again in the current one, so a scan that
+ * spans the epoch boundary is not counted twice; such a pair fades with
+ * the previous epoch's weight, so distinct counts may err slightly low.
+ * Each address raises each kind of alert at most once per window. Other
+ * estimates can only err high, and only by collisions, which sketch_width
+ * keeps rare.
+ *
+ * Packet time drives the window. Not thread-safe: owned by the pipeline
+ * thread.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct DetectionConfig {
+    std::chrono::seconds window{10};     // 0 disables detection
+    uint32_t syn_flood = 500;            // SYNs from or to one host
+    uint32_t port_scan = 100;            // Distinct destination ports from one source
+    uint32_t host_sweep = 50;            // Distinct destination hosts from one source
+    uint32_t rst_storm = 200;            // RSTs received by one host
+    double answered_ratio = 0.5;         // Fewer SYNs answered than this is suspicious
+    size_t sketch_width = 16384;         // Counters per sketch row, rounded up to a power of two
+};
+
+enum class DetectionKind : uint8_t { SYN_FLOOD, SYN_FLOOD_TARGET, PORT_SCAN, HOST_SWEEP, RST_STORM, COUNT };
+
+constexpr size_t DETECTION_KINDS = static_cast<size_t>(DetectionKind::COUNT);
+
+// Short name, e.g. "port-scan" (the alert's pattern)
+const char* detection_name(DetectionKind kind);
+
+struct DetectionEvent {
+    DetectionKind kind = DetectionKind::SYN_FLOOD;
+    std::string address;          // Source, or the target of a SYN flood
+    uint32_t count = 0;           // SYNs, ports, hosts or RSTs in the window
+    uint32_t attempts = 0;        // SYNs behind the count (0 for RST storms)
+    uint32_t answered = 0;        // SYN-ACKs to those SYNs
+
+    // Alert label, e.g. "Port scan: 143 ports in 10s, 2% answered"
+    std::string describe(std::chrono::seconds window) const;
+};
+
+struct DetectionStats {
+    uint64_t packets = 0;         // SYN, SYN-ACK and RST segments examined
+    std::array<uint64_t, DETECTION_KINDS> alerts{};
+};
+
+class AttackDetector {
+public:
+    explicit AttackDetector(const DetectionConfig& config = DetectionConfig());
+
+    // Feed a parsed packet; returns a detection when this packet takes an
+    // address over a threshold it has not alerted on within the window
+    std::optional<DetectionEvent> on_packet(const PacketInfo& info);
+
+    const DetectionStats& stats() const { return stats_; }
+    const DetectionConfig& config() const { return config_; }
+
+private:
+    // Count-min sketch of depth rows; add() applies conservative update
+    struct Sketch {
+        static constexpr size_t DEPTH = 4;
+        std::vector<uint32_t> counters;
+        size_t mask = 0;
+
+        void init(size_t width);
+        uint32_t add(uint64_t hash);
+        uint32_t estimate(uint64_t hash) const;
+    };
+
+    // Bloom filter with three probes; insert() says whether the key was new
+    struct Bloom {
+        std::vector<uint64_t> bits;
+        size_t mask = 0;
+
+        void init(size_t bit_count);
+        bool insert(uint64_t hash);
+        bool contains(uint64_t hash) const;
+    };
+
+    struct Epoch {
+        Sketch counts;
+        Bloom pairs;                 // (source, port) and (source, host) seen
+        Bloom alerted;               // (kind, address) already reported
+        void clear();
+    };
+
+    void advance(int64_t now_us);
+    // Current plus the overlapping share of the previous epoch
+    uint32_t windowed(uint64_t hash) const;
+    uint32_t add(uint64_t hash);
+    std::optional<DetectionEvent> check(DetectionKind kind, const PacketInfo& info,
+                                        uint64_t address, uint32_t count, uint32_t attempts,
+                                        uint32_t answered);
+    uint32_t threshold(DetectionKind kind) const;
+
+    DetectionConfig config_;
+    int64_t window_us_ = 0;
+    int64_t epoch_start_us_ = -1;
+    double previous_weight_ = 0.0;
+    std::array<Epoch, 2> epochs_;
+    size_t current_ = 0;
+    DetectionStats stats_;
+};
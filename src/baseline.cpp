@@ -0,0 +1,230 @@
+/*
+ * baseline.cpp - Learned rate baselines and anomaly detection implementation
+ */
+
+#include "baseline.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Same units as the UI's rate display
+std::string format_value(double value, bool bytes) {
+    char text[32];
+    if (!bytes) {
+        std::snprintf(text, sizeof(text), "%.0f pkt/s", value);
+    } else if (value >= 1000000000.0) {
+        std::snprintf(text, sizeof(text), "%.1f GB/s", value / 1000000000.0);
+    } else if (value >= 1000000.0) {
+        std::snprintf(text, sizeof(text), "%.1f MB/s", value / 1000000.0);
+    } else if (value >= 1000.0) {
+        std::snprintf(text, sizeof(text), "%.1f KB/s", value / 1000.0);
+    } else {
+        std::snprintf(text, sizeof(text), "%.1f B/s", value);
+    }
+    return text;
+}
+
+}  // namespace
+
+bool RateSeries::update(double value, double floor, const BaselineConfig& config) {
+    if (samples_ == 0) {
+        level_ = value;
+        samples_ = 1;
+        return false;
+    }
+
+    double predicted = level_ + trend_;
+    double error = value - predicted;
+    double threshold = config.sigmas * std::sqrt(variance_);
+    bool warm = samples_ >= config.warmup;
+    anomalous_ = warm && std::fabs(error) > threshold && std::fabs(error) > floor;
+
+    // Learn at most a threshold's worth from one tick
+    if (warm) {
+        double limit = std::max(threshold, floor);
+        error = std::clamp(error, -limit, limit);
+    }
+    double level = predicted + config.alpha * error;
+    trend_ = config.beta * (level - level_) + (1.0 - config.beta) * trend_;
+    level_ = level;
+    variance_ = (1.0 - config.alpha) * variance_ + config.alpha * error * error;
+    if (samples_ < UINT32_MAX) {
+        samples_++;
+    }
+    return anomalous_;
+}
+
+double RateSeries::sigma() const {
+    return std::sqrt(variance_);
+}
+
+std::string BaselineAnomaly::describe() const {
+    char deviation[32] = "steady until now";
+    if (sigma > 0.0) {
+        std::snprintf(deviation, sizeof(deviation), "%+.1f sigma", (value - expected) / sigma);
+    }
+    return "Rate anomaly: " + series + " " + format_value(value, bytes) + ", expected " +
+           format_value(expected, bytes) + " (" + deviation + ")";
+}
+
+BaselineMonitor::BaselineMonitor(const BaselineConfig& config) : config_(config) {}
+
+void BaselineMonitor::set_config(const BaselineConfig& config) {
+    config_ = config;
+    clear();
+}
+
+void BaselineMonitor::clear() {
+    total_packets_ = RateSeries();
+    total_bytes_ = RateSeries();
+    protocols_.clear();
+    hosts_.clear();
+    volumes_.clear();
+    heap_.clear();
+    heap_pos_.clear();
+    host_slots_.clear();
+}
+
+void BaselineMonitor::count(const PacketInfo& pkt) {
+    if (!enabled() || config_.max_hosts == 0) {
+        return;
+    }
+    if (!pkt.src_ip.empty()) {
+        count_host(pkt.src_ip, pkt.original_length);
+    }
+    if (!pkt.dst_ip.empty() && pkt.dst_ip != pkt.src_ip) {
+        count_host(pkt.dst_ip, pkt.original_length);
+    }
+}
+
+void BaselineMonitor::count_host(const std::string& address, uint32_t length) {
+    auto it = host_slots_.find(address);
+    if (it != host_slots_.end()) {
+        hosts_[it->second].bytes += length;
+        volumes_[it->second] += length;
+        sift_down(heap_pos_[it->second]);
+        return;
+    }
+
+    size_t slot = hosts_.size();
+    if (slot < config_.max_hosts) {
+        hosts_.emplace_back();
+        volumes_.push_back(0);
+        heap_pos_.push_back(heap_.size());
+        heap_.push_back(slot);
+    } else {
+        // The lightest host makes room; its count carries over, so the
+        // newcomer must outweigh the others' recent traffic to stay
+        slot = heap_.front();
+        host_slots_.erase(hosts_[slot].address);
+        hosts_[slot] = Host();
+    }
+    hosts_[slot].address = address;
+    hosts_[slot].bytes = length;
+    volumes_[slot] += length;
+    host_slots_.emplace(address, slot);
+    sift_up(heap_pos_[slot]);
+    sift_down(heap_pos_[slot]);
+}
+
+void BaselineMonitor::sift_up(size_t pos) {
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (volumes_[heap_[parent]] <= volumes_[heap_[pos]]) {
+            break;
+        }
+        swap_heap(pos, parent);
+        pos = parent;
+    }
+}
+
+void BaselineMonitor::sift_down(size_t pos) {
+    while (true) {
+        size_t least = pos;
+        for (size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap_.size(); ++child) {
+            if (volumes_[heap_[child]] < volumes_[heap_[least]]) {
+                least = child;
+            }
+        }
+        if (least == pos) {
+            break;
+        }
+        swap_heap(pos, least);
+        pos = least;
+    }
+}
+
+void BaselineMonitor::swap_heap(size_t a, size_t b) {
+    std::swap(heap_[a], heap_[b]);
+    heap_pos_[heap_[a]] = a;
+    heap_pos_[heap_[b]] = b;
+}
+
+uint8_t BaselineMonitor::tick(double packets_per_second, double bytes_per_second,
+                              const std::map<std::string, uint64_t>& protocol_counts,
+                              double elapsed, std::vector<BaselineAnomaly>& found) {
+    if (!enabled() || elapsed <= 0.0) {
+        return 0;
+    }
+
+    uint8_t flags = 0;
+    if (observe(total_packets_, "total", false, packets_per_second, found)) {
+        flags |= ANOMALY_PACKETS;
+    }
+    if (observe(total_bytes_, "total", true, bytes_per_second, found)) {
+        flags |= ANOMALY_BYTES;
+    }
+
+    // Protocol counts only grow until the store is cleared
+    for (const auto& [name, count] : protocol_counts) {
+        auto [it, added] = protocols_.try_emplace(name);
+        Protocol& protocol = it->second;
+        if (added) {
+            // Counted before the baselines started (or were reset)
+            protocol.last_count = count;
+            continue;
+        }
+        double rate = static_cast<double>(count - std::min(count, protocol.last_count)) / elapsed;
+        protocol.last_count = count;
+        if (observe(protocol.series, name, false, rate, found)) {
+            flags |= ANOMALY_PACKETS;
+        }
+    }
+
+    // Hosts not seen this tick fall towards zero. Halving every count
+    // keeps their order, so the heap needs no repair.
+    for (size_t i = 0; i < hosts_.size(); ++i) {
+        Host& host = hosts_[i];
+        double rate = static_cast<double>(host.bytes) / elapsed;
+        host.bytes = 0;
+        volumes_[i] /= 2;
+        if (observe(host.series, host.address, true, rate, found)) {
+            flags |= ANOMALY_BYTES;
+        }
+    }
+    return flags;
+}
+
+bool BaselineMonitor::observe(RateSeries& series, const std::string& name, bool bytes,
+                              double value, std::vector<BaselineAnomaly>& found) {
+    bool was_anomalous = series.anomalous();
+    double expected = series.forecast();
+    double sigma = series.sigma();
+    double floor = std::max(config_.min_ratio * expected,
+                            bytes ? config_.min_bytes : config_.min_packets);
+    if (!series.update(value, floor, config_)) {
+        return false;
+    }
+    if (!was_anomalous) {
+        BaselineAnomaly anomaly;
+        anomaly.series = name;
+        anomaly.bytes = bytes;
+        anomaly.value = value;
+        anomaly.expected = expected;
+        anomaly.sigma = sigma;
+        found.push_back(std::move(anomaly));
+    }
+    return true;
+}
@@ -0,0 +1,137 @@
+/*
+ * baseline.hpp - Learned rate baselines and anomaly detection
+ *
+ * Learns what normal looks like for the once-a-second rates PacketStore
+ * computes: total packets and bytes per second, packets per second of each
+ * protocol in protocol_counts, and bytes per second of each host seen. Each
+ * series is a Holt forecast (exponentially smoothed level plus trend) with
+ * an exponentially weighted variance of its forecast errors, so a tick is a
+ * few multiply-adds on four numbers per series.
+ *
+ * A rate that misses its forecast by more than `sigmas` standard deviations
+ * is anomalous, provided the miss is also larger than a floor (a share of
+ * the forecast and an absolute minimum) so near-constant series do not
+ * alert on noise. Errors feed the variance clipped to that threshold: a
+ * spike does not become the new normal, while a lasting change widens the
+ * variance until the forecast has caught up. A series is reported when it
+ * turns anomalous and not again until it has been normal for a tick, and
+ * never during its first `warmup` ticks.
+ *
+ * Hosts are counted per packet (source and destination) in a table of at
+ * most max_hosts entries kept by space-saving: a new host takes the slot of
+ * the one with the fewest recent bytes and inherits its count, so a stream
+ * of one-off sources churns the light slots while heavy hitters keep their
+ * series. A min-heap over the counts finds that slot in O(log n). Counts
+ * halve every tick, so recent traffic decides. There is no
+ * seasonal term: at one tick per second, a daily season would cost 86400
+ * slots per series. Not thread-safe: PacketStore calls it under its mutex.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BaselineConfig {
+    double sigmas = 4.0;          // Deviation that is anomalous; 0 disables baselines
+    double alpha = 0.1;           // Level and variance smoothing per tick
+    double beta = 0.02;           // Trend smoothing per tick
+    uint32_t warmup = 30;         // Ticks before a series may be reported
+    double min_ratio = 0.25;      // A deviation must also exceed this share of the forecast
+    double min_packets = 10.0;    // ... and this many pkt/s
+    double min_bytes = 10000.0;   // ... or B/s
+    size_t max_hosts = 256;
+};
+
+// Holt forecast and error variance of one rate series
+class RateSeries {
+public:
+    // Feed one tick's rate; true if it missed the forecast by more than
+    // config.sigmas standard deviations and by more than floor
+    bool update(double value, double floor, const BaselineConfig& config);
+
+    double forecast() const { return level_ + trend_ > 0.0 ? level_ + trend_ : 0.0; }
+    double sigma() const;
+    uint32_t samples() const { return samples_; }
+    bool anomalous() const { return anomalous_; }   // The last tick was
+
+private:
+    double level_ = 0.0;
+    double trend_ = 0.0;
+    double variance_ = 0.0;
+    uint32_t samples_ = 0;
+    bool anomalous_ = false;
+};
+
+struct BaselineAnomaly {
+    std::string series;           // "total", a protocol name or a host address
+    bool bytes = false;           // B/s rather than pkt/s
+    double value = 0.0;
+    double expected = 0.0;
+    double sigma = 0.0;
+
+    // Alert label, e.g. "Rate anomaly: TCP 5400 pkt/s, expected 800 (+28.0 sigma)"
+    std::string describe() const;
+};
+
+// Which graph a tick's anomalies belong on
+constexpr uint8_t ANOMALY_PACKETS = 0x01;   // Total or protocol pkt/s
+constexpr uint8_t ANOMALY_BYTES = 0x02;     // Total or host B/s
+
+class BaselineMonitor {
+public:
+    explicit BaselineMonitor(const BaselineConfig& config = BaselineConfig());
+
+    // Replaces the configuration and forgets everything learned
+    void set_config(const BaselineConfig& config);
+    const BaselineConfig& config() const { return config_; }
+    bool enabled() const { return config_.sigmas > 0.0; }
+
+    // Count a packet's bytes towards its hosts' current tick
+    void count(const PacketInfo& pkt);
+
+    // Close a tick of `elapsed` seconds. Series newly anomalous are
+    // appended to found; returns the ANOMALY_* flags of every series that
+    // was anomalous this tick.
+    uint8_t tick(double packets_per_second, double bytes_per_second,
+                 const std::map<std::string, uint64_t>& protocol_counts, double elapsed,
+                 std::vector<BaselineAnomaly>& found);
+
+    void clear();
+    size_t series_count() const { return 2 + protocols_.size() + hosts_.size(); }
+    bool has_host(const std::string& address) const { return host_slots_.count(address) > 0; }
+
+private:
+    struct Protocol {
+        RateSeries series;
+        uint64_t last_count = 0;
+    };
+
+    struct Host {
+        std::string address;
+        RateSeries series;
+        uint64_t bytes = 0;       // This tick
+    };
+
+    // Update a series; true if it is anomalous, reporting it if newly so
+    bool observe(RateSeries& series, const std::string& name, bool bytes, double value,
+                 std::vector<BaselineAnomaly>& found);
+    void count_host(const std::string& address, uint32_t length);
+    void sift_up(size_t pos);
+    void sift_down(size_t pos);
+    void swap_heap(size_t a, size_t b);
+
+    BaselineConfig config_;
+    RateSeries total_packets_;
+    RateSeries total_bytes_;
+    std::unordered_map<std::string, Protocol> protocols_;
+    std::vector<Host> hosts_;
+    std::vector<uint64_t> volumes_;   // Space-saving count of each slot in hosts_
+    std::vector<size_t> heap_;        // Slots, a min-heap on volumes_
+    std::vector<size_t> heap_pos_;    // Each slot's index in heap_
+    std::unordered_map<std::string, size_t> host_slots_;
+};
@@ -0,0 +1,206 @@
+/*
+ * bench.cpp - End-to-end pipeline benchmark implementation
+ */
+
+#include "bench.hpp"
+#include "alloc_counter.hpp"
+#include "pipeline.hpp"
+#include "traffic_gen.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <sys/resource.h>
+
+namespace {
+
+constexpr uint64_t DEFAULT_GENERATED_PACKETS = 1000000;
+constexpr size_t MAX_GENERATED_FRAMES = 1u << 20;
+constexpr uint64_t TICK_INTERVAL = 4096;  // Packets between pipeline ticks
+
+// Stages that run per packet, in pipeline order
+constexpr Stage PACKET_STAGES[] = {
+    Stage::PARSE, Stage::CHECKSUM, Stage::REASSEMBLE, Stage::TCP,
+    Stage::HTTP, Stage::QUIC, Stage::RESOLVE, Stage::WATCHLIST,
+    Stage::DETECT, Stage::DESCRIBE, Stage::PROCESS, Stage::STORE,
+};
+
+uint64_t peak_rss_bytes() {
+    struct rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // Linux reports KiB
+}
+
+std::string json_escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+bool FrameBuffer::add(uint64_t timestamp_us, const uint8_t* data, uint32_t caplen, uint32_t len) {
+    if (bytes_.size() + caplen > MAX_BYTES) {
+        return false;
+    }
+    frames_.push_back(Frame{bytes_.size(), timestamp_us, caplen, len});
+    bytes_.insert(bytes_.end(), data, data + caplen);
+    return true;
+}
+
+void bench_generate_frames(const BenchConfig& config, FrameBuffer& frames) {
+    TrafficProfile profile;
+    profile.seed = config.seed;
+    profile.flows = config.flows;
+    TrafficGenerator generator(profile);
+
+    uint64_t wanted = config.packets ? config.packets : DEFAULT_GENERATED_PACKETS;
+    uint64_t count = std::min<uint64_t>(wanted, MAX_GENERATED_FRAMES);
+    for (uint64_t i = 0; i < count; ++i) {
+        GeneratedFrame frame = generator.next();
+        if (!frames.add(frame.timestamp_us, frame.data, frame.length, frame.length)) {
+            break;
+        }
+    }
+}
+
+BenchResult run_benchmark(const BenchConfig& config, const FrameBuffer& frames,
+                          PacketPipeline& pipeline, const StageProfiler& profiler) {
+    BenchResult result;
+    result.config = config;
+    result.frames_loaded = frames.size();
+    result.frame_buffer_bytes = frames.bytes();
+    if (frames.size() == 0) {
+        return result;
+    }
+
+    uint64_t packets = config.packets;
+    if (packets == 0) {
+        packets = config.source == "gen" ? DEFAULT_GENERATED_PACKETS : frames.size();
+    }
+
+    // Each replay of the buffer is shifted past the previous one
+    uint64_t first_us = frames.frame(0).timestamp_us;
+    uint64_t lap_us = frames.frame(frames.size() - 1).timestamp_us - first_us + 1;
+    uint64_t lap_offset_us = 0;
+    size_t index = 0;
+
+    uint64_t allocations_before = thread_allocation_count();
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i < packets; ++i) {
+        const FrameBuffer::Frame& frame = frames.frame(index);
+        auto timestamp = std::chrono::system_clock::time_point(
+            std::chrono::microseconds(frame.timestamp_us + lap_offset_us));
+        pipeline.process(frames.data(frame), frame.caplen, frame.len, timestamp);
+        result.bytes += frame.len;
+
+        if (++index == frames.size()) {
+            index = 0;
+            lap_offset_us += lap_us;
+        }
+        if (i % TICK_INTERVAL == 0) {
+            pipeline.tick();
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.allocations = thread_allocation_count() - allocations_before;
+    result.packets = packets;
+    result.peak_rss_bytes = peak_rss_bytes();
+
+    for (Stage stage : PACKET_STAGES) {
+        HistogramSnapshot hist = profiler.snapshot(stage);
+        if (hist.count == 0) {
+            continue;
+        }
+        StageResult sr;
+        sr.stage = stage;
+        sr.calls = hist.count;
+        sr.mean_ns = hist.mean_ns();
+        sr.p50_ns = hist.percentile(0.5);
+        sr.p99_ns = hist.percentile(0.99);
+        sr.max_ns = hist.max_ns;
+        result.stages.push_back(sr);
+    }
+
+    return result;
+}
+
+std::string format_bench_json(const BenchResult& result) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "{\n"
+        << "  \"format_version\": 1,\n"
+        << "  \"source\": \"" << json_escape(result.config.source) << "\",\n"
+        << "  \"seed\": " << result.config.seed << ",\n"
+        << "  \"flows\": " << result.config.flows << ",\n"
+        << "  \"process_attribution\": " << (result.config.process ? "true" : "false") << ",\n"
+        << "  \"frames_loaded\": " << result.frames_loaded << ",\n"
+        << "  \"frame_buffer_bytes\": " << result.frame_buffer_bytes << ",\n"
+        << "  \"packets\": " << result.packets << ",\n"
+        << "  \"bytes\": " << result.bytes << ",\n"
+        << "  \"seconds\": " << std::setprecision(6) << result.seconds << std::setprecision(1) << ",\n"
+        << "  \"packets_per_second\": " << result.packets_per_second() << ",\n"
+        << "  \"ns_per_packet\": " << result.ns_per_packet() << ",\n"
+        << "  \"allocations_per_packet\": " << std::setprecision(3);
+    if (ALLOCATION_COUNTING) {
+        out << result.allocations_per_packet();
+    } else {
+        out << "null";   // Not counted in this build
+    }
+    out << std::setprecision(1) << ",\n"
+        << "  \"peak_rss_bytes\": " << result.peak_rss_bytes << ",\n"
+        << "  \"stages\": {";
+
+    for (size_t i = 0; i < result.stages.size(); ++i) {
+        const StageResult& sr = result.stages[i];
+        out << (i ? ",\n" : "\n")
+            << "    \"" << stage_name(sr.stage) << "\": {"
+            << "\"calls\": " << sr.calls
+            << ", \"mean_ns\": " << sr.mean_ns
+            << ", \"p50_ns\": " << sr.p50_ns
+            << ", \"p99_ns\": " << sr.p99_ns
+            << ", \"max_ns\": " << sr.max_ns << "}";
+    }
+    out << (result.stages.empty() ? "}\n" : "\n  }\n") << "}\n";
+    return out.str();
+}
+
+std::string format_bench_summary(const BenchResult& result) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << result.packets << " packets from " << result.config.source
+        << " (" << result.frames_loaded << " frames loaded) in "
+        << std::setprecision(3) << result.seconds << " s\n" << std::setprecision(1)
+        << "  " << result.packets_per_second() << " packets/s, "
+        << result.ns_per_packet() << " ns/packet, ";
+    if (ALLOCATION_COUNTING) {
+        out << std::setprecision(2) << result.allocations_per_packet() << " allocations/packet, ";
+    }
+    out << "peak RSS " << std::setprecision(1) << result.peak_rss_bytes / 1048576.0 << " MiB\n";
+
+    out << "  " << std::left << std::setw(10) << "stage" << std::right
+        << std::setw(10) << "mean ns" << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns"
+        << '\n';
+    for (const StageResult& sr : result.stages) {
+        out << "  " << std::left << std::setw(10) << stage_name(sr.stage) << std::right
+            << std::setw(10) << sr.mean_ns << std::setw(10) << sr.p50_ns
+            << std::setw(10) << sr.p99_ns << '\n';
+    }
+    return out.str();
+}
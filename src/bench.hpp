@@ -0,0 +1,93 @@
+/*
+ * bench.hpp - End-to-end pipeline benchmark (--bench)
+ *
+ * Loads frames into memory first, from a capture file or the synthetic
+ * traffic generator, then drives them through a PacketPipeline (parse,
+ * watchlist, description lookup, optional process attribution, store) with
+ * no UI and no I/O in the timed loop. When more packets are requested than
+ * were loaded, the frames are replayed with shifted timestamps.
+ *
+ * Reports packets/s, wall-clock ns per packet, mean/p50/p99 ns per stage
+ * (from the StageProfiler, so including its clock reads), heap allocations
+ * per packet on the pipeline thread, and peak RSS. format_bench_json()
+ * output is stable so runs can be diffed across commits.
+ */
+
+#pragma once
+
+#include "instrumentation.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class PacketPipeline;
+
+struct BenchConfig {
+    std::string source = "gen";   // "gen" or a pcap/pcapng file
+    uint64_t packets = 0;         // 0: 1M for gen, each file frame once
+    uint64_t seed = 1;            // Generator only
+    uint32_t flows = 1000;        // Generator only
+    bool process = false;         // Include process attribution
+};
+
+// Frames stored back to back so the timed loop only reads memory
+class FrameBuffer {
+public:
+    struct Frame {
+        uint64_t offset;
+        uint64_t timestamp_us;
+        uint32_t caplen;
+        uint32_t len;
+    };
+
+    static constexpr size_t MAX_BYTES = 256u << 20;
+
+    // Returns false (and stores nothing) once MAX_BYTES is reached
+    bool add(uint64_t timestamp_us, const uint8_t* data, uint32_t caplen, uint32_t len);
+
+    size_t size() const { return frames_.size(); }
+    uint64_t bytes() const { return bytes_.size(); }
+    const Frame& frame(size_t index) const { return frames_[index]; }
+    const uint8_t* data(const Frame& frame) const { return bytes_.data() + frame.offset; }
+
+private:
+    std::vector<uint8_t> bytes_;
+    std::vector<Frame> frames_;
+};
+
+struct StageResult {
+    Stage stage;
+    uint64_t calls = 0;
+    double mean_ns = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+struct BenchResult {
+    BenchConfig config;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t frames_loaded = 0;
+    uint64_t frame_buffer_bytes = 0;
+    double seconds = 0;
+    uint64_t allocations = 0;
+    uint64_t peak_rss_bytes = 0;
+    std::vector<StageResult> stages;   // Stages that ran, in pipeline order
+
+    double packets_per_second() const { return seconds > 0 ? packets / seconds : 0; }
+    double ns_per_packet() const { return packets ? seconds * 1e9 / packets : 0; }
+    double allocations_per_packet() const {
+        return packets ? static_cast<double>(allocations) / packets : 0;
+    }
+};
+
+// Fill frames from the traffic generator (config.seed/flows)
+void bench_generate_frames(const BenchConfig& config, FrameBuffer& frames);
+
+// Time the packet loop; the profiler must be the pipeline's and start empty
+BenchResult run_benchmark(const BenchConfig& config, const FrameBuffer& frames,
+                          PacketPipeline& pipeline, const StageProfiler& profiler);
+
+std::string format_bench_json(const BenchResult& result);
+std::string format_bench_summary(const BenchResult& result);
@@ -1,20 +1,18 @@
 /*
  * capture.cpp - libpcap-based packet capture implementation
  *
- * Handles opening network interfaces, running the capture loop in a background
- * thread, and parsing captured packets. Uses pcap_dispatch() with a callback
- * that pushes parsed packets to the PacketStore.
- *
- * Optionally checks packets against a Watchlist and performs process attribution.
+ * Handles opening network interfaces and running the capture loop in a
+ * background thread. Uses pcap_dispatch() with a callback that hands each
+ * frame to the PacketPipeline. Drop counters are polled from pcap_stats()
+ * about once a second.
  */
 
 #include "capture.hpp"
-#include "process_mapper.hpp"
-#include "watchlist.hpp"
+#include "metrics.hpp"
 #include <arpa/inet.h>
 #include <cstring>
 
-PacketCapture::PacketCapture(PacketStore& store) : store_(store) {}
+PacketCapture::PacketCapture(PacketStore& store) : store_(store), pipeline_(store) {}
 
 PacketCapture::~PacketCapture() {
     stop();
@@ -93,14 +91,30 @@ bool PacketCapture::open(const std::string& interface_name) {
         // Non-fatal, continue anyway
     }
 
+    // Resolve the framing once; every frame of this handle shares it
+    pipeline_.set_link_type(link_type_from_dlt(pcap_datalink(handle_)));
+
     interface_name_ = interface_name;
     store_.set_interface_name(interface_name);
+    if (pipeline_.metrics()) {
+        pipeline_.metrics()->set_interface_name(interface_name);
+    }
+    last_kernel_drops_ = 0;
+    last_interface_drops_ = 0;
     store_.clear();
     error_.clear();
 
     return true;
 }
 
+int PacketCapture::get_datalink() const {
+    return handle_ ? pcap_datalink(handle_) : DLT_EN10MB;
+}
+
+uint32_t PacketCapture::get_snaplen() const {
+    return handle_ ? static_cast<uint32_t>(pcap_snapshot(handle_)) : 65535;
+}
+
 void PacketCapture::start() {
     if (!handle_ || running_.load()) {
         return;
@@ -157,6 +171,9 @@ void PacketCapture::capture_loop() {
             break;
         }
 
+        poll_drop_stats();
+        pipeline_.tick();
+
         // Small sleep if no packets to avoid busy-waiting
         if (result == 0) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -164,50 +181,64 @@ void PacketCapture::capture_loop() {
     }
 }
 
+void PacketCapture::poll_drop_stats() {
+    MetricsRegistry* metrics = pipeline_.metrics();
+    if (!metrics) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_stats_poll_ < std::chrono::seconds(1)) {
+        return;
+    }
+    last_stats_poll_ = now;
+
+    struct pcap_stat ps{};
+    if (pcap_stats(handle_, &ps) != 0) {
+        return;  // Not supported for this handle
+    }
+
+    // pcap counters are per-handle and 32-bit on some platforms; only
+    // forward increases so the exported counters stay monotonic
+    uint64_t kernel = ps.ps_drop;
+    uint64_t iface = ps.ps_ifdrop;
+    metrics->add_capture_drops(kernel > last_kernel_drops_ ? kernel - last_kernel_drops_ : 0,
+                                iface > last_interface_drops_ ? iface - last_interface_drops_ : 0);
+    last_kernel_drops_ = kernel;
+    last_interface_drops_ = iface;
+}
+
 void PacketCapture::packet_callback(u_char* user,
                                     const struct pcap_pkthdr* header,
                                     const u_char* data) {
     auto* self = reinterpret_cast<PacketCapture*>(user);
+    auto timestamp = std::chrono::system_clock::time_point(
+        std::chrono::seconds(header->ts.tv_sec) +
+        std::chrono::microseconds(header->ts.tv_usec));
+    self->pipeline_.process(data, header->caplen, header->len, timestamp);
+}
 
-    // Parse the packet
-    PacketInfo info = parse_packet(data, header->caplen, header->len);
-
-    // Check against watchlist if configured
-    if (self->watchlist_) {
-        auto match = self->watchlist_->check(info);
-        if (match) {
-            info.watchlist_match = true;
-            info.watchlist_label = match->label;
-
-            // Create and log alert
-            Alert alert;
-            alert.timestamp = std::chrono::system_clock::now();
-            alert.matched_value = info.hostname.empty()
-                                      ? (info.dst_ip.empty() ? info.src_ip : info.dst_ip)
-                                      : info.hostname;
-            alert.pattern = match->pattern;
-            alert.label = match->label;
-            alert.packet_index = self->store_.size();
-
-            self->watchlist_->add_alert(alert);
-        }
+bool PacketCapture::read_file(const std::string& path, const FrameCallback& callback,
+                              int& linktype, std::string& error) {
+    char errbuf[PCAP_ERRBUF_SIZE];
+    pcap_t* handle = pcap_open_offline(path.c_str(), errbuf);
+    if (!handle) {
+        error = errbuf;
+        return false;
     }
+    linktype = pcap_datalink(handle);
 
-    // Process attribution when enabled
-    if (self->process_enabled_.load() && self->process_mapper_) {
-        auto proc = self->process_mapper_->lookup_packet(
-            info.src_ip,
-            info.src_port,
-            info.dst_ip,
-            info.dst_port,
-            info.protocol
-        );
-        if (proc) {
-            info.process_name = proc->name;
-            info.process_pid = proc->pid;
-        }
+    struct pcap_pkthdr* header;
+    const u_char* data;
+    int result;
+    while ((result = pcap_next_ex(handle, &header, &data)) == 1) {
+        callback(*header, data);
     }
 
-    // Push to store (thread-safe)
-    self->store_.push(std::move(info));
+    bool ok = result == PCAP_ERROR_BREAK;
+    if (!ok) {
+        error = pcap_geterr(handle);
+    }
+    pcap_close(handle);
+    return ok;
 }
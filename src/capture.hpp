@@ -2,12 +2,21 @@
  * capture.hpp - Network packet capture using libpcap
  *
  * Wraps libpcap functionality for capturing packets from network interfaces.
- * Runs packet capture in a background thread, parsing each packet and pushing
- * it to the PacketStore for display. Supports interface enumeration, starting/
- * stopping capture, and graceful thread shutdown.
+ * Runs packet capture in a background thread, handing each frame to a
+ * PacketPipeline that parses it and pushes it to the PacketStore for display.
+ * Supports interface enumeration, starting/stopping capture, graceful thread
+ * shutdown, and reading capture files (for the benchmark mode).
  *
- * Optionally integrates with Watchlist for real-time alert checking and
- * ProcessMapper for process attribution.
+ * Optionally integrates with Watchlist for real-time alert checking,
+ * ProcessMapper for process attribution, MetricsRegistry for the
+ * OpenMetrics endpoint (including kernel/interface drop counts from pcap_stats),
+ * PcapngRecorder for saving raw frames to disk, TriggerCapture for
+ * pre/post-alert packet windows, RecordExporter for NDJSON/CSV export,
+ * FlowExporter for IPFIX/NetFlow v9, IpReassembler/TcpReassembler for
+ * fragmented datagrams and application messages split across segments,
+ * QuicDissector for QUIC SNI, DnsCache/DnsTracker for passive DNS, and
+ * AttackDetector for SYN flood and scan alerts;
+ * these are forwarded to the pipeline.
  *
  * Usage: Create a PacketCapture with a PacketStore reference, call open() with
  * an interface name, then start() to begin capturing. Call stop() to end.
@@ -16,7 +25,9 @@
 #pragma once
 
 #include "packet_store.hpp"
+#include "pipeline.hpp"
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <pcap.h>
@@ -24,10 +35,6 @@
 #include <thread>
 #include <vector>
 
-// Forward declarations
-class Watchlist;
-class ProcessMapper;
-
 struct NetworkInterface {
     std::string name;
     std::string description;
@@ -59,19 +66,43 @@ public:
     bool is_running() const { return running_.load(); }
     std::string get_error() const { return error_; }
     std::string get_interface_name() const { return interface_name_; }
+    int get_datalink() const;
+    uint32_t get_snaplen() const;
 
     // Optional integrations
-    void set_watchlist(Watchlist* wl) { watchlist_ = wl; }
-    void set_process_mapper(ProcessMapper* pm) { process_mapper_ = pm; }
-    void set_process_enabled(bool enabled) { process_enabled_.store(enabled); }
-    bool is_process_enabled() const { return process_enabled_.load(); }
+    void set_watchlist(Watchlist* wl) { pipeline_.set_watchlist(wl); }
+    void set_process_mapper(ProcessMapper* pm) { pipeline_.set_process_mapper(pm); }
+    void set_metrics(MetricsRegistry* metrics) { pipeline_.set_metrics(metrics); }
+    void set_recorder(PcapngRecorder* recorder) { pipeline_.set_recorder(recorder); }
+    void set_trigger(TriggerCapture* trigger) { pipeline_.set_trigger(trigger); }
+    void set_exporter(RecordExporter* exporter) { pipeline_.set_exporter(exporter); }
+    void set_flow_exporter(FlowExporter* exporter) { pipeline_.set_flow_exporter(exporter); }
+    void set_reassembler(TcpReassembler* reassembler) { pipeline_.set_reassembler(reassembler); }
+    void set_ip_reassembler(IpReassembler* reassembler) { pipeline_.set_ip_reassembler(reassembler); }
+    void set_quic(QuicDissector* quic) { pipeline_.set_quic(quic); }
+    void set_dns_cache(DnsCache* cache) { pipeline_.set_dns_cache(cache); }
+    void set_dns_tracker(DnsTracker* tracker) { pipeline_.set_dns_tracker(tracker); }
+    void set_tcp_analyzer(TcpAnalyzer* analyzer) { pipeline_.set_tcp_analyzer(analyzer); }
+    void set_http_tracker(HttpTracker* tracker) { pipeline_.set_http_tracker(tracker); }
+    void set_detector(AttackDetector* detector) { pipeline_.set_detector(detector); }
+    void set_checksums(bool enabled) { pipeline_.set_checksums(enabled); }
+    void set_process_enabled(bool enabled) { pipeline_.set_process_enabled(enabled); }
+    bool is_process_enabled() const { return pipeline_.is_process_enabled(); }
+
+    // Read every frame of a pcap/pcapng file and report its DLT_* link type;
+    // returns false with error set on failure
+    using FrameCallback = std::function<void(const struct pcap_pkthdr& header, const u_char* data)>;
+    static bool read_file(const std::string& path, const FrameCallback& callback,
+                          int& linktype, std::string& error);
 
 private:
     void capture_loop();
+    void poll_drop_stats();
     static void packet_callback(u_char* user, const struct pcap_pkthdr* header,
                                 const u_char* data);
 
     PacketStore& store_;
+    PacketPipeline pipeline_;
     pcap_t* handle_ = nullptr;
     std::string interface_name_;
     std::string error_;
@@ -79,8 +110,8 @@ private:
     std::atomic<bool> running_{false};
     std::thread capture_thread_;
 
-    // Optional integrations
-    Watchlist* watchlist_ = nullptr;
-    ProcessMapper* process_mapper_ = nullptr;
-    std::atomic<bool> process_enabled_{false};
+    // Last pcap_stats() values, so the registry receives deltas
+    uint64_t last_kernel_drops_ = 0;
+    uint64_t last_interface_drops_ = 0;
+    std::chrono::steady_clock::time_point last_stats_poll_{};
 };
@@ -0,0 +1,133 @@
+/*
+ * capture_file.cpp - Capture file encoding implementation
+ *
+ * Every pcapng block is: type(4) + total length(4) + body + total length(4),
+ * with the body padded to a 32-bit boundary. Options are code(2) + length(2)
+ * + value padded to 32 bits, terminated by opt_endofopt.
+ */
+
+#include "capture_file.hpp"
+#include <cstring>
+
+namespace {
+
+constexpr uint16_t OPT_ENDOFOPT = 0;
+constexpr uint16_t OPT_COMMENT = 1;
+constexpr uint16_t SHB_USERAPPL = 4;
+constexpr uint16_t IF_NAME = 2;
+
+inline size_t pad4(size_t len) {
+    return (len + 3) & ~static_cast<size_t>(3);
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+    size_t pos = out.size();
+    out.resize(pos + sizeof(T));
+    std::memcpy(out.data() + pos, &value, sizeof(T));
+}
+
+void put_bytes(std::vector<uint8_t>& out, const void* data, size_t len) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + len);
+    out.resize(out.size() + (pad4(len) - len), 0);
+}
+
+void put_option(std::vector<uint8_t>& out, uint16_t code, const std::string& value) {
+    put<uint16_t>(out, code);
+    put<uint16_t>(out, static_cast<uint16_t>(value.size()));
+    put_bytes(out, value.data(), value.size());
+}
+
+// Write the block header and return the offset of the length field to patch
+size_t begin_block(std::vector<uint8_t>& out, uint32_t type) {
+    put<uint32_t>(out, type);
+    size_t len_pos = out.size();
+    put<uint32_t>(out, 0);
+    return len_pos;
+}
+
+void end_block(std::vector<uint8_t>& out, size_t len_pos) {
+    uint32_t total = static_cast<uint32_t>(out.size() - (len_pos - 4) + 4);
+    std::memcpy(out.data() + len_pos, &total, sizeof(total));
+    put<uint32_t>(out, total);
+}
+
+}  // namespace
+
+void pcapng_append_section_header(std::vector<uint8_t>& out, const std::string& application) {
+    size_t len_pos = begin_block(out, PCAPNG_SECTION_HEADER);
+    put<uint32_t>(out, PCAPNG_BYTE_ORDER_MAGIC);
+    put<uint16_t>(out, 1);   // Major version
+    put<uint16_t>(out, 0);   // Minor version
+    put<int64_t>(out, -1);   // Section length unknown (streaming)
+
+    if (!application.empty()) {
+        put_option(out, SHB_USERAPPL, application);
+    }
+    put<uint16_t>(out, OPT_ENDOFOPT);
+    put<uint16_t>(out, 0);
+
+    end_block(out, len_pos);
+}
+
+void pcapng_append_interface(std::vector<uint8_t>& out, uint16_t linktype, uint32_t snaplen,
+                             const std::string& name) {
+    size_t len_pos = begin_block(out, PCAPNG_INTERFACE_DESCRIPTION);
+    put<uint16_t>(out, linktype);
+    put<uint16_t>(out, 0);  // Reserved
+    put<uint32_t>(out, snaplen);
+
+    // No if_tsresol option: the default resolution is microseconds
+    if (!name.empty()) {
+        put_option(out, IF_NAME, name);
+    }
+    put<uint16_t>(out, OPT_ENDOFOPT);
+    put<uint16_t>(out, 0);
+
+    end_block(out, len_pos);
+}
+
+size_t pcapng_append_packet(std::vector<uint8_t>& out, uint32_t interface_id,
+                            uint64_t timestamp_us, const uint8_t* data, uint32_t caplen,
+                            uint32_t original_length, const std::string& comment) {
+    size_t start = out.size();
+
+    size_t len_pos = begin_block(out, PCAPNG_ENHANCED_PACKET);
+    put<uint32_t>(out, interface_id);
+    put<uint32_t>(out, static_cast<uint32_t>(timestamp_us >> 32));
+    put<uint32_t>(out, static_cast<uint32_t>(timestamp_us & 0xFFFFFFFF));
+    put<uint32_t>(out, caplen);
+    put<uint32_t>(out, original_length);
+    put_bytes(out, data, caplen);
+
+    if (!comment.empty()) {
+        put_option(out, OPT_COMMENT, comment);
+        put<uint16_t>(out, OPT_ENDOFOPT);
+        put<uint16_t>(out, 0);
+    }
+
+    end_block(out, len_pos);
+    return out.size() - start;
+}
+
+void pcap_append_file_header(std::vector<uint8_t>& out, uint32_t linktype, uint32_t snaplen) {
+    put<uint32_t>(out, PCAP_MAGIC_MICROS);
+    put<uint16_t>(out, 2);   // Major version
+    put<uint16_t>(out, 4);   // Minor version
+    put<int32_t>(out, 0);    // thiszone (UTC)
+    put<uint32_t>(out, 0);   // sigfigs
+    put<uint32_t>(out, snaplen);
+    put<uint32_t>(out, linktype);
+}
+
+size_t pcap_append_record(std::vector<uint8_t>& out, uint64_t timestamp_us,
+                          const uint8_t* data, uint32_t caplen, uint32_t original_length) {
+    size_t start = out.size();
+    put<uint32_t>(out, static_cast<uint32_t>(timestamp_us / 1000000));
+    put<uint32_t>(out, static_cast<uint32_t>(timestamp_us % 1000000));
+    put<uint32_t>(out, caplen);
+    put<uint32_t>(out, original_length);
+    out.insert(out.end(), data, data + caplen);
+    return out.size() - start;
+}
@@ -0,0 +1,48 @@
+/*
+ * capture_file.hpp - Capture file encoding (pcapng and classic pcap)
+ *
+ * Serialises frames into pcapng blocks appended to a byte buffer, so the
+ * writers can batch many blocks into a single write(2). Blocks are written
+ * in host byte order, as the pcapng byte-order magic allows.
+ *
+ * Supported blocks: Section Header (with shb_userappl), Interface
+ * Description (with if_name; microsecond timestamps) and Enhanced Packet
+ * (with an optional opt_comment, used for alert annotations).
+ *
+ * Classic libpcap files (24-byte global header + 16-byte record headers,
+ * microsecond timestamps) are also supported for short, self-contained
+ * extracts such as alert-triggered captures.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// pcapng block types
+constexpr uint32_t PCAPNG_SECTION_HEADER = 0x0A0D0D0A;
+constexpr uint32_t PCAPNG_INTERFACE_DESCRIPTION = 0x00000001;
+constexpr uint32_t PCAPNG_ENHANCED_PACKET = 0x00000006;
+constexpr uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+
+// Section Header Block; starts a new file/section
+void pcapng_append_section_header(std::vector<uint8_t>& out, const std::string& application);
+
+// Interface Description Block; interface ids are assigned in order from 0
+void pcapng_append_interface(std::vector<uint8_t>& out, uint16_t linktype, uint32_t snaplen,
+                             const std::string& name);
+
+// Enhanced Packet Block; returns the number of bytes appended
+size_t pcapng_append_packet(std::vector<uint8_t>& out, uint32_t interface_id,
+                            uint64_t timestamp_us, const uint8_t* data, uint32_t caplen,
+                            uint32_t original_length, const std::string& comment = "");
+
+// Classic pcap: global header and one record per frame
+constexpr uint32_t PCAP_MAGIC_MICROS = 0xA1B2C3D4;
+
+void pcap_append_file_header(std::vector<uint8_t>& out, uint32_t linktype, uint32_t snaplen);
+
+// Returns the number of bytes appended
+size_t pcap_append_record(std::vector<uint8_t>& out, uint64_t timestamp_us,
+                          const uint8_t* data, uint32_t caplen, uint32_t original_length);
@@ -0,0 +1,240 @@
+/*
+ * checksum.cpp - IPv4, TCP and UDP checksum verification implementation
+ */
+
+#include "checksum.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+uint16_t fold(uint64_t sum) {
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(sum);
+}
+
+// One's-complement addition of two folded sums
+uint16_t add(uint16_t a, uint16_t b) {
+    return fold(static_cast<uint32_t>(a) + b);
+}
+
+uint16_t read_be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// Sum of the TCP/UDP pseudo-header for an upper-layer length
+uint16_t pseudo_header_sum(const PacketInfo& info, uint32_t length) {
+    uint8_t header[40] = {};
+    size_t addr_len = info.ip_version == 4 ? 4 : 16;
+    std::memcpy(header, info.src_addr.data(), addr_len);
+    std::memcpy(header + addr_len, info.dst_addr.data(), addr_len);
+    uint8_t* tail = header + 2 * addr_len;
+    if (info.ip_version == 4) {
+        tail[1] = info.protocol;
+        tail[2] = static_cast<uint8_t>(length >> 8);
+        tail[3] = static_cast<uint8_t>(length);
+        return ones_complement_sum(header, 12);
+    }
+    tail[0] = static_cast<uint8_t>(length >> 24);
+    tail[1] = static_cast<uint8_t>(length >> 16);
+    tail[2] = static_cast<uint8_t>(length >> 8);
+    tail[3] = static_cast<uint8_t>(length);
+    tail[7] = info.protocol;
+    return ones_complement_sum(header, 40);
+}
+
+ChecksumStatus check_ipv4_header(const uint8_t* ip, size_t available) {
+    size_t header_len = (ip[0] & 0x0F) * 4;
+    if (header_len < 20 || header_len > available) {
+        return ChecksumStatus::UNCHECKED;
+    }
+    if (ones_complement_sum(ip, header_len) == 0xFFFF) {
+        return ChecksumStatus::GOOD;
+    }
+    // Outbound frames captured before the NIC filled the header in
+    if (read_be16(ip + 10) == 0 || read_be16(ip + 2) == 0) {
+        return ChecksumStatus::OFFLOADED;
+    }
+    return ChecksumStatus::BAD;
+}
+
+ChecksumStatus check_transport(const PacketInfo& info, const uint8_t* ip) {
+    if (info.is_fragment() || info.reassembled_length != 0) {
+        return ChecksumStatus::UNCHECKED;
+    }
+
+    // The segment must be captured whole: the IP header's length has to
+    // reach exactly the end of what the parser took as the IP payload
+    size_t ip_offset = info.ip_offset;
+    size_t segment_end = static_cast<size_t>(info.ip_payload_offset) + info.ip_payload_length;
+    size_t declared_end;
+    if (info.ip_version == 4) {
+        uint16_t total_length = read_be16(ip + 2);
+        if (total_length == 0) {
+            return ChecksumStatus::OFFLOADED;  // TSO super-frame
+        }
+        declared_end = ip_offset + total_length;
+    } else {
+        uint16_t payload_length = read_be16(ip + 4);
+        if (payload_length == 0) {
+            return ChecksumStatus::UNCHECKED;  // Jumbogram or GSO
+        }
+        declared_end = ip_offset + 40 + payload_length;
+    }
+    if (declared_end != segment_end || segment_end > info.raw_data.size()) {
+        return ChecksumStatus::UNCHECKED;
+    }
+
+    const uint8_t* segment = info.raw_data.data() + info.ip_payload_offset;
+    uint32_t length = info.ip_payload_length;
+    size_t field;
+    if (info.protocol == PROTO_TCP) {
+        if (length < 20) return ChecksumStatus::UNCHECKED;
+        field = 16;
+    } else {
+        if (length < 8) return ChecksumStatus::UNCHECKED;
+        field = 6;
+    }
+    uint16_t stored = read_be16(segment + field);
+    if (info.protocol == PROTO_UDP && info.ip_version == 4 && stored == 0) {
+        return ChecksumStatus::UNCHECKED;  // Sender did not compute one
+    }
+
+    uint16_t pseudo = pseudo_header_sum(info, length);
+    if (add(pseudo, ones_complement_sum(segment, length)) == 0xFFFF) {
+        return ChecksumStatus::GOOD;
+    }
+    // CHECKSUM_PARTIAL: the stack left the pseudo-header sum for the NIC
+    // to complete (some drivers store its complement)
+    if (stored == pseudo || stored == static_cast<uint16_t>(~pseudo)) {
+        return ChecksumStatus::OFFLOADED;
+    }
+    return ChecksumStatus::BAD;
+}
+
+}  // namespace
+
+uint16_t ones_complement_sum(const uint8_t* data, size_t len) {
+    uint64_t sum = 0;
+    size_t i = 0;
+#if defined(__AVX2__)
+    // 16-bit words widened into 32-bit lanes, two 32-byte chunks per step
+    // into independent accumulators. A block of 16384 steps adds at most
+    // 2 * 16384 * 0xFFFF to each lane, which cannot overflow.
+    const __m256i zero32 = _mm256_setzero_si256();
+    while (i + 64 <= len) {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        __m256i acc2 = _mm256_setzero_si256();
+        __m256i acc3 = _mm256_setzero_si256();
+        size_t block_end = i + std::min<size_t>((len - i) & ~size_t{63}, size_t{64} * 16384);
+        for (; i < block_end; i += 64) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+            acc0 = _mm256_add_epi32(acc0, _mm256_unpacklo_epi16(a, zero32));
+            acc1 = _mm256_add_epi32(acc1, _mm256_unpackhi_epi16(a, zero32));
+            acc2 = _mm256_add_epi32(acc2, _mm256_unpacklo_epi16(b, zero32));
+            acc3 = _mm256_add_epi32(acc3, _mm256_unpackhi_epi16(b, zero32));
+        }
+        // Widen to 64-bit lanes before combining the four
+        __m256i wide = _mm256_setzero_si256();
+        for (__m256i acc : {acc0, acc1, acc2, acc3}) {
+            wide = _mm256_add_epi64(wide, _mm256_unpacklo_epi32(acc, zero32));
+            wide = _mm256_add_epi64(wide, _mm256_unpackhi_epi32(acc, zero32));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), wide);
+        sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#endif
+#if defined(__SSE2__)
+    // The same with 16-byte chunks; also the tail of the AVX2 loop
+    const __m128i zero16 = _mm_setzero_si128();
+    while (i + 16 <= len) {
+        __m128i acc0 = _mm_setzero_si128();
+        __m128i acc1 = _mm_setzero_si128();
+        __m128i acc2 = _mm_setzero_si128();
+        __m128i acc3 = _mm_setzero_si128();
+        size_t block_end = i + std::min<size_t>((len - i) & ~size_t{31}, size_t{32} * 16384);
+        for (; i < block_end; i += 32) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+            acc0 = _mm_add_epi32(acc0, _mm_unpacklo_epi16(a, zero16));
+            acc1 = _mm_add_epi32(acc1, _mm_unpackhi_epi16(a, zero16));
+            acc2 = _mm_add_epi32(acc2, _mm_unpacklo_epi16(b, zero16));
+            acc3 = _mm_add_epi32(acc3, _mm_unpackhi_epi16(b, zero16));
+        }
+        if (i + 16 <= len && len - i < 32) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            acc0 = _mm_add_epi32(acc0, _mm_unpacklo_epi16(a, zero16));
+            acc1 = _mm_add_epi32(acc1, _mm_unpackhi_epi16(a, zero16));
+            i += 16;
+        }
+        __m128i wide = _mm_setzero_si128();
+        for (__m128i acc : {acc0, acc1, acc2, acc3}) {
+            wide = _mm_add_epi64(wide, _mm_unpacklo_epi32(acc, zero16));
+            wide = _mm_add_epi64(wide, _mm_unpackhi_epi32(acc, zero16));
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), wide);
+        sum += lanes[0] + lanes[1];
+    }
+#endif
+    // Native 32-bit words; 2^16 = 1 in one's-complement arithmetic, so they
+    // fold to the same sum as the 16-bit words they hold
+    for (; i + 4 <= len; i += 4) {
+        uint32_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        sum += word;
+    }
+    if (i + 2 <= len) {
+        uint16_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        sum += word;
+        i += 2;
+    }
+    if (i < len) {
+        uint8_t last[2] = {data[i], 0};
+        uint16_t word;
+        std::memcpy(&word, last, sizeof(word));
+        sum += word;
+    }
+
+    uint16_t folded = fold(sum);
+    if constexpr (std::endian::native == std::endian::little) {
+        folded = static_cast<uint16_t>((folded << 8) | (folded >> 8));
+    }
+    return folded;
+}
+
+void verify_checksums(PacketInfo& info) {
+    info.ip_checksum = ChecksumStatus::UNCHECKED;
+    info.l4_checksum = ChecksumStatus::UNCHECKED;
+    if (info.ip_version != 4 && info.ip_version != 6) {
+        return;
+    }
+
+    size_t min_header = info.ip_version == 4 ? 20 : 40;
+    if (static_cast<size_t>(info.ip_offset) + min_header > info.raw_data.size()) {
+        return;
+    }
+    const uint8_t* ip = info.raw_data.data() + info.ip_offset;
+    if ((ip[0] >> 4) != info.ip_version) {
+        return;
+    }
+    if (info.ip_version == 4) {
+        info.ip_checksum = check_ipv4_header(ip, info.raw_data.size() - info.ip_offset);
+    }
+    if (info.protocol == PROTO_TCP || info.protocol == PROTO_UDP) {
+        info.l4_checksum = check_transport(info, ip);
+    }
+}
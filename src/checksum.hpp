@@ -0,0 +1,29 @@
+/*
+ * checksum.hpp - IPv4, TCP and UDP checksum verification
+ *
+ * ones_complement_sum() is the RFC 1071 Internet checksum sum. The sum is
+ * byte-order independent, so it adds native 16-bit words (64 bytes per
+ * step with AVX2, 32 with SSE2, 4 in the scalar loop) into wide lanes and
+ * folds once at the end; the result is swapped to network order.
+ *
+ * verify_checksums() checks the IPv4 header and the innermost TCP or UDP
+ * segment of a parsed packet. Frames captured on their way out of this
+ * host usually carry checksums the NIC has not filled in yet: a zero IPv4
+ * header checksum, an IPv4 total length of zero (TSO), or a TCP/UDP field
+ * holding just the pseudo-header sum (CHECKSUM_PARTIAL). Those are
+ * reported as OFFLOADED rather than BAD. Truncated captures, fragments and
+ * UDP over IPv4 without a checksum are left UNCHECKED.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Folded one's-complement sum of data as big-endian 16-bit words; an odd
+// trailing byte is padded with zero. A valid checksummed block sums to 0xFFFF.
+uint16_t ones_complement_sum(const uint8_t* data, size_t len);
+
+// Fill info.ip_checksum and info.l4_checksum from info.raw_data
+void verify_checksums(PacketInfo& info);
@@ -0,0 +1,714 @@
+/*
+ * columnar.cpp - Columnar packet-header file implementation
+ *
+ * The capture thread appends each packet to a RowGroupBuilder whose column
+ * vectors were reserved for a full row group, so appending never
+ * allocates. Full builders are handed to the writer thread, which computes
+ * the statistics, encodes the group and writes it, then returns the
+ * builder to the pool. The dictionary is only read by the writer after
+ * the capture side has finished, when the footer is written.
+ */
+
+#include "columnar.hpp"
+#include <arpa/inet.h>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::endian::native == std::endian::little,
+              "columnar files are written in host order, which must be little-endian");
+
+namespace {
+
+constexpr char FILE_MAGIC[8] = {'N', 'E', 'T', 'M', 'O', 'N', 'C', '1'};
+constexpr uint32_t ROW_GROUP_MAGIC = 0x50524752;  // "RGRP"
+constexpr size_t ROW_GROUP_HEADER_BYTES = 16;
+constexpr size_t BUILDER_POOL_SIZE = 3;
+
+void put_u32(std::vector<uint8_t>& out, size_t pos, uint32_t value) {
+    std::memcpy(out.data() + pos, &value, sizeof(value));
+}
+
+void put_u64(std::vector<uint8_t>& out, size_t pos, uint64_t value) {
+    std::memcpy(out.data() + pos, &value, sizeof(value));
+}
+
+template <typename T>
+void append_value(std::vector<uint8_t>& out, T value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void pad_to_8(std::vector<uint8_t>& out) {
+    while (out.size() % 8 != 0) {
+        out.push_back(0);
+    }
+}
+
+uint32_t get_u32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint64_t get_u64(const uint8_t* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+template <typename T>
+ColumnStats compute_stats(const std::vector<T>& values) {
+    ColumnStats stats;
+    if (values.empty()) {
+        return stats;
+    }
+
+    T lo = values[0];
+    T hi = values[0];
+    for (T v : values) {
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+    }
+
+    stats.valid = true;
+    stats.min = static_cast<uint64_t>(lo);
+    stats.max = static_cast<uint64_t>(hi);
+    return stats;
+}
+
+// Raw bytes and statistics for one column of a builder
+const void* column_data(const RowGroupBuilder& g, Column column, ColumnStats& stats) {
+    switch (column) {
+        case Column::TIMESTAMP_US: stats = compute_stats(g.timestamp_us); return g.timestamp_us.data();
+        case Column::SRC_ADDR:     stats = {}; return g.src_addr.data();
+        case Column::DST_ADDR:     stats = {}; return g.dst_addr.data();
+        case Column::SRC_PORT:     stats = compute_stats(g.src_port); return g.src_port.data();
+        case Column::DST_PORT:     stats = compute_stats(g.dst_port); return g.dst_port.data();
+        case Column::IP_VERSION:   stats = compute_stats(g.ip_version); return g.ip_version.data();
+        case Column::IP_PROTOCOL:  stats = compute_stats(g.ip_protocol); return g.ip_protocol.data();
+        case Column::TCP_FLAGS:    stats = compute_stats(g.tcp_flags); return g.tcp_flags.data();
+        case Column::TTL:          stats = compute_stats(g.ttl); return g.ttl.data();
+        case Column::LENGTH:       stats = compute_stats(g.length); return g.length.data();
+        case Column::ETHER_TYPE:   stats = compute_stats(g.ether_type); return g.ether_type.data();
+        case Column::HOSTNAME:     stats = compute_stats(g.hostname); return g.hostname.data();
+        case Column::APP_PROTOCOL: stats = compute_stats(g.app_protocol); return g.app_protocol.data();
+        case Column::COUNT:        break;
+    }
+    stats = {};
+    return nullptr;
+}
+
+std::string format_address(const std::array<uint8_t, 16>& addr, int family) {
+    char buf[INET6_ADDRSTRLEN];
+    if (!inet_ntop(family, addr.data(), buf, sizeof(buf))) {
+        return "";
+    }
+    return buf;
+}
+
+}  // namespace
+
+ColumnType column_type(Column column) {
+    switch (column) {
+        case Column::TIMESTAMP_US: return ColumnType::INT64;
+        case Column::SRC_ADDR:
+        case Column::DST_ADDR:     return ColumnType::BYTES16;
+        case Column::SRC_PORT:
+        case Column::DST_PORT:
+        case Column::ETHER_TYPE:   return ColumnType::UINT16;
+        case Column::IP_VERSION:
+        case Column::IP_PROTOCOL:
+        case Column::TCP_FLAGS:
+        case Column::TTL:          return ColumnType::UINT8;
+        case Column::LENGTH:
+        case Column::HOSTNAME:
+        case Column::APP_PROTOCOL:
+        case Column::COUNT:        break;
+    }
+    return ColumnType::UINT32;
+}
+
+size_t column_width(ColumnType type) {
+    switch (type) {
+        case ColumnType::INT64:   return 8;
+        case ColumnType::UINT32:  return 4;
+        case ColumnType::UINT16:  return 2;
+        case ColumnType::UINT8:   return 1;
+        case ColumnType::BYTES16: return 16;
+    }
+    return 0;
+}
+
+const char* column_name(Column column) {
+    switch (column) {
+        case Column::TIMESTAMP_US: return "timestamp_us";
+        case Column::SRC_ADDR:     return "src_addr";
+        case Column::DST_ADDR:     return "dst_addr";
+        case Column::SRC_PORT:     return "src_port";
+        case Column::DST_PORT:     return "dst_port";
+        case Column::IP_VERSION:   return "ip_version";
+        case Column::IP_PROTOCOL:  return "ip_protocol";
+        case Column::TCP_FLAGS:    return "tcp_flags";
+        case Column::TTL:          return "ttl";
+        case Column::LENGTH:       return "length";
+        case Column::ETHER_TYPE:   return "ether_type";
+        case Column::HOSTNAME:     return "hostname";
+        case Column::APP_PROTOCOL: return "app_protocol";
+        case Column::COUNT:        break;
+    }
+    return "unknown";
+}
+
+// =============================================================================
+// Builder and encoding
+// =============================================================================
+
+void RowGroupBuilder::reserve(size_t rows) {
+    timestamp_us.reserve(rows);
+    src_addr.reserve(rows);
+    dst_addr.reserve(rows);
+    src_port.reserve(rows);
+    dst_port.reserve(rows);
+    ip_version.reserve(rows);
+    ip_protocol.reserve(rows);
+    tcp_flags.reserve(rows);
+    ttl.reserve(rows);
+    length.reserve(rows);
+    ether_type.reserve(rows);
+    hostname.reserve(rows);
+    app_protocol.reserve(rows);
+}
+
+void RowGroupBuilder::clear() {
+    timestamp_us.clear();
+    src_addr.clear();
+    dst_addr.clear();
+    src_port.clear();
+    dst_port.clear();
+    ip_version.clear();
+    ip_protocol.clear();
+    tcp_flags.clear();
+    ttl.clear();
+    length.clear();
+    ether_type.clear();
+    hostname.clear();
+    app_protocol.clear();
+}
+
+void columnar_encode_header(uint32_t row_group_rows, std::vector<uint8_t>& out) {
+    out.insert(out.end(), FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+    append_value<uint32_t>(out, COLUMNAR_VERSION);
+    append_value<uint32_t>(out, row_group_rows);
+    append_value<uint32_t>(out, static_cast<uint32_t>(COLUMN_COUNT));
+    append_value<uint32_t>(out, 0);
+    append_value<uint64_t>(out, 0);
+}
+
+void columnar_encode_row_group(const RowGroupBuilder& group, std::vector<uint8_t>& out) {
+    pad_to_8(out);
+    size_t start = out.size();
+    size_t rows = group.rows();
+
+    out.resize(start + ROW_GROUP_HEADER_BYTES + COLUMN_COUNT * COLUMNAR_DESCRIPTOR_BYTES, 0);
+    put_u32(out, start, ROW_GROUP_MAGIC);
+    put_u32(out, start + 4, static_cast<uint32_t>(rows));
+
+    for (size_t i = 0; i < COLUMN_COUNT; ++i) {
+        auto column = static_cast<Column>(i);
+        ColumnType type = column_type(column);
+        ColumnStats stats;
+        const void* data = column_data(group, column, stats);
+        size_t bytes = rows * column_width(type);
+
+        pad_to_8(out);
+        size_t offset = out.size() - start;
+        const auto* src = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), src, src + bytes);
+
+        size_t desc = start + ROW_GROUP_HEADER_BYTES + i * COLUMNAR_DESCRIPTOR_BYTES;
+        uint16_t id = static_cast<uint16_t>(i);
+        std::memcpy(out.data() + desc, &id, sizeof(id));
+        out[desc + 2] = static_cast<uint8_t>(type);
+        out[desc + 3] = stats.valid ? 1 : 0;
+        put_u64(out, desc + 8, offset);
+        put_u64(out, desc + 16, bytes);
+        put_u64(out, desc + 24, stats.min);
+        put_u64(out, desc + 32, stats.max);
+    }
+
+    pad_to_8(out);
+    put_u64(out, start + 8, out.size() - start);
+}
+
+void columnar_encode_footer(const StringDictionary& dictionary,
+                            const std::vector<uint64_t>& row_group_offsets,
+                            uint64_t footer_offset, uint64_t total_rows,
+                            std::vector<uint8_t>& out) {
+    const auto& entries = dictionary.entries();
+
+    append_value<uint32_t>(out, static_cast<uint32_t>(entries.size()));
+    append_value<uint32_t>(out, 0);
+
+    uint64_t string_offset = 0;
+    append_value<uint64_t>(out, 0);
+    for (const auto& entry : entries) {
+        string_offset += entry.size();
+        append_value<uint64_t>(out, string_offset);
+    }
+    for (const auto& entry : entries) {
+        out.insert(out.end(), entry.begin(), entry.end());
+    }
+    pad_to_8(out);
+
+    for (uint64_t offset : row_group_offsets) {
+        append_value<uint64_t>(out, offset);
+    }
+
+    append_value<uint64_t>(out, footer_offset);
+    append_value<uint64_t>(out, total_rows);
+    append_value<uint32_t>(out, static_cast<uint32_t>(row_group_offsets.size()));
+    append_value<uint32_t>(out, static_cast<uint32_t>(entries.size()));
+    out.insert(out.end(), FILE_MAGIC, FILE_MAGIC + sizeof(FILE_MAGIC));
+}
+
+StringDictionary::StringDictionary() {
+    clear();
+}
+
+void StringDictionary::clear() {
+    ids_.clear();
+    entries_.clear();
+    entries_.emplace_back();
+}
+
+uint32_t StringDictionary::intern(const std::string& value) {
+    if (value.empty()) {
+        return 0;
+    }
+
+    auto it = ids_.find(value);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    if (entries_.size() >= MAX_ENTRIES) {
+        return 0;
+    }
+
+    auto id = static_cast<uint32_t>(entries_.size());
+    entries_.push_back(value);
+    ids_.emplace(value, id);
+    return id;
+}
+
+// =============================================================================
+// ColumnarWriter
+// =============================================================================
+
+ColumnarWriter::~ColumnarWriter() {
+    finish();
+}
+
+bool ColumnarWriter::start(int fd, uint32_t row_group_rows, bool block_when_full) {
+    if (running_.load()) {
+        return true;
+    }
+
+    fd_ = fd;
+    row_group_rows_ = row_group_rows == 0 ? 1 : row_group_rows;
+    block_when_full_ = block_when_full;
+    dictionary_.clear();
+    row_group_offsets_.clear();
+    write_failed_ = false;
+    rows_written_.store(0);
+    rows_dropped_.store(0);
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        free_builders_.clear();
+        full_builders_.clear();
+        for (size_t i = 0; i < BUILDER_POOL_SIZE; ++i) {
+            auto builder = std::make_unique<RowGroupBuilder>();
+            builder->reserve(row_group_rows_);
+            free_builders_.push_back(std::move(builder));
+        }
+    }
+    current_.reset();
+
+    encode_buffer_.clear();
+    columnar_encode_header(row_group_rows_, encode_buffer_);
+    if (!write_bytes(encode_buffer_)) {
+        return false;
+    }
+    file_offset_ = encode_buffer_.size();
+
+    running_.store(true);
+    writer_thread_ = std::thread([this]() {
+        writer_loop();
+    });
+
+    return true;
+}
+
+void ColumnarWriter::finish() {
+    if (!running_.load()) {
+        return;
+    }
+
+    if (current_ && current_->rows() > 0) {
+        submit_builder();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        running_.store(false);
+    }
+    full_cv_.notify_all();
+    pool_cv_.notify_all();
+
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+
+    if (!write_failed_) {
+        encode_buffer_.clear();
+        columnar_encode_footer(dictionary_, row_group_offsets_, file_offset_,
+                               rows_written_.load(), encode_buffer_);
+        write_bytes(encode_buffer_);
+    }
+
+    current_.reset();
+    encode_buffer_.clear();
+    encode_buffer_.shrink_to_fit();
+}
+
+std::string ColumnarWriter::get_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return error_;
+}
+
+bool ColumnarWriter::append(const PacketInfo& pkt) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    if (!current_ && !acquire_builder()) {
+        rows_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    RowGroupBuilder& g = *current_;
+    g.timestamp_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+        pkt.timestamp.time_since_epoch()).count());
+    g.src_addr.push_back(pkt.src_addr);
+    g.dst_addr.push_back(pkt.dst_addr);
+    g.src_port.push_back(pkt.src_port);
+    g.dst_port.push_back(pkt.dst_port);
+    g.ip_version.push_back(pkt.ip_version);
+    g.ip_protocol.push_back(pkt.protocol);
+    g.tcp_flags.push_back(pkt.tcp_flags);
+    g.ttl.push_back(pkt.ttl);
+    g.length.push_back(pkt.original_length);
+    g.ether_type.push_back(pkt.ether_type);
+    g.hostname.push_back(dictionary_.intern(pkt.hostname));
+    g.app_protocol.push_back(dictionary_.intern(pkt.app_protocol));
+
+    if (g.rows() >= row_group_rows_) {
+        submit_builder();
+    }
+    return true;
+}
+
+bool ColumnarWriter::acquire_builder() {
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+
+    if (free_builders_.empty()) {
+        if (!block_when_full_) {
+            return false;
+        }
+        pool_cv_.wait(lock, [this]() {
+            return !free_builders_.empty() || !running_.load();
+        });
+        if (free_builders_.empty()) {
+            return false;
+        }
+    }
+
+    current_ = std::move(free_builders_.back());
+    free_builders_.pop_back();
+    return true;
+}
+
+void ColumnarWriter::submit_builder() {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        full_builders_.push_back(std::move(current_));
+    }
+    current_.reset();
+    full_cv_.notify_one();
+}
+
+void ColumnarWriter::writer_loop() {
+    while (true) {
+        std::unique_ptr<RowGroupBuilder> builder;
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex_);
+            full_cv_.wait(lock, [this]() {
+                return !full_builders_.empty() || !running_.load();
+            });
+            if (full_builders_.empty()) {
+                break;  // Stopped and drained
+            }
+            builder = std::move(full_builders_.front());
+            full_builders_.pop_front();
+        }
+
+        size_t rows = builder->rows();
+        if (!write_failed_) {
+            encode_buffer_.clear();
+            columnar_encode_row_group(*builder, encode_buffer_);
+            if (write_bytes(encode_buffer_)) {
+                row_group_offsets_.push_back(file_offset_);
+                file_offset_ += encode_buffer_.size();
+                rows_written_.fetch_add(rows, std::memory_order_relaxed);
+            } else {
+                rows_dropped_.fetch_add(rows, std::memory_order_relaxed);
+            }
+        } else {
+            rows_dropped_.fetch_add(rows, std::memory_order_relaxed);
+        }
+
+        builder->clear();
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            free_builders_.push_back(std::move(builder));
+        }
+        pool_cv_.notify_one();
+    }
+}
+
+bool ColumnarWriter::write_bytes(const std::vector<uint8_t>& bytes) {
+    size_t written = 0;
+    while (written < bytes.size()) {
+        ssize_t n = ::write(fd_, bytes.data() + written, bytes.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            write_failed_ = true;
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            error_ = "Columnar write failed: " + std::string(strerror(errno));
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// =============================================================================
+// ColumnarReader
+// =============================================================================
+
+ColumnStats RowGroupView::stats(Column column) const {
+    return stats_[static_cast<size_t>(column)];
+}
+
+ColumnarReader::~ColumnarReader() {
+    close();
+}
+
+bool ColumnarReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return fail("Cannot open " + path + ": " + strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return fail("Cannot read " + path);
+    }
+
+    map_size_ = static_cast<size_t>(st.st_size);
+    map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        return fail("Cannot map " + path + ": " + strerror(errno));
+    }
+
+    // Columns are consumed front to back
+    madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+    return parse(static_cast<const uint8_t*>(map_), map_size_);
+}
+
+bool ColumnarReader::open_memory(const uint8_t* data, size_t size) {
+    close();
+    return parse(data, size);
+}
+
+void ColumnarReader::close() {
+    if (map_) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+    groups_.clear();
+    dictionary_.clear();
+    total_rows_ = 0;
+}
+
+bool ColumnarReader::fail(const std::string& message) {
+    error_ = message;
+    groups_.clear();
+    dictionary_.clear();
+    total_rows_ = 0;
+    return false;
+}
+
+bool ColumnarReader::parse(const uint8_t* data, size_t size) {
+    if (size < COLUMNAR_HEADER_BYTES + COLUMNAR_TRAILER_BYTES ||
+        std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return fail("Not a columnar capture file");
+    }
+    if (get_u32(data + 8) != COLUMNAR_VERSION || get_u32(data + 16) != COLUMN_COUNT) {
+        return fail("Unsupported columnar format version");
+    }
+
+    const uint8_t* trailer = data + size - COLUMNAR_TRAILER_BYTES;
+    if (std::memcmp(trailer + 24, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return fail("Columnar file is truncated (no trailer)");
+    }
+
+    uint64_t footer_offset = get_u64(trailer);
+    total_rows_ = get_u64(trailer + 8);
+    uint32_t group_count = get_u32(trailer + 16);
+    uint32_t dict_count = get_u32(trailer + 20);
+    size_t footer_end = size - COLUMNAR_TRAILER_BYTES;
+
+    // Dictionary
+    if (footer_offset % 8 != 0 || footer_offset > footer_end || footer_end - footer_offset < 8 ||
+        get_u32(data + footer_offset) != dict_count || dict_count == 0) {
+        return fail("Corrupt columnar footer");
+    }
+    size_t offsets_pos = footer_offset + 8;
+    if ((footer_end - offsets_pos) / 8 < static_cast<size_t>(dict_count) + 1) {
+        return fail("Corrupt columnar dictionary");
+    }
+    size_t strings_pos = offsets_pos + (static_cast<size_t>(dict_count) + 1) * 8;
+    uint64_t strings_len = get_u64(data + offsets_pos + static_cast<size_t>(dict_count) * 8);
+    if (strings_len > footer_end - strings_pos) {
+        return fail("Corrupt columnar dictionary");
+    }
+
+    dictionary_.reserve(dict_count);
+    uint64_t prev = 0;
+    for (uint32_t i = 0; i < dict_count; ++i) {
+        uint64_t begin = get_u64(data + offsets_pos + static_cast<size_t>(i) * 8);
+        uint64_t end = get_u64(data + offsets_pos + (static_cast<size_t>(i) + 1) * 8);
+        if (begin != prev || end < begin || end > strings_len) {
+            return fail("Corrupt columnar dictionary");
+        }
+        dictionary_.emplace_back(reinterpret_cast<const char*>(data + strings_pos + begin),
+                                 static_cast<size_t>(end - begin));
+        prev = end;
+    }
+
+    // Row group index
+    size_t index_pos = (strings_pos + strings_len + 7) & ~size_t{7};
+    if (index_pos > footer_end || (footer_end - index_pos) / 8 < group_count) {
+        return fail("Corrupt columnar row group index");
+    }
+
+    uint64_t rows_seen = 0;
+    groups_.reserve(group_count);
+    for (uint32_t g = 0; g < group_count; ++g) {
+        uint64_t offset = get_u64(data + index_pos + static_cast<size_t>(g) * 8);
+        size_t header_bytes = ROW_GROUP_HEADER_BYTES + COLUMN_COUNT * COLUMNAR_DESCRIPTOR_BYTES;
+        if (offset % 8 != 0 || offset >= footer_offset || footer_offset - offset < header_bytes) {
+            return fail("Corrupt columnar row group offset");
+        }
+
+        const uint8_t* group = data + offset;
+        uint64_t group_bytes = get_u64(group + 8);
+        if (get_u32(group) != ROW_GROUP_MAGIC || group_bytes > footer_offset - offset) {
+            return fail("Corrupt columnar row group");
+        }
+
+        RowGroupView view;
+        view.rows_ = get_u32(group + 4);
+        for (size_t c = 0; c < COLUMN_COUNT; ++c) {
+            const uint8_t* desc = group + ROW_GROUP_HEADER_BYTES + c * COLUMNAR_DESCRIPTOR_BYTES;
+            uint16_t id;
+            std::memcpy(&id, desc, sizeof(id));
+            auto type = static_cast<ColumnType>(desc[2]);
+            uint64_t data_offset = get_u64(desc + 8);
+            uint64_t data_bytes = get_u64(desc + 16);
+
+            Column column = static_cast<Column>(c);
+            if (id != c || type != column_type(column) || data_offset % 8 != 0 ||
+                data_bytes != static_cast<uint64_t>(view.rows_) * column_width(type) ||
+                data_offset > group_bytes || data_bytes > group_bytes - data_offset) {
+                return fail("Corrupt columnar column chunk");
+            }
+
+            view.data_[c] = group + data_offset;
+            view.stats_[c].valid = (desc[3] & 1) != 0;
+            view.stats_[c].min = get_u64(desc + 24);
+            view.stats_[c].max = get_u64(desc + 32);
+        }
+
+        rows_seen += view.rows_;
+        groups_.push_back(view);
+    }
+
+    if (rows_seen != total_rows_) {
+        return fail("Columnar row count mismatch");
+    }
+
+    error_.clear();
+    return true;
+}
+
+std::string_view ColumnarReader::dictionary(uint32_t id) const {
+    return id < dictionary_.size() ? dictionary_[id] : std::string_view();
+}
+
+PacketInfo ColumnarReader::to_packet(const RowGroupView& group, uint32_t row) const {
+    PacketInfo info{};
+    info.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::microseconds(group.timestamp_us()[row]));
+    info.original_length = group.length()[row];
+    info.length = info.original_length;
+    info.ether_type = group.ether_type()[row];
+    info.ip_version = group.ip_version()[row];
+    info.protocol = group.ip_protocol()[row];
+    info.ttl = group.ttl()[row];
+    info.src_port = group.src_port()[row];
+    info.dst_port = group.dst_port()[row];
+    info.tcp_flags = group.tcp_flags()[row];
+    info.src_addr = group.src_addr()[row];
+    info.dst_addr = group.dst_addr()[row];
+
+    if (info.ip_version == 6) {
+        info.src_ip = format_address(info.src_addr, AF_INET6);
+        info.dst_ip = format_address(info.dst_addr, AF_INET6);
+    } else if (info.ip_version == 4 || info.ether_type == ETHERTYPE_ARP) {
+        info.src_ip = format_address(info.src_addr, AF_INET);
+        info.dst_ip = format_address(info.dst_addr, AF_INET);
+    }
+
+    info.hostname = std::string(dictionary(group.hostname()[row]));
+    info.app_protocol = std::string(dictionary(group.app_protocol()[row]));
+    return info;
+}
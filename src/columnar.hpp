@@ -0,0 +1,274 @@
+/*
+ * columnar.hpp - Columnar packet-header files (writer and mmap reader)
+ *
+ * Stores packet metadata as typed columns in fixed-size row groups, with
+ * hostnames and application protocols dictionary-encoded and min/max
+ * statistics per column chunk, so a day of headers loads into a dataframe
+ * with one frombuffer() per column instead of parsing text.
+ *
+ * File layout (little-endian; every section starts 8-byte aligned):
+ *
+ *   File header, 32 bytes
+ *     0  char[8]  magic "NETMONC1"
+ *     8  u32      format version (1)
+ *     12 u32      row group capacity (rows in every group but the last)
+ *     16 u32      column count
+ *     20 u32      reserved (0)
+ *     24 u64      reserved (0)
+ *
+ *   Row group, repeated
+ *     0  u32      magic "RGRP"
+ *     4  u32      row count
+ *     8  u64      group size in bytes, including this header
+ *     16 column descriptors, 40 bytes each, in column-id order:
+ *          u16 column id, u8 type, u8 flags (bit 0: min/max valid), u32 reserved
+ *          u64 data offset from the start of the row group
+ *          u64 data size in bytes (rows * type width, before padding)
+ *          u64 min, u64 max (INT64 columns store two's complement)
+ *     column data, densely packed values, each padded to 8 bytes
+ *
+ *   Footer
+ *     u32 dictionary entry count N, u32 reserved
+ *     u64 string offsets[N + 1] relative to the string bytes
+ *     string bytes, padded to 8
+ *     u64 absolute offset of each row group
+ *
+ *   Trailer, last 32 bytes of the file
+ *     0  u64      footer offset
+ *     8  u64      total rows
+ *     16 u32      row group count
+ *     20 u32      dictionary entry count
+ *     24 char[8]  magic "NETMONC1"
+ *
+ * Dictionary entry 0 is always the empty string, so id 0 means "none".
+ * Addresses are 16 raw bytes; IPv4 occupies the first 4, as in PacketInfo.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class ColumnType : uint8_t { INT64 = 1, UINT32 = 2, UINT16 = 3, UINT8 = 4, BYTES16 = 5 };
+
+enum class Column : uint16_t {
+    TIMESTAMP_US,   // INT64, microseconds since the epoch
+    SRC_ADDR,       // BYTES16
+    DST_ADDR,       // BYTES16
+    SRC_PORT,       // UINT16
+    DST_PORT,       // UINT16
+    IP_VERSION,     // UINT8 (0 for non-IP)
+    IP_PROTOCOL,    // UINT8
+    TCP_FLAGS,      // UINT8
+    TTL,            // UINT8
+    LENGTH,         // UINT32, original wire length
+    ETHER_TYPE,     // UINT16
+    HOSTNAME,       // UINT32 dictionary id
+    APP_PROTOCOL,   // UINT32 dictionary id
+    COUNT
+};
+
+constexpr size_t COLUMN_COUNT = static_cast<size_t>(Column::COUNT);
+constexpr uint32_t COLUMNAR_VERSION = 1;
+constexpr size_t COLUMNAR_HEADER_BYTES = 32;
+constexpr size_t COLUMNAR_TRAILER_BYTES = 32;
+constexpr size_t COLUMNAR_DESCRIPTOR_BYTES = 40;
+
+ColumnType column_type(Column column);
+size_t column_width(ColumnType type);
+const char* column_name(Column column);
+
+struct ColumnStats {
+    bool valid = false;
+    uint64_t min = 0;
+    uint64_t max = 0;
+};
+
+// Rows buffered for one row group; capacity is reserved up front
+struct RowGroupBuilder {
+    std::vector<int64_t> timestamp_us;
+    std::vector<std::array<uint8_t, 16>> src_addr;
+    std::vector<std::array<uint8_t, 16>> dst_addr;
+    std::vector<uint16_t> src_port;
+    std::vector<uint16_t> dst_port;
+    std::vector<uint8_t> ip_version;
+    std::vector<uint8_t> ip_protocol;
+    std::vector<uint8_t> tcp_flags;
+    std::vector<uint8_t> ttl;
+    std::vector<uint32_t> length;
+    std::vector<uint16_t> ether_type;
+    std::vector<uint32_t> hostname;
+    std::vector<uint32_t> app_protocol;
+
+    void reserve(size_t rows);
+    void clear();
+    size_t rows() const { return timestamp_us.size(); }
+};
+
+// Encode a row group (header, descriptors, padded column data) onto out
+void columnar_encode_row_group(const RowGroupBuilder& group, std::vector<uint8_t>& out);
+
+// Interns strings for the dictionary columns; id 0 is the empty string
+class StringDictionary {
+public:
+    StringDictionary();
+    uint32_t intern(const std::string& value);  // Returns 0 once max_entries is reached
+    size_t size() const { return entries_.size(); }
+    const std::vector<std::string>& entries() const { return entries_; }
+    void clear();
+
+    static constexpr size_t MAX_ENTRIES = 1u << 20;
+
+private:
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<std::string> entries_;
+};
+
+// Encode the footer and trailer onto out
+void columnar_encode_footer(const StringDictionary& dictionary,
+                            const std::vector<uint64_t>& row_group_offsets,
+                            uint64_t footer_offset, uint64_t total_rows,
+                            std::vector<uint8_t>& out);
+
+void columnar_encode_header(uint32_t row_group_rows, std::vector<uint8_t>& out);
+
+class ColumnarWriter {
+public:
+    ColumnarWriter() = default;
+    ~ColumnarWriter();
+
+    // Non-copyable
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    // fd is written sequentially and not closed by the writer
+    bool start(int fd, uint32_t row_group_rows, bool block_when_full);
+
+    // Flush the last row group, write the footer and join the thread
+    void finish();
+
+    // Capture thread. Returns false if the row was dropped.
+    bool append(const PacketInfo& pkt);
+
+    std::string get_error() const;
+    uint64_t rows_written() const { return rows_written_.load(); }
+    uint64_t rows_dropped() const { return rows_dropped_.load(); }
+
+private:
+    bool acquire_builder();
+    void submit_builder();
+    void writer_loop();
+    bool write_bytes(const std::vector<uint8_t>& bytes);
+
+    int fd_ = -1;
+    uint32_t row_group_rows_ = 65536;
+    bool block_when_full_ = true;
+
+    // Capture thread
+    std::unique_ptr<RowGroupBuilder> current_;
+    StringDictionary dictionary_;  // Read by the writer only after join
+
+    // Builder pool shared with the writer
+    std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;
+    std::condition_variable full_cv_;
+    std::vector<std::unique_ptr<RowGroupBuilder>> free_builders_;
+    std::deque<std::unique_ptr<RowGroupBuilder>> full_builders_;
+
+    // Writer thread
+    uint64_t file_offset_ = 0;
+    std::vector<uint64_t> row_group_offsets_;
+    std::vector<uint8_t> encode_buffer_;
+    bool write_failed_ = false;
+
+    mutable std::mutex error_mutex_;
+    std::string error_;
+
+    std::atomic<bool> running_{false};
+    std::thread writer_thread_;
+
+    std::atomic<uint64_t> rows_written_{0};
+    std::atomic<uint64_t> rows_dropped_{0};
+};
+
+// Read-only view of one row group inside a mapped file
+class RowGroupView {
+public:
+    uint32_t rows() const { return rows_; }
+    ColumnStats stats(Column column) const;
+
+    // Typed column pointers (valid while the reader is open)
+    const int64_t* timestamp_us() const { return column<int64_t>(Column::TIMESTAMP_US); }
+    const std::array<uint8_t, 16>* src_addr() const { return column<std::array<uint8_t, 16>>(Column::SRC_ADDR); }
+    const std::array<uint8_t, 16>* dst_addr() const { return column<std::array<uint8_t, 16>>(Column::DST_ADDR); }
+    const uint16_t* src_port() const { return column<uint16_t>(Column::SRC_PORT); }
+    const uint16_t* dst_port() const { return column<uint16_t>(Column::DST_PORT); }
+    const uint8_t* ip_version() const { return column<uint8_t>(Column::IP_VERSION); }
+    const uint8_t* ip_protocol() const { return column<uint8_t>(Column::IP_PROTOCOL); }
+    const uint8_t* tcp_flags() const { return column<uint8_t>(Column::TCP_FLAGS); }
+    const uint8_t* ttl() const { return column<uint8_t>(Column::TTL); }
+    const uint32_t* length() const { return column<uint32_t>(Column::LENGTH); }
+    const uint16_t* ether_type() const { return column<uint16_t>(Column::ETHER_TYPE); }
+    const uint32_t* hostname() const { return column<uint32_t>(Column::HOSTNAME); }
+    const uint32_t* app_protocol() const { return column<uint32_t>(Column::APP_PROTOCOL); }
+
+private:
+    friend class ColumnarReader;
+
+    template <typename T>
+    const T* column(Column c) const {
+        return reinterpret_cast<const T*>(data_[static_cast<size_t>(c)]);
+    }
+
+    uint32_t rows_ = 0;
+    std::array<const uint8_t*, COLUMN_COUNT> data_{};
+    std::array<ColumnStats, COLUMN_COUNT> stats_{};
+};
+
+class ColumnarReader {
+public:
+    ColumnarReader() = default;
+    ~ColumnarReader();
+
+    // Non-copyable
+    ColumnarReader(const ColumnarReader&) = delete;
+    ColumnarReader& operator=(const ColumnarReader&) = delete;
+
+    // Map and validate a file (or an in-memory image, for tests)
+    bool open(const std::string& path);
+    bool open_memory(const uint8_t* data, size_t size);
+    void close();
+
+    std::string get_error() const { return error_; }
+    uint64_t total_rows() const { return total_rows_; }
+    size_t row_group_count() const { return groups_.size(); }
+    const RowGroupView& row_group(size_t index) const { return groups_[index]; }
+
+    // Dictionary lookup; unknown ids read as empty
+    std::string_view dictionary(uint32_t id) const;
+
+    // Rebuild the PacketInfo for one row (no raw bytes or derived text)
+    PacketInfo to_packet(const RowGroupView& group, uint32_t row) const;
+
+private:
+    bool parse(const uint8_t* data, size_t size);
+    bool fail(const std::string& message);
+
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    std::string error_;
+    uint64_t total_rows_ = 0;
+    std::vector<RowGroupView> groups_;
+    std::vector<std::string_view> dictionary_;
+};
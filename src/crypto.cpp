@@ -0,0 +1,423 @@
+/*
+ * crypto.cpp - SHA-256, MD5, HKDF and AES-128-GCM implementation
+ *
+ * Straight from FIPS 180-4, RFC 1321, FIPS 197 and NIST SP 800-38D. The AES S-box is
+ * computed at compile time from its definition (multiplicative inverse in
+ * GF(2^8) followed by the affine map) rather than typed in.
+ */
+
+#include "crypto.hpp"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// ---- SHA-256 ----
+
+constexpr uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+void sha256_block(uint32_t* state, const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (static_cast<uint32_t>(block[4 * i]) << 24) | (block[4 * i + 1] << 16) |
+               (block[4 * i + 2] << 8) | block[4 * i + 3];
+    }
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) +
+                      SHA256_K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+// Hash of two concatenated buffers, which is all HMAC needs
+Sha256Digest sha256_pair(const uint8_t* a, size_t a_len, const uint8_t* b, size_t b_len) {
+    uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    uint8_t block[64];
+    size_t used = 0;
+    auto feed = [&](const uint8_t* data, size_t len) {
+        while (len > 0) {
+            size_t take = std::min(len, sizeof(block) - used);
+            std::memcpy(block + used, data, take);
+            used += take;
+            data += take;
+            len -= take;
+            if (used == sizeof(block)) {
+                sha256_block(state, block);
+                used = 0;
+            }
+        }
+    };
+    feed(a, a_len);
+    feed(b, b_len);
+
+    uint64_t bits = static_cast<uint64_t>(a_len + b_len) * 8;
+    uint8_t pad = 0x80;
+    feed(&pad, 1);
+    uint8_t zero = 0;
+    while (used != 56) {
+        feed(&zero, 1);
+    }
+    uint8_t length[8];
+    for (int i = 0; i < 8; ++i) {
+        length[i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    }
+    feed(length, sizeof(length));
+
+    Sha256Digest digest;
+    for (int i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+        digest[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+        digest[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+        digest[4 * i + 3] = static_cast<uint8_t>(state[i]);
+    }
+    return digest;
+}
+
+// ---- MD5 ----
+
+constexpr uint32_t MD5_K[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+
+constexpr int MD5_SHIFT[16] = {7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21};
+
+void md5_block(uint32_t* state, const uint8_t* block) {
+    uint32_t m[16];
+    for (int i = 0; i < 16; ++i) {
+        m[i] = block[4 * i] | (block[4 * i + 1] << 8) | (block[4 * i + 2] << 16) |
+               (static_cast<uint32_t>(block[4 * i + 3]) << 24);
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t f;
+        int g;
+        if (i < 16) {
+            f = (b & c) | (~b & d);
+            g = i;
+        } else if (i < 32) {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) % 16;
+        } else if (i < 48) {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) % 16;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * i) % 16;
+        }
+        uint32_t sum = a + f + MD5_K[i] + m[g];
+        int shift = MD5_SHIFT[(i / 16) * 4 + i % 4];
+        a = d; d = c; c = b;
+        b += (sum << shift) | (sum >> (32 - shift));
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+}
+
+// ---- AES-128 ----
+
+constexpr uint8_t xtime(uint8_t x) {
+    return static_cast<uint8_t>((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+}
+
+constexpr uint8_t gf_mul(uint8_t a, uint8_t b) {
+    uint8_t product = 0;
+    while (b) {
+        if (b & 1) product ^= a;
+        a = xtime(a);
+        b >>= 1;
+    }
+    return product;
+}
+
+constexpr std::array<uint8_t, 256> make_sbox() {
+    std::array<uint8_t, 256> sbox{};
+    for (int x = 0; x < 256; ++x) {
+        uint8_t inverse = 0;
+        for (int y = 1; y < 256 && x != 0; ++y) {
+            if (gf_mul(static_cast<uint8_t>(x), static_cast<uint8_t>(y)) == 1) {
+                inverse = static_cast<uint8_t>(y);
+                break;
+            }
+        }
+        uint8_t s = inverse;
+        for (int shift = 1; shift <= 4; ++shift) {
+            s ^= static_cast<uint8_t>((inverse << shift) | (inverse >> (8 - shift)));
+        }
+        sbox[x] = s ^ 0x63;
+    }
+    return sbox;
+}
+
+constexpr std::array<uint8_t, 256> SBOX = make_sbox();
+static_assert(SBOX[0x00] == 0x63 && SBOX[0x53] == 0xed, "AES S-box");
+
+// ---- GCM ----
+
+struct Block128 {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+};
+
+Block128 load128(const uint8_t* p) {
+    Block128 b;
+    for (int i = 0; i < 8; ++i) {
+        b.hi = (b.hi << 8) | p[i];
+        b.lo = (b.lo << 8) | p[8 + i];
+    }
+    return b;
+}
+
+void store128(const Block128& b, uint8_t* p) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<uint8_t>(b.hi >> (56 - 8 * i));
+        p[8 + i] = static_cast<uint8_t>(b.lo >> (56 - 8 * i));
+    }
+}
+
+// Multiplication in GF(2^128) with GCM's reflected bit order
+Block128 gf128_mul(const Block128& x, const Block128& y) {
+    Block128 z;
+    Block128 v = y;
+    for (int i = 0; i < 128; ++i) {
+        uint64_t word = i < 64 ? x.hi : x.lo;
+        if ((word >> (63 - (i & 63))) & 1) {
+            z.hi ^= v.hi;
+            z.lo ^= v.lo;
+        }
+        bool carry = v.lo & 1;
+        v.lo = (v.lo >> 1) | (v.hi << 63);
+        v.hi >>= 1;
+        if (carry) {
+            v.hi ^= 0xE100000000000000ULL;
+        }
+    }
+    return z;
+}
+
+void ghash_update(Block128& state, const Block128& h, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        uint8_t block[16] = {};
+        size_t take = std::min<size_t>(len, 16);
+        std::memcpy(block, data, take);
+        Block128 b = load128(block);
+        state.hi ^= b.hi;
+        state.lo ^= b.lo;
+        state = gf128_mul(state, h);
+        data += take;
+        len -= take;
+    }
+}
+
+// CTR keystream from counter block 2 onwards, plus the tag over aad and ciphertext
+void gcm(const uint8_t* key, const uint8_t* iv, const uint8_t* aad, size_t aad_len,
+         const uint8_t* in, size_t len, uint8_t* out, bool encrypt, uint8_t* tag) {
+    Aes128 aes(key);
+    uint8_t zero[16] = {};
+    uint8_t h_bytes[16];
+    aes.encrypt_block(zero, h_bytes);
+    Block128 h = load128(h_bytes);
+
+    uint8_t counter[16] = {};
+    std::memcpy(counter, iv, 12);
+    counter[15] = 1;
+    uint8_t tag_mask[16];
+    aes.encrypt_block(counter, tag_mask);
+
+    Block128 hash;
+    ghash_update(hash, h, aad, aad_len);
+    if (!encrypt) {
+        ghash_update(hash, h, in, len);
+    }
+
+    uint32_t n = 1;
+    for (size_t pos = 0; pos < len; pos += 16) {
+        ++n;
+        counter[12] = static_cast<uint8_t>(n >> 24);
+        counter[13] = static_cast<uint8_t>(n >> 16);
+        counter[14] = static_cast<uint8_t>(n >> 8);
+        counter[15] = static_cast<uint8_t>(n);
+        uint8_t stream[16];
+        aes.encrypt_block(counter, stream);
+        size_t take = std::min<size_t>(len - pos, 16);
+        for (size_t i = 0; i < take; ++i) {
+            out[pos + i] = in[pos + i] ^ stream[i];
+        }
+    }
+
+    if (encrypt) {
+        ghash_update(hash, h, out, len);
+    }
+    uint8_t lengths[16];
+    store128(Block128{static_cast<uint64_t>(aad_len) * 8, static_cast<uint64_t>(len) * 8}, lengths);
+    ghash_update(hash, h, lengths, sizeof(lengths));
+
+    store128(hash, tag);
+    for (int i = 0; i < 16; ++i) {
+        tag[i] ^= tag_mask[i];
+    }
+}
+
+}  // namespace
+
+Sha256Digest sha256(const uint8_t* data, size_t len) {
+    return sha256_pair(data, len, nullptr, 0);
+}
+
+Md5Digest md5(const uint8_t* data, size_t len) {
+    uint32_t state[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+    size_t full = len - len % 64;
+    for (size_t i = 0; i < full; i += 64) {
+        md5_block(state, data + i);
+    }
+
+    // Final one or two blocks: tail, 0x80, zeros, little-endian bit length
+    uint8_t tail[128] = {};
+    size_t rest = len - full;
+    std::memcpy(tail, data + full, rest);
+    tail[rest] = 0x80;
+    size_t tail_len = rest < 56 ? 64 : 128;
+    uint64_t bits = static_cast<uint64_t>(len) * 8;
+    for (int i = 0; i < 8; ++i) {
+        tail[tail_len - 8 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    for (size_t i = 0; i < tail_len; i += 64) {
+        md5_block(state, tail + i);
+    }
+
+    Md5Digest digest;
+    for (int i = 0; i < 16; ++i) {
+        digest[i] = static_cast<uint8_t>(state[i / 4] >> (8 * (i % 4)));
+    }
+    return digest;
+}
+
+Sha256Digest hmac_sha256(const uint8_t* key, size_t key_len, const uint8_t* data, size_t len) {
+    uint8_t block_key[64] = {};
+    if (key_len > sizeof(block_key)) {
+        Sha256Digest hashed = sha256(key, key_len);
+        std::memcpy(block_key, hashed.data(), hashed.size());
+    } else if (key_len > 0) {
+        std::memcpy(block_key, key, key_len);
+    }
+
+    uint8_t pad[64];
+    for (int i = 0; i < 64; ++i) pad[i] = block_key[i] ^ 0x36;
+    Sha256Digest inner = sha256_pair(pad, sizeof(pad), data, len);
+    for (int i = 0; i < 64; ++i) pad[i] = block_key[i] ^ 0x5c;
+    return sha256_pair(pad, sizeof(pad), inner.data(), inner.size());
+}
+
+Sha256Digest hkdf_extract(const uint8_t* salt, size_t salt_len, const uint8_t* ikm, size_t ikm_len) {
+    return hmac_sha256(salt, salt_len, ikm, ikm_len);
+}
+
+void hkdf_expand_label(const Sha256Digest& secret, const std::string& label,
+                       uint8_t* out, size_t length) {
+    // HkdfLabel: length(2) | label length(1) | "tls13 " label | context length(1)
+    std::vector<uint8_t> info;
+    std::string full = "tls13 " + label;
+    info.push_back(static_cast<uint8_t>(length >> 8));
+    info.push_back(static_cast<uint8_t>(length));
+    info.push_back(static_cast<uint8_t>(full.size()));
+    info.insert(info.end(), full.begin(), full.end());
+    info.push_back(0);
+    info.push_back(1);  // T(1) counter; one block covers length <= 32
+
+    Sha256Digest t = hmac_sha256(secret.data(), secret.size(), info.data(), info.size());
+    std::memcpy(out, t.data(), std::min(length, t.size()));
+}
+
+Aes128::Aes128(const uint8_t* key) {
+    std::memcpy(round_keys_.data(), key, 16);
+    uint8_t rcon = 1;
+    for (size_t i = 16; i < round_keys_.size(); i += 4) {
+        uint8_t t[4] = {round_keys_[i - 4], round_keys_[i - 3], round_keys_[i - 2], round_keys_[i - 1]};
+        if (i % 16 == 0) {
+            uint8_t first = t[0];
+            t[0] = SBOX[t[1]] ^ rcon;
+            t[1] = SBOX[t[2]];
+            t[2] = SBOX[t[3]];
+            t[3] = SBOX[first];
+            rcon = xtime(rcon);
+        }
+        for (int j = 0; j < 4; ++j) {
+            round_keys_[i + j] = round_keys_[i + j - 16] ^ t[j];
+        }
+    }
+}
+
+void Aes128::encrypt_block(const uint8_t* in, uint8_t* out) const {
+    uint8_t s[16];
+    for (int i = 0; i < 16; ++i) s[i] = in[i] ^ round_keys_[i];
+
+    for (int round = 1; round <= 10; ++round) {
+        // SubBytes and ShiftRows (state is column-major)
+        uint8_t t[16];
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                t[4 * c + r] = SBOX[s[4 * ((c + r) & 3) + r]];
+            }
+        }
+        // MixColumns, skipped in the last round
+        if (round != 10) {
+            for (int c = 0; c < 4; ++c) {
+                uint8_t* col = t + 4 * c;
+                uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+                uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+                col[0] ^= all ^ xtime(a0 ^ a1);
+                col[1] ^= all ^ xtime(a1 ^ a2);
+                col[2] ^= all ^ xtime(a2 ^ a3);
+                col[3] ^= all ^ xtime(a3 ^ a0);
+            }
+        }
+        for (int i = 0; i < 16; ++i) s[i] = t[i] ^ round_keys_[16 * round + i];
+    }
+    std::memcpy(out, s, 16);
+}
+
+void aes128_gcm_encrypt(const uint8_t* key, const uint8_t* iv, const uint8_t* aad, size_t aad_len,
+                        const uint8_t* in, size_t len, uint8_t* out, uint8_t* tag) {
+    gcm(key, iv, aad, aad_len, in, len, out, true, tag);
+}
+
+bool aes128_gcm_decrypt(const uint8_t* key, const uint8_t* iv, const uint8_t* aad, size_t aad_len,
+                        const uint8_t* in, size_t len, const uint8_t* tag, uint8_t* out) {
+    uint8_t expected[16];
+    gcm(key, iv, aad, aad_len, in, len, out, false, expected);
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; ++i) diff |= expected[i] ^ tag[i];
+    return diff == 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * crypto.hpp - SHA-256, MD5, HKDF and AES-128-GCM for QUIC and fingerprints
+ *
+ * Just enough cryptography to open QUIC Initial packets, whose keys are
+ * derived from the connection ID in the clear (RFC 9001 section 5.2):
+ * HKDF-SHA256 with TLS 1.3 labels, AES-128 for header protection and
+ * AES-128-GCM for the payload. MD5 is here only because JA3 is defined
+ * with it. Portable scalar code without external dependencies; it runs
+ * on the first few packets of each QUIC connection and once per distinct
+ * TLS fingerprint, so table-free simplicity beats speed. Not
+ * constant-time, which is fine for keys that are public by design.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using Sha256Digest = std::array<uint8_t, 32>;
+using Md5Digest = std::array<uint8_t, 16>;
+
+Sha256Digest sha256(const uint8_t* data, size_t len);
+Md5Digest md5(const uint8_t* data, size_t len);
+Sha256Digest hmac_sha256(const uint8_t* key, size_t key_len, const uint8_t* data, size_t len);
+
+// HKDF-Extract (RFC 5869) and HKDF-Expand-Label (RFC 8446 section 7.1)
+// with an empty context; length is at most 32
+Sha256Digest hkdf_extract(const uint8_t* salt, size_t salt_len, const uint8_t* ikm, size_t ikm_len);
+void hkdf_expand_label(const Sha256Digest& secret, const std::string& label,
+                       uint8_t* out, size_t length);
+
+class Aes128 {
+public:
+    explicit Aes128(const uint8_t* key);
+
+    void encrypt_block(const uint8_t* in, uint8_t* out) const;
+
+private:
+    std::array<uint8_t, 176> round_keys_;
+};
+
+// AES-128-GCM with a 12-byte IV and 16-byte tag. decrypt returns false
+// (and out is unspecified) if the tag does not match. out may equal in.
+void aes128_gcm_encrypt(const uint8_t* key, const uint8_t* iv, const uint8_t* aad, size_t aad_len,
+                        const uint8_t* in, size_t len, uint8_t* out, uint8_t* tag);
+bool aes128_gcm_decrypt(const uint8_t* key, const uint8_t* iv, const uint8_t* aad, size_t aad_len,
+                        const uint8_t* in, size_t len, const uint8_t* tag, uint8_t* out);
@@ -0,0 +1,104 @@
+/*
+ * dissector.hpp - Protocol dissector registry and dispatch tables
+ *
+ * Each layer of parse_packet() hands off to the next through a table
+ * built at compile time from a list of registrations: network dissectors
+ * are keyed by EtherType, transport dissectors by IP protocol and
+ * application dissectors by TCP/UDP port. A lookup is one array index, so
+ * the cost per packet does not grow with the number of protocols, and a
+ * new protocol is added by registering it rather than by editing the
+ * dispatch code. Registering the same key twice fails to compile.
+ * Tunnels register like any other layer (MPLS by EtherType, GRE and
+ * IP-in-IP by IP protocol, VXLAN and GENEVE by UDP destination port) and
+ * hand back an inner packet through the cursor.
+ *
+ * Application registrations are in priority order: when both ports of a
+ * packet are registered, the earlier entry wins. Payloads on ports with
+ * no registration are offered to the heuristic dissectors of their
+ * transport, which claim a payload only if its first bytes match.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Bytes of a frame still to be dissected; each layer advances pos past
+// its header and trims remaining to its own length. An encapsulation
+// dissector sets inner to the EtherType of the packet now at pos
+// (ETHERTYPE_TEB for an Ethernet frame), and dissection starts over there.
+struct DissectCursor {
+    const uint8_t* pos = nullptr;
+    size_t remaining = 0;
+    uint16_t inner = 0;
+};
+
+// Returns false when nothing above this layer can be parsed
+using LayerDissector = bool (*)(PacketInfo& info, DissectCursor& cursor);
+using PayloadDissector = void (*)(PacketInfo& info, const uint8_t* data, size_t len);
+// Returns true if it recognised and parsed the payload
+using HeuristicDissector = bool (*)(PacketInfo& info, const uint8_t* data, size_t len);
+
+// Application protocols with a port registration
+enum class AppDissector : uint8_t { NONE, DNS, HTTP, TLS, QUIC };
+
+enum class PortMatch : uint8_t {
+    EITHER,   // Source or destination port
+    DST,      // Destination port only (client-to-server messages)
+};
+
+struct LayerRegistration {
+    uint16_t key;             // EtherType or IP protocol
+    LayerDissector dissect;
+};
+
+struct PortRegistration {
+    AppDissector id;
+    uint8_t transport;        // PROTO_TCP or PROTO_UDP
+    uint16_t port;
+    PortMatch match;
+    PayloadDissector parse;
+};
+
+struct HeuristicRegistration {
+    uint8_t transport;
+    HeuristicDissector parse;
+};
+
+// Registration index + 1 for every key; 0 means unregistered
+template <size_t Keys>
+using DispatchTable = std::array<uint8_t, Keys>;
+
+template <size_t Keys, size_t N>
+constexpr DispatchTable<Keys> make_layer_table(const LayerRegistration (&entries)[N]) {
+    static_assert(N < 256, "dispatch tables index with uint8_t");
+    DispatchTable<Keys> table{};
+    for (size_t i = 0; i < N; ++i) {
+        if (entries[i].key >= Keys || table[entries[i].key] != 0) {
+            throw "layer dissector key out of range or registered twice";
+        }
+        table[entries[i].key] = static_cast<uint8_t>(i + 1);
+    }
+    return table;
+}
+
+template <size_t N>
+constexpr DispatchTable<65536> make_port_table(const PortRegistration (&entries)[N],
+                                               uint8_t transport) {
+    static_assert(N < 256, "dispatch tables index with uint8_t");
+    DispatchTable<65536> table{};
+    for (size_t i = 0; i < N; ++i) {
+        if (entries[i].transport != transport) continue;
+        if (table[entries[i].port] != 0) {
+            throw "port registered twice for one transport";
+        }
+        table[entries[i].port] = static_cast<uint8_t>(i + 1);
+    }
+    return table;
+}
+
+// Dissector registered for this TCP/UDP packet's ports, or NONE. Heuristic
+// dissectors are not consulted.
+AppDissector find_app_dissector(const PacketInfo& info);
@@ -0,0 +1,157 @@
+/*
+ * dns_cache.cpp - Passive DNS cache implementation
+ */
+
+#include "dns_cache.hpp"
+#include "flow_table.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+constexpr int MAX_CNAME_HOPS = 8;
+
+bool same_name(const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+}  // namespace
+
+size_t DnsCache::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = fnv1a(FNV1A_OFFSET, key.addr.data(), key.ip_version == 4 ? 4 : 16);
+    return static_cast<size_t>(hash ^ key.ip_version);
+}
+
+DnsCache::DnsCache(const DnsCacheConfig& config)
+    : config_(config),
+      shard_capacity_(std::max<size_t>(1, config.max_entries / SHARDS)) {}
+
+DnsCache::Shard& DnsCache::shard_for(const Key& key) {
+    // High bits, so the shard does not follow the in-shard bucket
+    return shards_[(KeyHash()(key) >> 28) % SHARDS];
+}
+
+void DnsCache::on_packet(PacketInfo& info) {
+    if (config_.max_entries == 0) {
+        return;
+    }
+    if (!info.dns_answers.empty()) {
+        learn(info.hostname, info.dns_answers, info.timestamp);
+        return;
+    }
+    if (!info.hostname.empty() || (info.ip_version != 4 && info.ip_version != 6)) {
+        return;
+    }
+
+    auto name = lookup(info.ip_version, info.dst_addr, info.timestamp);
+    if (!name) {
+        name = lookup(info.ip_version, info.src_addr, info.timestamp);
+    }
+    if (name) {
+        info.hostname = std::move(*name);
+        info.hostname_from_dns = true;
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DnsCache::learn(const std::string& qname, const std::vector<DnsAnswer>& answers,
+                     std::chrono::system_clock::time_point now) {
+    if (config_.max_entries == 0 || qname.empty()) {
+        return;
+    }
+
+    // Names reachable from the question through CNAMEs, in order
+    std::vector<const std::string*> chain{&qname};
+    for (int hop = 0; hop < MAX_CNAME_HOPS; ++hop) {
+        const std::string* next = nullptr;
+        for (const DnsAnswer& answer : answers) {
+            if (answer.type == DNS_TYPE_CNAME && same_name(answer.name, *chain.back())) {
+                next = &answer.target;
+                break;
+            }
+        }
+        if (!next) break;
+        chain.push_back(next);
+    }
+
+    for (const DnsAnswer& answer : answers) {
+        if (answer.type != DNS_TYPE_A && answer.type != DNS_TYPE_AAAA) {
+            continue;
+        }
+        // Addresses outside the chain (unrelated glue) keep their own name
+        bool in_chain = std::any_of(chain.begin(), chain.end(), [&](const std::string* name) {
+            return same_name(answer.name, *name);
+        });
+
+        Key key;
+        key.ip_version = answer.type == DNS_TYPE_A ? 4 : 6;
+        key.addr = answer.addr;
+        auto ttl = std::clamp(std::chrono::seconds(answer.ttl & 0x7FFFFFFF),
+                              config_.min_ttl, config_.max_ttl);
+        insert(key, in_chain ? qname : answer.name, now + ttl);
+    }
+}
+
+void DnsCache::insert(const Key& key, const std::string& hostname,
+                      std::chrono::system_clock::time_point expires) {
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    inserts_.fetch_add(1, std::memory_order_relaxed);
+
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        it->second.hostname = hostname;
+        it->second.expires = expires;
+        shard.lru.splice(shard.lru.end(), shard.lru, it->second.lru);
+        return;
+    }
+
+    if (shard.entries.size() >= shard_capacity_) {
+        shard.entries.erase(shard.lru.front());
+        shard.lru.pop_front();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+        entries_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    Entry entry{hostname, expires, shard.lru.insert(shard.lru.end(), key)};
+    shard.entries.emplace(key, std::move(entry));
+    entries_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::optional<std::string> DnsCache::lookup(uint8_t ip_version, const std::array<uint8_t, 16>& addr,
+                                            std::chrono::system_clock::time_point now) {
+    Key key;
+    key.ip_version = ip_version;
+    if (ip_version == 4) {
+        std::copy_n(addr.begin(), 4, key.addr.begin());  // Ignore anything past the IPv4 bytes
+    } else {
+        key.addr = addr;
+    }
+
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        return std::nullopt;
+    }
+    if (it->second.expires < now) {
+        shard.lru.erase(it->second.lru);
+        shard.entries.erase(it);
+        entries_.fetch_sub(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    shard.lru.splice(shard.lru.end(), shard.lru, it->second.lru);
+    return it->second.hostname;
+}
+
+DnsCacheStats DnsCache::stats() const {
+    DnsCacheStats stats;
+    stats.entries = entries_.load(std::memory_order_relaxed);
+    stats.inserts = inserts_.load(std::memory_order_relaxed);
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,103 @@
+/*
+ * dns_cache.hpp - Passive DNS: resolved addresses back to hostnames
+ *
+ * Learns address -> hostname mappings from the A and AAAA answers of DNS
+ * responses seen on the wire. Each address maps to the name that was asked
+ * for, so a CNAME chain (www.example.com -> edge.cdn.net -> 192.0.2.7)
+ * maps 192.0.2.7 to www.example.com. Entries expire by the record TTL
+ * measured in packet time (clamped to [min_ttl, max_ttl], since TTL 0
+ * answers are still used for the connection that follows).
+ *
+ * Packets without a hostname of their own (QUIC, SSH, resumed TLS) are then
+ * labelled with the name for their destination, or failing that their
+ * source address, and flagged hostname_from_dns.
+ *
+ * The table is split into shards, each with its own mutex and LRU list, so
+ * the capture thread and UI readers rarely contend; each shard holds at most
+ * max_entries / SHARDS entries.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+struct DnsCacheConfig {
+    size_t max_entries = 65536;   // 0 disables the cache
+    std::chrono::seconds min_ttl{60};
+    std::chrono::seconds max_ttl{86400};
+};
+
+struct DnsCacheStats {
+    uint64_t entries = 0;
+    uint64_t inserts = 0;
+    uint64_t hits = 0;        // Packets labelled from the cache
+    uint64_t evictions = 0;   // Dropped to stay within max_entries
+};
+
+class DnsCache {
+public:
+    static constexpr size_t SHARDS = 16;
+
+    explicit DnsCache(const DnsCacheConfig& config = DnsCacheConfig());
+
+    // Non-copyable (mutexes)
+    DnsCache(const DnsCache&) = delete;
+    DnsCache& operator=(const DnsCache&) = delete;
+
+    // Learn from a DNS response, or label a packet that has no hostname
+    void on_packet(PacketInfo& info);
+
+    // Record the answers of one response; qname is the question name
+    void learn(const std::string& qname, const std::vector<DnsAnswer>& answers,
+               std::chrono::system_clock::time_point now);
+
+    // Hostname for an address still valid at now (ip_version 4 or 6)
+    std::optional<std::string> lookup(uint8_t ip_version, const std::array<uint8_t, 16>& addr,
+                                      std::chrono::system_clock::time_point now);
+
+    DnsCacheStats stats() const;
+
+private:
+    struct Key {
+        uint8_t ip_version = 0;
+        std::array<uint8_t, 16> addr{};
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        std::string hostname;
+        std::chrono::system_clock::time_point expires;
+        std::list<Key>::iterator lru;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        std::list<Key> lru;   // Front is least recently used
+    };
+
+    Shard& shard_for(const Key& key);
+    void insert(const Key& key, const std::string& hostname,
+                std::chrono::system_clock::time_point expires);
+
+    DnsCacheConfig config_;
+    size_t shard_capacity_;
+    std::array<Shard, SHARDS> shards_;
+    std::atomic<uint64_t> entries_{0};
+    std::atomic<uint64_t> inserts_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
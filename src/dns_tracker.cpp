@@ -0,0 +1,181 @@
+/*
+ * dns_tracker.cpp - DNS transaction tracking implementation
+ */
+
+#include "dns_tracker.hpp"
+#include "flow_table.hpp"
+#include <algorithm>
+
+namespace {
+
+constexpr uint16_t DNS_FLAG_RESPONSE = 0x8000;
+constexpr uint8_t DNS_RCODE_SERVFAIL = 2;
+constexpr uint8_t DNS_RCODE_NXDOMAIN = 3;
+
+// FNV-1a over the lowercased name, so 0x20-randomised queries still match
+uint64_t name_hash(const std::string& name) {
+    uint64_t hash = FNV1A_OFFSET;
+    for (char c : name) {
+        uint8_t byte = static_cast<uint8_t>(c);
+        if (byte >= 'A' && byte <= 'Z') byte |= 0x20;
+        hash = fnv1a(hash, &byte, 1);
+    }
+    return hash;
+}
+
+void add_latency(DnsTimingStats& stats, uint64_t ns) {
+    stats.responses++;
+    stats.latency.add(ns);
+}
+
+}  // namespace
+
+size_t DnsTracker::KeyHash::operator()(const Key& key) const {
+    uint8_t header[5] = {
+        key.ip_version,
+        static_cast<uint8_t>(key.client_port >> 8), static_cast<uint8_t>(key.client_port),
+        static_cast<uint8_t>(key.id >> 8), static_cast<uint8_t>(key.id)
+    };
+    uint64_t hash = fnv1a(FNV1A_OFFSET, header, sizeof(header));
+    size_t addr_len = key.ip_version == 4 ? 4 : 16;
+    hash = fnv1a(hash, key.client.data(), addr_len);
+    hash = fnv1a(hash, key.server.data(), addr_len);
+    return static_cast<size_t>(hash ^ key.name_hash);
+}
+
+DnsTracker::DnsTracker(const DnsTrackerConfig& config) : config_(config) {
+    servers_.set_capacity(config.max_servers);
+    names_.set_capacity(config.max_names);
+    pending_.reserve(std::min<size_t>(config.max_pending, 4096));
+}
+
+void DnsTracker::on_packet(const PacketInfo& info) {
+    if (config_.max_pending == 0 || info.protocol != PROTO_UDP ||
+        info.hostname.empty() || info.app_protocol != "DNS") {
+        return;
+    }
+
+    bool response = info.dns_flags & DNS_FLAG_RESPONSE;
+    Key key;
+    key.ip_version = info.ip_version;
+    key.client_port = response ? info.dst_port : info.src_port;
+    key.id = info.dns_id;
+    key.name_hash = name_hash(info.hostname);
+    key.client = response ? info.dst_addr : info.src_addr;
+    key.server = response ? info.src_addr : info.dst_addr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (response) {
+        on_response(key, info);
+    } else {
+        on_query(key, info);
+    }
+    expire_locked(info.timestamp);
+}
+
+void DnsTracker::on_query(const Key& key, const PacketInfo& info) {
+    total_.queries++;
+    servers_.get(info.dst_ip).queries++;
+    names_.get(info.hostname).queries++;
+
+    // A retransmission keeps the original send time
+    if (pending_.count(key)) {
+        return;
+    }
+    if (pending_.size() >= config_.max_pending) {
+        overflows_++;
+        unanswered(pending_.find(ages_.front()));
+    }
+    Pending query;
+    query.sent = info.timestamp;
+    query.server = info.dst_ip;
+    query.name = info.hostname;
+    query.age = ages_.insert(ages_.end(), key);
+    pending_.emplace(key, std::move(query));
+}
+
+void DnsTracker::on_response(const Key& key, const PacketInfo& info) {
+    auto it = pending_.find(key);
+    if (it == pending_.end()) {
+        unmatched_++;
+        return;
+    }
+
+    auto elapsed = std::max(info.timestamp - it->second.sent,
+                            std::chrono::system_clock::duration::zero());
+    uint64_t ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    DnsTimingStats& server = servers_.get(it->second.server);
+    DnsTimingStats& name = names_.get(it->second.name);
+    add_latency(total_, ns);
+    add_latency(server, ns);
+    add_latency(name, ns);
+
+    uint8_t rcode = info.dns_flags & 0x0F;
+    if (rcode == DNS_RCODE_NXDOMAIN) {
+        total_.nxdomain++;
+        server.nxdomain++;
+        name.nxdomain++;
+    } else if (rcode == DNS_RCODE_SERVFAIL) {
+        total_.servfail++;
+        server.servfail++;
+        name.servfail++;
+    }
+
+    ages_.erase(it->second.age);
+    pending_.erase(it);
+}
+
+void DnsTracker::unanswered(PendingMap::iterator it) {
+    total_.unanswered++;
+    servers_.get(it->second.server).unanswered++;
+    names_.get(it->second.name).unanswered++;
+    ages_.erase(it->second.age);
+    pending_.erase(it);
+}
+
+void DnsTracker::expire(std::chrono::system_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire_locked(now);
+}
+
+void DnsTracker::expire_locked(std::chrono::system_clock::time_point now) {
+    // Amortised O(1): each query is aged out at most once
+    auto cutoff = now - config_.timeout;
+    while (!ages_.empty()) {
+        auto it = pending_.find(ages_.front());
+        if (it->second.sent >= cutoff) {
+            break;
+        }
+        unanswered(it);
+    }
+}
+
+DnsTrackerSnapshot DnsTracker::snapshot(size_t top, DnsOrder order) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DnsTrackerSnapshot snap;
+    snap.total = total_;
+    snap.servers = top_entries(servers_, top, order);
+    snap.names = top_entries(names_, top, order);
+    snap.pending = pending_.size();
+    snap.overflows = overflows_;
+    snap.unmatched = unmatched_;
+    return snap;
+}
+
+std::vector<DnsTimingStats> DnsTracker::top_entries(const Table& table, size_t top,
+                                                    DnsOrder order) {
+    auto winners = top_ranked(
+        table, top,
+        [order](const DnsTimingStats& stats) -> uint64_t {
+            return order == DnsOrder::BUSIEST ? stats.queries : stats.latency.percentile(0.99);
+        },
+        [](const DnsTimingStats& a, const DnsTimingStats& b) { return a.label < b.label; });
+
+    std::vector<DnsTimingStats> result;
+    result.reserve(winners.size());
+    for (const DnsTimingStats* stats : winners) {
+        result.push_back(*stats);
+    }
+    return result;
+}
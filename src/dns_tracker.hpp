@@ -0,0 +1,121 @@
+/*
+ * dns_tracker.hpp - DNS transaction latency and failure tracking
+ *
+ * Matches each DNS response to its query by (client address and port,
+ * server address, transaction id, question name) and records the response
+ * time in packet time. Results are kept for the whole capture, per server
+ * and per question name: query and response counts, NXDOMAIN and SERVFAIL
+ * responses, queries that were never answered, and a latency histogram.
+ *
+ * The pending-query table is a hash map with an age list, so matching is
+ * O(1) per packet. It holds at most max_pending queries: a flood of queries
+ * pushes out the oldest ones, which count as unanswered, as do queries
+ * still pending after the timeout (checked on each DNS packet, and by the
+ * pipeline's tick() when DNS traffic stops). The server and name tables are bounded
+ * too, dropping the least recently seen entry. One mutex guards everything;
+ * the pipeline thread writes and the DNS panel takes snapshots.
+ */
+
+#pragma once
+
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include "stats_table.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct DnsTrackerConfig {
+    size_t max_pending = 16384;       // Outstanding queries; 0 disables tracking
+    size_t max_servers = 256;
+    size_t max_names = 512;
+    std::chrono::seconds timeout{5};  // Pending longer than this = unanswered
+};
+
+struct DnsTimingStats {
+    std::string label;            // Server address or question name
+    uint64_t queries = 0;
+    uint64_t responses = 0;       // Matched to a query
+    uint64_t nxdomain = 0;
+    uint64_t servfail = 0;
+    uint64_t unanswered = 0;      // Timed out or pushed out of the pending table
+    HistogramSnapshot latency;    // Query to response
+};
+
+enum class DnsOrder : uint8_t { BUSIEST, SLOWEST };
+
+struct DnsTrackerSnapshot {
+    DnsTimingStats total;
+    std::vector<DnsTimingStats> servers;
+    std::vector<DnsTimingStats> names;
+    uint64_t pending = 0;
+    uint64_t overflows = 0;       // Pending queries dropped to stay within max_pending
+    uint64_t unmatched = 0;       // Responses with no pending query
+};
+
+class DnsTracker {
+public:
+    explicit DnsTracker(const DnsTrackerConfig& config = DnsTrackerConfig());
+
+    // Non-copyable (mutex)
+    DnsTracker(const DnsTracker&) = delete;
+    DnsTracker& operator=(const DnsTracker&) = delete;
+
+    // Feed a parsed packet; anything but a DNS query or response is ignored
+    void on_packet(const PacketInfo& info);
+
+    // Count queries pending since before now - timeout as unanswered
+    void expire(std::chrono::system_clock::time_point now);
+
+    // Totals plus the top entries of each table in the given order
+    DnsTrackerSnapshot snapshot(size_t top, DnsOrder order = DnsOrder::BUSIEST) const;
+
+private:
+    struct Key {
+        uint8_t ip_version = 0;
+        uint16_t client_port = 0;
+        uint16_t id = 0;
+        uint64_t name_hash = 0;
+        std::array<uint8_t, 16> client{};
+        std::array<uint8_t, 16> server{};
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Pending {
+        std::chrono::system_clock::time_point sent;
+        std::string server;
+        std::string name;
+        std::list<Key>::iterator age;
+    };
+
+    // Server or name statistics with least-recently-seen eviction
+    using Table = LruStatsTable<DnsTimingStats, &DnsTimingStats::label>;
+
+    using PendingMap = std::unordered_map<Key, Pending, KeyHash>;
+
+    void on_query(const Key& key, const PacketInfo& info);
+    void on_response(const Key& key, const PacketInfo& info);
+    void unanswered(PendingMap::iterator it);
+    void expire_locked(std::chrono::system_clock::time_point now);
+    static std::vector<DnsTimingStats> top_entries(const Table& table, size_t top, DnsOrder order);
+
+    DnsTrackerConfig config_;
+    mutable std::mutex mutex_;
+    PendingMap pending_;
+    std::list<Key> ages_;          // Front is the oldest query
+    Table servers_;
+    Table names_;
+    DnsTimingStats total_;
+    uint64_t overflows_ = 0;
+    uint64_t unmatched_ = 0;
+};
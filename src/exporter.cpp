@@ -0,0 +1,411 @@
+/*
+ * exporter.cpp - Streaming record export implementation
+ *
+ * Chunks are recycled between the capture thread and the writer, so once
+ * the pool has warmed up the export path performs no allocation per
+ * record. A write error on the sink (for example a closed pipe) stops
+ * output; later records are counted as dropped so BLOCK can never hang.
+ *
+ * Flow expiry runs on capture time: packets advance it directly, and
+ * tick() advances it by the wall-clock time elapsed since the last packet,
+ * so offline captures and idle links both expire flows correctly.
+ */
+
+#include "exporter.hpp"
+#include "columnar.hpp"
+#include "record_format.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(200);
+constexpr auto EXPIRE_INTERVAL = std::chrono::seconds(1);
+constexpr size_t PREALLOCATED_CHUNKS = 4;
+
+}  // namespace
+
+RecordExporter::~RecordExporter() {
+    stop();
+}
+
+bool RecordExporter::parse_format(const std::string& text, ExportFormat& out) {
+    if (text == "ndjson" || text == "json") {
+        out = ExportFormat::NDJSON;
+    } else if (text == "csv") {
+        out = ExportFormat::CSV;
+    } else if (text == "columnar") {
+        out = ExportFormat::COLUMNAR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool RecordExporter::parse_records(const std::string& text, ExportRecords& out) {
+    if (text == "packets") {
+        out = ExportRecords::PACKETS;
+    } else if (text == "flows") {
+        out = ExportRecords::FLOWS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool RecordExporter::parse_policy(const std::string& text, ExportPolicy& out) {
+    if (text == "block") {
+        out = ExportPolicy::BLOCK;
+    } else if (text == "drop") {
+        out = ExportPolicy::DROP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool RecordExporter::start(const ExportConfig& config) {
+    if (running_.load()) {
+        return true;
+    }
+
+    config_ = config;
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_.clear();
+    }
+    if (config_.chunk_bytes < 4096) config_.chunk_bytes = 4096;
+    if (config_.max_chunks < 2) config_.max_chunks = 2;
+
+    if (config_.path == "-") {
+        fd_ = STDOUT_FILENO;
+        owns_fd_ = false;
+    } else {
+        // A columnar file ends in a footer, so it can only be rewritten
+        bool append = config_.append && config_.format != ExportFormat::COLUMNAR;
+        fd_ = ::open(config_.path.c_str(),
+                     O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+        if (fd_ < 0) {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            error_ = "Cannot open " + config_.path + ": " + strerror(errno);
+            return false;
+        }
+        owns_fd_ = true;
+    }
+
+    if (config_.format == ExportFormat::COLUMNAR) {
+        columnar_ = std::make_unique<ColumnarWriter>();
+        if (!columnar_->start(fd_, config_.row_group_rows,
+                              config_.policy == ExportPolicy::BLOCK)) {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            error_ = columnar_->get_error();
+            columnar_.reset();
+            if (owns_fd_) ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        running_.store(true);
+        return true;
+    }
+
+    flows_ = FlowTable(config_.max_flows);
+    last_expire_ = {};
+    last_packet_time_ = {};
+    last_submit_ = std::chrono::steady_clock::now();
+    sink_failed_.store(false);
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        free_chunks_.clear();
+        full_chunks_.clear();
+        allocated_chunks_ = 0;
+        for (size_t i = 0; i < PREALLOCATED_CHUNKS && i < config_.max_chunks; ++i) {
+            Chunk chunk;
+            chunk.data = std::make_unique<char[]>(config_.chunk_bytes);
+            free_chunks_.push_back(std::move(chunk));
+            allocated_chunks_++;
+        }
+    }
+    has_current_ = false;
+
+    running_.store(true);
+    writer_thread_ = std::thread([this]() {
+        writer_loop();
+    });
+
+    // Appended rows follow the header already in the file
+    bool continuing = config_.append && (!owns_fd_ || ::lseek(fd_, 0, SEEK_END) > 0);
+    if (config_.format == ExportFormat::CSV && !continuing) {
+        const char* header = config_.records == ExportRecords::FLOWS
+                                 ? flow_csv_header() : packet_csv_header();
+        if (acquire_chunk()) {
+            size_t len = strlen(header);
+            std::memcpy(current_.data.get(), header, len);
+            current_.size = len;
+        }
+    }
+
+    return true;
+}
+
+void RecordExporter::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    if (columnar_) {
+        columnar_->finish();
+        records_written_.store(columnar_->rows_written());
+        records_dropped_.store(columnar_->rows_dropped());
+        std::string error = columnar_->get_error();
+        if (!error.empty()) {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            error_ = error;
+        }
+        columnar_.reset();
+        running_.store(false);
+        if (owns_fd_ && fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+        owns_fd_ = false;
+        return;
+    }
+
+    if (config_.records == ExportRecords::FLOWS) {
+        flows_.drain([this](const FlowRecord& flow, FlowEndReason reason) {
+            emit_flow(flow, reason);
+        });
+    }
+    submit_chunk();
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        running_.store(false);
+    }
+    full_cv_.notify_all();
+    pool_cv_.notify_all();
+
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+
+    if (owns_fd_ && fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    owns_fd_ = false;
+}
+
+std::string RecordExporter::get_error() const {
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_.empty()) {
+            return error_;
+        }
+    }
+    return columnar_ ? columnar_->get_error() : std::string();
+}
+
+uint64_t RecordExporter::records_written() const {
+    return columnar_ ? columnar_->rows_written() : records_written_.load();
+}
+
+uint64_t RecordExporter::records_dropped() const {
+    return columnar_ ? columnar_->rows_dropped() : records_dropped_.load();
+}
+
+void RecordExporter::on_packet(const PacketInfo& pkt) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    if (columnar_) {
+        columnar_->append(pkt);
+        return;
+    }
+
+    last_packet_time_ = pkt.timestamp;
+    last_packet_seen_ = std::chrono::steady_clock::now();
+
+    if (config_.records == ExportRecords::PACKETS) {
+        emit_packet(pkt);
+        return;
+    }
+
+    flows_.update(pkt);
+    if (pkt.timestamp - last_expire_ >= EXPIRE_INTERVAL) {
+        expire_flows(pkt.timestamp);
+    }
+}
+
+void RecordExporter::tick() {
+    if (!running_.load(std::memory_order_relaxed) || columnar_) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    // Advance capture time by however long the link has been quiet
+    if (config_.records == ExportRecords::FLOWS && flows_.size() > 0) {
+        auto capture_now = last_packet_time_ +
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                now - last_packet_seen_);
+        if (capture_now - last_expire_ >= EXPIRE_INTERVAL) {
+            expire_flows(capture_now);
+        }
+    }
+
+    // Keep slow streams flowing to consumers
+    if (has_current_ && current_.size > 0 && now - last_submit_ >= FLUSH_INTERVAL) {
+        submit_chunk();
+    }
+}
+
+void RecordExporter::expire_flows(std::chrono::system_clock::time_point now) {
+    last_expire_ = now;
+    flows_.expire(now, config_.flow_idle_timeout, config_.flow_active_timeout,
+                  [this](const FlowRecord& flow, FlowEndReason reason) {
+                      emit_flow(flow, reason);
+                  });
+}
+
+void RecordExporter::emit_packet(const PacketInfo& pkt) {
+    if (config_.format == ExportFormat::CSV) {
+        emit([&pkt](FormatBuffer& out) { return format_packet_csv(out, pkt); });
+    } else {
+        emit([&pkt](FormatBuffer& out) { return format_packet_ndjson(out, pkt); });
+    }
+}
+
+void RecordExporter::emit_flow(const FlowRecord& flow, FlowEndReason reason) {
+    if (config_.format == ExportFormat::CSV) {
+        emit([&](FormatBuffer& out) { return format_flow_csv(out, flow, reason); });
+    } else {
+        emit([&](FormatBuffer& out) { return format_flow_ndjson(out, flow, reason); });
+    }
+}
+
+template <typename Format>
+void RecordExporter::emit(Format&& format) {
+    if (!has_current_ && !acquire_chunk()) {
+        records_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    FormatBuffer out(current_.data.get() + current_.size, config_.chunk_bytes - current_.size);
+    if (!format(out)) {
+        // Doesn't fit: start a fresh chunk, unless this one was already empty
+        if (current_.size == 0) {
+            records_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        submit_chunk();
+        if (!acquire_chunk()) {
+            records_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        out = FormatBuffer(current_.data.get(), config_.chunk_bytes);
+        if (!format(out)) {
+            records_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    current_.size += out.size();
+    current_.records++;
+}
+
+bool RecordExporter::acquire_chunk() {
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+
+    if (free_chunks_.empty() && allocated_chunks_ < config_.max_chunks) {
+        Chunk chunk;
+        chunk.data = std::make_unique<char[]>(config_.chunk_bytes);
+        free_chunks_.push_back(std::move(chunk));
+        allocated_chunks_++;
+    }
+
+    if (free_chunks_.empty()) {
+        if (config_.policy == ExportPolicy::DROP) {
+            return false;
+        }
+        // Backpressure: wait for the writer to return a chunk
+        pool_cv_.wait(lock, [this]() {
+            return !free_chunks_.empty() || !running_.load();
+        });
+        if (free_chunks_.empty()) {
+            return false;
+        }
+    }
+
+    current_ = std::move(free_chunks_.back());
+    free_chunks_.pop_back();
+    has_current_ = true;
+    return true;
+}
+
+void RecordExporter::submit_chunk() {
+    last_submit_ = std::chrono::steady_clock::now();
+    if (!has_current_ || current_.size == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        full_chunks_.push_back(std::move(current_));
+    }
+    has_current_ = false;
+    current_ = Chunk{};
+    full_cv_.notify_one();
+}
+
+void RecordExporter::writer_loop() {
+    while (true) {
+        Chunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex_);
+            full_cv_.wait(lock, [this]() {
+                return !full_chunks_.empty() || !running_.load();
+            });
+            if (full_chunks_.empty()) {
+                break;  // Stopped and drained
+            }
+            chunk = std::move(full_chunks_.front());
+            full_chunks_.pop_front();
+        }
+
+        if (!sink_failed_.load() && write_all(chunk.data.get(), chunk.size)) {
+            records_written_.fetch_add(chunk.records, std::memory_order_relaxed);
+            bytes_written_.fetch_add(chunk.size, std::memory_order_relaxed);
+        } else {
+            records_dropped_.fetch_add(chunk.records, std::memory_order_relaxed);
+        }
+
+        chunk.size = 0;
+        chunk.records = 0;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            free_chunks_.push_back(std::move(chunk));
+        }
+        pool_cv_.notify_one();
+    }
+}
+
+bool RecordExporter::write_all(const char* data, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = ::write(fd_, data + written, size - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            sink_failed_.store(true);
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            error_ = "Export write failed: " + std::string(strerror(errno));
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+/*
+ * exporter.hpp - Streaming NDJSON/CSV export of packets or flows
+ *
+ * Serialises parsed packet metadata (never raw bytes), or flow summaries
+ * from a FlowTable, to a file or stdout. Records are formatted on the
+ * capture thread straight into fixed-size chunks taken from a preallocated
+ * pool; full chunks go to a writer thread that issues one write(2) each.
+ *
+ * When the sink is slower than capture the pool runs dry, and the policy
+ * decides what happens: BLOCK waits for the writer (backpressure on the
+ * capture thread, and from there onto the kernel buffer), DROP discards
+ * records and counts them.
+ *
+ * The columnar format (see columnar.hpp) is binary and packets-only; it is
+ * delegated to a ColumnarWriter that buffers whole row groups instead.
+ *
+ * Usage: start(), then on_packet() for every packet and tick() regularly
+ * from the capture thread; stop() expires the remaining flows and flushes.
+ */
+
+#pragma once
+
+#include "flow_table.hpp"
+#include "packet.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ColumnarWriter;
+
+enum class ExportFormat { NDJSON, CSV, COLUMNAR };
+enum class ExportRecords { PACKETS, FLOWS };
+enum class ExportPolicy { BLOCK, DROP };
+
+struct ExportConfig {
+    std::string path = "-";                          // "-" = stdout
+    ExportFormat format = ExportFormat::NDJSON;
+    ExportRecords records = ExportRecords::PACKETS;
+    ExportPolicy policy = ExportPolicy::BLOCK;
+    size_t chunk_bytes = 64u << 10;                  // Bytes per write(2)
+    size_t max_chunks = 64;                          // Pool size (memory cap)
+    std::chrono::seconds flow_idle_timeout{15};
+    std::chrono::seconds flow_active_timeout{60};
+    size_t max_flows = 65536;
+    uint32_t row_group_rows = 65536;                 // Columnar format only
+    bool append = false;                             // Keep what the file holds (not columnar)
+};
+
+class RecordExporter {
+public:
+    RecordExporter() = default;
+    ~RecordExporter();
+
+    // Non-copyable
+    RecordExporter(const RecordExporter&) = delete;
+    RecordExporter& operator=(const RecordExporter&) = delete;
+
+    // Open the sink, write the CSV header if any, start the writer thread
+    bool start(const ExportConfig& config);
+
+    // Expire remaining flows, flush and close the sink
+    void stop();
+
+    // Capture thread
+    void on_packet(const PacketInfo& pkt);
+    void tick();  // Expires idle flows and flushes partly filled chunks
+
+    bool is_running() const { return running_.load(); }
+    std::string get_error() const;
+
+    // Counters
+    uint64_t records_written() const;
+    uint64_t records_dropped() const;
+    uint64_t bytes_written() const { return bytes_written_.load(); }
+
+    // Parse --export-* values; return false if unrecognised
+    static bool parse_format(const std::string& text, ExportFormat& out);
+    static bool parse_records(const std::string& text, ExportRecords& out);
+    static bool parse_policy(const std::string& text, ExportPolicy& out);
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+        uint64_t records = 0;
+    };
+
+    // Capture thread
+    void emit_packet(const PacketInfo& pkt);
+    void emit_flow(const FlowRecord& flow, FlowEndReason reason);
+    template <typename Format>
+    void emit(Format&& format);
+    bool acquire_chunk();
+    void submit_chunk();
+    void expire_flows(std::chrono::system_clock::time_point now);
+
+    // Writer thread
+    void writer_loop();
+    bool write_all(const char* data, size_t size);
+
+    ExportConfig config_;
+    int fd_ = -1;
+    bool owns_fd_ = false;
+    std::unique_ptr<ColumnarWriter> columnar_;
+
+    // Capture-thread state
+    Chunk current_;
+    bool has_current_ = false;
+    FlowTable flows_;
+    std::chrono::system_clock::time_point last_expire_{};       // Capture time
+    std::chrono::system_clock::time_point last_packet_time_{};  // Capture time
+    std::chrono::steady_clock::time_point last_packet_seen_{};
+    std::chrono::steady_clock::time_point last_submit_{};
+
+    // Chunk pool shared with the writer
+    std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;   // Signalled when a chunk is freed
+    std::condition_variable full_cv_;   // Signalled when a chunk is submitted
+    std::vector<Chunk> free_chunks_;
+    std::deque<Chunk> full_chunks_;
+    size_t allocated_chunks_ = 0;
+
+    mutable std::mutex error_mutex_;
+    std::string error_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> sink_failed_{false};
+    std::thread writer_thread_;
+
+    std::atomic<uint64_t> records_written_{0};
+    std::atomic<uint64_t> records_dropped_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+};
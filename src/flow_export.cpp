@@ -0,0 +1,471 @@
+/*
+ * flow_export.cpp - IPFIX / NetFlow v9 encoding and UDP export
+ *
+ * All message fields are big-endian. IPFIX data sets are not padded (RFC
+ * 7011 makes padding optional); NetFlow v9 FlowSets are padded to a 4-byte
+ * boundary as RFC 3954 recommends. A record is never split across
+ * messages, so each datagram is self-contained apart from templates.
+ */
+
+#include "flow_export.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint16_t IPFIX_VERSION = 10;
+constexpr uint16_t NETFLOW_V9_VERSION = 9;
+constexpr uint16_t IPFIX_TEMPLATE_SET = 2;
+constexpr uint16_t NETFLOW_V9_TEMPLATE_SET = 0;
+constexpr size_t SET_HEADER_BYTES = 4;
+
+struct FieldSpec {
+    uint16_t id;
+    uint16_t length;
+};
+
+// Information elements: IANA IPFIX registry / RFC 3954 field types
+constexpr FieldSpec IPFIX_FIELDS_V4[] = {
+    {8, 4},     // sourceIPv4Address
+    {12, 4},    // destinationIPv4Address
+    {7, 2},     // sourceTransportPort
+    {11, 2},    // destinationTransportPort
+    {4, 1},     // protocolIdentifier
+    {6, 2},     // tcpControlBits
+    {136, 1},   // flowEndReason
+    {1, 8},     // octetDeltaCount
+    {2, 8},     // packetDeltaCount
+    {152, 8},   // flowStartMilliseconds
+    {153, 8},   // flowEndMilliseconds
+};
+
+constexpr FieldSpec IPFIX_FIELDS_V6[] = {
+    {27, 16},   // sourceIPv6Address
+    {28, 16},   // destinationIPv6Address
+    {7, 2}, {11, 2}, {4, 1}, {6, 2}, {136, 1}, {1, 8}, {2, 8}, {152, 8}, {153, 8},
+};
+
+constexpr FieldSpec NETFLOW_V9_FIELDS_V4[] = {
+    {8, 4},     // IPV4_SRC_ADDR
+    {12, 4},    // IPV4_DST_ADDR
+    {7, 2},     // L4_SRC_PORT
+    {11, 2},    // L4_DST_PORT
+    {4, 1},     // PROTOCOL
+    {6, 1},     // TCP_FLAGS
+    {1, 8},     // IN_BYTES
+    {2, 8},     // IN_PKTS
+    {22, 4},    // FIRST_SWITCHED (sysUpTime ms)
+    {21, 4},    // LAST_SWITCHED
+};
+
+constexpr FieldSpec NETFLOW_V9_FIELDS_V6[] = {
+    {27, 16},   // IPV6_SRC_ADDR
+    {28, 16},   // IPV6_DST_ADDR
+    {7, 2}, {11, 2}, {4, 1}, {6, 1}, {1, 8}, {2, 8}, {22, 4}, {21, 4},
+};
+
+template <size_t N>
+constexpr size_t record_bytes(const FieldSpec (&fields)[N]) {
+    size_t total = 0;
+    for (const auto& f : fields) total += f.length;
+    return total;
+}
+
+void append_be16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void append_be32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(v >> shift));
+    }
+}
+
+void append_be64(std::vector<uint8_t>& out, uint64_t v) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(v >> shift));
+    }
+}
+
+void patch_be16(std::vector<uint8_t>& out, size_t pos, uint16_t v) {
+    out[pos] = static_cast<uint8_t>(v >> 8);
+    out[pos + 1] = static_cast<uint8_t>(v);
+}
+
+void patch_be32(std::vector<uint8_t>& out, size_t pos, uint32_t v) {
+    out[pos] = static_cast<uint8_t>(v >> 24);
+    out[pos + 1] = static_cast<uint8_t>(v >> 16);
+    out[pos + 2] = static_cast<uint8_t>(v >> 8);
+    out[pos + 3] = static_cast<uint8_t>(v);
+}
+
+template <size_t N>
+void append_template(std::vector<uint8_t>& out, uint16_t id, const FieldSpec (&fields)[N]) {
+    append_be16(out, id);
+    append_be16(out, static_cast<uint16_t>(N));
+    for (const auto& f : fields) {
+        append_be16(out, f.id);
+        append_be16(out, f.length);
+    }
+}
+
+uint64_t epoch_ms(std::chrono::system_clock::time_point tp) {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+    return ms < 0 ? 0 : static_cast<uint64_t>(ms);
+}
+
+// RFC 5102 flowEndReason values
+uint8_t ipfix_end_reason(FlowEndReason reason) {
+    switch (reason) {
+        case FlowEndReason::IDLE_TIMEOUT:   return 1;
+        case FlowEndReason::ACTIVE_TIMEOUT: return 2;
+        case FlowEndReason::END_OF_FLOW:    return 3;
+        case FlowEndReason::FORCED:         return 4;
+    }
+    return 4;
+}
+
+}  // namespace
+
+// =============================================================================
+// FlowMessageEncoder
+// =============================================================================
+
+FlowMessageEncoder::FlowMessageEncoder(FlowExportProtocol protocol, uint32_t domain_id,
+                                       size_t max_message_bytes)
+    : protocol_(protocol), domain_id_(domain_id), max_bytes_(max_message_bytes) {
+    buffer_.reserve(max_bytes_);
+}
+
+void FlowMessageEncoder::begin(uint32_t export_time_secs, uint32_t uptime_ms,
+                               bool include_templates) {
+    buffer_.clear();
+    set_start_ = 0;
+    set_template_ = 0;
+    data_records_ = 0;
+    template_records_ = 0;
+    has_templates_ = false;
+
+    // Length/count and sequence number are patched in finish()
+    if (protocol_ == FlowExportProtocol::IPFIX) {
+        append_be16(buffer_, IPFIX_VERSION);
+        append_be16(buffer_, 0);
+        append_be32(buffer_, export_time_secs);
+        append_be32(buffer_, 0);
+        append_be32(buffer_, domain_id_);
+    } else {
+        append_be16(buffer_, NETFLOW_V9_VERSION);
+        append_be16(buffer_, 0);
+        append_be32(buffer_, uptime_ms);
+        append_be32(buffer_, export_time_secs);
+        append_be32(buffer_, 0);
+        append_be32(buffer_, domain_id_);
+    }
+
+    if (include_templates) {
+        append_templates();
+    }
+}
+
+void FlowMessageEncoder::append_templates() {
+    size_t start = buffer_.size();
+    bool ipfix = protocol_ == FlowExportProtocol::IPFIX;
+
+    append_be16(buffer_, ipfix ? IPFIX_TEMPLATE_SET : NETFLOW_V9_TEMPLATE_SET);
+    append_be16(buffer_, 0);
+    if (ipfix) {
+        append_template(buffer_, FLOW_TEMPLATE_IPV4, IPFIX_FIELDS_V4);
+        append_template(buffer_, FLOW_TEMPLATE_IPV6, IPFIX_FIELDS_V6);
+    } else {
+        append_template(buffer_, FLOW_TEMPLATE_IPV4, NETFLOW_V9_FIELDS_V4);
+        append_template(buffer_, FLOW_TEMPLATE_IPV6, NETFLOW_V9_FIELDS_V6);
+    }
+    patch_be16(buffer_, start + 2, static_cast<uint16_t>(buffer_.size() - start));
+
+    template_records_ = 2;
+    has_templates_ = true;
+}
+
+void FlowMessageEncoder::close_set() {
+    if (set_start_ == 0) {
+        return;
+    }
+
+    if (protocol_ == FlowExportProtocol::NETFLOW_V9) {
+        while ((buffer_.size() - set_start_) % 4 != 0) {
+            buffer_.push_back(0);
+        }
+    }
+    patch_be16(buffer_, set_start_ + 2, static_cast<uint16_t>(buffer_.size() - set_start_));
+    set_start_ = 0;
+}
+
+bool FlowMessageEncoder::add(const FlowRecord& flow, FlowEndReason reason, uint64_t boot_ms) {
+    bool ipv6 = flow.key.ip_version == 6;
+    bool ipfix = protocol_ == FlowExportProtocol::IPFIX;
+    uint16_t template_id = ipv6 ? FLOW_TEMPLATE_IPV6 : FLOW_TEMPLATE_IPV4;
+
+    size_t needed = ipfix ? (ipv6 ? record_bytes(IPFIX_FIELDS_V6) : record_bytes(IPFIX_FIELDS_V4))
+                          : (ipv6 ? record_bytes(NETFLOW_V9_FIELDS_V6)
+                                  : record_bytes(NETFLOW_V9_FIELDS_V4));
+    bool new_set = set_start_ == 0 || set_template_ != template_id;
+    if (new_set) {
+        needed += SET_HEADER_BYTES + (ipfix ? 0 : 3);  // Worst-case v9 padding of the old set
+    }
+    if (buffer_.size() + needed > max_bytes_) {
+        return false;
+    }
+
+    if (new_set) {
+        close_set();
+        set_start_ = buffer_.size();
+        set_template_ = template_id;
+        append_be16(buffer_, template_id);
+        append_be16(buffer_, 0);
+    }
+
+    size_t addr_len = ipv6 ? 16 : 4;
+    buffer_.insert(buffer_.end(), flow.key.src_addr.begin(), flow.key.src_addr.begin() + addr_len);
+    buffer_.insert(buffer_.end(), flow.key.dst_addr.begin(), flow.key.dst_addr.begin() + addr_len);
+    append_be16(buffer_, flow.key.src_port);
+    append_be16(buffer_, flow.key.dst_port);
+    buffer_.push_back(flow.key.protocol);
+
+    uint64_t first_ms = epoch_ms(flow.first_seen);
+    uint64_t last_ms = epoch_ms(flow.last_seen);
+    if (ipfix) {
+        append_be16(buffer_, flow.tcp_flags);
+        buffer_.push_back(ipfix_end_reason(reason));
+        append_be64(buffer_, flow.bytes);
+        append_be64(buffer_, flow.packets);
+        append_be64(buffer_, first_ms);
+        append_be64(buffer_, last_ms);
+    } else {
+        // sysUpTime-relative; flows older than the exporter clamp to 0
+        buffer_.push_back(flow.tcp_flags);
+        append_be64(buffer_, flow.bytes);
+        append_be64(buffer_, flow.packets);
+        append_be32(buffer_, static_cast<uint32_t>(first_ms > boot_ms ? first_ms - boot_ms : 0));
+        append_be32(buffer_, static_cast<uint32_t>(last_ms > boot_ms ? last_ms - boot_ms : 0));
+    }
+
+    data_records_++;
+    return true;
+}
+
+const std::vector<uint8_t>& FlowMessageEncoder::finish() {
+    close_set();
+
+    if (protocol_ == FlowExportProtocol::IPFIX) {
+        patch_be16(buffer_, 2, static_cast<uint16_t>(buffer_.size()));
+        patch_be32(buffer_, 8, sequence_);
+        sequence_ += static_cast<uint32_t>(data_records_);
+    } else {
+        patch_be16(buffer_, 2, static_cast<uint16_t>(template_records_ + data_records_));
+        patch_be32(buffer_, 12, sequence_);
+        sequence_++;
+    }
+
+    return buffer_;
+}
+
+// =============================================================================
+// FlowExporter
+// =============================================================================
+
+FlowExporter::~FlowExporter() {
+    stop();
+}
+
+bool FlowExporter::parse_collector(const std::string& text, std::string& host, uint16_t& port) {
+    size_t colon;
+    if (!text.empty() && text[0] == '[') {
+        size_t close = text.find(']');
+        if (close == std::string::npos || close + 1 >= text.size() || text[close + 1] != ':') {
+            return false;
+        }
+        host = text.substr(1, close - 1);
+        colon = close + 1;
+    } else {
+        colon = text.rfind(':');
+        if (colon == std::string::npos || text.find(':') != colon) {
+            return false;
+        }
+        host = text.substr(0, colon);
+    }
+
+    std::string port_text = text.substr(colon + 1);
+    if (host.empty() || port_text.empty() || port_text.size() > 5) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (char c : port_text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    if (value == 0 || value > 65535) {
+        return false;
+    }
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+bool FlowExporter::start(const FlowExportConfig& config) {
+    if (fd_ >= 0) {
+        return true;
+    }
+
+    config_ = config;
+    error_.clear();
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(config_.collector_port);
+    int rc = getaddrinfo(config_.collector_host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        error_ = "Cannot resolve collector " + config_.collector_host + ": " + gai_strerror(rc);
+        return false;
+    }
+
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        ai->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            fd_ = fd;
+            break;
+        }
+        ::close(fd);
+    }
+    freeaddrinfo(result);
+
+    if (fd_ < 0) {
+        error_ = "Cannot connect to collector " + config_.collector_host + ": " + strerror(errno);
+        return false;
+    }
+
+    flows_ = FlowTable(config_.max_flows);
+    encoder_ = FlowMessageEncoder(config_.protocol, config_.domain_id, config_.max_message_bytes);
+    message_open_ = false;
+    started_ = std::chrono::steady_clock::now();
+    boot_ms_ = epoch_ms(std::chrono::system_clock::now());
+    last_template_ = {};
+    messages_since_template_ = 0;
+    last_expire_ = {};
+    last_packet_time_ = {};
+    return true;
+}
+
+void FlowExporter::stop() {
+    if (fd_ < 0) {
+        return;
+    }
+
+    flows_.drain([this](const FlowRecord& flow, FlowEndReason reason) {
+        export_flow(flow, reason);
+    });
+    if (message_open_ && encoder_.record_count() > 0) {
+        send_message();
+    }
+    message_open_ = false;
+
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void FlowExporter::on_packet(const PacketInfo& pkt) {
+    if (fd_ < 0) {
+        return;
+    }
+
+    last_packet_time_ = pkt.timestamp;
+    last_packet_seen_ = std::chrono::steady_clock::now();
+
+    // Expiry runs from tick(), off the per-packet path
+    flows_.update(pkt);
+}
+
+void FlowExporter::tick() {
+    if (fd_ < 0 || flows_.size() == 0) {
+        return;
+    }
+
+    // Advance capture time by however long the link has been quiet
+    auto capture_now = last_packet_time_ +
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::steady_clock::now() - last_packet_seen_);
+    if (capture_now - last_expire_ >= std::chrono::seconds(1)) {
+        expire(capture_now);
+    }
+}
+
+void FlowExporter::expire(std::chrono::system_clock::time_point now) {
+    last_expire_ = now;
+    flows_.expire(now, config_.idle_timeout, config_.active_timeout,
+                  [this](const FlowRecord& flow, FlowEndReason reason) {
+                      export_flow(flow, reason);
+                  });
+
+    // Don't hold a partly filled message across expiry rounds
+    if (message_open_ && encoder_.record_count() > 0) {
+        send_message();
+    }
+}
+
+void FlowExporter::begin_message() {
+    auto now = std::chrono::steady_clock::now();
+    bool templates = last_template_ == std::chrono::steady_clock::time_point{} ||
+                     now - last_template_ >= std::chrono::seconds(config_.template_refresh_seconds) ||
+                     messages_since_template_ >= config_.template_refresh_messages;
+    if (templates) {
+        last_template_ = now;
+        messages_since_template_ = 0;
+    }
+
+    auto uptime = std::chrono::duration_cast<std::chrono::milliseconds>(now - started_).count();
+    auto export_secs = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    encoder_.begin(static_cast<uint32_t>(export_secs), static_cast<uint32_t>(uptime), templates);
+    message_open_ = true;
+}
+
+void FlowExporter::export_flow(const FlowRecord& flow, FlowEndReason reason) {
+    if (!message_open_) {
+        begin_message();
+    }
+    if (!encoder_.add(flow, reason, boot_ms_)) {
+        send_message();
+        begin_message();
+        encoder_.add(flow, reason, boot_ms_);
+    }
+    flows_exported_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FlowExporter::send_message() {
+    const auto& message = encoder_.finish();
+    bool carried_templates = encoder_.has_templates();
+    message_open_ = false;
+    messages_since_template_++;
+
+    ssize_t n;
+    do {
+        n = ::send(fd_, message.data(), message.size(), 0);
+    } while (n < 0 && errno == EINTR);
+
+    // EAGAIN (socket buffer full) or ECONNREFUSED (no collector yet): drop it
+    if (n < 0) {
+        messages_dropped_.fetch_add(1, std::memory_order_relaxed);
+        if (carried_templates) {
+            last_template_ = {};  // Resend with the next message
+        }
+    } else {
+        messages_sent_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * flow_export.hpp - IPFIX / NetFlow v9 flow export over UDP
+ *
+ * Aggregates packets into unidirectional 5-tuple flows (FlowTable) and,
+ * when a flow ends or hits its active/idle timeout, encodes it as an
+ * IPFIX (RFC 7011) or NetFlow v9 (RFC 3954) data record. Records are
+ * batched into messages no larger than max_message_bytes and sent to a
+ * single collector over UDP.
+ *
+ * Two templates are used, one for IPv4 flows (id 256) and one for IPv6
+ * (id 257). As UDP is unreliable, templates are sent in the first message
+ * and then again every template_refresh_seconds or template_refresh_messages,
+ * whichever comes first. Sequence numbers follow each RFC: IPFIX counts
+ * data records sent before the message, NetFlow v9 counts export packets.
+ *
+ * on_packet() and tick() run on the capture thread. Sends are non-blocking;
+ * a full socket buffer drops the message and counts it.
+ */
+
+#pragma once
+
+#include "flow_table.hpp"
+#include "packet.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class FlowExportProtocol { IPFIX, NETFLOW_V9 };
+
+struct FlowExportConfig {
+    std::string collector_host = "127.0.0.1";
+    uint16_t collector_port = 4739;              // IANA IPFIX port
+    FlowExportProtocol protocol = FlowExportProtocol::IPFIX;
+    uint32_t domain_id = 1;                      // Observation domain / source id
+    std::chrono::seconds active_timeout{60};
+    std::chrono::seconds idle_timeout{15};
+    uint32_t template_refresh_seconds = 60;
+    uint32_t template_refresh_messages = 100;
+    size_t max_message_bytes = 1400;             // Stay under a typical path MTU
+    size_t max_flows = 1u << 20;
+};
+
+// Template ids used for both protocols
+constexpr uint16_t FLOW_TEMPLATE_IPV4 = 256;
+constexpr uint16_t FLOW_TEMPLATE_IPV6 = 257;
+
+// Builds one export message at a time. Pure encoding, no I/O.
+class FlowMessageEncoder {
+public:
+    FlowMessageEncoder(FlowExportProtocol protocol, uint32_t domain_id, size_t max_message_bytes);
+
+    // Start a message. uptime_ms is the NetFlow v9 sysUpTime.
+    void begin(uint32_t export_time_secs, uint32_t uptime_ms, bool include_templates);
+
+    // Append a data record; returns false (and appends nothing) if it doesn't fit.
+    // boot_ms is the epoch time, in ms, that v9 FIRST/LAST_SWITCHED are relative to.
+    bool add(const FlowRecord& flow, FlowEndReason reason, uint64_t boot_ms);
+
+    // Patch lengths, counts and sequence number; returns the finished message
+    const std::vector<uint8_t>& finish();
+
+    size_t record_count() const { return data_records_; }
+    bool has_templates() const { return has_templates_; }
+
+    uint32_t sequence() const { return sequence_; }
+
+private:
+    void append_templates();
+    void close_set();
+
+    FlowExportProtocol protocol_;
+    uint32_t domain_id_;
+    size_t max_bytes_;
+
+    std::vector<uint8_t> buffer_;
+    size_t set_start_ = 0;          // Offset of the open data set, or 0
+    uint16_t set_template_ = 0;
+    size_t data_records_ = 0;
+    size_t template_records_ = 0;
+    bool has_templates_ = false;
+
+    // IPFIX: data records sent so far; v9: packets sent so far
+    uint32_t sequence_ = 0;
+};
+
+class FlowExporter {
+public:
+    FlowExporter() = default;
+    ~FlowExporter();
+
+    // Non-copyable
+    FlowExporter(const FlowExporter&) = delete;
+    FlowExporter& operator=(const FlowExporter&) = delete;
+
+    // Resolve the collector and open the UDP socket
+    bool start(const FlowExportConfig& config);
+
+    // Expire every remaining flow, send, close the socket
+    void stop();
+
+    // Capture thread. Flows expire only from tick(), at most once a
+    // second of capture time, so call it regularly.
+    void on_packet(const PacketInfo& pkt);
+    void tick();
+
+    bool is_running() const { return fd_ >= 0; }
+    std::string get_error() const { return error_; }
+
+    // Counters (readable from any thread)
+    uint64_t flows_exported() const { return flows_exported_.load(); }
+    uint64_t messages_sent() const { return messages_sent_.load(); }
+    uint64_t messages_dropped() const { return messages_dropped_.load(); }
+
+    // Parse "HOST:PORT" or "[V6ADDR]:PORT"
+    static bool parse_collector(const std::string& text, std::string& host, uint16_t& port);
+
+private:
+    void export_flow(const FlowRecord& flow, FlowEndReason reason);
+    void expire(std::chrono::system_clock::time_point now);
+    void begin_message();
+    void send_message();
+
+    FlowExportConfig config_;
+    int fd_ = -1;
+    std::string error_;
+
+    FlowTable flows_;
+    FlowMessageEncoder encoder_{FlowExportProtocol::IPFIX, 1, 1400};
+    bool message_open_ = false;
+
+    std::chrono::steady_clock::time_point started_{};
+    uint64_t boot_ms_ = 0;  // Wall clock at start, for v9 uptime
+    std::chrono::steady_clock::time_point last_template_{};
+    uint32_t messages_since_template_ = 0;
+
+    std::chrono::system_clock::time_point last_expire_{};
+    std::chrono::system_clock::time_point last_packet_time_{};
+    std::chrono::steady_clock::time_point last_packet_seen_{};
+
+    std::atomic<uint64_t> flows_exported_{0};
+    std::atomic<uint64_t> messages_sent_{0};
+    std::atomic<uint64_t> messages_dropped_{0};
+};
@@ -0,0 +1,158 @@
+/*
+ * flow_table.cpp - Flow aggregation implementation
+ *
+ * The key hash is FNV-1a over the packed key fields; it only needs to
+ * spread flows across unordered_map buckets, not resist adversaries
+ * beyond the table's size cap.
+ */
+
+#include "flow_table.hpp"
+#include <cstring>
+#include <utility>
+
+FlowKey FlowKey::from_packet(const PacketInfo& pkt) {
+    FlowKey key;
+    key.ip_version = pkt.ip_version;
+    key.protocol = pkt.protocol;
+    key.src_port = pkt.src_port;
+    key.dst_port = pkt.dst_port;
+    key.src_addr = pkt.src_addr;
+    key.dst_addr = pkt.dst_addr;
+    return key;
+}
+
+FlowKey FlowKey::canonical(const PacketInfo& pkt, bool& swapped) {
+    FlowKey key = from_packet(pkt);
+    size_t addr_len = pkt.ip_version == 4 ? 4 : 16;
+    int cmp = std::memcmp(key.src_addr.data(), key.dst_addr.data(), addr_len);
+    swapped = cmp > 0 || (cmp == 0 && key.src_port > key.dst_port);
+    if (swapped) {
+        std::swap(key.src_addr, key.dst_addr);
+        std::swap(key.src_port, key.dst_port);
+    }
+    return key;
+}
+
+size_t FlowKeyHash::operator()(const FlowKey& key) const {
+    uint8_t header[6] = {
+        key.ip_version, key.protocol,
+        static_cast<uint8_t>(key.src_port >> 8), static_cast<uint8_t>(key.src_port),
+        static_cast<uint8_t>(key.dst_port >> 8), static_cast<uint8_t>(key.dst_port)
+    };
+    uint64_t hash = fnv1a(FNV1A_OFFSET, header, sizeof(header));
+
+    // IPv4 addresses only occupy the first 4 bytes
+    size_t addr_len = key.ip_version == 4 ? 4 : 16;
+    hash = fnv1a(hash, key.src_addr.data(), addr_len);
+    hash = fnv1a(hash, key.dst_addr.data(), addr_len);
+
+    return static_cast<size_t>(hash);
+}
+
+FlowTable::FlowTable(size_t max_flows) : max_flows_(max_flows) {
+    flows_.reserve(max_flows_ < 4096 ? max_flows_ : 4096);
+}
+
+bool FlowTable::update(const PacketInfo& pkt) {
+    if (pkt.ip_version != 4 && pkt.ip_version != 6) {
+        return false;
+    }
+
+    FlowKey key = FlowKey::from_packet(pkt);
+    auto it = flows_.find(key);
+
+    if (it == flows_.end()) {
+        if (flows_.size() >= max_flows_) {
+            overflow_++;
+            return false;
+        }
+
+        Entry entry;
+        entry.record.key = key;
+        entry.record.src_ip = pkt.src_ip;
+        entry.record.dst_ip = pkt.dst_ip;
+        entry.record.first_seen = pkt.timestamp;
+        it = flows_.emplace(key, std::move(entry)).first;
+        Node* node = &*it;
+        it->second.by_last = by_last_.insert(by_last_.end(), node);
+        it->second.by_first = by_first_.insert(by_first_.end(), node);
+    } else {
+        by_last_.splice(by_last_.end(), by_last_, it->second.by_last);
+    }
+
+    FlowRecord& flow = it->second.record;
+    if (key.protocol == PROTO_TCP && (pkt.tcp_flags & (TCP_FIN | TCP_RST)) &&
+        !(flow.tcp_flags & (TCP_FIN | TCP_RST))) {
+        ended_.push_back(key);
+    }
+    flow.last_seen = pkt.timestamp;
+    flow.packets++;
+    flow.bytes += pkt.original_length;
+    flow.tcp_flags |= pkt.tcp_flags;
+
+    if (flow.hostname.empty() && !pkt.hostname.empty()) {
+        flow.hostname = pkt.hostname;
+    }
+    if (flow.app_protocol.empty() && !pkt.app_protocol.empty()) {
+        flow.app_protocol = pkt.app_protocol;
+    }
+    if (!flow.tls_fingerprint && pkt.tls_fingerprint) {
+        flow.tls_fingerprint = pkt.tls_fingerprint;
+    }
+
+    return true;
+}
+
+size_t FlowTable::expire(std::chrono::system_clock::time_point now,
+                         std::chrono::seconds idle_timeout,
+                         std::chrono::seconds active_timeout,
+                         const ExpireCallback& callback) {
+    size_t expired = 0;
+
+    // Finished TCP flows (a queued key may since have expired otherwise)
+    for (const FlowKey& key : ended_) {
+        auto it = flows_.find(key);
+        if (it != flows_.end()) {
+            remove(&*it, FlowEndReason::END_OF_FLOW, callback);
+            expired++;
+        }
+    }
+    ended_.clear();
+
+    // Both lists are in time order, so stop at the first flow still current
+    while (!by_last_.empty() && now - by_last_.front()->second.record.last_seen >= idle_timeout) {
+        remove(by_last_.front(), FlowEndReason::IDLE_TIMEOUT, callback);
+        expired++;
+    }
+    while (!by_first_.empty() &&
+           now - by_first_.front()->second.record.first_seen >= active_timeout) {
+        remove(by_first_.front(), FlowEndReason::ACTIVE_TIMEOUT, callback);
+        expired++;
+    }
+
+    return expired;
+}
+
+void FlowTable::remove(Node* node, FlowEndReason reason, const ExpireCallback& callback) {
+    callback(node->second.record, reason);
+    by_last_.erase(node->second.by_last);
+    by_first_.erase(node->second.by_first);
+    flows_.erase(node->first);
+}
+
+size_t FlowTable::drain(const ExpireCallback& callback) {
+    size_t count = flows_.size();
+    for (const auto& [key, entry] : flows_) {
+        callback(entry.record, FlowEndReason::FORCED);
+    }
+    flows_.clear();
+    by_last_.clear();
+    by_first_.clear();
+    ended_.clear();
+    return count;
+}
+
+const FlowRecord* FlowTable::find(const FlowKey& key) const {
+    auto it = flows_.find(key);
+    return it == flows_.end() ? nullptr : &it->second.record;
+}
@@ -0,0 +1,127 @@
+/*
+ * flow_table.hpp - Unidirectional 5-tuple flow aggregation
+ *
+ * Aggregates packets into flows keyed by (IP version, protocol, source
+ * and destination address, source and destination port), in the same
+ * unidirectional sense as NetFlow/IPFIX. Each flow tracks first/last
+ * seen, packet and byte counts, OR-ed TCP flags, the first hostname
+ * seen on it and the TLS client fingerprint of its ClientHello.
+ *
+ * Flows leave the table through expire() (idle and active timeouts) or
+ * drain(), which hand each finished FlowRecord to a callback. Flows are
+ * also kept in two lists, by last packet and by creation, and finished TCP
+ * flows are queued as their FIN or RST arrives, so expire() only touches
+ * the flows it removes, however large the table. (Packets are assumed to
+ * arrive in timestamp order; a slightly reordered one at worst delays a
+ * flow's expiry by the reordering.) The table is bounded; when full, new
+ * flows are counted as overflow and ignored. Not thread-safe: owned by
+ * whichever thread feeds it.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FlowKey {
+    uint8_t ip_version = 0;
+    uint8_t protocol = 0;
+    uint16_t src_port = 0;
+    uint16_t dst_port = 0;
+    std::array<uint8_t, 16> src_addr{};
+    std::array<uint8_t, 16> dst_addr{};
+
+    static FlowKey from_packet(const PacketInfo& pkt);
+    // Key shared by both directions of a connection: the lower address
+    // (then port) is the source. swapped is set when pkt runs the other way.
+    static FlowKey canonical(const PacketInfo& pkt, bool& swapped);
+    bool operator==(const FlowKey& other) const = default;
+};
+
+// FNV-1a, shared by the hash tables keyed on addresses: fold len bytes
+// into hash, starting from FNV1A_OFFSET
+constexpr uint64_t FNV1A_OFFSET = 0xcbf29ce484222325ULL;
+
+inline uint64_t fnv1a(uint64_t hash, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+struct FlowKeyHash {
+    size_t operator()(const FlowKey& key) const;
+};
+
+struct FlowRecord {
+    FlowKey key;
+    std::string src_ip;
+    std::string dst_ip;
+    std::chrono::system_clock::time_point first_seen;
+    std::chrono::system_clock::time_point last_seen;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint8_t tcp_flags = 0;        // OR of all flags seen
+    std::string hostname;         // First hostname seen on the flow
+    std::string app_protocol;
+    TlsFingerprintRef tls_fingerprint;  // JA3/JA4, client-to-server flows only
+};
+
+// Why a flow left the table
+enum class FlowEndReason { IDLE_TIMEOUT, ACTIVE_TIMEOUT, END_OF_FLOW, FORCED };
+
+class FlowTable {
+public:
+    using ExpireCallback = std::function<void(const FlowRecord&, FlowEndReason)>;
+
+    explicit FlowTable(size_t max_flows = 65536);
+
+    // Add a packet to its flow. Non-IP packets are ignored.
+    // Returns false if the packet was ignored or the table was full.
+    bool update(const PacketInfo& pkt);
+
+    // Expire flows idle for longer than idle_timeout, or active for longer
+    // than active_timeout (long-lived flows are reported in pieces), and
+    // TCP flows that have seen FIN or RST.
+    size_t expire(std::chrono::system_clock::time_point now,
+                  std::chrono::seconds idle_timeout,
+                  std::chrono::seconds active_timeout,
+                  const ExpireCallback& callback);
+
+    // Expire every flow (shutdown)
+    size_t drain(const ExpireCallback& callback);
+
+    // Look up a flow without modifying it
+    const FlowRecord* find(const FlowKey& key) const;
+
+    size_t size() const { return flows_.size(); }
+    uint64_t overflow_count() const { return overflow_; }
+
+private:
+    struct Entry;
+    using FlowMap = std::unordered_map<FlowKey, Entry, FlowKeyHash>;
+    using Node = FlowMap::value_type;   // Stable across rehashing
+
+    struct Entry {
+        FlowRecord record;
+        std::list<Node*>::iterator by_last;
+        std::list<Node*>::iterator by_first;
+    };
+
+    void remove(Node* node, FlowEndReason reason, const ExpireCallback& callback);
+
+    size_t max_flows_;
+    FlowMap flows_;
+    std::list<Node*> by_last_;     // Front saw its last packet longest ago
+    std::list<Node*> by_first_;    // Front is the oldest flow
+    std::vector<FlowKey> ended_;   // TCP flows that have seen FIN or RST
+    uint64_t overflow_ = 0;
+};
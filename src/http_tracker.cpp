@@ -0,0 +1,222 @@
+/*
+ * http_tracker.cpp - HTTP/1.x transaction tracking implementation
+ */
+
+#include "http_tracker.hpp"
+#include <algorithm>
+
+namespace {
+
+int64_t to_us(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+}
+
+void add_response(HttpHostStats& stats, uint16_t status, int64_t content_length, uint64_t ns) {
+    stats.responses++;
+    if (status >= 100 && status < 600) {
+        stats.status[status / 100 - 1]++;
+    }
+    stats.body_bytes += static_cast<uint64_t>(std::max<int64_t>(content_length, 0));
+    stats.ttfb.add(ns);
+}
+
+}  // namespace
+
+HttpTracker::HttpTracker(const HttpTrackerConfig& config) : config_(config) {
+    hosts_.set_capacity(config.max_hosts);
+    flows_.reserve(std::min<size_t>(config.max_flows, 4096));
+}
+
+void HttpTracker::on_packet(PacketInfo& info) {
+    if (config_.max_flows == 0 || info.protocol != PROTO_TCP || info.is_fragment() ||
+        info.reassembled_length != 0) {
+        return;
+    }
+    bool closing = info.tcp_flags & (TCP_FIN | TCP_RST);
+    size_t len = info.payload_length;
+    if (len == 0 && !closing) {
+        return;
+    }
+
+    bool swapped = false;
+    FlowKey key = FlowKey::canonical(info, swapped);
+    int64_t now_us = to_us(info.timestamp);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire(now_us);
+
+    auto it = flows_.find(key);
+    if (it == flows_.end()) {
+        // Only a segment starting with a request or status line opens one
+        if (len == 0 || info.app_protocol != "HTTP") {
+            return;
+        }
+        if (flows_.size() >= config_.max_flows) {
+            overflows_++;
+            return;
+        }
+        it = flows_.emplace(key, Flow()).first;
+        it->second.age = ages_.insert(ages_.end(), &*it);
+    }
+
+    Flow& flow = it->second;
+    flow.last_us = now_us;
+    ages_.splice(ages_.end(), ages_, flow.age);
+    if (len > 0) {
+        on_segment(flow, swapped ? 1 : 0, info, info.raw_data.data() + info.payload_offset, len,
+                   now_us);
+    }
+
+    // A FIN may be a half-close with the response still to come
+    if ((info.tcp_flags & TCP_RST) || (closing && flow.pending == 0)) {
+        remove(it);
+    }
+}
+
+void HttpTracker::on_segment(Flow& flow, int dir, PacketInfo& info, const uint8_t* data,
+                             size_t len, int64_t now_us) {
+    Direction& self = flow.dir[dir];
+    uint32_t seq = info.tcp_seq;
+    size_t pos = 0;
+    bool expected = self.synced;   // A head should start at pos
+    if (self.synced) {
+        int32_t offset = static_cast<int32_t>(self.next_seq - seq);
+        if (offset < 0) {
+            lose_sync(self);   // The next head was not captured
+            expected = false;
+        } else if (static_cast<size_t>(offset) >= len) {
+            return;            // Body, or a retransmission of bytes already walked
+        } else {
+            pos = static_cast<size_t>(offset);
+        }
+    }
+
+    // Walk every head that starts in this segment
+    while (pos < len) {
+        HttpHead head;
+        if (!parse_http_head(data + pos, len - pos, head)) {
+            if (expected) lose_sync(self);
+            self.synced = false;
+            return;
+        }
+        int64_t body;
+        if (head.response) {
+            body = on_response(flow, head, info, pos == 0, now_us);
+        } else {
+            on_request(flow, head, info, now_us);
+            body = head.chunked ? -1 : std::max<int64_t>(head.content_length, 0);
+        }
+        if (head.length == 0 || body < 0) {
+            lose_sync(self);
+            return;
+        }
+        pos += head.length + static_cast<size_t>(body);
+        expected = true;
+    }
+    self.next_seq = seq + static_cast<uint32_t>(pos);
+    self.synced = true;
+}
+
+void HttpTracker::on_request(Flow& flow, const HttpHead& head, const PacketInfo& info,
+                             int64_t now_us) {
+    std::string host = head.host.empty() ? info.dst_ip
+                                         : std::string(head.host.substr(0, head.host.find(':')));
+    total_.requests++;
+    hosts_.get(host).requests++;
+
+    if (flow.pending == PIPELINE_DEPTH) {
+        unanswered(flow);
+    }
+    Request& request = flow.queue[(flow.first + flow.pending) % PIPELINE_DEPTH];
+    request.sent_us = now_us;
+    request.head = head.head_request;
+    request.host = std::move(host);
+    flow.pending++;
+}
+
+int64_t HttpTracker::on_response(Flow& flow, const HttpHead& head, PacketInfo& info, bool first,
+                                 int64_t now_us) {
+    // 100 Continue and friends precede the real response
+    bool interim = head.status >= 100 && head.status < 200 && head.status != 101;
+    bool head_request = false;
+    if (interim) {
+        // Not a response to any request
+    } else if (flow.pending == 0) {
+        unmatched_++;
+    } else {
+        Request& request = flow.queue[flow.first];
+        uint32_t ttfb_us = static_cast<uint32_t>(
+            std::clamp<int64_t>(now_us - request.sent_us, 0, UINT32_MAX));
+        uint64_t ns = static_cast<uint64_t>(ttfb_us) * 1000;
+        add_response(total_, head.status, head.content_length, ns);
+        add_response(hosts_.get(request.host), head.status, head.content_length, ns);
+        if (first) {
+            info.http_ttfb_us = ttfb_us;
+        }
+        head_request = request.head;
+        flow.first = static_cast<uint8_t>((flow.first + 1) % PIPELINE_DEPTH);
+        flow.pending--;
+    }
+
+    if (interim || head.status == 204 || head.status == 304 || head_request) {
+        return 0;
+    }
+    // Chunked and close-delimited bodies are not followed
+    return head.chunked ? -1 : head.content_length;
+}
+
+void HttpTracker::lose_sync(Direction& dir) {
+    lost_sync_++;
+    dir.synced = false;
+}
+
+void HttpTracker::unanswered(Flow& flow) {
+    Request& request = flow.queue[flow.first];
+    total_.unanswered++;
+    hosts_.get(request.host).unanswered++;
+    flow.first = static_cast<uint8_t>((flow.first + 1) % PIPELINE_DEPTH);
+    flow.pending--;
+}
+
+void HttpTracker::expire(int64_t now_us) {
+    // Amortised O(1): each connection is removed at most once
+    int64_t timeout_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        config_.timeout).count();
+    while (!ages_.empty() && now_us - ages_.front()->second.last_us > timeout_us) {
+        remove(flows_.find(ages_.front()->first));
+    }
+}
+
+// Requests still outstanding when a connection ends go unanswered
+void HttpTracker::remove(FlowMap::iterator it) {
+    while (it->second.pending > 0) {
+        unanswered(it->second);
+    }
+    ages_.erase(it->second.age);
+    flows_.erase(it);
+}
+
+HttpTrackerSnapshot HttpTracker::snapshot(size_t top, HttpOrder order) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    HttpTrackerSnapshot snap;
+    snap.total = total_;
+    snap.connections = flows_.size();
+    snap.overflows = overflows_;
+    snap.unmatched = unmatched_;
+    snap.lost_sync = lost_sync_;
+
+    auto winners = top_ranked(
+        hosts_, top,
+        [order](const HttpHostStats& stats) -> uint64_t {
+            if (order == HttpOrder::BUSIEST) return stats.requests;
+            if (order == HttpOrder::SLOWEST) return stats.ttfb.percentile(0.99);
+            return stats.errors();
+        },
+        [](const HttpHostStats& a, const HttpHostStats& b) { return a.host < b.host; });
+
+    snap.hosts.reserve(winners.size());
+    for (const HttpHostStats* stats : winners) {
+        snap.hosts.push_back(*stats);
+    }
+    return snap;
+}
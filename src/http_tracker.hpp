@@ -0,0 +1,138 @@
+/*
+ * http_tracker.hpp - HTTP/1.x transaction latency and status tracking
+ *
+ * Follows the message boundaries of both directions of each HTTP/1.x
+ * connection and matches every response to the oldest outstanding request,
+ * so pipelined requests are answered in order. The time from a request
+ * head to its response head (time to first byte, in packet time) goes into
+ * a histogram, and responses are counted by status class, for the whole
+ * capture and per Host.
+ *
+ * Nothing is buffered: a direction remembers only the sequence number
+ * where its next message head starts, found from the head's length plus
+ * its Content-Length. Several heads in one segment are walked in turn. A
+ * head split across segments, a chunked or close-delimited body, or a gap
+ * in the capture loses the boundary; the direction then waits for a
+ * segment that starts with a request or status line. Each connection holds
+ * at most PIPELINE_DEPTH outstanding requests; older ones are pushed out
+ * and count as unanswered, as do requests outstanding when the connection
+ * closes or goes idle past the timeout.
+ *
+ * The connection table and the host table are bounded. New connections
+ * are dropped and counted when the table is full; hosts are dropped least
+ * recently seen first. Connections sit in a list ordered by their last
+ * segment, so idle ones are expired from its front in amortised O(1). One mutex guards everything; the pipeline thread
+ * writes and the HTTP panel takes snapshots.
+ */
+
+#pragma once
+
+#include "flow_table.hpp"
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include "stats_table.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct HttpTrackerConfig {
+    size_t max_flows = 16384;                // Connections followed; 0 disables tracking
+    size_t max_hosts = 256;
+    std::chrono::seconds timeout{30};        // Idle connections are dropped after this
+};
+
+struct HttpHostStats {
+    std::string host;             // Host header, or the server address without one
+    uint64_t requests = 0;
+    uint64_t responses = 0;       // Matched to a request
+    std::array<uint64_t, 5> status{};  // Responses by class: 1xx (101 only) to 5xx
+    uint64_t unanswered = 0;      // Pushed out, or pending when the connection ended
+    uint64_t body_bytes = 0;      // Content-Length of responses
+    HistogramSnapshot ttfb;       // Request head to response head
+
+    uint64_t errors() const { return status[3] + status[4]; }
+};
+
+enum class HttpOrder : uint8_t { BUSIEST, SLOWEST, ERRORS };
+
+struct HttpTrackerSnapshot {
+    HttpHostStats total;
+    std::vector<HttpHostStats> hosts;
+    uint64_t connections = 0;     // Currently followed
+    uint64_t overflows = 0;       // New connections dropped with the table full
+    uint64_t unmatched = 0;       // Responses with no outstanding request
+    uint64_t lost_sync = 0;       // Message boundaries lost (split head, chunked body, gap)
+};
+
+class HttpTracker {
+public:
+    static constexpr size_t PIPELINE_DEPTH = 8;
+
+    explicit HttpTracker(const HttpTrackerConfig& config = HttpTrackerConfig());
+
+    // Non-copyable (mutex)
+    HttpTracker(const HttpTracker&) = delete;
+    HttpTracker& operator=(const HttpTracker&) = delete;
+
+    // Feed a parsed packet; sets info.http_ttfb_us on a matched response.
+    // Anything but an unfragmented TCP segment is ignored.
+    void on_packet(PacketInfo& info);
+
+    // Totals plus the top hosts in the given order
+    HttpTrackerSnapshot snapshot(size_t top, HttpOrder order = HttpOrder::BUSIEST) const;
+
+private:
+    struct Request {
+        int64_t sent_us = 0;
+        bool head = false;        // HEAD: its response has no body
+        std::string host;
+    };
+
+    // One direction: where its next message head starts
+    struct Direction {
+        uint32_t next_seq = 0;
+        bool synced = false;
+    };
+
+    struct Flow;
+    using FlowMap = std::unordered_map<FlowKey, Flow, FlowKeyHash>;
+    using Node = FlowMap::value_type;   // Stable across rehashing
+
+    struct Flow {
+        std::array<Direction, 2> dir;        // Indexed like the canonical key
+        std::array<Request, PIPELINE_DEPTH> queue;
+        uint8_t first = 0;                   // Oldest outstanding request
+        uint8_t pending = 0;
+        int64_t last_us = 0;
+        std::list<Node*>::iterator age;      // In ages_
+    };
+
+    // Host statistics with least-recently-seen eviction
+    using Table = LruStatsTable<HttpHostStats, &HttpHostStats::host>;
+
+    void on_segment(Flow& flow, int dir, PacketInfo& info, const uint8_t* data, size_t len,
+                    int64_t now_us);
+    void on_request(Flow& flow, const HttpHead& head, const PacketInfo& info, int64_t now_us);
+    // Body bytes after the head, or -1 when its end cannot be known
+    int64_t on_response(Flow& flow, const HttpHead& head, PacketInfo& info, bool first,
+                        int64_t now_us);
+    void lose_sync(Direction& dir);
+    void unanswered(Flow& flow);
+    void expire(int64_t now_us);
+    void remove(FlowMap::iterator it);
+
+    HttpTrackerConfig config_;
+    mutable std::mutex mutex_;
+    FlowMap flows_;
+    std::list<Node*> ages_;       // Front saw its last segment longest ago
+    Table hosts_;
+    HttpHostStats total_;
+    uint64_t overflows_ = 0;
+    uint64_t unmatched_ = 0;
+    uint64_t lost_sync_ = 0;
+};
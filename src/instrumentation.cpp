@@ -0,0 +1,110 @@
+/*
+ * instrumentation.cpp - Lock-free latency histogram implementation
+ *
+ * Bucket layout: indices 0..15 hold values 0..15 exactly. Above that,
+ * each power of two [2^e, 2^(e+1)) is split into 16 equal sub-buckets
+ * selected by the four bits after the leading one.
+ */
+
+#include "instrumentation.hpp"
+#include <bit>
+#include <cmath>
+
+const char* stage_name(Stage stage) {
+    switch (stage) {
+        case Stage::PARSE: return "parse";
+        case Stage::CHECKSUM: return "checksum";
+        case Stage::REASSEMBLE: return "reassemble";
+        case Stage::TCP: return "tcp";
+        case Stage::HTTP: return "http";
+        case Stage::QUIC: return "quic";
+        case Stage::RESOLVE: return "resolve";
+        case Stage::WATCHLIST: return "watchlist";
+        case Stage::DETECT: return "detect";
+        case Stage::DESCRIBE: return "describe";
+        case Stage::PROCESS: return "process";
+        case Stage::STORE: return "store";
+        case Stage::RENDER: return "render";
+        case Stage::COUNT: break;
+    }
+    return "unknown";
+}
+
+size_t HistogramSnapshot::bucket_index(uint64_t value_ns) {
+    if (value_ns < SUB_BUCKETS) {
+        return static_cast<size_t>(value_ns);
+    }
+
+    size_t exponent = 63 - static_cast<size_t>(std::countl_zero(value_ns));
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;  // Saturate
+    }
+
+    size_t sub = static_cast<size_t>(value_ns >> (exponent - 4)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+}
+
+uint64_t HistogramSnapshot::bucket_upper_bound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    size_t exponent = (index - SUB_BUCKETS) / SUB_BUCKETS + 4;
+    uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << (exponent - 4)) - 1;
+}
+
+uint64_t HistogramSnapshot::percentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    if (fraction <= 0.0) fraction = 0.0;
+    if (fraction >= 1.0) return max_ns;
+
+    // Rank of the sample we're after (1-based, rounded up)
+    uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count)));
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // Never report more than the true maximum
+            uint64_t bound = bucket_upper_bound(i);
+            return bound < max_ns ? bound : max_ns;
+        }
+    }
+
+    return max_ns;
+}
+
+void HistogramSnapshot::add(uint64_t value_ns) {
+    buckets[bucket_index(value_ns)]++;
+    count++;
+    sum_ns += value_ns;
+    max_ns = value_ns > max_ns ? value_ns : max_ns;
+}
+
+void LatencyHistogram::record(uint64_t value_ns) {
+    buckets_[HistogramSnapshot::bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(value_ns, std::memory_order_relaxed);
+
+    uint64_t current = max_ns_.load(std::memory_order_relaxed);
+    while (value_ns > current &&
+           !max_ns_.compare_exchange_weak(current, value_ns, std::memory_order_relaxed)) {
+        // current reloaded by compare_exchange_weak
+    }
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot snap;
+    for (size_t i = 0; i < HistogramSnapshot::BUCKET_COUNT; ++i) {
+        snap.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    snap.count = count_.load(std::memory_order_relaxed);
+    snap.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    snap.max_ns = max_ns_.load(std::memory_order_relaxed);
+    return snap;
+}
@@ -0,0 +1,111 @@
+/*
+ * instrumentation.hpp - Self-instrumentation for the packet pipeline
+ *
+ * LatencyHistogram is a lock-free, HDR-style log-linear histogram: values
+ * below 16ns get exact buckets, larger values get 16 sub-buckets per power
+ * of two (~6% relative error). Recording is a handful of relaxed atomic
+ * adds, so it can sit on the capture hot path.
+ *
+ * StageProfiler holds one histogram per pipeline stage and ScopedStageTimer
+ * times a block with steady_clock. Snapshots are plain copies that can be
+ * queried for percentiles by the diagnostics panel and the metrics export.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Pipeline stages that are timed
+enum class Stage : uint8_t {
+    PARSE, CHECKSUM, REASSEMBLE, TCP, HTTP, QUIC, RESOLVE, WATCHLIST, DETECT, DESCRIBE, PROCESS, STORE, RENDER, COUNT
+};
+
+constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::COUNT);
+
+const char* stage_name(Stage stage);
+
+// Point-in-time copy of a LatencyHistogram
+struct HistogramSnapshot {
+    static constexpr size_t SUB_BUCKETS = 16;
+    static constexpr size_t MAX_EXPONENT = 40;  // Values up to ~2^40 ns (~18 min)
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - 4) * SUB_BUCKETS;
+
+    std::array<uint64_t, BUCKET_COUNT> buckets{};
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+
+    // Value (ns) at or below which the given fraction (0..1) of samples fall
+    uint64_t percentile(double fraction) const;
+    double mean_ns() const { return count ? static_cast<double>(sum_ns) / count : 0.0; }
+
+    // Record into this copy directly, for single-writer users behind a lock
+    void add(uint64_t value_ns);
+
+    // Bucket mapping (exposed for tests)
+    static size_t bucket_index(uint64_t value_ns);
+    static uint64_t bucket_upper_bound(size_t index);
+};
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() = default;
+
+    // Non-copyable (atomics)
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t value_ns);
+    HistogramSnapshot snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, HistogramSnapshot::BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+class StageProfiler {
+public:
+    void record(Stage stage, uint64_t value_ns) {
+        histograms_[static_cast<size_t>(stage)].record(value_ns);
+    }
+
+    HistogramSnapshot snapshot(Stage stage) const {
+        return histograms_[static_cast<size_t>(stage)].snapshot();
+    }
+
+private:
+    std::array<LatencyHistogram, STAGE_COUNT> histograms_;
+};
+
+// Times the enclosing scope into a stage histogram. A null profiler
+// disables timing entirely (no clock reads).
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(StageProfiler* profiler, Stage stage)
+        : profiler_(profiler), stage_(stage) {
+        if (profiler_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedStageTimer() {
+        if (profiler_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            profiler_->record(stage_, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    StageProfiler* profiler_;
+    Stage stage_;
+    std::chrono::steady_clock::time_point start_{};
+};
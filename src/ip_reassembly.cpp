@@ -0,0 +1,220 @@
+/*
+ * ip_reassembly.cpp - IP fragment reassembly implementation
+ */
+
+#include "ip_reassembly.hpp"
+#include "flow_table.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t MAX_DATAGRAM = 65535;
+
+void put16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+}  // namespace
+
+size_t IpReassembler::KeyHash::operator()(const Key& key) const {
+    uint8_t header[6] = {
+        key.ip_version, key.protocol,
+        static_cast<uint8_t>(key.id >> 24), static_cast<uint8_t>(key.id >> 16),
+        static_cast<uint8_t>(key.id >> 8), static_cast<uint8_t>(key.id)
+    };
+    uint64_t hash = fnv1a(FNV1A_OFFSET, header, sizeof(header));
+    size_t addr_len = key.ip_version == 4 ? 4 : 16;
+    hash = fnv1a(hash, key.src_addr.data(), addr_len);
+    hash = fnv1a(hash, key.dst_addr.data(), addr_len);
+    return static_cast<size_t>(hash);
+}
+
+IpReassembler::IpReassembler(const FragmentConfig& config) : config_(config) {}
+
+void IpReassembler::on_packet(PacketInfo& info) {
+    if (config_.max_memory_bytes == 0 || !info.is_fragment() ||
+        (info.ip_version != 4 && info.ip_version != 6) ||
+        info.ip_payload_offset > info.raw_data.size()) {
+        return;
+    }
+    expire(info.timestamp);
+
+    const uint8_t* bytes = info.raw_data.data() + info.ip_payload_offset;
+    size_t len = std::min<size_t>(info.ip_payload_length,
+                                  info.raw_data.size() - info.ip_payload_offset);
+    uint32_t offset = info.fragment_offset;
+    if (len == 0 || offset + len > MAX_DATAGRAM) {
+        return;
+    }
+
+    Key key;
+    key.ip_version = info.ip_version;
+    key.protocol = info.protocol;
+    key.id = info.fragment_id;
+    key.src_addr = info.src_addr;
+    key.dst_addr = info.dst_addr;
+
+    auto it = datagrams_.find(key);
+    if (it == datagrams_.end()) {
+        if (datagrams_.size() >= config_.max_datagrams) {
+            erase(datagrams_.find(ages_.front()));
+            stats_.evicted++;
+        }
+        Datagram datagram;
+        datagram.first_seen = info.timestamp;
+        datagram.age = ages_.insert(ages_.end(), key);
+        it = datagrams_.emplace(key, std::move(datagram)).first;
+        stats_.datagrams = datagrams_.size();
+    }
+
+    Datagram& datagram = it->second;
+    size_t grow = offset + len > datagram.data.size() ? offset + len - datagram.data.size() : 0;
+    if (!make_room(grow, key)) {
+        erase(it);
+        stats_.evicted++;
+        return;
+    }
+    if (!add_fragment(datagram, offset, bytes, len, !info.more_fragments)) {
+        erase(it);
+        stats_.overlaps++;
+        return;
+    }
+
+    if (datagram.total != 0 && datagram.ranges.size() == 1 &&
+        datagram.ranges[0] == std::make_pair(0u, datagram.total)) {
+        complete(key, datagram, info);
+        erase(it);
+        stats_.reassembled++;
+    }
+}
+
+bool IpReassembler::add_fragment(Datagram& datagram, uint32_t offset, const uint8_t* data,
+                                 size_t len, bool last) {
+    uint32_t end = offset + static_cast<uint32_t>(len);
+    if (last) {
+        if (datagram.total != 0 && datagram.total != end) return false;
+        datagram.total = end;
+    }
+    if (datagram.total != 0 && end > datagram.total) {
+        return false;
+    }
+
+    // Exact duplicates are retransmissions; any other overlap is rejected
+    auto pos = datagram.ranges.begin();
+    for (; pos != datagram.ranges.end() && pos->first < end; ++pos) {
+        if (pos->first == offset && pos->second == end) return true;
+        if (offset < pos->second) return false;
+    }
+
+    if (datagram.data.size() < end) {
+        stats_.buffered_bytes += end - datagram.data.size();
+        datagram.data.resize(end);
+    }
+    std::memcpy(datagram.data.data() + offset, data, len);
+
+    // Insert and merge with touching neighbours
+    pos = datagram.ranges.insert(pos, {offset, end});
+    if (pos + 1 != datagram.ranges.end() && (pos + 1)->first == end) {
+        pos->second = (pos + 1)->second;
+        datagram.ranges.erase(pos + 1);
+    }
+    if (pos != datagram.ranges.begin() && (pos - 1)->second == offset) {
+        (pos - 1)->second = pos->second;
+        datagram.ranges.erase(pos);
+    }
+    return true;
+}
+
+void IpReassembler::complete(const Key& key, const Datagram& datagram, PacketInfo& info) {
+    // Ethernet and a fragment-free IP header in front of the whole payload
+    size_t ip_len = key.ip_version == 4 ? 20 : 40;
+    std::vector<uint8_t> frame(14 + ip_len + datagram.total, 0);
+    put16(frame.data() + 12, key.ip_version == 4 ? ETHERTYPE_IPV4 : ETHERTYPE_IPV6);
+    uint8_t* ip = frame.data() + 14;
+    if (key.ip_version == 4) {
+        ip[0] = 0x45;
+        put16(ip + 2, static_cast<uint16_t>(20 + datagram.total));
+        put16(ip + 4, static_cast<uint16_t>(key.id));
+        ip[8] = info.ttl;
+        ip[9] = key.protocol;
+        std::memcpy(ip + 12, key.src_addr.data(), 4);
+        std::memcpy(ip + 16, key.dst_addr.data(), 4);
+    } else {
+        ip[0] = 0x60;
+        put16(ip + 4, static_cast<uint16_t>(datagram.total));
+        ip[6] = key.protocol;
+        ip[7] = info.ttl;
+        std::memcpy(ip + 8, key.src_addr.data(), 16);
+        std::memcpy(ip + 24, key.dst_addr.data(), 16);
+    }
+    std::memcpy(ip + ip_len, datagram.data.data(), datagram.total);
+
+    PacketInfo whole = parse_packet(frame.data(), static_cast<uint32_t>(frame.size()),
+                                    static_cast<uint32_t>(frame.size()));
+    if (whole.tunnel.depth > 0) {
+        // A fragmented tunnel packet: report the inner packet like any other
+        info.tunnel = std::move(whole.tunnel);
+        info.ether_type = whole.ether_type;
+        info.ip_version = whole.ip_version;
+        info.src_ip = std::move(whole.src_ip);
+        info.dst_ip = std::move(whole.dst_ip);
+        info.src_addr = whole.src_addr;
+        info.dst_addr = whole.dst_addr;
+        info.ttl = whole.ttl;
+    }
+    info.protocol = whole.protocol;
+    info.src_port = whole.src_port;
+    info.dst_port = whole.dst_port;
+    info.tcp_flags = whole.tcp_flags;
+    info.tcp_seq = whole.tcp_seq;
+    info.tcp_ack = whole.tcp_ack;
+    info.tcp_window = whole.tcp_window;
+    info.hostname = std::move(whole.hostname);
+    info.app_protocol = std::move(whole.app_protocol);
+    info.app_info = std::move(whole.app_info);
+    info.user_agent = std::move(whole.user_agent);
+    info.content_type = std::move(whole.content_type);
+    info.dns_answers = std::move(whole.dns_answers);
+    info.tls_fingerprint = std::move(whole.tls_fingerprint);
+    info.reassembled_length = datagram.total;
+    info.payload_offset = 0;   // The payload is not in this frame's raw_data
+    info.payload_length = 0;
+}
+
+bool IpReassembler::make_room(size_t bytes, const Key& keep) {
+    auto victim = ages_.begin();
+    while (stats_.buffered_bytes + bytes > config_.max_memory_bytes) {
+        if (victim != ages_.end() && *victim == keep) {
+            ++victim;
+        }
+        if (victim == ages_.end()) {
+            return false;
+        }
+        auto next = std::next(victim);
+        erase(datagrams_.find(*victim));
+        stats_.evicted++;
+        victim = next;
+    }
+    return true;
+}
+
+void IpReassembler::expire(std::chrono::system_clock::time_point now) {
+    auto cutoff = now - config_.timeout;
+    while (!ages_.empty()) {
+        auto it = datagrams_.find(ages_.front());
+        if (it->second.first_seen >= cutoff) {
+            break;
+        }
+        erase(it);
+        stats_.timed_out++;
+    }
+}
+
+void IpReassembler::erase(DatagramMap::iterator it) {
+    stats_.buffered_bytes -= it->second.data.size();
+    ages_.erase(it->second.age);
+    datagrams_.erase(it);
+    stats_.datagrams = datagrams_.size();
+}
@@ -0,0 +1,92 @@
+/*
+ * ip_reassembly.hpp - IPv4/IPv6 fragment reassembly
+ *
+ * Collects fragments keyed by (IP version, source, destination,
+ * identification, protocol). When every byte of a datagram has arrived,
+ * it is rebuilt behind a synthetic Ethernet/IP header and run through
+ * parse_packet(), and the transport and application fields are copied
+ * onto the fragment that completed it. That packet keeps its own raw
+ * bytes, so recording and hex views still show what was on the wire.
+ *
+ * Overlapping fragments drop the whole datagram (RFC 5722 requires it for
+ * IPv6; doing the same for IPv4 avoids choosing between copies). Buffered
+ * bytes are capped globally with the oldest datagrams evicted first, and
+ * incomplete datagrams time out. Not thread-safe: owned by the pipeline
+ * thread.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct FragmentConfig {
+    size_t max_memory_bytes = 4u << 20;   // All datagrams together; 0 disables
+    size_t max_datagrams = 4096;
+    std::chrono::seconds timeout{30};     // From the first fragment, as in Linux
+};
+
+struct FragmentStats {
+    uint64_t datagrams = 0;        // Currently incomplete
+    uint64_t buffered_bytes = 0;
+    uint64_t reassembled = 0;
+    uint64_t overlaps = 0;         // Datagrams dropped for overlapping fragments
+    uint64_t evicted = 0;          // Dropped by the memory or datagram cap
+    uint64_t timed_out = 0;
+};
+
+class IpReassembler {
+public:
+    explicit IpReassembler(const FragmentConfig& config = FragmentConfig());
+
+    // Feed a parsed packet; non-fragments are ignored. When info completes a
+    // datagram, its ports and application fields are filled in.
+    void on_packet(PacketInfo& info);
+
+    // Drop datagrams whose first fragment arrived before now - timeout
+    void expire(std::chrono::system_clock::time_point now);
+
+    const FragmentStats& stats() const { return stats_; }
+
+private:
+    struct Key {
+        uint8_t ip_version = 0;
+        uint8_t protocol = 0;
+        uint32_t id = 0;
+        std::array<uint8_t, 16> src_addr{};
+        std::array<uint8_t, 16> dst_addr{};
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Datagram {
+        std::vector<uint8_t> data;                       // Fragment bytes at their offsets
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;  // Received [begin, end), sorted
+        uint32_t total = 0;                              // Known once the last fragment arrives
+        std::chrono::system_clock::time_point first_seen;
+        std::list<Key>::iterator age;
+    };
+
+    using DatagramMap = std::unordered_map<Key, Datagram, KeyHash>;
+
+    bool add_fragment(Datagram& datagram, uint32_t offset, const uint8_t* data, size_t len,
+                      bool last);
+    void complete(const Key& key, const Datagram& datagram, PacketInfo& info);
+    bool make_room(size_t bytes, const Key& keep);
+    void erase(DatagramMap::iterator it);
+
+    FragmentConfig config_;
+    DatagramMap datagrams_;
+    std::list<Key> ages_;          // Front is the oldest
+    FragmentStats stats_;
+};
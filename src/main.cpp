@@ -1,8 +1,9 @@
 /*
  * main.cpp - Network Monitor entry point
  *
- * Minimal entry point that creates the App instance and runs it.
- * All application logic is encapsulated in the App class.
+ * Minimal entry point that parses command-line options, then creates the
+ * App instance and runs it. All application logic is encapsulated in the
+ * App class.
  *
  * Note: Packet capture requires root privileges or CAP_NET_RAW capability.
  * Run with: sudo ./network-monitor
@@ -10,14 +11,24 @@
  */
 
 #include "app.hpp"
+#include "options.hpp"
 #include <iostream>
 
 int main(int argc, char** argv)
 {
-    (void)argc;
-    (void)argv;
+    std::string error;
+    auto options = Options::parse(argc, argv, error);
+    if (!options) {
+        std::cerr << error << "\n\n" << Options::usage(argv[0]);
+        return 2;
+    }
+
+    if (options->show_help) {
+        std::cout << Options::usage(argv[0]);
+        return 0;
+    }
 
-    App app;
+    App app(*options);
 
     if (!app.init()) {
         std::cerr << "Failed to initialize application" << std::endl;
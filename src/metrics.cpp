@@ -0,0 +1,232 @@
+/*
+ * metrics.cpp - Lock-free counter registry implementation
+ *
+ * All counter updates use memory_order_relaxed: each counter is
+ * independently monotonic, and scrapes do not need a consistent cut
+ * across counters.
+ */
+
+#include "metrics.hpp"
+#include <cstdio>
+
+ProtocolClass classify_protocol(const PacketInfo& pkt) {
+    if (!pkt.app_protocol.empty()) {
+        if (pkt.app_protocol == "DNS") return ProtocolClass::DNS;
+        if (pkt.app_protocol == "HTTP") return ProtocolClass::HTTP;
+        if (pkt.app_protocol == "TLS") return ProtocolClass::TLS;
+        if (pkt.app_protocol == "QUIC") return ProtocolClass::QUIC;
+        return ProtocolClass::OTHER;
+    }
+
+    if (pkt.ether_type == ETHERTYPE_ARP) {
+        return ProtocolClass::ARP;
+    }
+
+    switch (pkt.protocol) {
+        case PROTO_ICMP: return ProtocolClass::ICMP;
+        case PROTO_TCP: return ProtocolClass::TCP;
+        case PROTO_UDP: return ProtocolClass::UDP;
+        case PROTO_ICMPV6: return ProtocolClass::ICMPV6;
+        default:
+            if (pkt.ip_version == 4 || pkt.ip_version == 6) {
+                return ProtocolClass::OTHER;
+            }
+            return ProtocolClass::ETH;
+    }
+}
+
+const char* protocol_class_name(ProtocolClass cls) {
+    switch (cls) {
+        case ProtocolClass::ETH: return "ETH";
+        case ProtocolClass::ARP: return "ARP";
+        case ProtocolClass::ICMP: return "ICMP";
+        case ProtocolClass::ICMPV6: return "ICMPv6";
+        case ProtocolClass::TCP: return "TCP";
+        case ProtocolClass::UDP: return "UDP";
+        case ProtocolClass::DNS: return "DNS";
+        case ProtocolClass::HTTP: return "HTTP";
+        case ProtocolClass::TLS: return "TLS";
+        case ProtocolClass::QUIC: return "QUIC";
+        case ProtocolClass::OTHER: return "other";
+        case ProtocolClass::COUNT: break;
+    }
+    return "other";
+}
+
+void MetricsRegistry::record_packet(const PacketInfo& pkt) {
+    size_t cls = static_cast<size_t>(classify_protocol(pkt));
+
+    packets_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(pkt.original_length, std::memory_order_relaxed);
+    protocol_packets_[cls].fetch_add(1, std::memory_order_relaxed);
+    protocol_bytes_[cls].fetch_add(pkt.original_length, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::record_alert() {
+    alerts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::add_capture_drops(uint64_t kernel_drops, uint64_t interface_drops) {
+    kernel_drops_.fetch_add(kernel_drops, std::memory_order_relaxed);
+    interface_drops_.fetch_add(interface_drops, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::record_recording(uint64_t written, uint64_t dropped) {
+    recorded_frames_.fetch_add(written, std::memory_order_relaxed);
+    recording_dropped_.fetch_add(dropped, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::set_interface_name(const std::string& name) {
+    std::lock_guard<std::mutex> lock(name_mutex_);
+    interface_name_ = name;
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    MetricsSnapshot snap;
+
+    {
+        std::lock_guard<std::mutex> lock(name_mutex_);
+        snap.interface_name = interface_name_;
+    }
+
+    snap.packets = packets_.load(std::memory_order_relaxed);
+    snap.bytes = bytes_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < PROTOCOL_CLASS_COUNT; ++i) {
+        snap.protocol_packets[i] = protocol_packets_[i].load(std::memory_order_relaxed);
+        snap.protocol_bytes[i] = protocol_bytes_[i].load(std::memory_order_relaxed);
+    }
+    snap.kernel_drops = kernel_drops_.load(std::memory_order_relaxed);
+    snap.interface_drops = interface_drops_.load(std::memory_order_relaxed);
+    snap.alerts = alerts_.load(std::memory_order_relaxed);
+    snap.recorded_frames = recorded_frames_.load(std::memory_order_relaxed);
+    snap.recording_dropped = recording_dropped_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        snap.stages[i] = profiler_.snapshot(static_cast<Stage>(i));
+    }
+
+    return snap;
+}
+
+namespace {
+
+// Escape a label value per the OpenMetrics ABNF (backslash, quote, newline)
+std::string escape_label(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out += c; break;
+        }
+    }
+    return out;
+}
+
+void append_family(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += "\n# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += '\n';
+}
+
+void append_sample(std::string& out, const std::string& name, const std::string& labels,
+                   uint64_t value) {
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+}
+
+void append_seconds(std::string& out, const std::string& name, const std::string& labels,
+                    double seconds) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", seconds);
+    out += name;
+    out += '{';
+    out += labels;
+    out += "} ";
+    out += buf;
+    out += '\n';
+}
+
+}  // namespace
+
+std::string format_openmetrics(const MetricsSnapshot& snap) {
+    std::string out;
+    out.reserve(8192);
+
+    std::string iface = "interface=\"" + escape_label(snap.interface_name) + "\"";
+
+    append_family(out, "netmon_packets", "counter", "Packets captured.");
+    append_sample(out, "netmon_packets_total", iface, snap.packets);
+
+    append_family(out, "netmon_bytes", "counter", "Bytes captured (original wire length).");
+    append_sample(out, "netmon_bytes_total", iface, snap.bytes);
+
+    append_family(out, "netmon_protocol_packets", "counter", "Packets captured by protocol.");
+    for (size_t i = 0; i < PROTOCOL_CLASS_COUNT; ++i) {
+        std::string labels = iface + ",protocol=\"" +
+            protocol_class_name(static_cast<ProtocolClass>(i)) + "\"";
+        append_sample(out, "netmon_protocol_packets_total", labels, snap.protocol_packets[i]);
+    }
+
+    append_family(out, "netmon_protocol_bytes", "counter", "Bytes captured by protocol.");
+    for (size_t i = 0; i < PROTOCOL_CLASS_COUNT; ++i) {
+        std::string labels = iface + ",protocol=\"" +
+            protocol_class_name(static_cast<ProtocolClass>(i)) + "\"";
+        append_sample(out, "netmon_protocol_bytes_total", labels, snap.protocol_bytes[i]);
+    }
+
+    append_family(out, "netmon_capture_dropped_packets", "counter",
+                  "Packets dropped before reaching the application.");
+    append_sample(out, "netmon_capture_dropped_packets_total",
+                  iface + ",reason=\"kernel\"", snap.kernel_drops);
+    append_sample(out, "netmon_capture_dropped_packets_total",
+                  iface + ",reason=\"interface\"", snap.interface_drops);
+
+    append_family(out, "netmon_alerts", "counter", "Watchlist alerts raised.");
+    append_sample(out, "netmon_alerts_total", "", snap.alerts);
+
+    append_family(out, "netmon_recording_frames", "counter",
+                  "Frames handled by the pcapng recorder.");
+    append_sample(out, "netmon_recording_frames_total", "result=\"written\"",
+                  snap.recorded_frames);
+    append_sample(out, "netmon_recording_frames_total", "result=\"dropped\"",
+                  snap.recording_dropped);
+
+    append_family(out, "netmon_stage_latency_seconds", "summary",
+                  "Time spent per packet (or frame, for render) in each pipeline stage.");
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        const HistogramSnapshot& hist = snap.stages[i];
+        std::string stage = std::string("stage=\"") + stage_name(static_cast<Stage>(i)) + "\"";
+        append_seconds(out, "netmon_stage_latency_seconds", stage + ",quantile=\"0.5\"",
+                       hist.percentile(0.5) / 1e9);
+        append_seconds(out, "netmon_stage_latency_seconds", stage + ",quantile=\"0.99\"",
+                       hist.percentile(0.99) / 1e9);
+        append_seconds(out, "netmon_stage_latency_seconds_sum", stage, hist.sum_ns / 1e9);
+        append_sample(out, "netmon_stage_latency_seconds_count", stage, hist.count);
+    }
+
+    append_family(out, "netmon_stage_latency_max_seconds", "gauge",
+                  "Largest observed latency per pipeline stage.");
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        std::string stage = std::string("stage=\"") + stage_name(static_cast<Stage>(i)) + "\"";
+        append_seconds(out, "netmon_stage_latency_max_seconds", stage,
+                       snap.stages[i].max_ns / 1e9);
+    }
+
+    out += "# EOF\n";
+    return out;
+}
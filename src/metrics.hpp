@@ -0,0 +1,96 @@
+/*
+ * metrics.hpp - Lock-free counters for external monitoring
+ *
+ * MetricsRegistry keeps a fixed set of atomic counters (packets, bytes,
+ * per-protocol breakdown, capture drops, alerts, recording) that the capture thread
+ * bumps with relaxed increments. Readers take a MetricsSnapshot by loading
+ * each counter once, so a scrape never touches PacketStore's mutex or its
+ * packet deque and costs the same regardless of capture rate.
+ *
+ * The registry also owns the StageProfiler latency histograms, so the
+ * per-stage timings are exported alongside the traffic counters.
+ *
+ * format_openmetrics() renders a snapshot in the OpenMetrics text format
+ * served by MetricsServer.
+ */
+
+#pragma once
+
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Fixed protocol classes so counters can live in a flat array.
+// Mirrors the names returned by PacketInfo::protocol_name().
+enum class ProtocolClass : uint8_t {
+    ETH, ARP, ICMP, ICMPV6, TCP, UDP, DNS, HTTP, TLS, QUIC, OTHER, COUNT
+};
+
+constexpr size_t PROTOCOL_CLASS_COUNT = static_cast<size_t>(ProtocolClass::COUNT);
+
+// Classify a packet without allocating
+ProtocolClass classify_protocol(const PacketInfo& pkt);
+const char* protocol_class_name(ProtocolClass cls);
+
+// Plain copy of all counters at one point in time
+struct MetricsSnapshot {
+    std::string interface_name;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    std::array<uint64_t, PROTOCOL_CLASS_COUNT> protocol_packets{};
+    std::array<uint64_t, PROTOCOL_CLASS_COUNT> protocol_bytes{};
+    uint64_t kernel_drops = 0;     // Dropped by the kernel buffer (ps_drop)
+    uint64_t interface_drops = 0;  // Dropped by the interface/driver (ps_ifdrop)
+    uint64_t alerts = 0;
+    uint64_t recorded_frames = 0;        // Written by the pcapng recorder
+    uint64_t recording_dropped = 0;      // Queue overflow or write failure
+
+    // Per-stage latency histograms
+    std::array<HistogramSnapshot, STAGE_COUNT> stages{};
+};
+
+class MetricsRegistry {
+public:
+    MetricsRegistry() = default;
+
+    // Non-copyable (atomics)
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Writers (capture thread)
+    void record_packet(const PacketInfo& pkt);
+    void record_alert();
+    void add_capture_drops(uint64_t kernel_drops, uint64_t interface_drops);
+    void set_interface_name(const std::string& name);
+    void record_recording(uint64_t written, uint64_t dropped);
+
+    // Pipeline stage timings
+    StageProfiler& profiler() { return profiler_; }
+    const StageProfiler& profiler() const { return profiler_; }
+
+    // Readers (metrics server, UI)
+    MetricsSnapshot snapshot() const;
+
+private:
+    std::atomic<uint64_t> packets_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::array<std::atomic<uint64_t>, PROTOCOL_CLASS_COUNT> protocol_packets_{};
+    std::array<std::atomic<uint64_t>, PROTOCOL_CLASS_COUNT> protocol_bytes_{};
+    std::atomic<uint64_t> kernel_drops_{0};
+    std::atomic<uint64_t> interface_drops_{0};
+    std::atomic<uint64_t> alerts_{0};
+    std::atomic<uint64_t> recorded_frames_{0};
+    std::atomic<uint64_t> recording_dropped_{0};
+    StageProfiler profiler_;
+
+    // Interface label changes only when a capture is opened
+    mutable std::mutex name_mutex_;
+    std::string interface_name_;
+};
+
+// Render a snapshot as OpenMetrics text (terminated by "# EOF")
+std::string format_openmetrics(const MetricsSnapshot& snap);
@@ -0,0 +1,217 @@
+/*
+ * metrics_server.cpp - Embedded metrics HTTP endpoint implementation
+ *
+ * Uses plain POSIX sockets and poll(). Each connection has an overall
+ * deadline covering the request and the response, plus a size cap on the
+ * request, so a client trickling bytes or never reading cannot hold the
+ * server thread for long.
+ */
+
+#include "metrics_server.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int POLL_TIMEOUT_MS = 200;
+constexpr size_t MAX_REQUEST_BYTES = 4096;
+constexpr auto CLIENT_DEADLINE = std::chrono::seconds(2);   // Whole request and response
+
+using Deadline = std::chrono::steady_clock::time_point;
+
+// Wait for events on fd; false once the deadline has passed
+bool wait_for(int fd, short events, Deadline deadline) {
+    for (;;) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) {
+            return false;
+        }
+        pollfd pfd{};
+        pfd.fd = fd;
+        pfd.events = events;
+        int ready = ::poll(&pfd, 1, static_cast<int>(left));
+        if (ready < 0 && errno == EINTR) continue;
+        return ready > 0;
+    }
+}
+
+// Write the whole buffer, retrying on short writes, until the deadline
+void send_all(int fd, const std::string& data, Deadline deadline) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        if (!wait_for(fd, POLLOUT, deadline)) return;
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent,
+                           MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+std::string make_response(const char* status, const char* content_type,
+                          const std::string& body) {
+    std::string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += content_type;
+    response += "\r\nContent-Length: ";
+    response += std::to_string(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(const MetricsRegistry& registry) : registry_(registry) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& bind_addr, uint16_t port) {
+    if (running_.load()) {
+        return true;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bind_addr.c_str(), &addr.sin_addr) != 1) {
+        error_ = "Invalid metrics bind address: " + bind_addr;
+        return false;
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        error_ = std::string("socket: ") + strerror(errno);
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 16) < 0) {
+        error_ = "Metrics port " + std::to_string(port) + ": " + strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    error_.clear();
+    running_.store(true);
+    server_thread_ = std::thread([this]() {
+        serve_loop();
+    });
+
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    running_.store(false);
+
+    if (server_thread_.joinable()) {
+        server_thread_.join();
+    }
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void MetricsServer::serve_loop() {
+    while (running_.load()) {
+        pollfd pfd{};
+        pfd.fd = listen_fd_;
+        pfd.events = POLLIN;
+
+        int ready = ::poll(&pfd, 1, POLL_TIMEOUT_MS);
+        if (ready <= 0) {
+            continue;  // Timeout or EINTR: re-check running_
+        }
+
+        int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+
+        handle_client(client);
+        ::close(client);
+    }
+}
+
+void MetricsServer::handle_client(int fd) {
+    // Bound how long a slow client can hold the thread: per call by the
+    // socket timeouts, and in total by the deadline
+    Deadline deadline = std::chrono::steady_clock::now() + CLIENT_DEADLINE;
+    timeval tv{};
+    tv.tv_sec = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    // Read until the end of the request headers
+    std::string request;
+    char buf[1024];
+    while (request.size() < MAX_REQUEST_BYTES &&
+           request.find("\r\n\r\n") == std::string::npos &&
+           wait_for(fd, POLLIN, deadline)) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    size_t line_end = request.find("\r\n");
+    if (line_end == std::string::npos) {
+        send_all(fd, make_response("400 Bad Request", "text/plain", "Bad request\n"), deadline);
+        return;
+    }
+
+    // Request line: METHOD SP PATH SP VERSION
+    std::string line = request.substr(0, line_end);
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.find(' ', sp1 == std::string::npos ? 0 : sp1 + 1);
+    if (sp1 == std::string::npos || sp2 == std::string::npos) {
+        send_all(fd, make_response("400 Bad Request", "text/plain", "Bad request\n"), deadline);
+        return;
+    }
+
+    std::string method = line.substr(0, sp1);
+    std::string path = line.substr(sp1 + 1, sp2 - sp1 - 1);
+
+    // Ignore any query string
+    size_t query = path.find('?');
+    if (query != std::string::npos) {
+        path.resize(query);
+    }
+
+    if (method != "GET") {
+        send_all(fd, make_response("405 Method Not Allowed", "text/plain",
+                                   "Method not allowed\n"), deadline);
+        return;
+    }
+
+    if (path != "/metrics") {
+        send_all(fd, make_response("404 Not Found", "text/plain", "Not found\n"), deadline);
+        return;
+    }
+
+    std::string body = format_openmetrics(registry_.snapshot());
+    send_all(fd, make_response("200 OK",
+                               "application/openmetrics-text; version=1.0.0; charset=utf-8",
+                               body),
+             deadline);
+}
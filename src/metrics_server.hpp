@@ -0,0 +1,48 @@
+/*
+ * metrics_server.hpp - Embedded HTTP endpoint for OpenMetrics scrapes
+ *
+ * A deliberately small HTTP/1.0-style server running on its own thread.
+ * It answers "GET /metrics" with a snapshot of the MetricsRegistry
+ * rendered as OpenMetrics text, and 404s everything else. One request is
+ * handled per connection; the listening socket is polled with a short
+ * timeout so stop() returns promptly.
+ *
+ * Usage: construct with a registry, call start() with a bind address and
+ * port, and stop() on shutdown.
+ */
+
+#pragma once
+
+#include "metrics.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+class MetricsServer {
+public:
+    explicit MetricsServer(const MetricsRegistry& registry);
+    ~MetricsServer();
+
+    // Non-copyable
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // Bind, listen and start the server thread. Returns false on error.
+    bool start(const std::string& bind_addr, uint16_t port);
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+    std::string get_error() const { return error_; }
+
+private:
+    void serve_loop();
+    void handle_client(int fd);
+
+    const MetricsRegistry& registry_;
+    int listen_fd_ = -1;
+    std::string error_;
+
+    std::atomic<bool> running_{false};
+    std::thread server_thread_;
+};
@@ -0,0 +1,302 @@
+/*
+ * options.cpp - Command-line option parsing implementation
+ *
+ * Hand-rolled parser (no getopt_long) so that the same code runs in the unit
+ * tests. Unknown flags and malformed values are reported as errors rather
+ * than silently ignored.
+ */
+
+#include "options.hpp"
+#include <sstream>
+#include <type_traits>
+
+namespace {
+
+// Parse an unsigned integer in [min, max]; rejects trailing garbage
+bool parse_uint(const std::string& text, uint64_t min, uint64_t max, uint64_t& out) {
+    if (text.empty()) return false;
+
+    uint64_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+        if (value > max) return false;
+    }
+
+    if (value < min) return false;
+    out = value;
+    return true;
+}
+
+}  // namespace
+
+std::optional<Options> Options::parse(int argc, char** argv, std::string& error) {
+    Options opts;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string name = arg;
+        std::string value;
+        bool has_inline_value = false;
+
+        // Split "--name=value"
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) == 0 && eq != std::string::npos) {
+            name = arg.substr(0, eq);
+            value = arg.substr(eq + 1);
+            has_inline_value = true;
+        }
+
+        // Fetch the value for options that take one
+        auto take_value = [&](std::string& out) -> bool {
+            if (has_inline_value) {
+                out = value;
+                return true;
+            }
+            if (i + 1 >= argc) {
+                error = "Missing value for " + name;
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+
+        // Fetch a number in [min, max] into an integer option
+        auto take_uint = [&](uint64_t min, uint64_t max, auto& field) -> bool {
+            std::string text;
+            if (!take_value(text)) return false;
+            uint64_t number = 0;
+            if (!parse_uint(text, min, max, number)) {
+                error = "Invalid value for " + name + ": " + text;
+                return false;
+            }
+            field = static_cast<std::remove_reference_t<decltype(field)>>(number);
+            return true;
+        };
+
+        if (name == "-h" || name == "--help") {
+            opts.show_help = true;
+        } else if (name == "-i" || name == "--interface") {
+            if (!take_value(opts.interface_name)) return std::nullopt;
+            if (opts.interface_name.empty()) {
+                error = "Empty name for " + name;
+                return std::nullopt;
+            }
+        } else if (name == "--no-ui") {
+            opts.headless = true;
+        } else if (name == "--replay") {
+            if (!take_value(opts.replay_path)) return std::nullopt;
+            if (opts.replay_path.empty()) {
+                error = "Empty path for --replay";
+                return std::nullopt;
+            }
+        } else if (name == "--export") {
+            if (!take_value(opts.export_path)) return std::nullopt;
+            if (opts.export_path.empty()) {
+                error = "Empty path for --export";
+                return std::nullopt;
+            }
+        } else if (name == "--export-format") {
+            std::string text;
+            if (!take_value(text)) return std::nullopt;
+            if (!RecordExporter::parse_format(text, opts.export_format)) {
+                error = "Invalid value for --export-format: " + text;
+                return std::nullopt;
+            }
+        } else if (name == "--export-records") {
+            std::string text;
+            if (!take_value(text)) return std::nullopt;
+            if (!RecordExporter::parse_records(text, opts.export_records)) {
+                error = "Invalid value for --export-records: " + text;
+                return std::nullopt;
+            }
+        } else if (name == "--export-policy") {
+            std::string text;
+            if (!take_value(text)) return std::nullopt;
+            if (!RecordExporter::parse_policy(text, opts.export_policy)) {
+                error = "Invalid value for --export-policy: " + text;
+                return std::nullopt;
+            }
+        } else if (name == "--metrics-port") {
+            std::string text;
+            if (!take_value(text)) return std::nullopt;
+            uint64_t port = 0;
+            if (!parse_uint(text, 1, 65535, port)) {
+                error = "Invalid port for --metrics-port: " + text;
+                return std::nullopt;
+            }
+            opts.metrics_port = static_cast<uint16_t>(port);
+        } else if (name == "--metrics-bind") {
+            if (!take_value(opts.metrics_bind)) return std::nullopt;
+            if (opts.metrics_bind.empty()) {
+                error = "Empty address for --metrics-bind";
+                return std::nullopt;
+            }
+        } else if (name == "--flow-export") {
+            std::string text;
+            if (!take_value(text)) return std::nullopt;
+            if (!FlowExporter::parse_collector(text, opts.flow_collector_host,
+                                               opts.flow_collector_port)) {
+                error = "Invalid collector for --flow-export (expected HOST:PORT): " + text;
+                return std::nullopt;
+            }
+        } else if (name == "--flow-protocol") {
+            std::string text;
+            if (!take_value(text)) return std::nullopt;
+            if (text == "ipfix") {
+                opts.flow_protocol = FlowExportProtocol::IPFIX;
+            } else if (text == "netflow9" || text == "v9") {
+                opts.flow_protocol = FlowExportProtocol::NETFLOW_V9;
+            } else {
+                error = "Invalid value for --flow-protocol: " + text;
+                return std::nullopt;
+            }
+        } else if (name == "--flow-active-timeout") {
+            if (!take_uint(1, 86400, opts.flow_active_timeout)) return std::nullopt;
+        } else if (name == "--flow-idle-timeout") {
+            if (!take_uint(1, 86400, opts.flow_idle_timeout)) return std::nullopt;
+        } else if (name == "--record") {
+            if (!take_value(opts.record_prefix)) return std::nullopt;
+            if (opts.record_prefix.empty()) {
+                error = "Empty path prefix for --record";
+                return std::nullopt;
+            }
+        } else if (name == "--record-rotate-mb") {
+            if (!take_uint(1, 0xFFFFFFFF, opts.record_rotate_mb)) return std::nullopt;
+        } else if (name == "--record-rotate-secs") {
+            if (!take_uint(1, 0xFFFFFFFF, opts.record_rotate_secs)) return std::nullopt;
+        } else if (name == "--record-max-files") {
+            if (!take_uint(1, 0xFFFFFFFF, opts.record_max_files)) return std::nullopt;
+        } else if (name == "--trigger-dir") {
+            if (!take_value(opts.trigger_dir)) return std::nullopt;
+            if (opts.trigger_dir.empty()) {
+                error = "Empty directory for --trigger-dir";
+                return std::nullopt;
+            }
+        } else if (name == "--trigger-pre") {
+            if (!take_uint(0, 86400, opts.trigger_pre_secs)) return std::nullopt;
+        } else if (name == "--trigger-post") {
+            if (!take_uint(0, 86400, opts.trigger_post_secs)) return std::nullopt;
+        } else if (name == "--trigger-budget-mb") {
+            if (!take_uint(1, 86400, opts.trigger_budget_mb)) return std::nullopt;
+        } else if (name == "--reassembly-bytes") {
+            if (!take_uint(0, 1048576, opts.reassembly_bytes)) return std::nullopt;
+        } else if (name == "--reassembly-memory-mb") {
+            if (!take_uint(1, 4096, opts.reassembly_memory_mb)) return std::nullopt;
+        } else if (name == "--fragment-memory-mb") {
+            if (!take_uint(0, 1024, opts.fragment_memory_mb)) return std::nullopt;
+        } else if (name == "--quic-flows") {
+            if (!take_uint(0, 1000000, opts.quic_flows)) return std::nullopt;
+        } else if (name == "--dns-cache-size") {
+            if (!take_uint(0, 10000000, opts.dns_cache_size)) return std::nullopt;
+        } else if (name == "--dns-pending") {
+            if (!take_uint(0, 1000000, opts.dns_pending)) return std::nullopt;
+        } else if (name == "--bench") {
+            if (!take_value(opts.bench_source)) return std::nullopt;
+            if (opts.bench_source.empty()) {
+                error = "Empty source for --bench (use \"gen\" or a capture file)";
+                return std::nullopt;
+            }
+        } else if (name == "--bench-packets") {
+            if (!take_uint(1, 1000000000000000ULL, opts.bench_packets)) return std::nullopt;
+        } else if (name == "--bench-seed") {
+            if (!take_uint(0, 1000000000000000ULL, opts.bench_seed)) return std::nullopt;
+        } else if (name == "--bench-flows") {
+            if (!take_uint(1, 10000000, opts.bench_flows)) return std::nullopt;
+        } else if (name == "--tcp-flows") {
+            if (!take_uint(0, 10000000, opts.tcp_flows)) return std::nullopt;
+        } else if (name == "--http-flows") {
+            if (!take_uint(0, 10000000, opts.http_flows)) return std::nullopt;
+        } else if (name == "--detect-window") {
+            if (!take_uint(0, 3600, opts.detect_window_secs)) return std::nullopt;
+        } else if (name == "--anomaly-sigma") {
+            if (!take_uint(0, 100, opts.anomaly_sigma)) return std::nullopt;
+        } else if (name == "--verify-checksums") {
+            opts.verify_checksums = true;
+        } else if (name == "--bench-process") {
+            opts.bench_process = true;
+        } else {
+            error = "Unknown option: " + arg;
+            return std::nullopt;
+        }
+    }
+
+    if (opts.show_help) {
+        return opts;
+    }
+    if (!opts.bench_source.empty()) {
+        if (!opts.interface_name.empty() || !opts.replay_path.empty() ||
+            !opts.export_path.empty() || !opts.flow_collector_host.empty() ||
+            !opts.record_prefix.empty() || !opts.trigger_dir.empty()) {
+            error = "--bench cannot be combined with capture, replay, export or recording options";
+            return std::nullopt;
+        }
+        opts.headless = true;
+        return opts;
+    }
+    if (opts.export_path == "-" && !opts.headless) {
+        error = "--export - (stdout) requires --no-ui";
+        return std::nullopt;
+    }
+    if (opts.headless && opts.interface_name.empty() && opts.replay_path.empty()) {
+        error = "--no-ui requires --interface or --replay";
+        return std::nullopt;
+    }
+    if (!opts.interface_name.empty() && !opts.replay_path.empty()) {
+        error = "--interface and --replay cannot be combined";
+        return std::nullopt;
+    }
+    if (opts.export_format == ExportFormat::COLUMNAR &&
+        opts.export_records == ExportRecords::FLOWS) {
+        error = "--export-format columnar only supports packet records";
+        return std::nullopt;
+    }
+
+    return opts;
+}
+
+std::string Options::usage(const std::string& program) {
+    std::ostringstream oss;
+    oss << "Usage: " << program << " [options]\n"
+        << "\n"
+        << "Options:\n"
+        << "  -i, --interface NAME   Start capturing on NAME immediately\n"
+        << "  --no-ui                Run without the terminal UI (needs --interface or --replay)\n"
+        << "  --replay FILE          Load a columnar export instead of capturing\n"
+        << "  --export PATH          Stream records to PATH (\"-\" = stdout, needs --no-ui)\n"
+        << "  --export-format FMT    ndjson (default), csv or columnar\n"
+        << "  --export-records KIND  packets (default) or flows\n"
+        << "  --export-policy P      block (default) or drop when the sink falls behind\n"
+        << "  --flow-export HOST:PORT  Send IPFIX flow records to a UDP collector\n"
+        << "  --flow-protocol P      ipfix (default) or netflow9\n"
+        << "  --flow-active-timeout SECS  Report long-lived flows every SECS (default 60)\n"
+        << "  --flow-idle-timeout SECS    End flows idle for SECS (default 15)\n"
+        << "  --reassembly-bytes N   Reassemble the first N bytes of each TCP direction (default 8192, 0 = off)\n"
+        << "  --reassembly-memory-mb N  Memory cap for TCP reassembly (default 32)\n"
+        << "  --fragment-memory-mb N Memory cap for IP fragment reassembly (default 4, 0 = off)\n"
+        << "  --quic-flows N         QUIC flows named from decrypted Initials (default 16384, 0 = off)\n"
+        << "  --dns-cache-size N     Addresses remembered from DNS answers (default 65536, 0 = off)\n"
+        << "  --dns-pending N        Outstanding DNS queries timed at once (default 16384, 0 = off)\n"
+        << "  --tcp-flows N          TCP connections analysed for RTT and retransmissions (default 65536, 0 = off)\n"
+        << "  --http-flows N         HTTP connections matched for status and TTFB (default 16384, 0 = off)\n"
+        << "  --detect-window SECS   Window for SYN flood, scan and sweep alerts (default 10, 0 = off)\n"
+        << "  --anomaly-sigma K      Alert on rates K sigma from their baseline (default 4, 0 = off)\n"
+        << "  --verify-checksums     Count packets with bad IPv4, TCP or UDP checksums\n"
+        << "  --bench SOURCE         Benchmark the pipeline on \"gen\" (synthetic) or a pcap file\n"
+        << "  --bench-packets N      Packets to process (default 1000000, or each file frame once)\n"
+        << "  --bench-seed N         Generator seed (default 1)\n"
+        << "  --bench-flows N        Generator concurrent flows (default 1000)\n"
+        << "  --bench-process        Include process attribution in the benchmark\n"
+        << "  --metrics-port PORT    Serve OpenMetrics text on http://ADDR:PORT/metrics\n"
+        << "  --metrics-bind ADDR    Address for the metrics endpoint (default 127.0.0.1)\n"
+        << "  --record PREFIX        Record frames to PREFIX_<time>_NNNNN.pcapng\n"
+        << "  --record-rotate-mb N   Start a new file after N megabytes\n"
+        << "  --record-rotate-secs N Start a new file after N seconds\n"
+        << "  --record-max-files N   Keep only the newest N files (ring buffer)\n"
+        << "  --trigger-dir DIR      Write a pcap per watchlist alert into DIR\n"
+        << "  --trigger-pre SECS     Seconds of traffic before the alert (default 10)\n"
+        << "  --trigger-post SECS    Seconds of traffic after the alert (default 10)\n"
+        << "  --trigger-budget-mb N  Total disk budget for alert captures (default 500)\n"
+        << "  -h, --help             Show this help and exit\n";
+    return oss.str();
+}
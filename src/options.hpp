@@ -0,0 +1,104 @@
+/*
+ * options.hpp - Command-line options
+ *
+ * Parses the flags accepted on the command line. Every option is optional;
+ * with no arguments the application starts the interactive UI exactly as
+ * before. Combinations that cannot work (exporting to stdout under the
+ * curses UI, --no-ui without an interface or replay file) are rejected
+ * here. Flags accept both "--name value" and "--name=value" forms.
+ * --bench runs the pipeline benchmark instead of the UI or a live capture.
+ */
+
+#pragma once
+
+#include "exporter.hpp"
+#include "flow_export.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+
+struct Options {
+    // Interface to capture on at startup (required with --no-ui)
+    std::string interface_name;
+
+    // Run without the curses UI until SIGINT/SIGTERM
+    bool headless = false;
+
+    // Load a columnar export instead of capturing live
+    std::string replay_path;
+
+    // Streaming record export (empty path = disabled, "-" = stdout)
+    std::string export_path;
+    ExportFormat export_format = ExportFormat::NDJSON;
+    ExportRecords export_records = ExportRecords::PACKETS;
+    ExportPolicy export_policy = ExportPolicy::BLOCK;
+
+    // Metrics endpoint (0 = disabled)
+    uint16_t metrics_port = 0;
+    std::string metrics_bind = "127.0.0.1";
+
+    // IPFIX / NetFlow v9 export (empty host = disabled)
+    std::string flow_collector_host;
+    uint16_t flow_collector_port = 0;
+    FlowExportProtocol flow_protocol = FlowExportProtocol::IPFIX;
+    uint32_t flow_active_timeout = 60;
+    uint32_t flow_idle_timeout = 15;
+
+    // Continuous pcapng recording (empty prefix = disabled)
+    std::string record_prefix;
+    uint64_t record_rotate_mb = 0;       // 0 = no size rotation
+    uint32_t record_rotate_secs = 0;     // 0 = no time rotation
+    uint32_t record_max_files = 0;       // 0 = unlimited
+
+    // Alert-triggered capture (empty dir = disabled)
+    std::string trigger_dir;
+    uint32_t trigger_pre_secs = 10;
+    uint32_t trigger_post_secs = 10;
+    uint64_t trigger_budget_mb = 500;
+
+    // Reassembly of split ClientHellos and HTTP heads (0 bytes = disabled)
+    // and of fragmented IP datagrams
+    uint32_t reassembly_bytes = 8192;    // Per direction of each connection
+    uint32_t reassembly_memory_mb = 32;  // All connections together
+    uint32_t fragment_memory_mb = 4;     // IP fragment reassembly (0 = disabled)
+
+    // QUIC flows remembered after decrypting their ClientHello (0 = disabled)
+    uint32_t quic_flows = 16384;
+
+    // Passive DNS cache entries (0 = disabled)
+    uint32_t dns_cache_size = 65536;
+
+    // Outstanding DNS queries tracked for response times (0 = disabled)
+    uint32_t dns_pending = 16384;
+
+    // TCP connections analysed for RTT, retransmissions and windows (0 = disabled)
+    uint32_t tcp_flows = 65536;
+
+    // HTTP/1.x connections followed for status codes and TTFB (0 = disabled)
+    uint32_t http_flows = 16384;
+
+    // Window for SYN flood, port scan, host sweep and RST storm detection (0 = disabled)
+    uint32_t detect_window_secs = 10;
+
+    // Standard deviations from a learned rate baseline that raise an alert (0 = disabled)
+    uint32_t anomaly_sigma = 4;
+
+    // Verify IPv4, TCP and UDP checksums
+    bool verify_checksums = false;
+
+    // Pipeline benchmark (empty source = disabled; "gen" = synthetic traffic)
+    std::string bench_source;
+    uint64_t bench_packets = 0;          // 0 = default for the source
+    uint64_t bench_seed = 1;
+    uint32_t bench_flows = 1000;
+    bool bench_process = false;
+
+    // Print usage and exit
+    bool show_help = false;
+
+    // Parse argv. Returns std::nullopt and sets error on invalid input.
+    static std::optional<Options> parse(int argc, char** argv, std::string& error);
+
+    // Usage text for --help and error messages
+    static std::string usage(const std::string& program);
+};
@@ -2,10 +2,19 @@
  * packet.cpp - Network packet parsing implementation
  *
  * Implements packet parsing for multiple protocol layers:
- * - Layer 2: Ethernet, VLAN (802.1Q)
- * - Layer 3: IPv4, IPv6, ARP
+ * - Layer 2: Ethernet, VLAN (802.1Q), Linux cooked capture (SLL, SLL2), BSD
+ *   loopback, PPP, raw IP
+ * - Layer 3: IPv4, IPv6 (with extension headers), ARP
  * - Layer 4: TCP, UDP, ICMP
- * - Layer 7: DNS queries, HTTP requests, TLS Client Hello (SNI extraction)
+ * - Tunnels: VXLAN, GENEVE, GRE, MPLS, IP-in-IP, decapsulated recursively
+ * - Layer 7: DNS queries, HTTP requests, TLS Client Hello (SNI extraction),
+ *   QUIC long/short header classification
+ *
+ * Each layer hands off to the next through the compile-time dispatch
+ * tables of dissector.hpp; the registrations sit just above parse_packet().
+ *
+ * HTTP heads are scanned in place with SSE2/AVX2 byte search where the
+ * compiler targets it, falling back to a scalar loop elsewhere.
  *
  * The hostname extraction features allow the application to show what
  * domains/URLs are being accessed, even for encrypted HTTPS traffic
@@ -13,13 +22,21 @@
  */
 
 #include "packet.hpp"
+#include "dissector.hpp"
 #include <arpa/inet.h>
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
 #include <cstring>
 #include <iomanip>
 #include <sstream>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 std::string PacketInfo::protocol_name() const {
     // Return application protocol if we detected one
     if (!app_protocol.empty()) {
@@ -129,7 +146,7 @@ std::string parse_dns_name(const uint8_t* data, size_t len, size_t& offset) {
 
         if (label_len == 0) {
             if (!jumped) offset = pos + 1;
-            break;
+            return name;
         }
 
         // Check for compression pointer (starts with 0xC0)
@@ -150,11 +167,12 @@ std::string parse_dns_name(const uint8_t* data, size_t len, size_t& offset) {
         pos += label_len + 1;
     }
 
-    if (!jumped) offset = pos;
+    if (!jumped) offset = pos;  // Truncated: stop where parsing did
     return name;
 }
 
-// Parse DNS query to extract the queried hostname
+// Parse DNS query to extract the queried hostname; responses also get
+// their A/AAAA/CNAME answers
 void parse_dns_query(PacketInfo& info, const uint8_t* data, size_t len) {
     if (len < sizeof(DNSHeader)) return;
 
@@ -175,6 +193,8 @@ void parse_dns_query(PacketInfo& info, const uint8_t* data, size_t len) {
 
     info.hostname = qname;
     info.app_protocol = "DNS";
+    info.dns_id = ntohs(dns->id);
+    info.dns_flags = flags;
 
     // Get query type if we have room
     if (offset + 4 <= len) {
@@ -192,95 +212,315 @@ void parse_dns_query(PacketInfo& info, const uint8_t* data, size_t len) {
         }
         info.app_info = is_query ? "Query " + type_str : "Response " + type_str;
     }
+
+    if (is_query) return;
+
+    // Summarise the answer: first address (or the error) and how many more
+    uint8_t rcode = flags & 0x0F;
+    if (rcode == 3) {
+        info.app_info += " NXDOMAIN";
+    } else if (rcode == 2) {
+        info.app_info += " SERVFAIL";
+    } else if (rcode != 0) {
+        info.app_info += " rcode " + std::to_string(rcode);
+    }
+    parse_dns_answers(data, len, info.dns_answers);
+    size_t addresses = 0;
+    for (const DnsAnswer& answer : info.dns_answers) {
+        if (answer.type == DNS_TYPE_CNAME) continue;
+        if (addresses++ == 0) {
+            char text[INET6_ADDRSTRLEN];
+            int family = answer.type == DNS_TYPE_A ? AF_INET : AF_INET6;
+            inet_ntop(family, answer.addr.data(), text, sizeof(text));
+            info.app_info += ' ';
+            info.app_info += text;
+        }
+    }
+    if (addresses > 1) {
+        info.app_info += " (+" + std::to_string(addresses - 1) + ")";
+    }
 }
 
-// Parse HTTP request to extract Host header
-void parse_http_request(PacketInfo& info, const uint8_t* data, size_t len) {
-    // Need at least some data for HTTP
-    if (len < 16) return;
-
-    // Check for HTTP method
-    const char* methods[] = {"GET ", "POST ", "PUT ", "DELETE ", "HEAD ",
-                             "OPTIONS ", "PATCH ", "CONNECT "};
-    bool is_http = false;
-    std::string method;
-
-    for (const char* m : methods) {
-        size_t mlen = strlen(m);
-        if (len >= mlen && memcmp(data, m, mlen) == 0) {
-            is_http = true;
-            method = std::string(m, mlen - 1);  // Remove trailing space
-            break;
+// Parse the answer section into A, AAAA and CNAME records; other types are
+// skipped. Returns the number of records appended.
+size_t parse_dns_answers(const uint8_t* data, size_t len, std::vector<DnsAnswer>& out) {
+    if (len < sizeof(DNSHeader)) return 0;
+    const auto* dns = reinterpret_cast<const DNSHeader*>(data);
+    uint16_t qdcount = ntohs(dns->qdcount);
+    uint16_t ancount = ntohs(dns->ancount);
+
+    size_t offset = sizeof(DNSHeader);
+    for (uint16_t i = 0; i < qdcount; ++i) {
+        parse_dns_name(data, len, offset);
+        offset += 4;  // QTYPE, QCLASS
+        if (offset > len) return 0;
+    }
+
+    size_t added = 0;
+    for (uint16_t i = 0; i < ancount; ++i) {
+        std::string name = parse_dns_name(data, len, offset);
+        if (offset + 10 > len) break;
+        uint16_t type = (data[offset] << 8) | data[offset + 1];
+        uint32_t ttl = (static_cast<uint32_t>(data[offset + 4]) << 24) | (data[offset + 5] << 16) |
+                       (data[offset + 6] << 8) | data[offset + 7];
+        uint16_t rdlength = (data[offset + 8] << 8) | data[offset + 9];
+        offset += 10;
+        if (offset + rdlength > len) break;
+
+        DnsAnswer answer;
+        answer.type = type;
+        answer.ttl = ttl;
+        if (type == DNS_TYPE_A && rdlength == 4) {
+            std::memcpy(answer.addr.data(), data + offset, 4);
+        } else if (type == DNS_TYPE_AAAA && rdlength == 16) {
+            std::memcpy(answer.addr.data(), data + offset, 16);
+        } else if (type == DNS_TYPE_CNAME) {
+            size_t target_offset = offset;
+            answer.target = parse_dns_name(data, offset + rdlength, target_offset);
+            if (answer.target.empty()) type = 0;
+        } else {
+            type = 0;
         }
+        offset += rdlength;
+        if (type == 0 || name.empty()) continue;
+
+        answer.name = std::move(name);
+        out.push_back(std::move(answer));
+        added++;
     }
+    return added;
+}
+
+namespace {
 
-    // Also check for HTTP response
-    if (!is_http && len >= 9 && memcmp(data, "HTTP/1.", 7) == 0) {
-        is_http = true;
-        method = "Response";
+// Case-insensitive ASCII compare against a lowercase header name
+bool header_name_is(const uint8_t* name, size_t len, const char* lower, size_t lower_len) {
+    if (len != lower_len) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if ((name[i] | 0x20) != static_cast<uint8_t>(lower[i])) return false;
     }
+    return true;
+}
 
-    if (!is_http) return;
+// Header value with surrounding spaces and tabs removed
+std::string_view header_value(const uint8_t* begin, const uint8_t* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+    return std::string_view(reinterpret_cast<const char*>(begin), end - begin);
+}
 
-    info.app_protocol = "HTTP";
-    info.app_info = method;
+// Decimal Content-Length, or -1 if it is not a plain number
+int64_t parse_content_length(std::string_view value) {
+    if (value.empty() || value.size() > 18) return -1;
+    int64_t length = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') return -1;
+        length = length * 10 + (c - '0');
+    }
+    return length;
+}
+
+// Leading bytes packed in host byte order, as a single 8-byte load sees them
+constexpr uint64_t prefix_bits(const char* text, size_t len) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < len; ++i) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        bits |= static_cast<uint64_t>(static_cast<uint8_t>(text[i])) << (8 * i);
+#else
+        bits |= static_cast<uint64_t>(static_cast<uint8_t>(text[i])) << (56 - 8 * i);
+#endif
+    }
+    return bits;
+}
+
+constexpr uint64_t prefix_mask(size_t len) {
+    return prefix_bits("\xff\xff\xff\xff\xff\xff\xff\xff", len);
+}
+
+struct HttpStart {
+    uint64_t bits;
+    uint64_t mask;
+    const char* name;   // "Response" for status lines
+    size_t name_len;    // Bytes before the request line's first space
+};
+
+#define HTTP_START(text, name, name_len) \
+    {prefix_bits(text, sizeof(text) - 1), prefix_mask(sizeof(text) - 1), name, name_len}
+
+constexpr HttpStart HTTP_STARTS[] = {
+    HTTP_START("GET ", "GET", 3),
+    HTTP_START("POST ", "POST", 4),
+    HTTP_START("PUT ", "PUT", 3),
+    HTTP_START("DELETE ", "DELETE", 6),
+    HTTP_START("HEAD ", "HEAD", 4),
+    HTTP_START("OPTIONS ", "OPTIONS", 7),
+    HTTP_START("PATCH ", "PATCH", 5),
+    HTTP_START("CONNECT ", "CONNECT", 7),
+    HTTP_START("HTTP/1.", "Response", 0),
+};
+
+#undef HTTP_START
+
+constexpr uint16_t TLS_EXT_SERVER_NAME = 0x0000;
+constexpr uint16_t TLS_EXT_SUPPORTED_GROUPS = 0x000a;
+constexpr uint16_t TLS_EXT_EC_POINT_FORMATS = 0x000b;
+constexpr uint16_t TLS_EXT_SIGNATURE_ALGORITHMS = 0x000d;
+constexpr uint16_t TLS_EXT_ALPN = 0x0010;
+constexpr uint16_t TLS_EXT_SUPPORTED_VERSIONS = 0x002b;
+
+uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// Big-endian 16-bit values filling len bytes (a trailing odd byte is ignored)
+void read_u16_list(const uint8_t* p, size_t len, std::vector<uint16_t>& out) {
+    for (size_t i = 0; i + 2 <= len; i += 2) {
+        out.push_back(read_u16(p + i));
+    }
+}
+
+}  // namespace
+
+size_t find_byte(const uint8_t* data, size_t len, uint8_t byte) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i needle32 = _mm256_set1_epi8(static_cast<char>(byte));
+    for (; i + 32 <= len; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        uint32_t hits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle32)));
+        if (hits) return i + __builtin_ctz(hits);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i needle16 = _mm_set1_epi8(static_cast<char>(byte));
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        uint32_t hits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle16)));
+        if (hits) return i + __builtin_ctz(hits);
+    }
+#endif
+    for (; i < len; ++i) {
+        if (data[i] == byte) return i;
+    }
+    return len;
+}
 
-    // Search for Host header
-    std::string content(reinterpret_cast<const char*>(data),
-                        std::min(len, static_cast<size_t>(2048)));
+// Parse an HTTP/1.x request or response head in place: the method from one
+// 8-byte load, then each CRLF-terminated line located with find_byte()
+bool parse_http_head(const uint8_t* data, size_t len, HttpHead& head) {
+    // Need at least some data for HTTP
+    if (len < 16) return false;
+
+    uint64_t first8;
+    std::memcpy(&first8, data, sizeof(first8));
+    const HttpStart* start = nullptr;
+    for (const HttpStart& candidate : HTTP_STARTS) {
+        if ((first8 & candidate.mask) == candidate.bits) {
+            start = &candidate;
+            break;
+        }
+    }
+    if (!start) return false;
 
-    // Look for Host: header (case-insensitive)
+    head = HttpHead();
+    head.response = start->name_len == 0;
+    head.method = start->name;
+    head.head_request = head.method == "HEAD";
+    bool first_line = true;
     size_t pos = 0;
-    while (pos < content.length()) {
-        size_t line_end = content.find("\r\n", pos);
-        if (line_end == std::string::npos) break;
-
-        std::string line = content.substr(pos, line_end - pos);
-
-        // Check for Host header
-        if (line.length() > 6) {
-            std::string header_name = line.substr(0, 5);
-            std::transform(header_name.begin(), header_name.end(),
-                           header_name.begin(), ::tolower);
-
-            if (header_name == "host:") {
-                size_t value_start = 5;
-                while (value_start < line.length() && line[value_start] == ' ') {
-                    value_start++;
+
+    while (pos < len) {
+        // Find the next CRLF; a bare CR does not end the line
+        size_t line_end = pos;
+        for (;;) {
+            line_end += find_byte(data + line_end, len - line_end, '\r');
+            if (line_end + 1 >= len || data[line_end + 1] == '\n') break;
+            ++line_end;
+        }
+        if (line_end + 1 >= len) break;  // Incomplete line
+        if (line_end == pos) {           // Blank line ends the head
+            head.length = pos + 2;
+            break;
+        }
+
+        const uint8_t* line = data + pos;
+        size_t line_len = line_end - pos;
+
+        if (first_line) {
+            first_line = false;
+            if (head.response) {
+                // "HTTP/1.x NNN reason"
+                if (line_len >= 12 && line[8] == ' ') {
+                    uint16_t status = 0;
+                    for (size_t i = 9; i < 12; ++i) {
+                        if (line[i] < '0' || line[i] > '9') {
+                            status = 0;
+                            break;
+                        }
+                        status = static_cast<uint16_t>(status * 10 + (line[i] - '0'));
+                    }
+                    head.status = status;
+                    head.target = header_value(line + 9, line + line_len);
                 }
-                info.hostname = line.substr(value_start);
-                // Remove port if present for cleaner display
-                size_t colon = info.hostname.find(':');
-                if (colon != std::string::npos) {
-                    info.hostname = info.hostname.substr(0, colon);
+            } else {
+                // Request path sits between the method and the last space
+                size_t path_start = start->name_len + 1;
+                size_t path_end = line_len;
+                while (path_end > path_start && line[path_end - 1] != ' ') --path_end;
+                if (path_end > path_start) {
+                    head.target = std::string_view(reinterpret_cast<const char*>(line + path_start),
+                                                   path_end - 1 - path_start);
+                }
+            }
+        } else {
+            size_t colon = find_byte(line, line_len, ':');
+            if (colon < line_len) {
+                const uint8_t* value = line + colon + 1;
+                const uint8_t* value_end = line + line_len;
+                if (header_name_is(line, colon, "host", 4)) {
+                    if (head.host.empty()) head.host = header_value(value, value_end);
+                } else if (header_name_is(line, colon, "user-agent", 10)) {
+                    if (head.user_agent.empty()) head.user_agent = header_value(value, value_end);
+                } else if (header_name_is(line, colon, "content-type", 12)) {
+                    if (head.content_type.empty()) head.content_type = header_value(value, value_end);
+                } else if (header_name_is(line, colon, "content-length", 14)) {
+                    head.content_length = parse_content_length(header_value(value, value_end));
+                } else if (header_name_is(line, colon, "transfer-encoding", 17)) {
+                    // Chunked is always the last coding applied
+                    std::string_view coding = header_value(value, value_end);
+                    head.chunked = coding.size() >= 7 &&
+                        header_name_is(reinterpret_cast<const uint8_t*>(coding.data()) +
+                                       coding.size() - 7, 7, "chunked", 7);
                 }
-                break;
             }
         }
 
         pos = line_end + 2;
+    }
+    return true;
+}
 
-        // Stop at end of headers
-        if (line.empty()) break;
-    }
-
-    // Also try to extract the path from the request line
-    if (method != "Response") {
-        size_t first_line_end = content.find("\r\n");
-        if (first_line_end != std::string::npos) {
-            std::string request_line = content.substr(0, first_line_end);
-            size_t path_start = request_line.find(' ');
-            size_t path_end = request_line.rfind(' ');
-            if (path_start != std::string::npos && path_end != std::string::npos
-                && path_start < path_end) {
-                std::string path = request_line.substr(path_start + 1,
-                                                       path_end - path_start - 1);
-                if (path.length() > 1 && path.length() < 50) {
-                    info.app_info = method + " " + path;
-                }
-            }
-        }
+void parse_http_request(PacketInfo& info, const uint8_t* data, size_t len) {
+    // Headers beyond the first 2 KB are not worth the scan
+    HttpHead head;
+    if (!parse_http_head(data, std::min(len, static_cast<size_t>(2048)), head)) {
+        return;
     }
+
+    info.app_protocol = "HTTP";
+    info.app_info = head.method;
+    if (head.target.size() > 1 && head.target.size() < 50) {
+        info.app_info += ' ';
+        info.app_info += head.target;
+    }
+    if (!head.host.empty()) {
+        // Remove port if present for cleaner display
+        info.hostname = head.host.substr(0, head.host.find(':'));
+    }
+    if (!head.user_agent.empty()) info.user_agent = head.user_agent;
+    if (!head.content_type.empty()) info.content_type = head.content_type;
+    info.http_status = head.status;
+    info.http_content_length = head.content_length;
 }
 
 // Parse TLS Client Hello to extract Server Name Indication (SNI)
@@ -292,7 +532,14 @@ void parse_tls_client_hello(PacketInfo& info, const uint8_t* data, size_t len) {
     if (data[0] != 0x16) return;
 
     // Skip record header
-    size_t pos = 5;
+    parse_client_hello(info, data + 5, len - 5);
+}
+
+// ClientHello handshake message, as carried in a TLS record or a QUIC
+// CRYPTO stream. The walk that finds the server name also collects the
+// fingerprint fields; the fingerprint is set only for a complete message.
+void parse_client_hello(PacketInfo& info, const uint8_t* data, size_t len) {
+    size_t pos = 0;
 
     // Handshake header: type(1) + length(3)
     if (pos + 4 > len) return;
@@ -303,16 +550,22 @@ void parse_tls_client_hello(PacketInfo& info, const uint8_t* data, size_t len) {
 
     // Client Hello: version(2) + random(32) + session_id_len(1)
     if (pos + 35 > len) return;
+    thread_local ClientHelloFields fields;  // Reused to keep vector capacity
+    fields.clear();
+    fields.transport = info.protocol == PROTO_UDP ? 'q' : 't';
+    fields.version = read_u16(data + pos);
     pos += 34;
 
     // Skip session ID
     uint8_t session_id_len = data[pos++];
     pos += session_id_len;
 
-    // Skip cipher suites
+    // Cipher suites
     if (pos + 2 > len) return;
-    uint16_t cipher_suites_len = (data[pos] << 8) | data[pos + 1];
-    pos += 2 + cipher_suites_len;
+    size_t ciphers_end = pos + 2 + read_u16(data + pos);
+    if (ciphers_end > len) return;
+    read_u16_list(data + pos + 2, ciphers_end - pos - 2, fields.ciphers);
+    pos = ciphers_end;
 
     // Skip compression methods
     if (pos + 1 > len) return;
@@ -321,49 +574,560 @@ void parse_tls_client_hello(PacketInfo& info, const uint8_t* data, size_t len) {
 
     // Extensions length
     if (pos + 2 > len) return;
-    uint16_t extensions_len = (data[pos] << 8) | data[pos + 1];
+    uint16_t extensions_len = read_u16(data + pos);
     pos += 2;
 
     size_t extensions_end = pos + extensions_len;
-    if (extensions_end > len) extensions_end = len;
+    bool complete = extensions_end <= len;
+    if (!complete) extensions_end = len;
 
-    // Parse extensions looking for SNI (type 0x0000)
     while (pos + 4 <= extensions_end) {
-        uint16_t ext_type = (data[pos] << 8) | data[pos + 1];
-        uint16_t ext_len = (data[pos + 2] << 8) | data[pos + 3];
+        uint16_t ext_type = read_u16(data + pos);
+        uint16_t ext_len = read_u16(data + pos + 2);
         pos += 4;
 
         if (pos + ext_len > extensions_end) break;
-
-        // SNI extension
-        if (ext_type == 0x0000 && ext_len >= 5) {
-            // SNI list length (2) + name type (1) + name length (2)
-            size_t sni_pos = pos + 2;  // Skip list length
-            if (sni_pos + 3 > pos + ext_len) break;
-
-            uint8_t name_type = data[sni_pos];
-            uint16_t name_len = (data[sni_pos + 1] << 8) | data[sni_pos + 2];
-            sni_pos += 3;
-
-            // Host name type is 0
-            if (name_type == 0 && sni_pos + name_len <= pos + ext_len) {
-                info.hostname = std::string(
-                    reinterpret_cast<const char*>(data + sni_pos), name_len);
-                info.app_protocol = "TLS";
-                info.app_info = "Client Hello";
-                return;
+        fields.extensions.push_back(ext_type);
+        const uint8_t* ext = data + pos;
+
+        switch (ext_type) {
+            case TLS_EXT_SERVER_NAME: {
+                // List length (2) + name type (1) + name length (2); host name type is 0
+                fields.has_sni = true;
+                if (ext_len < 5 || ext[2] != 0) break;
+                uint16_t name_len = read_u16(ext + 3);
+                if (5 + static_cast<size_t>(name_len) <= ext_len) {
+                    info.hostname = std::string(reinterpret_cast<const char*>(ext + 5), name_len);
+                }
+                break;
+            }
+            case TLS_EXT_SUPPORTED_GROUPS:
+                if (ext_len >= 2) {
+                    read_u16_list(ext + 2, std::min<size_t>(read_u16(ext), ext_len - 2), fields.groups);
+                }
+                break;
+            case TLS_EXT_EC_POINT_FORMATS:
+                if (ext_len >= 1 && ext[0] <= ext_len - 1) {
+                    fields.point_formats.assign(ext + 1, ext + 1 + ext[0]);
+                }
+                break;
+            case TLS_EXT_SIGNATURE_ALGORITHMS:
+                if (ext_len >= 2) {
+                    read_u16_list(ext + 2, std::min<size_t>(read_u16(ext), ext_len - 2),
+                                  fields.signature_algorithms);
+                }
+                break;
+            case TLS_EXT_ALPN:
+                // List length (2) + first protocol length (1) + protocol
+                if (ext_len >= 3 && 3 + static_cast<size_t>(ext[2]) <= ext_len) {
+                    fields.alpn.assign(reinterpret_cast<const char*>(ext + 3), ext[2]);
+                }
+                break;
+            case TLS_EXT_SUPPORTED_VERSIONS: {
+                // List length (1) + versions
+                size_t list_end = ext_len >= 1 ? std::min<size_t>(1 + ext[0], ext_len) : 0;
+                for (size_t i = 1; i + 2 <= list_end; i += 2) {
+                    uint16_t version = read_u16(ext + i);
+                    if (!is_grease(version) && version > fields.supported_version) {
+                        fields.supported_version = version;
+                    }
+                }
+                break;
             }
         }
 
         pos += ext_len;
     }
+
+    if (!info.hostname.empty() || (complete && pos == extensions_end)) {
+        info.app_protocol = "TLS";
+        info.app_info = "Client Hello";
+    }
+    if (complete && pos == extensions_end) {
+        info.tls_fingerprint = intern_tls_fingerprint(fields);
+    }
 }
 
-PacketInfo parse_packet(const uint8_t* data, uint32_t caplen, uint32_t len) {
+namespace {
+
+// ---- Network layer (keyed by EtherType) ----
+
+bool dissect_arp(PacketInfo& info, DissectCursor& cursor) {
+    if (cursor.remaining >= sizeof(ARPHeader)) {
+        const auto* arp = reinterpret_cast<const ARPHeader*>(cursor.pos);
+        char src_str[INET_ADDRSTRLEN], dst_str[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, arp->sender_ip, src_str, sizeof(src_str));
+        inet_ntop(AF_INET, arp->target_ip, dst_str, sizeof(dst_str));
+        info.src_ip = src_str;
+        info.dst_ip = dst_str;
+        std::memcpy(info.src_addr.data(), arp->sender_ip, 4);
+        std::memcpy(info.dst_addr.data(), arp->target_ip, 4);
+    }
+    return false;
+}
+
+bool dissect_ipv4(PacketInfo& info, DissectCursor& cursor) {
+    if (cursor.remaining < sizeof(IPv4Header)) {
+        return false;
+    }
+
+    const auto* ip = reinterpret_cast<const IPv4Header*>(cursor.pos);
+    info.ip_version = 4;
+    info.protocol = ip->protocol;
+    info.ttl = ip->ttl;
+
+    char src_str[INET_ADDRSTRLEN], dst_str[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &ip->src_addr, src_str, sizeof(src_str));
+    inet_ntop(AF_INET, &ip->dst_addr, dst_str, sizeof(dst_str));
+    info.src_ip = src_str;
+    info.dst_ip = dst_str;
+    std::memcpy(info.src_addr.data(), &ip->src_addr, 4);
+    std::memcpy(info.dst_addr.data(), &ip->dst_addr, 4);
+
+    size_t ip_hdr_len = (ip->version_ihl & 0x0F) * 4;
+    if (ip_hdr_len > cursor.remaining) {
+        return false;
+    }
+
+    cursor.pos += ip_hdr_len;
+    cursor.remaining -= ip_hdr_len;
+
+    // Drop Ethernet padding; a zero length (TSO captures) is left alone
+    size_t total_length = ntohs(ip->total_length);
+    if (total_length >= ip_hdr_len && total_length - ip_hdr_len < cursor.remaining) {
+        cursor.remaining = total_length - ip_hdr_len;
+    }
+
+    uint16_t flags_fragment = ntohs(ip->flags_fragment);
+    info.fragment_id = ntohs(ip->identification);
+    info.fragment_offset = static_cast<uint16_t>((flags_fragment & 0x1FFF) * 8);
+    info.more_fragments = (flags_fragment & 0x2000) != 0;
+    return true;
+}
+
+bool dissect_ipv6(PacketInfo& info, DissectCursor& cursor) {
+    if (cursor.remaining < sizeof(IPv6Header)) {
+        return false;
+    }
+
+    const auto* ip6 = reinterpret_cast<const IPv6Header*>(cursor.pos);
+    info.ip_version = 6;
+    info.protocol = ip6->next_header;
+    info.ttl = ip6->hop_limit;
+
+    char src_str[INET6_ADDRSTRLEN], dst_str[INET6_ADDRSTRLEN];
+    inet_ntop(AF_INET6, ip6->src_addr, src_str, sizeof(src_str));
+    inet_ntop(AF_INET6, ip6->dst_addr, dst_str, sizeof(dst_str));
+    info.src_ip = src_str;
+    info.dst_ip = dst_str;
+    std::memcpy(info.src_addr.data(), ip6->src_addr, 16);
+    std::memcpy(info.dst_addr.data(), ip6->dst_addr, 16);
+
+    const uint8_t* payload = cursor.pos + sizeof(IPv6Header);
+    size_t remaining = cursor.remaining - sizeof(IPv6Header);
+
+    size_t payload_length = ntohs(ip6->payload_length);
+    if (payload_length != 0 && payload_length < remaining) {
+        remaining = payload_length;
+    }
+
+    // Skip extension headers to reach the upper-layer protocol
+    for (int i = 0; i < IPV6_MAX_EXTENSION_HEADERS; ++i) {
+        size_t ext_len;
+        if (info.protocol == IPV6_EXT_FRAGMENT) {
+            if (remaining < 8) return false;
+            uint16_t offset_flags = (payload[2] << 8) | payload[3];
+            info.fragment_offset = offset_flags & 0xFFF8;
+            info.more_fragments = (offset_flags & 0x0001) != 0;
+            info.fragment_id = (static_cast<uint32_t>(payload[4]) << 24) |
+                               (payload[5] << 16) | (payload[6] << 8) | payload[7];
+            ext_len = 8;
+        } else if (info.protocol == IPV6_EXT_HOP_BY_HOP || info.protocol == IPV6_EXT_ROUTING ||
+                   info.protocol == IPV6_EXT_DEST_OPTS) {
+            if (remaining < 2) return false;
+            ext_len = (payload[1] + 1) * 8;
+        } else if (info.protocol == IPV6_EXT_AUTH) {
+            if (remaining < 2) return false;
+            ext_len = (payload[1] + 2) * 4;
+        } else {
+            break;
+        }
+        if (ext_len > remaining) return false;
+        info.protocol = payload[0];
+        payload += ext_len;
+        remaining -= ext_len;
+
+        // Headers after a real fragment header belong to the fragmentable
+        // part; they are walked once the datagram is reassembled
+        if (info.is_fragment()) break;
+    }
+
+    cursor.pos = payload;
+    cursor.remaining = remaining;
+    return true;
+}
+
+// ---- Transport layer (keyed by IP protocol) ----
+
+bool dissect_tcp(PacketInfo& info, DissectCursor& cursor) {
+    if (cursor.remaining < sizeof(TCPHeader)) {
+        return false;
+    }
+
+    const auto* tcp = reinterpret_cast<const TCPHeader*>(cursor.pos);
+    info.src_port = ntohs(tcp->src_port);
+    info.dst_port = ntohs(tcp->dst_port);
+    info.tcp_flags = tcp->flags;
+    info.tcp_seq = ntohl(tcp->seq_num);
+    info.tcp_ack = ntohl(tcp->ack_num);
+    info.tcp_window = ntohs(tcp->window);
+
+    size_t tcp_hdr_len = ((tcp->data_offset >> 4) & 0x0F) * 4;
+    if (tcp_hdr_len > cursor.remaining) {
+        return false;
+    }
+    cursor.pos += tcp_hdr_len;
+    cursor.remaining -= tcp_hdr_len;
+    return true;
+}
+
+bool dissect_udp(PacketInfo& info, DissectCursor& cursor) {
+    if (cursor.remaining < sizeof(UDPHeader)) {
+        return false;
+    }
+
+    const auto* udp = reinterpret_cast<const UDPHeader*>(cursor.pos);
+    info.src_port = ntohs(udp->src_port);
+    info.dst_port = ntohs(udp->dst_port);
+    cursor.pos += sizeof(UDPHeader);
+    cursor.remaining -= sizeof(UDPHeader);
+    return true;
+}
+
+// ---- Encapsulations ----
+
+uint16_t ether_type_from_ip_version(const uint8_t* data, size_t len) {
+    if (len == 0) return 0;
+    switch (data[0] >> 4) {
+        case 4: return ETHERTYPE_IPV4;
+        case 6: return ETHERTYPE_IPV6;
+        default: return 0;
+    }
+}
+
+uint32_t read_u24(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 16) | (p[1] << 8) | p[2];
+}
+
+// Appended outermost first, so nested tunnels read left to right
+void add_encapsulation(PacketInfo& info, const char* name, const uint32_t* id = nullptr) {
+    std::string& out = info.tunnel.encapsulation;
+    if (!out.empty()) out += " / ";
+    out += name;
+    if (id) {
+        out += ' ';
+        out += std::to_string(*id);
+    }
+}
+
+// MPLS label stack (RFC 3032); the payload type is not signalled, so the
+// IP version nibble after the bottom label decides
+bool dissect_mpls(PacketInfo& info, DissectCursor& cursor) {
+    size_t pos = 0;
+    for (;;) {
+        if (pos + 4 > cursor.remaining) return false;
+        if (cursor.pos[pos + 2] & 0x01) break;  // Bottom of stack
+        pos += 4;
+    }
+    uint32_t label = read_u24(cursor.pos) >> 4;
+    uint16_t inner = ether_type_from_ip_version(cursor.pos + pos + 4, cursor.remaining - pos - 4);
+    if (inner == 0) return false;
+    add_encapsulation(info, "MPLS", &label);
+    cursor.pos += pos + 4;
+    cursor.remaining -= pos + 4;
+    cursor.inner = inner;
+    return true;
+}
+
+bool dissect_ip_in_ip(PacketInfo& info, DissectCursor& cursor) {
+    add_encapsulation(info, "IP-in-IP");
+    cursor.inner = info.protocol == PROTO_IPIP ? ETHERTYPE_IPV4 : ETHERTYPE_IPV6;
+    return true;
+}
+
+// GRE version 0 (RFC 2784/2890): optional checksum, key and sequence words
+bool dissect_gre(PacketInfo& info, DissectCursor& cursor) {
+    if (cursor.remaining < 4) return false;
+    const uint8_t* p = cursor.pos;
+    uint16_t flags = read_u16(p);
+    if (flags & 0x0007) return false;  // Version 1 is PPTP
+    size_t len = 4;
+    if (flags & 0x8000) len += 4;
+    bool has_key = flags & 0x2000;
+    size_t key_pos = len;
+    if (has_key) len += 4;
+    if (flags & 0x1000) len += 4;
+    if (len > cursor.remaining) return false;
+
+    uint16_t protocol = read_u16(p + 2);
+    if (has_key) {
+        uint32_t key = (read_u24(p + key_pos) << 8) | p[key_pos + 3];
+        add_encapsulation(info, "GRE", &key);
+    } else {
+        add_encapsulation(info, "GRE");
+    }
+    cursor.pos += len;
+    cursor.remaining -= len;
+    cursor.inner = protocol;
+    return true;
+}
+
+// VXLAN (RFC 7348): flags with the VNI-valid bit, VNI, always Ethernet inside
+bool dissect_vxlan(PacketInfo& info, DissectCursor& cursor) {
+    if (cursor.remaining < 8 || !(cursor.pos[0] & 0x08)) return false;
+    uint32_t vni = read_u24(cursor.pos + 4);
+    add_encapsulation(info, "VXLAN", &vni);
+    cursor.pos += 8;
+    cursor.remaining -= 8;
+    cursor.inner = ETHERTYPE_TEB;
+    return true;
+}
+
+// GENEVE (RFC 8926): variable-length options, protocol type like GRE
+bool dissect_geneve(PacketInfo& info, DissectCursor& cursor) {
+    if (cursor.remaining < 8 || (cursor.pos[0] >> 6) != 0) return false;
+    size_t len = 8 + (cursor.pos[0] & 0x3F) * 4;
+    if (len > cursor.remaining) return false;
+    uint32_t vni = read_u24(cursor.pos + 4);
+    uint16_t protocol = read_u16(cursor.pos + 2);
+    add_encapsulation(info, "GENEVE", &vni);
+    cursor.pos += len;
+    cursor.remaining -= len;
+    cursor.inner = protocol;
+    return true;
+}
+
+// ---- Heuristics for unregistered ports ----
+
+// TLS handshake record holding a ClientHello, e.g. HTTPS on 8443
+bool heuristic_tls(PacketInfo& info, const uint8_t* data, size_t len) {
+    if (len < 6 || data[0] != 0x16 || data[1] != 0x03 || data[5] != 0x01) {
+        return false;
+    }
+    parse_tls_client_hello(info, data, len);
+    return true;
+}
+
+// HTTP/1.x request or status line, e.g. proxies on 8080
+bool heuristic_http(PacketInfo& info, const uint8_t* data, size_t len) {
+    parse_http_request(info, data, len);
+    return !info.app_protocol.empty();
+}
+
+// ---- Registrations ----
+
+constexpr LayerRegistration NETWORK_DISSECTORS[] = {
+    {ETHERTYPE_IPV4, dissect_ipv4},
+    {ETHERTYPE_ARP, dissect_arp},
+    {ETHERTYPE_IPV6, dissect_ipv6},
+    {ETHERTYPE_MPLS, dissect_mpls},
+    {ETHERTYPE_MPLS_MULTICAST, dissect_mpls},
+};
+
+constexpr LayerRegistration TRANSPORT_DISSECTORS[] = {
+    {PROTO_TCP, dissect_tcp},
+    {PROTO_UDP, dissect_udp},
+    {PROTO_IPIP, dissect_ip_in_ip},
+    {PROTO_IPV6_ENCAP, dissect_ip_in_ip},
+    {PROTO_GRE, dissect_gre},
+};
+
+// UDP encapsulations, keyed by destination port
+constexpr LayerRegistration UDP_TUNNEL_DISSECTORS[] = {
+    {PORT_VXLAN, dissect_vxlan},
+    {PORT_GENEVE, dissect_geneve},
+};
+
+// Priority order. QUIC has no record layer to detect, so UDP/443 is
+// classified from its header and decrypted later by QuicDissector.
+constexpr PortRegistration PORT_DISSECTORS[] = {
+    {AppDissector::DNS, PROTO_UDP, PORT_DNS, PortMatch::EITHER, parse_dns_query},
+    {AppDissector::DNS, PROTO_TCP, PORT_DNS, PortMatch::EITHER, parse_dns_query},
+    {AppDissector::HTTP, PROTO_TCP, PORT_HTTP, PortMatch::EITHER, parse_http_request},
+    {AppDissector::QUIC, PROTO_UDP, PORT_HTTPS, PortMatch::EITHER, parse_quic},
+    {AppDissector::TLS, PROTO_TCP, PORT_HTTPS, PortMatch::DST, parse_tls_client_hello},
+};
+
+constexpr HeuristicRegistration HEURISTIC_DISSECTORS[] = {
+    {PROTO_TCP, heuristic_tls},
+    {PROTO_TCP, heuristic_http},
+};
+
+constexpr auto NETWORK_TABLE = make_layer_table<65536>(NETWORK_DISSECTORS);
+constexpr auto TRANSPORT_TABLE = make_layer_table<256>(TRANSPORT_DISSECTORS);
+constexpr auto UDP_TUNNEL_TABLE = make_layer_table<65536>(UDP_TUNNEL_DISSECTORS);
+constexpr auto TCP_PORT_TABLE = make_port_table(PORT_DISSECTORS, PROTO_TCP);
+constexpr auto UDP_PORT_TABLE = make_port_table(PORT_DISSECTORS, PROTO_UDP);
+
+// Registration index + 1 for the packet's ports, 0 if neither is registered
+uint8_t port_slot(const PacketInfo& info) {
+    const DispatchTable<65536>* table;
+    if (info.protocol == PROTO_TCP) {
+        table = &TCP_PORT_TABLE;
+    } else if (info.protocol == PROTO_UDP) {
+        table = &UDP_PORT_TABLE;
+    } else {
+        return 0;
+    }
+
+    uint8_t by_dst = (*table)[info.dst_port];
+    uint8_t by_src = (*table)[info.src_port];
+    if (by_src != 0 && PORT_DISSECTORS[by_src - 1].match == PortMatch::DST) {
+        by_src = 0;
+    }
+    if (by_dst == 0 || (by_src != 0 && by_src < by_dst)) {
+        return by_src;
+    }
+    return by_dst;
+}
+
+
+// ---- Link layer (resolved once per capture) ----
+
+constexpr size_t SLL_HEADER_LEN = 16;
+constexpr size_t SLL2_HEADER_LEN = 20;
+constexpr uint16_t PPP_IPV4 = 0x0021;
+constexpr uint16_t PPP_IPV6 = 0x0057;
+
+// Source link-layer address of a cooked header, when it is a MAC
+void copy_sll_address(PacketInfo& info, const uint8_t* addr, uint16_t addr_len) {
+    if (addr_len == 6) {
+        std::copy(addr, addr + 6, info.src_mac.begin());
+    }
+}
+
+// Fill the link fields and step the cursor past the link header; ether_type
+// selects the network dissector
+template <LinkType Link>
+bool dissect_link(PacketInfo& info, DissectCursor& cursor) {
+    const uint8_t* p = cursor.pos;
+    size_t header_len;
+
+    if constexpr (Link == LinkType::ETHERNET) {
+        if (cursor.remaining < sizeof(EthernetHeader)) return false;
+        const auto* eth = reinterpret_cast<const EthernetHeader*>(p);
+        std::copy(eth->src_mac, eth->src_mac + 6, info.src_mac.begin());
+        std::copy(eth->dst_mac, eth->dst_mac + 6, info.dst_mac.begin());
+        info.ether_type = ntohs(eth->ether_type);
+        header_len = sizeof(EthernetHeader);
+    } else if constexpr (Link == LinkType::LINUX_SLL) {
+        // Packet type(2), ARPHRD(2), address length(2), address(8), protocol(2)
+        if (cursor.remaining < SLL_HEADER_LEN) return false;
+        copy_sll_address(info, p + 6, read_u16(p + 4));
+        info.ether_type = read_u16(p + 14);
+        header_len = SLL_HEADER_LEN;
+    } else if constexpr (Link == LinkType::LINUX_SLL2) {
+        // Protocol(2), reserved(2), ifindex(4), ARPHRD(2), packet type(1),
+        // address length(1), address(8)
+        if (cursor.remaining < SLL2_HEADER_LEN) return false;
+        info.ether_type = read_u16(p);
+        copy_sll_address(info, p + 12, p[11]);
+        header_len = SLL2_HEADER_LEN;
+    } else if constexpr (Link == LinkType::LOOPBACK) {
+        // 4-byte address family; DLT_NULL uses the sender's byte order, and
+        // every family fits in the low 16 bits
+        if (cursor.remaining < 4) return false;
+        uint32_t family = (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        if (family & 0xFFFF0000) family = __builtin_bswap32(family);
+        header_len = 4;
+        switch (family) {
+            case 2:                                      // AF_INET everywhere
+                info.ether_type = ETHERTYPE_IPV4;
+                break;
+            case 10: case 24: case 28: case 30:          // AF_INET6: Linux, BSDs, Darwin
+                info.ether_type = ETHERTYPE_IPV6;
+                break;
+            default:
+                info.ether_type = 0;
+                break;
+        }
+    } else if constexpr (Link == LinkType::PPP) {
+        // HDLC address/control bytes are optional; protocol is 1 or 2 bytes
+        size_t pos = 0;
+        if (cursor.remaining >= 2 && p[0] == 0xFF && p[1] == 0x03) pos = 2;
+        if (pos >= cursor.remaining) return false;
+        uint16_t protocol;
+        if (p[pos] & 0x01) {
+            protocol = p[pos++];
+        } else {
+            if (pos + 2 > cursor.remaining) return false;
+            protocol = read_u16(p + pos);
+            pos += 2;
+        }
+        info.ether_type = protocol == PPP_IPV4 ? ETHERTYPE_IPV4 :
+                          protocol == PPP_IPV6 ? ETHERTYPE_IPV6 : 0;
+        header_len = pos;
+    } else if constexpr (Link == LinkType::RAW) {
+        info.ether_type = ether_type_from_ip_version(p, cursor.remaining);
+        header_len = 0;
+    } else {
+        return false;
+    }
+
+    cursor.pos += header_len;
+    cursor.remaining -= header_len;
+    return true;
+}
+
+// Step into the packet an encapsulation handed back: the outermost
+// addressing is kept in info.tunnel, and the layers the inner packet fills
+// in again are cleared. Fragments wait for IpReassembler instead, and a
+// payload no dissector understands leaves the outer packet as it was.
+bool enter_tunnel(PacketInfo& info, DissectCursor& cursor) {
+    TunnelInfo& tunnel = info.tunnel;
+    if (tunnel.depth >= MAX_TUNNEL_DEPTH || info.is_fragment() ||
+        (cursor.inner != ETHERTYPE_TEB && NETWORK_TABLE[cursor.inner] == 0)) {
+        size_t last = tunnel.encapsulation.rfind(" / ");
+        tunnel.encapsulation.resize(last == std::string::npos ? 0 : last);
+        return false;
+    }
+    if (tunnel.depth == 0) {
+        tunnel.ip_version = info.ip_version;
+        tunnel.src_ip = std::move(info.src_ip);
+        tunnel.dst_ip = std::move(info.dst_ip);
+        tunnel.protocol = info.protocol;
+        tunnel.src_port = info.src_port;
+        tunnel.dst_port = info.dst_port;
+    }
+    tunnel.depth++;
+
+    info.ip_version = 0;
+    info.src_ip.clear();
+    info.dst_ip.clear();
+    info.src_addr = {};
+    info.dst_addr = {};
+    info.protocol = 0;
+    info.ttl = 0;
+    info.src_port = 0;
+    info.dst_port = 0;
+    info.ip_payload_offset = 0;
+    info.ip_payload_length = 0;
+
+    info.ether_type = cursor.inner;
+    cursor.inner = 0;
+    if (info.ether_type == ETHERTYPE_TEB) {
+        return dissect_link<LinkType::ETHERNET>(info, cursor);
+    }
+    return true;
+}
+
+template <LinkType Link>
+PacketInfo parse_frame(const uint8_t* data, uint32_t caplen, uint32_t len) {
     PacketInfo info{};
     info.timestamp = std::chrono::system_clock::now();
     info.length = caplen;
     info.original_length = len;
+    info.link_type = Link;
     info.ip_version = 0;
     info.protocol = 0;
     info.src_port = 0;
@@ -374,136 +1138,214 @@ PacketInfo parse_packet(const uint8_t* data, uint32_t caplen, uint32_t len) {
     // Store raw data
     info.raw_data.assign(data, data + caplen);
 
-    // Need at least Ethernet header
-    if (caplen < sizeof(EthernetHeader)) {
+    DissectCursor cursor{data, caplen};
+    if (!dissect_link<Link>(info, cursor)) {
         return info;
     }
 
-    // Parse Ethernet
-    const auto* eth = reinterpret_cast<const EthernetHeader*>(data);
-    std::copy(eth->src_mac, eth->src_mac + 6, info.src_mac.begin());
-    std::copy(eth->dst_mac, eth->dst_mac + 6, info.dst_mac.begin());
-    info.ether_type = ntohs(eth->ether_type);
+    // Once per encapsulation layer, until a packet that is not a tunnel
+    for (;;) {
+        // Handle VLAN tags (802.1Q)
+        while (info.ether_type == 0x8100 && cursor.remaining >= 4) {
+            info.ether_type = ntohs(*reinterpret_cast<const uint16_t*>(cursor.pos + 2));
+            cursor.pos += 4;
+            cursor.remaining -= 4;
+        }
 
-    const uint8_t* payload = data + sizeof(EthernetHeader);
-    size_t remaining = caplen - sizeof(EthernetHeader);
+        // ARP, IPv4, IPv6, MPLS
+        info.ip_offset = static_cast<uint32_t>(cursor.pos - data);
+        uint8_t network = NETWORK_TABLE[info.ether_type];
+        if (network == 0 || !NETWORK_DISSECTORS[network - 1].dissect(info, cursor)) {
+            return info;
+        }
+        if (cursor.inner != 0) {
+            if (!enter_tunnel(info, cursor)) return info;
+            continue;
+        }
 
-    // Handle VLAN tags (802.1Q)
-    while (info.ether_type == 0x8100 && remaining >= 4) {
-        info.ether_type = ntohs(*reinterpret_cast<const uint16_t*>(payload + 2));
-        payload += 4;
-        remaining -= 4;
-    }
+        info.ip_payload_offset = static_cast<uint32_t>(cursor.pos - data);
+        info.ip_payload_length = static_cast<uint32_t>(cursor.remaining);
 
-    // Parse ARP
-    if (info.ether_type == ETHERTYPE_ARP) {
-        if (remaining >= sizeof(ARPHeader)) {
-            const auto* arp = reinterpret_cast<const ARPHeader*>(payload);
-            char src_str[INET_ADDRSTRLEN], dst_str[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, arp->sender_ip, src_str, sizeof(src_str));
-            inet_ntop(AF_INET, arp->target_ip, dst_str, sizeof(dst_str));
-            info.src_ip = src_str;
-            info.dst_ip = dst_str;
+        // Only the first fragment carries the transport header
+        if (info.fragment_offset != 0) {
+            return info;
         }
-        return info;
-    }
 
-    // Parse IPv4
-    if (info.ether_type == ETHERTYPE_IPV4) {
-        if (remaining < sizeof(IPv4Header)) {
+        // TCP, UDP, GRE, IP-in-IP
+        uint8_t transport = TRANSPORT_TABLE[info.protocol];
+        if (transport == 0 || !TRANSPORT_DISSECTORS[transport - 1].dissect(info, cursor)) {
             return info;
         }
 
-        const auto* ip = reinterpret_cast<const IPv4Header*>(payload);
-        info.ip_version = 4;
-        info.protocol = ip->protocol;
-        info.ttl = ip->ttl;
+        // VXLAN, GENEVE
+        if (info.protocol == PROTO_UDP) {
+            uint8_t tunnel = UDP_TUNNEL_TABLE[info.dst_port];
+            if (tunnel != 0) {
+                UDP_TUNNEL_DISSECTORS[tunnel - 1].dissect(info, cursor);
+            }
+        }
 
-        char src_str[INET_ADDRSTRLEN], dst_str[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &ip->src_addr, src_str, sizeof(src_str));
-        inet_ntop(AF_INET, &ip->dst_addr, dst_str, sizeof(dst_str));
-        info.src_ip = src_str;
-        info.dst_ip = dst_str;
+        if (cursor.inner == 0) break;
+        if (!enter_tunnel(info, cursor)) return info;
+    }
 
-        size_t ip_hdr_len = (ip->version_ihl & 0x0F) * 4;
-        if (ip_hdr_len > remaining) {
-            return info;
-        }
+    // Parse application layer protocols
+    if (cursor.remaining > 0) {
+        info.payload_offset = static_cast<uint32_t>(cursor.pos - data);
+        info.payload_length = static_cast<uint32_t>(cursor.remaining);
+        parse_application(info, cursor.pos, cursor.remaining);
+    }
+
+    return info;
+}
 
-        payload += ip_hdr_len;
-        remaining -= ip_hdr_len;
+}  // namespace
+
+AppDissector find_app_dissector(const PacketInfo& info) {
+    uint8_t slot = port_slot(info);
+    return slot ? PORT_DISSECTORS[slot - 1].id : AppDissector::NONE;
+}
+
+PacketInfo parse_packet(const uint8_t* data, uint32_t caplen, uint32_t len) {
+    return parse_frame<LinkType::ETHERNET>(data, caplen, len);
+}
+
+PacketParser packet_parser(LinkType link) {
+    switch (link) {
+        case LinkType::ETHERNET: return parse_frame<LinkType::ETHERNET>;
+        case LinkType::LINUX_SLL: return parse_frame<LinkType::LINUX_SLL>;
+        case LinkType::LINUX_SLL2: return parse_frame<LinkType::LINUX_SLL2>;
+        case LinkType::LOOPBACK: return parse_frame<LinkType::LOOPBACK>;
+        case LinkType::PPP: return parse_frame<LinkType::PPP>;
+        case LinkType::RAW: return parse_frame<LinkType::RAW>;
+        case LinkType::UNSUPPORTED: break;
     }
-    // Parse IPv6
-    else if (info.ether_type == ETHERTYPE_IPV6) {
-        if (remaining < sizeof(IPv6Header)) {
-            return info;
-        }
+    return parse_frame<LinkType::UNSUPPORTED>;
+}
 
-        const auto* ip6 = reinterpret_cast<const IPv6Header*>(payload);
-        info.ip_version = 6;
-        info.protocol = ip6->next_header;
-        info.ttl = ip6->hop_limit;
+LinkType link_type_from_dlt(int dlt) {
+    // DLT_* values from pcap/dlt.h, kept literal so pcap.h is not needed here
+    switch (dlt) {
+        case 1: return LinkType::ETHERNET;                     // DLT_EN10MB
+        case 113: return LinkType::LINUX_SLL;                  // DLT_LINUX_SLL
+        case 276: return LinkType::LINUX_SLL2;                 // DLT_LINUX_SLL2
+        case 0: case 108: return LinkType::LOOPBACK;           // DLT_NULL, DLT_LOOP
+        case 9: case 50: return LinkType::PPP;                 // DLT_PPP, DLT_PPP_SERIAL
+        case 12: case 14: case 228: case 229: return LinkType::RAW;  // DLT_RAW, DLT_IPV4/6
+        default: return LinkType::UNSUPPORTED;
+    }
+}
 
-        char src_str[INET6_ADDRSTRLEN], dst_str[INET6_ADDRSTRLEN];
-        inet_ntop(AF_INET6, ip6->src_addr, src_str, sizeof(src_str));
-        inet_ntop(AF_INET6, ip6->dst_addr, dst_str, sizeof(dst_str));
-        info.src_ip = src_str;
-        info.dst_ip = dst_str;
+const char* link_type_name(LinkType link) {
+    switch (link) {
+        case LinkType::ETHERNET: return "Ethernet";
+        case LinkType::LINUX_SLL: return "Linux cooked";
+        case LinkType::LINUX_SLL2: return "Linux cooked v2";
+        case LinkType::LOOPBACK: return "Loopback";
+        case LinkType::PPP: return "PPP";
+        case LinkType::RAW: return "Raw IP";
+        case LinkType::UNSUPPORTED: break;
+    }
+    return "Unsupported";
+}
 
-        payload += sizeof(IPv6Header);
-        remaining -= sizeof(IPv6Header);
+bool read_quic_varint(const uint8_t* data, size_t len, size_t& pos, uint64_t& value) {
+    if (pos >= len) return false;
+    size_t size = size_t{1} << (data[pos] >> 6);
+    if (pos + size > len) return false;
+    value = data[pos] & 0x3F;
+    for (size_t i = 1; i < size; ++i) {
+        value = (value << 8) | data[pos + i];
     }
-    else {
-        return info;
+    pos += size;
+    return true;
+}
+
+bool parse_quic_long_header(const uint8_t* data, size_t len, QuicLongHeader& header) {
+    // Form bit, then version and the two connection IDs
+    if (len < 7 || !(data[0] & 0x80)) return false;
+    header.version = (static_cast<uint32_t>(data[1]) << 24) | (data[2] << 16) |
+                     (data[3] << 8) | data[4];
+    size_t pos = 5;
+    header.dcid_len = data[pos++];
+    if (header.dcid_len > header.dcid.size() || pos + header.dcid_len + 1 > len) return false;
+    std::memcpy(header.dcid.data(), data + pos, header.dcid_len);
+    pos += header.dcid_len;
+    header.scid_len = data[pos++];
+    if (header.scid_len > header.scid.size() || pos + header.scid_len > len) return false;
+    std::memcpy(header.scid.data(), data + pos, header.scid_len);
+    pos += header.scid_len;
+
+    if (header.version == 0) {
+        header.type = QuicPacketType::VERSION_NEGOTIATION;
+        return true;
     }
 
-    // Track application layer payload for later parsing
-    const uint8_t* app_payload = nullptr;
-    size_t app_remaining = 0;
+    // QUIC v2 rotates the type codes (RFC 9369 section 3.2)
+    uint8_t bits = (data[0] >> 4) & 0x03;
+    if (header.version == QUIC_VERSION_2) bits = (bits + 3) & 0x03;
+    static constexpr QuicPacketType TYPES[] = {
+        QuicPacketType::INITIAL, QuicPacketType::ZERO_RTT,
+        QuicPacketType::HANDSHAKE, QuicPacketType::RETRY
+    };
+    header.type = TYPES[bits];
+    if (header.type == QuicPacketType::RETRY) {
+        return true;
+    }
 
-    // Parse TCP
-    if (info.protocol == PROTO_TCP) {
-        if (remaining >= sizeof(TCPHeader)) {
-            const auto* tcp = reinterpret_cast<const TCPHeader*>(payload);
-            info.src_port = ntohs(tcp->src_port);
-            info.dst_port = ntohs(tcp->dst_port);
-            info.tcp_flags = tcp->flags;
-
-            // Calculate TCP header length and get payload
-            size_t tcp_hdr_len = ((tcp->data_offset >> 4) & 0x0F) * 4;
-            if (tcp_hdr_len <= remaining) {
-                app_payload = payload + tcp_hdr_len;
-                app_remaining = remaining - tcp_hdr_len;
-            }
-        }
+    uint64_t value = 0;
+    if (header.type == QuicPacketType::INITIAL) {
+        if (!read_quic_varint(data, len, pos, value) || value > len - pos) return false;
+        pos += value;  // Token
     }
-    // Parse UDP
-    else if (info.protocol == PROTO_UDP) {
-        if (remaining >= sizeof(UDPHeader)) {
-            const auto* udp = reinterpret_cast<const UDPHeader*>(payload);
-            info.src_port = ntohs(udp->src_port);
-            info.dst_port = ntohs(udp->dst_port);
+    if (!read_quic_varint(data, len, pos, value)) return false;
+    header.pn_offset = pos;
+    header.length = value;
+    return true;
+}
 
-            app_payload = payload + sizeof(UDPHeader);
-            app_remaining = remaining - sizeof(UDPHeader);
-        }
+// Classify a UDP/443 datagram from its first QUIC header; decryption of
+// Initial packets is left to QuicDissector
+void parse_quic(PacketInfo& info, const uint8_t* data, size_t len) {
+    if (len < 1 || !(data[0] & 0x40 || data[0] & 0x80)) return;
+
+    if (!(data[0] & 0x80)) {
+        info.app_protocol = "QUIC";
+        info.app_info = "1-RTT";
+        return;
     }
 
-    // Parse application layer protocols
-    if (app_payload && app_remaining > 0) {
-        // DNS (port 53)
-        if (info.src_port == PORT_DNS || info.dst_port == PORT_DNS) {
-            parse_dns_query(info, app_payload, app_remaining);
-        }
-        // HTTP (port 80)
-        else if (info.src_port == PORT_HTTP || info.dst_port == PORT_HTTP) {
-            parse_http_request(info, app_payload, app_remaining);
-        }
-        // HTTPS/TLS (port 443) - extract SNI from Client Hello
-        else if (info.dst_port == PORT_HTTPS) {
-            parse_tls_client_hello(info, app_payload, app_remaining);
-        }
+    QuicLongHeader header;
+    if (!parse_quic_long_header(data, len, header)) return;
+    info.app_protocol = "QUIC";
+    switch (header.type) {
+        case QuicPacketType::INITIAL: info.app_info = "Initial"; break;
+        case QuicPacketType::ZERO_RTT: info.app_info = "0-RTT"; break;
+        case QuicPacketType::HANDSHAKE: info.app_info = "Handshake"; break;
+        case QuicPacketType::RETRY: info.app_info = "Retry"; break;
+        case QuicPacketType::VERSION_NEGOTIATION: info.app_info = "Version Negotiation"; return;
     }
+    if (header.version == QUIC_VERSION_1) {
+        info.app_info += " v1";
+    } else if (header.version == QUIC_VERSION_2) {
+        info.app_info += " v2";
+    } else {
+        char version[16];
+        std::snprintf(version, sizeof(version), " 0x%08x", header.version);
+        info.app_info += version;
+    }
+}
 
-    return info;
+void parse_application(PacketInfo& info, const uint8_t* payload, size_t len) {
+    uint8_t slot = port_slot(info);
+    if (slot != 0) {
+        PORT_DISSECTORS[slot - 1].parse(info, payload, len);
+        return;
+    }
+    for (const HeuristicRegistration& heuristic : HEURISTIC_DISSECTORS) {
+        if (heuristic.transport == info.protocol && heuristic.parse(info, payload, len)) {
+            return;
+        }
+    }
 }
+
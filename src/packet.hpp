@@ -3,19 +3,24 @@
  *
  * Defines the PacketInfo structure that holds parsed packet data and the
  * protocol header structures used for parsing raw packet bytes. Supports
- * Ethernet, IPv4, IPv6, TCP, UDP, ICMP, ARP, DNS, HTTP, and TLS protocols.
+ * Ethernet, Linux cooked capture, BSD loopback, PPP and raw IP framing,
+ * then IPv4, IPv6, TCP, UDP, ICMP, ARP, DNS, HTTP, TLS and QUIC, inside
+ * VXLAN, GENEVE, GRE, MPLS and IP-in-IP tunnels.
  *
  * The parse_packet() function converts raw captured bytes into a structured
  * PacketInfo object that the rest of the application can use for display
- * and analysis.
+ * and analysis. It assumes Ethernet; captures on other link types resolve
+ * a parser specialised for their framing once with packet_parser().
  */
 
 #pragma once
 
+#include "tls_fingerprint.hpp"
 #include <array>
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Protocol numbers
@@ -23,11 +28,39 @@ constexpr uint8_t PROTO_ICMP = 1;
 constexpr uint8_t PROTO_TCP = 6;
 constexpr uint8_t PROTO_UDP = 17;
 constexpr uint8_t PROTO_ICMPV6 = 58;
+constexpr uint8_t PROTO_IPIP = 4;        // IPv4 in IP
+constexpr uint8_t PROTO_IPV6_ENCAP = 41; // IPv6 in IP
+constexpr uint8_t PROTO_GRE = 47;
+
+// IPv6 extension headers walked by parse_packet()
+constexpr uint8_t IPV6_EXT_HOP_BY_HOP = 0;
+constexpr uint8_t IPV6_EXT_ROUTING = 43;
+constexpr uint8_t IPV6_EXT_FRAGMENT = 44;
+constexpr uint8_t IPV6_EXT_AUTH = 51;
+constexpr uint8_t IPV6_EXT_DEST_OPTS = 60;
+constexpr int IPV6_MAX_EXTENSION_HEADERS = 8;
 
 // EtherTypes
 constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
 constexpr uint16_t ETHERTYPE_ARP = 0x0806;
 constexpr uint16_t ETHERTYPE_IPV6 = 0x86DD;
+constexpr uint16_t ETHERTYPE_MPLS = 0x8847;
+constexpr uint16_t ETHERTYPE_MPLS_MULTICAST = 0x8848;
+constexpr uint16_t ETHERTYPE_TEB = 0x6558;  // Transparent Ethernet bridging (GRE, GENEVE)
+
+// Link-layer framing, from pcap_datalink()
+enum class LinkType : uint8_t {
+    ETHERNET,      // DLT_EN10MB
+    LINUX_SLL,     // DLT_LINUX_SLL ("any" on Linux)
+    LINUX_SLL2,    // DLT_LINUX_SLL2
+    LOOPBACK,      // DLT_NULL (sender byte order) and DLT_LOOP (network order)
+    PPP,           // DLT_PPP, DLT_PPP_SERIAL
+    RAW,           // DLT_RAW, DLT_IPV4, DLT_IPV6 (tun, WireGuard)
+    UNSUPPORTED,   // Kept raw, not parsed
+};
+
+LinkType link_type_from_dlt(int dlt);
+const char* link_type_name(LinkType link);
 
 // TCP Flags
 constexpr uint8_t TCP_FIN = 0x01;
@@ -37,37 +70,152 @@ constexpr uint8_t TCP_PSH = 0x08;
 constexpr uint8_t TCP_ACK = 0x10;
 constexpr uint8_t TCP_URG = 0x20;
 
+// PacketInfo::tcp_analysis bits, set by TcpAnalyzer
+constexpr uint8_t TCP_ANALYSIS_RETRANSMISSION = 0x01;
+constexpr uint8_t TCP_ANALYSIS_OUT_OF_ORDER = 0x02;
+constexpr uint8_t TCP_ANALYSIS_DUP_ACK = 0x04;
+constexpr uint8_t TCP_ANALYSIS_ZERO_WINDOW = 0x08;
+constexpr uint8_t TCP_ANALYSIS_KEEP_ALIVE = 0x10;
+
 // Well-known ports
 constexpr uint16_t PORT_DNS = 53;
 constexpr uint16_t PORT_HTTP = 80;
 constexpr uint16_t PORT_HTTPS = 443;
+constexpr uint16_t PORT_VXLAN = 4789;
+constexpr uint16_t PORT_GENEVE = 6081;
+
+// Encapsulations removed before the inner packet is dissected
+constexpr uint8_t MAX_TUNNEL_DEPTH = 4;
+
+// DNS resource record types
+constexpr uint16_t DNS_TYPE_A = 1;
+constexpr uint16_t DNS_TYPE_CNAME = 5;
+constexpr uint16_t DNS_TYPE_AAAA = 28;
+
+// QUIC versions whose Initial packet protection is known
+constexpr uint32_t QUIC_VERSION_1 = 0x00000001;
+constexpr uint32_t QUIC_VERSION_2 = 0x6b3343cf;
+
+enum class QuicPacketType : uint8_t { INITIAL, ZERO_RTT, HANDSHAKE, RETRY, VERSION_NEGOTIATION };
+
+// QUIC long header (RFC 9000 section 17.2) up to the protected packet number
+struct QuicLongHeader {
+    uint32_t version = 0;
+    QuicPacketType type = QuicPacketType::INITIAL;
+    uint8_t dcid_len = 0;
+    std::array<uint8_t, 20> dcid{};
+    uint8_t scid_len = 0;
+    std::array<uint8_t, 20> scid{};
+    size_t pn_offset = 0;   // Start of the protected packet number (not Retry/VN)
+    size_t length = 0;      // Packet number and payload bytes from pn_offset
+};
+
+// One A, AAAA or CNAME record from a DNS response's answer section
+struct DnsAnswer {
+    std::string name;             // Owner name
+    uint16_t type = 0;
+    uint32_t ttl = 0;
+    std::array<uint8_t, 16> addr{};  // A uses the first 4 bytes
+    std::string target;           // CNAME target
+};
+
+// HTTP/1.x request or response head, as found by parse_http_head(). The
+// views point into the parsed bytes.
+struct HttpHead {
+    bool response = false;
+    bool head_request = false;     // HEAD: the response carries no body
+    bool chunked = false;          // Transfer-Encoding: chunked
+    uint16_t status = 0;           // Responses
+    int64_t content_length = -1;   // -1 when absent
+    size_t length = 0;             // Through the blank line; 0 if the head is incomplete
+    std::string_view method;       // "Response" for status lines
+    std::string_view target;       // Request path or status code and reason
+    std::string_view host;
+    std::string_view user_agent;
+    std::string_view content_type;
+};
+
+// Outermost headers of a decapsulated packet. PacketInfo's own IP and
+// port fields describe the innermost packet.
+struct TunnelInfo {
+    uint8_t depth = 0;            // Encapsulations removed; 0 = not tunnelled
+    std::string encapsulation;    // Outermost first, e.g. "GRE / VXLAN 5001"
+    uint8_t ip_version = 0;       // 0 when the outermost layer was MPLS
+    std::string src_ip;
+    std::string dst_ip;
+    uint8_t protocol = 0;
+    uint16_t src_port = 0;
+    uint16_t dst_port = 0;
+};
+
+// Result of verify_checksums() for one header
+enum class ChecksumStatus : uint8_t {
+    UNCHECKED,   // Not verified, or nothing to verify
+    GOOD,
+    BAD,
+    OFFLOADED,   // Left for the NIC to fill in (outbound capture)
+};
 
 struct PacketInfo {
     std::chrono::system_clock::time_point timestamp;
     uint32_t length;
     uint32_t original_length;
 
-    // Ethernet layer
+    // Link layer; MACs are zero where the framing has none, and ether_type
+    // is derived from the link header's protocol field or the IP version
+    LinkType link_type = LinkType::ETHERNET;
     std::array<uint8_t, 6> src_mac;
     std::array<uint8_t, 6> dst_mac;
     uint16_t ether_type;
 
+    // Encapsulation, when the IP layer below is an inner packet
+    TunnelInfo tunnel;
+
     // IP layer
     uint8_t ip_version;
     std::string src_ip;
     std::string dst_ip;
-    uint8_t protocol;
+    std::array<uint8_t, 16> src_addr{};  // Binary address (IPv4 uses the first 4 bytes)
+    std::array<uint8_t, 16> dst_addr{};
+    uint8_t protocol;          // Upper-layer protocol, after any IPv6 extension headers
     uint8_t ttl;
+    uint32_t ip_offset = 0;    // Innermost IP header position in raw_data
+    ChecksumStatus ip_checksum = ChecksumStatus::UNCHECKED;   // IPv4 header
+    ChecksumStatus l4_checksum = ChecksumStatus::UNCHECKED;   // TCP/UDP segment
+
+    // IP fragmentation; ip_payload_* locate the bytes after the IP headers
+    uint32_t fragment_id = 0;          // IPv4 identification or IPv6 fragment ID
+    uint16_t fragment_offset = 0;      // Bytes
+    bool more_fragments = false;
+    uint32_t ip_payload_offset = 0;
+    uint32_t ip_payload_length = 0;
+    uint32_t reassembled_length = 0;   // Set on the fragment that completed a datagram
 
     // Transport layer
     uint16_t src_port;
     uint16_t dst_port;
     uint8_t tcp_flags;
+    uint32_t tcp_seq = 0;
+    uint32_t tcp_ack = 0;
+    uint16_t tcp_window = 0;       // As advertised, before window scaling
+    uint8_t tcp_analysis = 0;      // TCP_ANALYSIS_* bits
+    uint32_t payload_offset = 0;   // TCP/UDP payload position in raw_data
+    uint32_t payload_length = 0;
 
     // Application layer - extracted hostnames/URLs
     std::string hostname;      // DNS query name, HTTP Host, or TLS SNI
     std::string app_protocol;  // "DNS", "HTTP", "TLS", etc.
     std::string app_info;      // Additional info (HTTP method, DNS type, etc.)
+    std::string user_agent;    // HTTP User-Agent
+    std::string content_type;  // HTTP Content-Type
+    uint16_t http_status = 0;              // HTTP response status code
+    int64_t http_content_length = -1;      // HTTP Content-Length, -1 when absent
+    uint32_t http_ttfb_us = 0;             // Request to this response (HttpTracker)
+    uint16_t dns_id = 0;                 // DNS header, when app_protocol is "DNS"
+    uint16_t dns_flags = 0;              // QR is the top bit, RCODE the low four
+    std::vector<DnsAnswer> dns_answers;  // Responses only
+    bool hostname_from_dns = false;      // hostname came from the passive DNS cache
+    TlsFingerprintRef tls_fingerprint;   // JA3/JA4 of a complete ClientHello
 
     // Description lookup results (populated during rendering)
     std::string category;      // e.g., "Google", "Microsoft", "Telemetry"
@@ -86,6 +234,7 @@ struct PacketInfo {
 
     // Helper methods
     std::string protocol_name() const;
+    bool is_fragment() const { return more_fragments || fragment_offset != 0; }
     std::string tcp_flags_str() const;
     std::string summary() const;
     std::string format_mac(const std::array<uint8_t, 6>& mac) const;
@@ -167,9 +316,29 @@ struct DNSHeader {
 
 // Application layer parsing functions
 std::string parse_dns_name(const uint8_t* data, size_t len, size_t& offset);
-void parse_dns_query(PacketInfo& info, const uint8_t* data, size_t len);
-void parse_http_request(PacketInfo& info, const uint8_t* data, size_t len);
+void parse_dns_query(PacketInfo& info, const uint8_t* data, size_t len);  // Also responses
+size_t parse_dns_answers(const uint8_t* data, size_t len, std::vector<DnsAnswer>& out);
+void parse_http_request(PacketInfo& info, const uint8_t* data, size_t len);  // Also responses
+bool parse_http_head(const uint8_t* data, size_t len, HttpHead& head);
 void parse_tls_client_hello(PacketInfo& info, const uint8_t* data, size_t len);
+void parse_client_hello(PacketInfo& info, const uint8_t* data, size_t len);  // No record header
+void parse_quic(PacketInfo& info, const uint8_t* data, size_t len);
+
+// QUIC variable-length integer at pos (advanced past it)
+bool read_quic_varint(const uint8_t* data, size_t len, size_t& pos, uint64_t& value);
+bool parse_quic_long_header(const uint8_t* data, size_t len, QuicLongHeader& header);
 
-// Parse a raw packet into PacketInfo
+// Dispatch a TCP/UDP payload to the parser registered for its ports, or
+// to the heuristic dissectors when neither port is registered
+void parse_application(PacketInfo& info, const uint8_t* payload, size_t len);
+
+// Index of the first occurrence of byte in data[0, len), or len (SIMD where available)
+size_t find_byte(const uint8_t* data, size_t len, uint8_t byte);
+
+// Parse a raw Ethernet frame into PacketInfo
 PacketInfo parse_packet(const uint8_t* data, uint32_t caplen, uint32_t len);
+
+// parse_packet() for another link type, with the link header parse
+// specialised at compile time; resolve once per capture
+using PacketParser = PacketInfo (*)(const uint8_t* data, uint32_t caplen, uint32_t len);
+PacketParser packet_parser(LinkType link);
@@ -35,6 +35,27 @@ void PacketStore::update_stats_unlocked(const PacketInfo& pkt) {
     std::string proto = pkt.protocol_name();
     stats_.protocol_counts[proto]++;
     stats_.protocol_bytes[proto] += pkt.original_length;
+    baselines_.count(pkt);
+
+    if (pkt.ip_checksum == ChecksumStatus::UNCHECKED &&
+        pkt.l4_checksum == ChecksumStatus::UNCHECKED) {
+        return;
+    }
+    stats_.checksums_verified++;
+    if (pkt.ip_checksum == ChecksumStatus::BAD) {
+        stats_.bad_ipv4_checksums++;
+    }
+    if (pkt.l4_checksum == ChecksumStatus::BAD) {
+        if (pkt.protocol == PROTO_TCP) {
+            stats_.bad_tcp_checksums++;
+        } else {
+            stats_.bad_udp_checksums++;
+        }
+    }
+    if (pkt.ip_checksum == ChecksumStatus::OFFLOADED ||
+        pkt.l4_checksum == ChecksumStatus::OFFLOADED) {
+        stats_.offloaded_checksums++;
+    }
 }
 
 std::vector<PacketInfo> PacketStore::get_recent(size_t count) const {
@@ -71,6 +92,8 @@ void PacketStore::clear() {
     stats_ = InterfaceStats{};
     stats_.last_rate_update = std::chrono::steady_clock::now();
     selected_index_ = 0;
+    baselines_.clear();
+    pending_anomalies_.clear();
 }
 
 InterfaceStats PacketStore::get_stats() const {
@@ -102,6 +125,24 @@ void PacketStore::update_rates() {
             stats_.bps_history.pop_front();
         }
 
+        // Compare against the baselines learned so far
+        std::vector<BaselineAnomaly> found;
+        uint8_t flags = baselines_.tick(stats_.packets_per_second, stats_.bytes_per_second,
+                                        stats_.protocol_counts, elapsed, found);
+        stats_.anomaly_history.push_back(flags);
+        if (stats_.anomaly_history.size() > InterfaceStats::MAX_HISTORY) {
+            stats_.anomaly_history.pop_front();
+        }
+        for (const BaselineAnomaly& anomaly : found) {
+            stats_.recent_anomalies.push_back(anomaly);
+            if (stats_.recent_anomalies.size() > InterfaceStats::MAX_RECENT_ANOMALIES) {
+                stats_.recent_anomalies.pop_front();
+            }
+            if (pending_anomalies_.size() < MAX_PENDING_ANOMALIES) {
+                pending_anomalies_.push_back(anomaly);
+            }
+        }
+
         stats_.last_packets = stats_.packets_received;
         stats_.last_bytes = stats_.bytes_received;
         stats_.last_rate_update = now;
@@ -113,6 +154,25 @@ void PacketStore::set_interface_name(const std::string& name) {
     stats_.name = name;
 }
 
+void PacketStore::set_baseline_config(const BaselineConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    baselines_.set_config(config);
+    pending_anomalies_.clear();
+}
+
+void PacketStore::reset_baselines() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    baselines_.clear();
+    pending_anomalies_.clear();
+}
+
+std::vector<BaselineAnomaly> PacketStore::take_anomalies() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<BaselineAnomaly> anomalies;
+    anomalies.swap(pending_anomalies_);
+    return anomalies;
+}
+
 void PacketStore::set_selected_index(size_t index) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (index < packets_.size()) {
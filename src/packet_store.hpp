@@ -7,11 +7,14 @@
  * thread to push packets while the UI thread reads them safely.
  *
  * The store maintains a history of traffic rates for graphing purposes
- * and tracks which packet is currently selected for detail viewing.
+ * and tracks which packet is currently selected for detail viewing. Each
+ * rate update also feeds the learned baselines (see baseline.hpp), marking
+ * the history entries where traffic departed from them.
  */
 
 #pragma once
 
+#include "baseline.hpp"
 #include "packet.hpp"
 #include <chrono>
 #include <deque>
@@ -31,6 +34,14 @@ struct InterfaceStats {
     std::map<std::string, uint64_t> protocol_counts;
     std::map<std::string, uint64_t> protocol_bytes;
 
+    // Checksum verification (--verify-checksums); packets whose headers
+    // were left for the NIC to fill in count as offloaded, not bad
+    uint64_t checksums_verified = 0;
+    uint64_t bad_ipv4_checksums = 0;
+    uint64_t bad_tcp_checksums = 0;
+    uint64_t bad_udp_checksums = 0;
+    uint64_t offloaded_checksums = 0;
+
     // For rate calculation
     std::chrono::steady_clock::time_point last_rate_update;
     uint64_t last_packets = 0;
@@ -40,6 +51,11 @@ struct InterfaceStats {
     std::deque<double> pps_history;
     std::deque<double> bps_history;
     static constexpr size_t MAX_HISTORY = 60;  // 60 seconds of history
+
+    // ANOMALY_* flags for each history entry, and the latest anomalies
+    std::deque<uint8_t> anomaly_history;
+    std::deque<BaselineAnomaly> recent_anomalies;
+    static constexpr size_t MAX_RECENT_ANOMALIES = 8;
 };
 
 class PacketStore {
@@ -61,6 +77,12 @@ public:
     void update_rates();  // Call periodically (every second)
     void set_interface_name(const std::string& name);
 
+    // Rate baselines; a new configuration (or reset) forgets what was learned
+    void set_baseline_config(const BaselineConfig& config);
+    void reset_baselines();
+    // Anomalies found since the last call, for raising alerts
+    std::vector<BaselineAnomaly> take_anomalies();
+
     // Selected packet for detail view
     void set_selected_index(size_t index);
     size_t get_selected_index() const;
@@ -71,6 +93,9 @@ private:
     std::deque<PacketInfo> packets_;
     InterfaceStats stats_;
     size_t selected_index_ = 0;
+    BaselineMonitor baselines_;
+    std::vector<BaselineAnomaly> pending_anomalies_;
+    static constexpr size_t MAX_PENDING_ANOMALIES = 64;
 
     void update_stats_unlocked(const PacketInfo& pkt);
 };
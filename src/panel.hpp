@@ -2,11 +2,11 @@
  * panel.hpp - Base class for UI panels
  *
  * Abstract base class that all main content panels inherit from (PacketList,
- * Stats, Graph, Detail). Provides common interface for rendering, keyboard
+ * Stats, Graph, Detail, DNS). Provides common interface for rendering, keyboard
  * handling, and active state management. Each panel has access to the shared
  * PacketStore for reading captured packet data.
  *
- * Panels are displayed in the main window area and switched via F1-F4 keys.
+ * Panels are displayed in the main window area and switched via F1-F5 keys.
  */
 
 #pragma once
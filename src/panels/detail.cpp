@@ -9,9 +9,25 @@
  */
 
 #include "detail.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <iomanip>
 #include <sstream>
 
+namespace {
+
+const char* checksum_label(ChecksumStatus status) {
+    switch (status) {
+        case ChecksumStatus::GOOD: return "correct";
+        case ChecksumStatus::BAD: return "BAD";
+        case ChecksumStatus::OFFLOADED: return "offloaded to NIC";
+        case ChecksumStatus::UNCHECKED: break;
+    }
+    return "not verified";
+}
+
+}  // namespace
+
 DetailPanel::DetailPanel(PacketStore& store, UI& ui)
     : Panel("Packet Detail", store, ui) {}
 
@@ -87,15 +103,21 @@ void DetailPanel::render_parsed(WINDOW* win, const PacketInfo& pkt) {
               pkt.length, pkt.original_length);
     y++;
 
-    // Ethernet section
+    // Link layer section; cooked captures only know the source address
     if (y < max_y - 2) {
         wattron(win, A_BOLD | A_UNDERLINE);
-        mvwprintw(win, y++, 2, "Ethernet");
+        mvwprintw(win, y++, 2, "%s", link_type_name(pkt.link_type));
         wattroff(win, A_BOLD | A_UNDERLINE);
         y++;
 
-        mvwprintw(win, y++, 4, "Src MAC:  %s", pkt.format_mac(pkt.src_mac).c_str());
-        mvwprintw(win, y++, 4, "Dst MAC:  %s", pkt.format_mac(pkt.dst_mac).c_str());
+        bool ethernet = pkt.link_type == LinkType::ETHERNET;
+        bool cooked = pkt.link_type == LinkType::LINUX_SLL || pkt.link_type == LinkType::LINUX_SLL2;
+        if (ethernet || cooked) {
+            mvwprintw(win, y++, 4, "Src MAC:  %s", pkt.format_mac(pkt.src_mac).c_str());
+        }
+        if (ethernet) {
+            mvwprintw(win, y++, 4, "Dst MAC:  %s", pkt.format_mac(pkt.dst_mac).c_str());
+        }
         mvwprintw(win, y++, 4, "Type:     0x%04X (%s)", pkt.ether_type,
                   pkt.ether_type == ETHERTYPE_IPV4 ? "IPv4" :
                   pkt.ether_type == ETHERTYPE_IPV6 ? "IPv6" :
@@ -103,6 +125,27 @@ void DetailPanel::render_parsed(WINDOW* win, const PacketInfo& pkt) {
         y++;
     }
 
+    // Tunnel section: the outermost headers; the sections below are the inner packet
+    if (pkt.tunnel.depth > 0 && y < max_y - 2) {
+        const TunnelInfo& tunnel = pkt.tunnel;
+        wattron(win, A_BOLD | A_UNDERLINE);
+        mvwprintw(win, y++, 2, "Tunnel");
+        wattroff(win, A_BOLD | A_UNDERLINE);
+        y++;
+
+        int width = getmaxx(win) - 16;
+        mvwprintw(win, y++, 4, "Encap:    %.*s", width, tunnel.encapsulation.c_str());
+        if (tunnel.ip_version != 0) {
+            mvwprintw(win, y++, 4, "Outer:    %s -> %s", tunnel.src_ip.c_str(),
+                      tunnel.dst_ip.c_str());
+            if (tunnel.protocol == PROTO_UDP) {
+                mvwprintw(win, y++, 4, "Ports:    UDP %u -> %u", tunnel.src_port,
+                          tunnel.dst_port);
+            }
+        }
+        y++;
+    }
+
     // IP section
     if (pkt.ip_version != 0 && y < max_y - 2) {
         wattron(win, A_BOLD | A_UNDERLINE);
@@ -114,6 +157,20 @@ void DetailPanel::render_parsed(WINDOW* win, const PacketInfo& pkt) {
         mvwprintw(win, y++, 4, "Dst IP:   %s", pkt.dst_ip.c_str());
         mvwprintw(win, y++, 4, "Protocol: %d (%s)", pkt.protocol, pkt.protocol_name().c_str());
         mvwprintw(win, y++, 4, "TTL:      %d", pkt.ttl);
+        if (pkt.ip_checksum != ChecksumStatus::UNCHECKED) {
+            mvwprintw(win, y++, 4, "Checksum: %s", checksum_label(pkt.ip_checksum));
+        }
+        if (pkt.is_fragment()) {
+            mvwprintw(win, y++, 4, "Fragment: id %u, offset %u%s", pkt.fragment_id,
+                      pkt.fragment_offset, pkt.more_fragments ? ", more" : ", last");
+        }
+        if (pkt.reassembled_length > 0) {
+            mvwprintw(win, y++, 4, "Datagram: %u bytes reassembled", pkt.reassembled_length);
+        }
+        if (pkt.hostname_from_dns) {
+            int width = std::max(0, getmaxx(win) - 28);
+            mvwprintw(win, y++, 4, "Host:     %.*s (from DNS)", width, pkt.hostname.c_str());
+        }
         y++;
     }
 
@@ -136,6 +193,65 @@ void DetailPanel::render_parsed(WINDOW* win, const PacketInfo& pkt) {
             if (pkt.tcp_flags & TCP_PSH) flags += "PSH ";
             if (pkt.tcp_flags & TCP_URG) flags += "URG ";
             mvwprintw(win, y++, 4, "Flags:    %s", flags.c_str());
+            mvwprintw(win, y++, 4, "Seq:      %u   Ack: %u   Window: %u",
+                      pkt.tcp_seq, pkt.tcp_ack, pkt.tcp_window);
+
+            std::string analysis;
+            if (pkt.tcp_analysis & TCP_ANALYSIS_RETRANSMISSION) analysis += "retransmission ";
+            if (pkt.tcp_analysis & TCP_ANALYSIS_OUT_OF_ORDER) analysis += "out-of-order ";
+            if (pkt.tcp_analysis & TCP_ANALYSIS_DUP_ACK) analysis += "dup-ACK ";
+            if (pkt.tcp_analysis & TCP_ANALYSIS_ZERO_WINDOW) analysis += "zero-window ";
+            if (pkt.tcp_analysis & TCP_ANALYSIS_KEEP_ALIVE) analysis += "keep-alive ";
+            if (!analysis.empty()) {
+                ui_.set_color(win, COLOR_ALERT_TEXT);
+                mvwprintw(win, y++, 4, "Analysis: %s", analysis.c_str());
+                ui_.unset_color(win, COLOR_ALERT_TEXT);
+            }
+        }
+        if (pkt.l4_checksum != ChecksumStatus::UNCHECKED) {
+            mvwprintw(win, y++, 4, "Checksum: %s", checksum_label(pkt.l4_checksum));
+        }
+        y++;
+    }
+
+    // Application section
+    if (!pkt.app_protocol.empty() && y < max_y - 2) {
+        wattron(win, A_BOLD | A_UNDERLINE);
+        mvwprintw(win, y++, 2, "%s", pkt.app_protocol.c_str());
+        wattroff(win, A_BOLD | A_UNDERLINE);
+        y++;
+
+        int width = std::max(0, getmaxx(win) - 16);  // Keep values inside the box
+        if (!pkt.hostname.empty() && y < max_y - 1) {
+            mvwprintw(win, y++, 4, "Host:     %.*s", width, pkt.hostname.c_str());
+        }
+        if (!pkt.app_info.empty() && y < max_y - 1) {
+            mvwprintw(win, y++, 4, "Info:     %.*s", width, pkt.app_info.c_str());
+        }
+        if (!pkt.user_agent.empty() && y < max_y - 1) {
+            mvwprintw(win, y++, 4, "Agent:    %.*s", width, pkt.user_agent.c_str());
+        }
+        if (!pkt.content_type.empty() && y < max_y - 1) {
+            mvwprintw(win, y++, 4, "Type:     %.*s", width, pkt.content_type.c_str());
+        }
+        if (pkt.http_status != 0 && y < max_y - 1) {
+            std::string line = std::to_string(pkt.http_status);
+            if (pkt.http_content_length >= 0) {
+                line += ", " + std::to_string(pkt.http_content_length) + " bytes";
+            }
+            if (pkt.http_ttfb_us != 0) {
+                char ttfb[32];
+                std::snprintf(ttfb, sizeof(ttfb), ", TTFB %.1f ms", pkt.http_ttfb_us / 1000.0);
+                line += ttfb;
+            }
+            bool error = pkt.http_status >= 400;
+            if (error) ui_.set_color(win, COLOR_ALERT_TEXT);
+            mvwprintw(win, y++, 4, "Status:   %.*s", width, line.c_str());
+            if (error) ui_.unset_color(win, COLOR_ALERT_TEXT);
+        }
+        if (pkt.tls_fingerprint && y < max_y - 2) {
+            mvwprintw(win, y++, 4, "JA3:      %.*s", width, pkt.tls_fingerprint->ja3.c_str());
+            mvwprintw(win, y++, 4, "JA4:      %.*s", width, pkt.tls_fingerprint->ja4.c_str());
         }
     }
 }
@@ -0,0 +1,99 @@
+/*
+ * diagnostics.cpp - Self-instrumentation panel implementation
+ *
+ * Renders a table of per-stage latency statistics from a fresh snapshot
+ * of the lock-free histograms each frame.
+ */
+
+#include "diagnostics.hpp"
+#include <iomanip>
+#include <sstream>
+
+DiagnosticsPanel::DiagnosticsPanel(PacketStore& store, UI& ui, const MetricsRegistry& metrics)
+    : Panel("Diagnostics", store, ui), metrics_(metrics),
+      last_rate_update_(std::chrono::steady_clock::now()) {}
+
+void DiagnosticsPanel::render(WINDOW* win) {
+    UI::clear_window(win);
+
+    int max_x = getmaxx(win);
+
+    std::array<HistogramSnapshot, STAGE_COUNT> stages;
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        stages[i] = metrics_.profiler().snapshot(static_cast<Stage>(i));
+    }
+
+    // Update call rates once per second
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_rate_update_).count();
+    if (elapsed >= 1.0) {
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            rates_[i] = static_cast<double>(stages[i].count - last_counts_[i]) / elapsed;
+            last_counts_[i] = stages[i].count;
+        }
+        last_rate_update_ = now;
+    }
+
+    // Title
+    wattron(win, A_BOLD);
+    mvwprintw(win, 1, 2, "Pipeline Diagnostics");
+    wattroff(win, A_BOLD);
+
+    mvwhline(win, 2, 1, ACS_HLINE, max_x - 2);
+
+    // Table header
+    int y = 3;
+    wattron(win, A_BOLD | A_UNDERLINE);
+    mvwprintw(win, y, 2, "%-10s %12s %10s %9s %9s %9s %9s",
+              "Stage", "Calls", "Calls/s", "Mean", "p50", "p99", "Max");
+    wattroff(win, A_BOLD | A_UNDERLINE);
+    y += 1;
+
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        const HistogramSnapshot& hist = stages[i];
+
+        ui_.set_color(win, COLOR_UDP);
+        mvwprintw(win, y, 2, "%-10s", stage_name(static_cast<Stage>(i)));
+        ui_.unset_color(win, COLOR_UDP);
+
+        if (hist.count == 0) {
+            mvwprintw(win, y, 13, "%12s", "-");
+        } else {
+            mvwprintw(win, y, 13, "%12lu %10.1f %9s %9s %9s %9s",
+                      hist.count, rates_[i],
+                      format_ns(static_cast<uint64_t>(hist.mean_ns())).c_str(),
+                      format_ns(hist.percentile(0.5)).c_str(),
+                      format_ns(hist.percentile(0.99)).c_str(),
+                      format_ns(hist.max_ns).c_str());
+        }
+        y++;
+    }
+
+    y++;
+    mvwprintw(win, y, 2, "parse to store are per packet (describe only with --bench); render is per frame.");
+
+    UI::draw_box(win, active_);
+    wrefresh(win);
+}
+
+std::string DiagnosticsPanel::format_ns(uint64_t ns) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+
+    if (ns >= 1000000000ULL) {
+        oss << static_cast<double>(ns) / 1e9 << "s";
+    } else if (ns >= 1000000ULL) {
+        oss << static_cast<double>(ns) / 1e6 << "ms";
+    } else if (ns >= 1000ULL) {
+        oss << static_cast<double>(ns) / 1e3 << "us";
+    } else {
+        oss << std::setprecision(0) << static_cast<double>(ns) << "ns";
+    }
+
+    return oss.str();
+}
+
+bool DiagnosticsPanel::handle_key(int key) {
+    (void)key;
+    return false;
+}
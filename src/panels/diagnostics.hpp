@@ -0,0 +1,33 @@
+/*
+ * diagnostics.hpp - Self-instrumentation panel (F12, hidden)
+ *
+ * Shows where the monitor itself spends time: for each pipeline stage
+ * (parse, watchlist, process lookup, store push, render) it lists call
+ * count, call rate, mean, p50, p99 and max latency from the
+ * StageProfiler histograms. Not shown in the tab bar.
+ */
+
+#pragma once
+
+#include "../metrics.hpp"
+#include "../panel.hpp"
+#include <array>
+#include <chrono>
+
+class DiagnosticsPanel : public Panel {
+public:
+    DiagnosticsPanel(PacketStore& store, UI& ui, const MetricsRegistry& metrics);
+
+    void render(WINDOW* win) override;
+    bool handle_key(int key) override;
+
+private:
+    const MetricsRegistry& metrics_;
+
+    // Call rates are computed from count deltas about once a second
+    std::array<uint64_t, STAGE_COUNT> last_counts_{};
+    std::array<double, STAGE_COUNT> rates_{};
+    std::chrono::steady_clock::time_point last_rate_update_{};
+
+    static std::string format_ns(uint64_t ns);
+};
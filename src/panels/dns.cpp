@@ -0,0 +1,127 @@
+/*
+ * dns.cpp - DNS transactions panel implementation
+ *
+ * Takes one snapshot per frame, sized to the rows that fit, and splits the
+ * space below the summary between the server and name tables.
+ */
+
+#include "dns.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// Response times are milliseconds in practice
+std::string format_ms(uint64_t ns) {
+    char text[16];
+    if (ns >= 10000000000ULL) {
+        std::snprintf(text, sizeof(text), "%.0fs", static_cast<double>(ns) / 1e9);
+    } else if (ns >= 100000000ULL) {
+        std::snprintf(text, sizeof(text), "%.0fms", static_cast<double>(ns) / 1e6);
+    } else {
+        std::snprintf(text, sizeof(text), "%.1fms", static_cast<double>(ns) / 1e6);
+    }
+    return text;
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+}  // namespace
+
+DnsPanel::DnsPanel(PacketStore& store, UI& ui, const DnsTracker* tracker)
+    : Panel("DNS", store, ui), tracker_(tracker) {}
+
+void DnsPanel::render(WINDOW* win) {
+    UI::clear_window(win);
+
+    int max_y = getmaxy(win);
+    int max_x = getmaxx(win);
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, 1, 2, "DNS Transactions");
+    wattroff(win, A_BOLD);
+
+    if (!tracker_) {
+        mvwprintw(win, 3, 2, "(DNS tracking disabled with --dns-pending 0)");
+        UI::draw_box(win, active_);
+        wrefresh(win);
+        return;
+    }
+
+    mvwprintw(win, 1, max_x - 30, "[o] order: %s",
+              order_ == DnsOrder::BUSIEST ? "busiest" : "slowest p99");
+
+    // Rows left for the two tables after the summary and their headings
+    int table_rows = std::max(1, (max_y - 14) / 2);
+    DnsTrackerSnapshot snap = tracker_->snapshot(static_cast<size_t>(table_rows), order_);
+    const DnsTimingStats& total = snap.total;
+
+    int y = 3;
+    mvwprintw(win, y++, 2, "Queries: %lu   Answered: %lu   Unanswered: %lu (%.1f%%)   Pending: %lu",
+              total.queries, total.responses, total.unanswered,
+              percent(total.unanswered, total.responses + total.unanswered), snap.pending);
+
+    bool failing = total.servfail > 0 || total.unanswered > 0;
+    if (failing) ui_.set_color(win, COLOR_ALERT_TEXT);
+    mvwprintw(win, y++, 2, "NXDOMAIN: %.1f%%   SERVFAIL: %.1f%%   Unmatched responses: %lu   Dropped pending: %lu",
+              percent(total.nxdomain, total.responses), percent(total.servfail, total.responses),
+              snap.unmatched, snap.overflows);
+    if (failing) ui_.unset_color(win, COLOR_ALERT_TEXT);
+
+    if (total.latency.count > 0) {
+        mvwprintw(win, y, 2, "Latency:  p50 %s   p90 %s   p99 %s   max %s",
+                  format_ms(total.latency.percentile(0.5)).c_str(),
+                  format_ms(total.latency.percentile(0.9)).c_str(),
+                  format_ms(total.latency.percentile(0.99)).c_str(),
+                  format_ms(total.latency.max_ns).c_str());
+    } else {
+        mvwprintw(win, y, 2, "(No DNS responses matched yet)");
+    }
+    y += 2;
+
+    mvwhline(win, y++, 1, ACS_HLINE, max_x - 2);
+    render_table(win, y, y + table_rows + 1, "Server", snap.servers);
+    y++;
+    render_table(win, y, max_y - 2, "Name", snap.names);
+
+    UI::draw_box(win, active_);
+    wrefresh(win);
+}
+
+void DnsPanel::render_table(WINDOW* win, int& y, int last_row, const char* heading,
+                            const std::vector<DnsTimingStats>& rows) {
+    int label_width = std::max(16, getmaxx(win) - 70);
+
+    wattron(win, A_BOLD | A_UNDERLINE);
+    mvwprintw(win, y++, 2, "%-*s %8s %7s %7s %7s %6s %8s %8s", label_width, heading,
+              "Queries", "NXDOM%", "SERVF%", "Unansw", "Lost%", "p50", "p99");
+    wattroff(win, A_BOLD | A_UNDERLINE);
+
+    for (const DnsTimingStats& row : rows) {
+        if (y >= last_row) break;
+        uint64_t outcomes = row.responses + row.unanswered;
+        bool slow_or_failing = row.servfail > 0 || row.unanswered > 0;
+
+        if (slow_or_failing) ui_.set_color(win, COLOR_ALERT_TEXT);
+        mvwprintw(win, y++, 2, "%-*.*s %8lu %7.1f %7.1f %7lu %6.1f %8s %8s",
+                  label_width, label_width, row.label.c_str(), row.queries,
+                  percent(row.nxdomain, row.responses), percent(row.servfail, row.responses),
+                  row.unanswered, percent(row.unanswered, outcomes),
+                  row.latency.count ? format_ms(row.latency.percentile(0.5)).c_str() : "-",
+                  row.latency.count ? format_ms(row.latency.percentile(0.99)).c_str() : "-");
+        if (slow_or_failing) ui_.unset_color(win, COLOR_ALERT_TEXT);
+    }
+    if (rows.empty() && y < last_row) {
+        mvwprintw(win, y++, 2, "(none)");
+    }
+}
+
+bool DnsPanel::handle_key(int key) {
+    if (key == 'o' || key == 'O') {
+        order_ = order_ == DnsOrder::BUSIEST ? DnsOrder::SLOWEST : DnsOrder::BUSIEST;
+        return true;
+    }
+    return false;
+}
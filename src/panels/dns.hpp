@@ -0,0 +1,29 @@
+/*
+ * dns.hpp - DNS transactions panel (F5)
+ *
+ * Shows how DNS is performing: overall query, response and failure counts
+ * with latency percentiles, then per-server and per-name tables (queries,
+ * NXDOMAIN and SERVFAIL rates, unanswered queries, p50/p99 response time)
+ * from DnsTracker snapshots. 'o' switches between busiest and slowest first.
+ */
+
+#pragma once
+
+#include "../dns_tracker.hpp"
+#include "../panel.hpp"
+
+class DnsPanel : public Panel {
+public:
+    // A null tracker means tracking is disabled (--dns-pending 0)
+    DnsPanel(PacketStore& store, UI& ui, const DnsTracker* tracker);
+
+    void render(WINDOW* win) override;
+    bool handle_key(int key) override;
+
+private:
+    const DnsTracker* tracker_;
+    DnsOrder order_ = DnsOrder::BUSIEST;
+
+    void render_table(WINDOW* win, int& y, int last_row, const char* heading,
+                      const std::vector<DnsTimingStats>& rows);
+};
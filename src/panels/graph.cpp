@@ -44,6 +44,14 @@ void GraphPanel::render(WINDOW* win) {
     }
     mvwprintw(win, 2, 2, "%s", current_rate.c_str());
 
+    // Latest departure from a learned baseline
+    if (!stats.recent_anomalies.empty() && max_x > 40) {
+        std::string anomaly = stats.recent_anomalies.back().describe();
+        ui_.set_color(win, COLOR_ERROR);
+        mvwprintw(win, 2, 26, "%s", UI::truncate(anomaly, max_x - 28).c_str());
+        ui_.unset_color(win, COLOR_ERROR);
+    }
+
     // Separator
     mvwhline(win, 3, 1, ACS_HLINE, max_x - 2);
 
@@ -70,7 +78,8 @@ void GraphPanel::render(WINDOW* win) {
     }
 
     render_graph(win, graph_start_y, graph_height, graph_width, data,
-                 show_bytes_ ? "B/s" : "pkt/s");
+                 show_bytes_ ? "B/s" : "pkt/s", stats.anomaly_history,
+                 show_bytes_ ? ANOMALY_BYTES : ANOMALY_PACKETS);
 
     // Draw box
     UI::draw_box(win, active_);
@@ -79,7 +88,8 @@ void GraphPanel::render(WINDOW* win) {
 }
 
 void GraphPanel::render_graph(WINDOW* win, int start_y, int height, int width,
-                              const std::deque<double>& data, const std::string& /*label*/) {
+                              const std::deque<double>& data, const std::string& /*label*/,
+                              const std::deque<uint8_t>& anomalies, uint8_t anomaly_mask) {
     double max_val = get_max_value(data);
     if (max_val < 1.0) max_val = 1.0;
 
@@ -162,6 +172,16 @@ void GraphPanel::render_graph(WINDOW* win, int start_y, int height, int width,
             mvwaddch(win, y, x, ACS_BLOCK);
         }
         ui_.unset_color(win, color);
+
+        // Anomaly flags are pushed alongside the rate history
+        size_t flag_idx = start_idx + i + anomalies.size() - data.size();
+        if (anomalies.size() >= data.size() && (anomalies[flag_idx] & anomaly_mask)) {
+            ui_.set_color(win, COLOR_ERROR);
+            wattron(win, A_BOLD);
+            mvwaddch(win, start_y, x, '!');
+            wattroff(win, A_BOLD);
+            ui_.unset_color(win, COLOR_ERROR);
+        }
     }
 }
 
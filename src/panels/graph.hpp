@@ -3,7 +3,9 @@
  *
  * Displays an ASCII bar chart of network traffic over time. Shows either
  * packets per second or bytes per second (toggle with 'b' key). The graph
- * scrolls horizontally to show the last 60 seconds of data.
+ * scrolls horizontally to show the last 60 seconds of data. Seconds where
+ * a rate departed from its learned baseline are marked with '!' above the
+ * bars, and the latest such anomaly is shown under the title.
  */
 
 #pragma once
@@ -21,6 +23,7 @@ private:
     bool show_bytes_ = false;  // false = packets/sec, true = bytes/sec
 
     void render_graph(WINDOW* win, int start_y, int height, int width,
-                      const std::deque<double>& data, const std::string& label);
+                      const std::deque<double>& data, const std::string& label,
+                      const std::deque<uint8_t>& anomalies, uint8_t anomaly_mask);
     double get_max_value(const std::deque<double>& data) const;
 };
@@ -0,0 +1,141 @@
+/*
+ * http.cpp - HTTP transactions panel implementation
+ *
+ * Takes one snapshot per frame, sized to the rows that fit below the
+ * summary.
+ */
+
+#include "http.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+std::string format_ms(const HistogramSnapshot& latency, double quantile) {
+    if (latency.count == 0) return "-";
+    uint64_t ns = latency.percentile(quantile);
+    char text[16];
+    if (ns >= 10000000000ULL) {
+        std::snprintf(text, sizeof(text), "%.0fs", static_cast<double>(ns) / 1e9);
+    } else if (ns >= 100000000ULL) {
+        std::snprintf(text, sizeof(text), "%.0fms", static_cast<double>(ns) / 1e6);
+    } else {
+        std::snprintf(text, sizeof(text), "%.1fms", static_cast<double>(ns) / 1e6);
+    }
+    return text;
+}
+
+std::string format_bytes(uint64_t bytes) {
+    char text[16];
+    if (bytes >= 1000000000ULL) {
+        std::snprintf(text, sizeof(text), "%.1fG", static_cast<double>(bytes) / 1e9);
+    } else if (bytes >= 1000000ULL) {
+        std::snprintf(text, sizeof(text), "%.1fM", static_cast<double>(bytes) / 1e6);
+    } else if (bytes >= 1000ULL) {
+        std::snprintf(text, sizeof(text), "%.1fK", static_cast<double>(bytes) / 1e3);
+    } else {
+        std::snprintf(text, sizeof(text), "%lu", bytes);
+    }
+    return text;
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+const char* order_name(HttpOrder order) {
+    switch (order) {
+        case HttpOrder::BUSIEST: return "busiest";
+        case HttpOrder::SLOWEST: return "slowest p99";
+        case HttpOrder::ERRORS: return "most errors";
+    }
+    return "";
+}
+
+}  // namespace
+
+HttpPanel::HttpPanel(PacketStore& store, UI& ui, const HttpTracker* tracker)
+    : Panel("HTTP", store, ui), tracker_(tracker) {}
+
+void HttpPanel::render(WINDOW* win) {
+    UI::clear_window(win);
+
+    int max_y = getmaxy(win);
+    int max_x = getmaxx(win);
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, 1, 2, "HTTP Transactions");
+    wattroff(win, A_BOLD);
+
+    if (!tracker_) {
+        mvwprintw(win, 3, 2, "(HTTP tracking disabled with --http-flows 0)");
+        UI::draw_box(win, active_);
+        wrefresh(win);
+        return;
+    }
+
+    mvwprintw(win, 1, max_x - 30, "[o] order: %s", order_name(order_));
+
+    int table_rows = std::max(1, max_y - 12);
+    HttpTrackerSnapshot snap = tracker_->snapshot(static_cast<size_t>(table_rows), order_);
+    const HttpHostStats& total = snap.total;
+
+    int y = 3;
+    mvwprintw(win, y++, 2, "Requests: %lu   Responses: %lu   Unanswered: %lu   Unmatched: %lu   Connections: %lu",
+              total.requests, total.responses, total.unanswered, snap.unmatched, snap.connections);
+
+    bool errors = total.errors() > 0;
+    if (errors) ui_.set_color(win, COLOR_ALERT_TEXT);
+    mvwprintw(win, y++, 2, "2xx: %lu   3xx: %lu   4xx: %lu   5xx: %lu   Errors: %.2f%%",
+              total.status[1], total.status[2], total.status[3], total.status[4],
+              percent(total.errors(), total.responses));
+    if (errors) ui_.unset_color(win, COLOR_ALERT_TEXT);
+
+    mvwprintw(win, y++, 2, "TTFB:  p50 %s   p90 %s   p99 %s   max %s      Lost sync: %lu   Dropped: %lu",
+              format_ms(total.ttfb, 0.5).c_str(), format_ms(total.ttfb, 0.9).c_str(),
+              format_ms(total.ttfb, 0.99).c_str(), format_ms(total.ttfb, 1.0).c_str(),
+              snap.lost_sync, snap.overflows);
+    y++;
+
+    mvwhline(win, y++, 1, ACS_HLINE, max_x - 2);
+    render_table(win, y, max_y - 1, snap.hosts);
+
+    UI::draw_box(win, active_);
+    wrefresh(win);
+}
+
+void HttpPanel::render_table(WINDOW* win, int y, int last_row,
+                             const std::vector<HttpHostStats>& rows) {
+    int host_width = std::max(16, getmaxx(win) - 70);
+
+    wattron(win, A_BOLD | A_UNDERLINE);
+    mvwprintw(win, y++, 2, "%-*s %7s %5s %5s %5s %5s %6s %5s %7s %8s %8s", host_width, "Host",
+              "Req", "2xx", "3xx", "4xx", "5xx", "Err%", "Lost", "Bytes", "p50", "p99");
+    wattroff(win, A_BOLD | A_UNDERLINE);
+
+    for (const HttpHostStats& row : rows) {
+        if (y >= last_row) break;
+        bool errors = row.errors() > 0;
+        if (errors) ui_.set_color(win, COLOR_ALERT_TEXT);
+        mvwprintw(win, y++, 2, "%-*.*s %7lu %5lu %5lu %5lu %5lu %6.1f %5lu %7s %8s %8s",
+                  host_width, host_width, row.host.c_str(), row.requests, row.status[1],
+                  row.status[2], row.status[3], row.status[4],
+                  percent(row.errors(), row.responses), row.unanswered,
+                  format_bytes(row.body_bytes).c_str(), format_ms(row.ttfb, 0.5).c_str(),
+                  format_ms(row.ttfb, 0.99).c_str());
+        if (errors) ui_.unset_color(win, COLOR_ALERT_TEXT);
+    }
+    if (rows.empty() && y < last_row) {
+        mvwprintw(win, y, 2, "(No HTTP requests seen yet)");
+    }
+}
+
+bool HttpPanel::handle_key(int key) {
+    if (key == 'o' || key == 'O') {
+        order_ = order_ == HttpOrder::BUSIEST ? HttpOrder::SLOWEST
+               : order_ == HttpOrder::SLOWEST ? HttpOrder::ERRORS
+                                              : HttpOrder::BUSIEST;
+        return true;
+    }
+    return false;
+}
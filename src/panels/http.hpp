@@ -0,0 +1,29 @@
+/*
+ * http.hpp - HTTP transactions panel (F7)
+ *
+ * Shows HTTP/1.x request, response, status-class and unanswered totals
+ * with time-to-first-byte percentiles, then a table of hosts (requests,
+ * responses by status class, error rate, body bytes, TTFB p50/p99) from
+ * HttpTracker snapshots. 'o' cycles between busiest, slowest p99 and
+ * most errors first.
+ */
+
+#pragma once
+
+#include "../http_tracker.hpp"
+#include "../panel.hpp"
+
+class HttpPanel : public Panel {
+public:
+    // A null tracker means tracking is disabled (--http-flows 0)
+    HttpPanel(PacketStore& store, UI& ui, const HttpTracker* tracker);
+
+    void render(WINDOW* win) override;
+    bool handle_key(int key) override;
+
+private:
+    const HttpTracker* tracker_;
+    HttpOrder order_ = HttpOrder::BUSIEST;
+
+    void render_table(WINDOW* win, int y, int last_row, const std::vector<HttpHostStats>& rows);
+};
@@ -56,7 +56,7 @@ void PacketListPanel::render(WINDOW* win) {
 
     // Show packet count in corner
     std::ostringstream oss;
-    oss << "[" << packet_count << " pkts]";
+    oss << "[" << packet_count << " pkts" << (show_outer_ ? ", outer" : "") << "]";
     mvwprintw(win, max_y - 1, max_x - static_cast<int>(oss.str().length()) - 1,
               "%s", oss.str().c_str());
 
@@ -108,11 +108,14 @@ void PacketListPanel::render_packet_row(WINDOW* win, int y, int width,
     mvwprintw(win, y, 1, "%-10s", time_str.c_str());
 
     // Source (14 chars)
-    std::string src = pkt.src_ip.empty() ? pkt.format_mac(pkt.src_mac) : pkt.src_ip;
+    bool outer = show_outer_ && !pkt.tunnel.src_ip.empty();
+    std::string src = outer ? pkt.tunnel.src_ip
+                            : pkt.src_ip.empty() ? pkt.format_mac(pkt.src_mac) : pkt.src_ip;
     mvwprintw(win, y, 12, "%-14s", UI::truncate(src, 13).c_str());
 
     // Destination (14 chars)
-    std::string dst = pkt.dst_ip.empty() ? pkt.format_mac(pkt.dst_mac) : pkt.dst_ip;
+    std::string dst = outer ? pkt.tunnel.dst_ip
+                            : pkt.dst_ip.empty() ? pkt.format_mac(pkt.dst_mac) : pkt.dst_ip;
     mvwprintw(win, y, 27, "%-14s", UI::truncate(dst, 13).c_str());
 
     // Protocol with colour (5 chars)
@@ -265,6 +268,11 @@ bool PacketListPanel::handle_key(int key) {
             auto_scroll_ = !auto_scroll_;
             return true;
 
+        case 'o':
+        case 'O':
+            show_outer_ = !show_outer_;
+            return true;
+
         case '\n':
         case KEY_ENTER:
             // Select packet for detail view
@@ -4,7 +4,8 @@
  * Displays a scrolling table of captured packets with columns for
  * timestamp, source, destination, protocol, length, category, and info.
  * Supports auto-scroll to follow new packets, manual scrolling, and
- * selecting packets for detailed inspection in the Detail panel.
+ * selecting packets for detailed inspection in the Detail panel. Tunnelled
+ * packets show their inner addresses unless 'o' switches to the outer ones.
  */
 
 #pragma once
@@ -30,6 +31,7 @@ public:
 
 private:
     bool auto_scroll_ = true;
+    bool show_outer_ = false;     // Toggled by 'o'
     size_t selected_row_ = 0;
     DescriptionDatabase* descriptions_ = nullptr;
 
@@ -87,6 +87,21 @@ void StatsPanel::render_summary(WINDOW* win, int& y, const InterfaceStats& stats
     wattroff(win, A_BOLD);
     ui_.unset_color(win, COLOR_TCP);
     y++;
+
+    // Bad checksums by protocol, once verification has seen a packet
+    if (stats.checksums_verified > 0) {
+        uint64_t bad = stats.bad_ipv4_checksums + stats.bad_tcp_checksums +
+                       stats.bad_udp_checksums;
+        mvwprintw(win, y, 2, "Bad Checksums: ");
+        if (bad > 0) ui_.set_color(win, COLOR_ERROR);
+        wattron(win, A_BOLD);
+        mvwprintw(win, y, 17, "IPv4 %lu  TCP %lu  UDP %lu",
+                  stats.bad_ipv4_checksums, stats.bad_tcp_checksums, stats.bad_udp_checksums);
+        wattroff(win, A_BOLD);
+        if (bad > 0) ui_.unset_color(win, COLOR_ERROR);
+        wprintw(win, "  (%lu offloaded)", stats.offloaded_checksums);
+        y++;
+    }
 }
 
 void StatsPanel::render_protocol_breakdown(WINDOW* win, int& y, int width,
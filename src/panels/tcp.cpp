@@ -0,0 +1,123 @@
+/*
+ * tcp.cpp - TCP connection health panel implementation
+ *
+ * Takes one snapshot per frame, sized to the rows that fit below the
+ * summary.
+ */
+
+#include "tcp.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+std::string format_rtt_us(uint64_t us) {
+    if (us == 0) return "-";
+    char text[16];
+    if (us >= 10000000ULL) {
+        std::snprintf(text, sizeof(text), "%.0fs", static_cast<double>(us) / 1e6);
+    } else if (us >= 100000ULL) {
+        std::snprintf(text, sizeof(text), "%.0fms", static_cast<double>(us) / 1e3);
+    } else {
+        std::snprintf(text, sizeof(text), "%.1fms", static_cast<double>(us) / 1e3);
+    }
+    return text;
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+}  // namespace
+
+TcpPanel::TcpPanel(PacketStore& store, UI& ui, const TcpAnalyzer* analyzer)
+    : Panel("TCP", store, ui), analyzer_(analyzer) {}
+
+void TcpPanel::render(WINDOW* win) {
+    UI::clear_window(win);
+
+    int max_y = getmaxy(win);
+    int max_x = getmaxx(win);
+
+    wattron(win, A_BOLD);
+    mvwprintw(win, 1, 2, "TCP Connections");
+    wattroff(win, A_BOLD);
+
+    if (!analyzer_) {
+        mvwprintw(win, 3, 2, "(TCP analysis disabled with --tcp-flows 0)");
+        UI::draw_box(win, active_);
+        wrefresh(win);
+        return;
+    }
+
+    mvwprintw(win, 1, max_x - 30, "[o] order: %s",
+              order_ == TcpOrder::WORST ? "most problems" : "slowest RTT");
+
+    int table_rows = std::max(1, max_y - 12);
+    TcpAnalyticsSnapshot snap = analyzer_->snapshot(static_cast<size_t>(table_rows), order_);
+    const TcpTotals& totals = snap.totals;
+
+    int y = 3;
+    mvwprintw(win, y++, 2, "Connections: %lu   Active: %lu   Handshakes: %lu   Resets: %lu   Evicted: %lu",
+              totals.connections, snap.active, totals.handshakes, totals.resets, snap.evictions);
+
+    bool unhealthy = totals.retransmissions > 0 || totals.zero_windows > 0;
+    if (unhealthy) ui_.set_color(win, COLOR_ALERT_TEXT);
+    mvwprintw(win, y++, 2, "Retransmitted: %lu (%.2f%%)   Out of order: %lu   Dup ACKs: %lu   Zero windows: %lu",
+              totals.retransmissions, percent(totals.retransmissions, totals.data_segments),
+              totals.out_of_order, totals.dup_acks, totals.zero_windows);
+    if (unhealthy) ui_.unset_color(win, COLOR_ALERT_TEXT);
+
+    const HistogramSnapshot& hs = snap.handshake_rtt;
+    const HistogramSnapshot& data = snap.data_rtt;
+    mvwprintw(win, y++, 2, "Handshake RTT:  p50 %s   p99 %s      Data RTT:  p50 %s   p99 %s",
+              format_rtt_us(hs.count ? hs.percentile(0.5) / 1000 : 0).c_str(),
+              format_rtt_us(hs.count ? hs.percentile(0.99) / 1000 : 0).c_str(),
+              format_rtt_us(data.count ? data.percentile(0.5) / 1000 : 0).c_str(),
+              format_rtt_us(data.count ? data.percentile(0.99) / 1000 : 0).c_str());
+    y++;
+
+    mvwhline(win, y++, 1, ACS_HLINE, max_x - 2);
+    render_table(win, y, max_y - 1, snap.flows);
+
+    UI::draw_box(win, active_);
+    wrefresh(win);
+}
+
+void TcpPanel::render_table(WINDOW* win, int y, int last_row,
+                            const std::vector<TcpFlowStats>& rows) {
+    int endpoint_width = std::max(16, (getmaxx(win) - 66) / 2);
+
+    wattron(win, A_BOLD | A_UNDERLINE);
+    mvwprintw(win, y++, 2, "%-*s %-*s %7s %6s %5s %5s %5s %8s %8s", endpoint_width, "Client",
+              endpoint_width, "Server", "Packets", "Retr%", "OOO", "Dup", "ZWin", "iRTT", "sRTT");
+    wattroff(win, A_BOLD | A_UNDERLINE);
+
+    for (const TcpFlowStats& row : rows) {
+        if (y >= last_row) break;
+        const TcpFlowState& s = row.state;
+        bool unhealthy = s.retransmissions > 0 || s.zero_windows > 0;
+
+        if (unhealthy) ui_.set_color(win, COLOR_ALERT_TEXT);
+        if (row.closed()) wattron(win, A_DIM);
+        mvwprintw(win, y++, 2, "%-*.*s %-*.*s %7u %6.1f %5u %5u %5u %8s %8s",
+                  endpoint_width, endpoint_width, row.client.c_str(),
+                  endpoint_width, endpoint_width, row.server.c_str(), s.packets,
+                  percent(s.retransmissions, s.data_segments), s.out_of_order, s.dup_acks,
+                  s.zero_windows, format_rtt_us(s.handshake_rtt_us).c_str(),
+                  format_rtt_us(s.srtt_us).c_str());
+        if (row.closed()) wattroff(win, A_DIM);
+        if (unhealthy) ui_.unset_color(win, COLOR_ALERT_TEXT);
+    }
+    if (rows.empty() && y < last_row) {
+        mvwprintw(win, y, 2, "(No TCP connections seen yet)");
+    }
+}
+
+bool TcpPanel::handle_key(int key) {
+    if (key == 'o' || key == 'O') {
+        order_ = order_ == TcpOrder::WORST ? TcpOrder::SLOWEST : TcpOrder::WORST;
+        return true;
+    }
+    return false;
+}
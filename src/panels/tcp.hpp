@@ -0,0 +1,30 @@
+/*
+ * tcp.hpp - TCP connection health panel (F6)
+ *
+ * Shows how TCP is performing: connection, retransmission, out-of-order,
+ * duplicate ACK and zero-window totals with handshake and data RTT
+ * percentiles, then a table of connections (client, server, packets,
+ * retransmission rate, reordering, duplicate ACKs, zero windows, RTTs)
+ * from TcpAnalyzer snapshots. 'o' switches between most problems and
+ * slowest first.
+ */
+
+#pragma once
+
+#include "../panel.hpp"
+#include "../tcp_analytics.hpp"
+
+class TcpPanel : public Panel {
+public:
+    // A null analyzer means analysis is disabled (--tcp-flows 0)
+    TcpPanel(PacketStore& store, UI& ui, const TcpAnalyzer* analyzer);
+
+    void render(WINDOW* win) override;
+    bool handle_key(int key) override;
+
+private:
+    const TcpAnalyzer* analyzer_;
+    TcpOrder order_ = TcpOrder::WORST;
+
+    void render_table(WINDOW* win, int y, int last_row, const std::vector<TcpFlowStats>& rows);
+};
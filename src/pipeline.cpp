@@ -0,0 +1,213 @@
+/*
+ * pipeline.cpp - Per-packet processing implementation
+ */
+
+#include "pipeline.hpp"
+#include "attack_detector.hpp"
+#include "checksum.hpp"
+#include "descriptions.hpp"
+#include "dns_cache.hpp"
+#include "dns_tracker.hpp"
+#include "exporter.hpp"
+#include "flow_export.hpp"
+#include "http_tracker.hpp"
+#include "ip_reassembly.hpp"
+#include "quic.hpp"
+#include "metrics.hpp"
+#include "process_mapper.hpp"
+#include "recorder.hpp"
+#include "tcp_analytics.hpp"
+#include "tcp_reassembly.hpp"
+#include "trigger_capture.hpp"
+#include "watchlist.hpp"
+
+void PacketPipeline::process(const uint8_t* data, uint32_t caplen, uint32_t len,
+                             std::chrono::system_clock::time_point timestamp) {
+    StageProfiler* profiler = metrics_ ? &metrics_->profiler() : nullptr;
+
+    // Parse the packet
+    PacketInfo info;
+    {
+        ScopedStageTimer timer(profiler, Stage::PARSE);
+        info = parser_(data, caplen, len);
+    }
+
+    // Use the capture timestamp rather than the time we got around to it
+    info.timestamp = timestamp;
+    last_packet_time_ = timestamp;
+    last_packet_seen_ = std::chrono::steady_clock::now();
+
+    // Before reassembly replaces fragments with the datagram they complete
+    if (checksums_) {
+        ScopedStageTimer timer(profiler, Stage::CHECKSUM);
+        verify_checksums(info);
+    }
+
+    // Rebuild fragmented datagrams, then application messages split
+    // across TCP segments
+    bool fragment = ip_reassembler_ && info.is_fragment();
+    bool segment = reassembler_ && info.protocol == PROTO_TCP && !info.is_fragment();
+    if (fragment || segment) {
+        ScopedStageTimer timer(profiler, Stage::REASSEMBLE);
+        if (fragment) {
+            ip_reassembler_->on_packet(info);
+        } else {
+            reassembler_->on_packet(info);
+        }
+    }
+
+    // Retransmissions, reordering, windows and RTT of TCP connections
+    if (tcp_analyzer_ && info.protocol == PROTO_TCP) {
+        ScopedStageTimer timer(profiler, Stage::TCP);
+        tcp_analyzer_->on_packet(info);
+    }
+
+    // Match HTTP/1.x responses to requests for status and time to first byte
+    if (http_tracker_ && info.protocol == PROTO_TCP) {
+        ScopedStageTimer timer(profiler, Stage::HTTP);
+        http_tracker_->on_packet(info);
+    }
+
+    // Decrypt the ClientHello in the first QUIC Initials of a connection
+    if (quic_ && info.protocol == PROTO_UDP) {
+        ScopedStageTimer timer(profiler, Stage::QUIC);
+        quic_->on_packet(info);
+    }
+
+    // Time DNS transactions, learn answers, and name packets that carry
+    // no hostname of their own
+    if ((dns_cache_ || dns_tracker_) && info.ip_version != 0) {
+        ScopedStageTimer timer(profiler, Stage::RESOLVE);
+        if (dns_tracker_) {
+            dns_tracker_->on_packet(info);
+        }
+        if (dns_cache_) {
+            dns_cache_->on_packet(info);
+        }
+    }
+
+    // Check against watchlist if configured
+    if (watchlist_) {
+        ScopedStageTimer timer(profiler, Stage::WATCHLIST);
+        auto match = watchlist_->check(info);
+        if (match) {
+            info.watchlist_match = true;
+            info.watchlist_label = match->label;
+            raise_alert(match->matched_value(info), match->pattern, match->label);
+        }
+    }
+
+    // SYN floods, port scans, host sweeps and RST storms; a watchlist
+    // label already on the packet is kept
+    if (detector_ && info.protocol == PROTO_TCP) {
+        ScopedStageTimer timer(profiler, Stage::DETECT);
+        if (auto event = detector_->on_packet(info)) {
+            std::string label = event->describe(detector_->config().window);
+            if (!info.watchlist_match) {
+                info.watchlist_match = true;
+                info.watchlist_label = label;
+            }
+            raise_alert(event->address, detection_name(event->kind), label);
+        }
+    }
+
+    // Rolling pre-trigger buffer; an alert opens a window that includes
+    // this packet and everything up to post_seconds after it
+    if (trigger_) {
+        trigger_->on_packet(info);
+        if (info.watchlist_match) {
+            trigger_->on_alert(info.watchlist_label, info.timestamp);
+        }
+    }
+
+    // Eager description lookup (benchmarks); the packet list does it on render
+    if (descriptions_ && !info.hostname.empty()) {
+        ScopedStageTimer timer(profiler, Stage::DESCRIBE);
+        auto result = descriptions_->lookup(info.hostname);
+        if (result) {
+            info.category = result->category;
+            info.description = result->description;
+        }
+    }
+
+    // Process attribution when enabled
+    if (process_enabled_.load() && process_mapper_) {
+        ScopedStageTimer timer(profiler, Stage::PROCESS);
+        auto proc = process_mapper_->lookup_packet(
+            info.src_ip,
+            info.src_port,
+            info.dst_ip,
+            info.dst_port,
+            info.protocol
+        );
+        if (proc) {
+            info.process_name = proc->name;
+            info.process_pid = proc->pid;
+        }
+    }
+
+    if (metrics_) {
+        metrics_->record_packet(info);
+    }
+
+    // Queue raw frame for the recorder thread (never blocks)
+    if (recorder_) {
+        recorder_->enqueue(info);
+    }
+
+    // Serialise metadata for export (may block under the BLOCK policy)
+    if (exporter_) {
+        exporter_->on_packet(info);
+    }
+    if (flow_exporter_) {
+        flow_exporter_->on_packet(info);
+    }
+
+    // Push to store (thread-safe)
+    ScopedStageTimer timer(profiler, Stage::STORE);
+    store_.push(std::move(info));
+}
+
+void PacketPipeline::tick() {
+    // Close alert windows even when traffic stops
+    if (trigger_) {
+        trigger_->tick();
+    }
+
+    // Expire idle flows and flush partly filled export chunks
+    if (exporter_) {
+        exporter_->tick();
+    }
+    if (flow_exporter_) {
+        flow_exporter_->tick();
+    }
+
+    // Count queries that were never answered even when traffic stops,
+    // advancing capture time by however long the link has been quiet
+    if (dns_tracker_ && last_packet_seen_ != std::chrono::steady_clock::time_point{}) {
+        auto capture_now = last_packet_time_ +
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::steady_clock::now() - last_packet_seen_);
+        if (capture_now - last_dns_expire_ >= std::chrono::seconds(1)) {
+            last_dns_expire_ = capture_now;
+            dns_tracker_->expire(capture_now);
+        }
+    }
+}
+
+void PacketPipeline::raise_alert(const std::string& matched_value, const std::string& pattern,
+                                 const std::string& label) {
+    Alert alert;
+    alert.timestamp = std::chrono::system_clock::now();
+    alert.matched_value = matched_value;
+    alert.pattern = pattern;
+    alert.label = label;
+    alert.packet_index = store_.size();
+
+    if (watchlist_) {
+        watchlist_->add_alert(alert);
+    }
+    if (metrics_) {
+        metrics_->record_alert();
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * pipeline.hpp - Per-packet processing shared by live capture and benchmarks
+ *
+ * Takes one captured frame through every stage: parse (with the parser
+ * specialised for the capture's link type), optional IPv4/TCP/UDP checksum
+ * verification, IP fragment and TCP
+ * reassembly for split datagrams and application messages, TCP sequence
+ * and RTT analysis, HTTP request/response matching, QUIC Initial
+ * decryption for SNI, passive DNS
+ * (learning answers, labelling packets without a hostname, timing queries),
+ * watchlist check, SYN flood/scan/sweep detection,
+ * optional description enrichment, optional process attribution, metrics,
+ * the recorder/trigger/export integrations, and finally the PacketStore.
+ * Each stage is timed into the metrics registry's StageProfiler when a
+ * registry is set.
+ *
+ * PacketCapture drives it from the pcap callback; the benchmark mode drives
+ * it from memory. Not thread-safe: call process() and tick() from one thread.
+ */
+
+#pragma once
+
+#include "packet_store.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+class Watchlist;
+class DescriptionDatabase;
+class ProcessMapper;
+class MetricsRegistry;
+class PcapngRecorder;
+class TriggerCapture;
+class RecordExporter;
+class FlowExporter;
+class TcpReassembler;
+class IpReassembler;
+class DnsCache;
+class DnsTracker;
+class TcpAnalyzer;
+class HttpTracker;
+class QuicDissector;
+class AttackDetector;
+
+class PacketPipeline {
+public:
+    explicit PacketPipeline(PacketStore& store) : store_(store) {}
+
+    // Non-copyable
+    PacketPipeline(const PacketPipeline&) = delete;
+    PacketPipeline& operator=(const PacketPipeline&) = delete;
+
+    // Run one frame through every stage
+    void process(const uint8_t* data, uint32_t caplen, uint32_t len,
+                 std::chrono::system_clock::time_point timestamp);
+
+    // Timeouts and flushes for the integrations; call regularly
+    void tick();
+
+    // Framing of the frames passed to process(); Ethernet unless set
+    void set_link_type(LinkType link) { parser_ = packet_parser(link); }
+
+    // Verify IPv4, TCP and UDP checksums of every packet; off unless set
+    void set_checksums(bool enabled) { checksums_ = enabled; }
+
+    // Optional integrations
+    void set_watchlist(Watchlist* wl) { watchlist_ = wl; }
+    void set_descriptions(const DescriptionDatabase* db) { descriptions_ = db; }
+    void set_process_mapper(ProcessMapper* pm) { process_mapper_ = pm; }
+    void set_metrics(MetricsRegistry* metrics) { metrics_ = metrics; }
+    void set_recorder(PcapngRecorder* recorder) { recorder_ = recorder; }
+    void set_trigger(TriggerCapture* trigger) { trigger_ = trigger; }
+    void set_exporter(RecordExporter* exporter) { exporter_ = exporter; }
+    void set_flow_exporter(FlowExporter* exporter) { flow_exporter_ = exporter; }
+    void set_reassembler(TcpReassembler* reassembler) { reassembler_ = reassembler; }
+    void set_ip_reassembler(IpReassembler* reassembler) { ip_reassembler_ = reassembler; }
+    void set_quic(QuicDissector* quic) { quic_ = quic; }
+    void set_dns_cache(DnsCache* cache) { dns_cache_ = cache; }
+    void set_dns_tracker(DnsTracker* tracker) { dns_tracker_ = tracker; }
+    void set_tcp_analyzer(TcpAnalyzer* analyzer) { tcp_analyzer_ = analyzer; }
+    void set_http_tracker(HttpTracker* tracker) { http_tracker_ = tracker; }
+    void set_detector(AttackDetector* detector) { detector_ = detector; }
+    void set_process_enabled(bool enabled) { process_enabled_.store(enabled); }
+    bool is_process_enabled() const { return process_enabled_.load(); }
+
+    MetricsRegistry* metrics() const { return metrics_; }
+
+private:
+    // Log an alert for the packet about to be stored
+    void raise_alert(const std::string& matched_value, const std::string& pattern,
+                     const std::string& label);
+
+    PacketStore& store_;
+    PacketParser parser_ = parse_packet;
+    bool checksums_ = false;
+
+    Watchlist* watchlist_ = nullptr;
+    const DescriptionDatabase* descriptions_ = nullptr;  // The UI enriches lazily instead
+    ProcessMapper* process_mapper_ = nullptr;
+    MetricsRegistry* metrics_ = nullptr;
+    PcapngRecorder* recorder_ = nullptr;
+    TriggerCapture* trigger_ = nullptr;
+    RecordExporter* exporter_ = nullptr;
+    FlowExporter* flow_exporter_ = nullptr;
+    TcpReassembler* reassembler_ = nullptr;
+    IpReassembler* ip_reassembler_ = nullptr;
+    QuicDissector* quic_ = nullptr;
+    DnsCache* dns_cache_ = nullptr;
+    DnsTracker* dns_tracker_ = nullptr;
+    TcpAnalyzer* tcp_analyzer_ = nullptr;
+    HttpTracker* http_tracker_ = nullptr;
+    AttackDetector* detector_ = nullptr;
+    std::atomic<bool> process_enabled_{false};  // Toggled from the UI thread
+
+    // Capture time for tick(): the last packet's timestamp and when it came
+    std::chrono::system_clock::time_point last_packet_time_{};
+    std::chrono::steady_clock::time_point last_packet_seen_{};
+    std::chrono::system_clock::time_point last_dns_expire_{};
+};
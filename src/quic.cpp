@@ -0,0 +1,297 @@
+/*
+ * quic.cpp - QUIC Initial packet decryption implementation
+ */
+
+#include "quic.hpp"
+#include "crypto.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t QUIC_V1_SALT[20] = {
+    0x38, 0x76, 0x2c, 0xf7, 0xf5, 0x59, 0x34, 0xb3, 0x4d, 0x17,
+    0x9a, 0xe6, 0xa4, 0xc8, 0x0c, 0xad, 0xcc, 0xbb, 0x7f, 0x0a
+};
+constexpr uint8_t QUIC_V2_SALT[20] = {
+    0x0d, 0xed, 0xe3, 0xde, 0xf7, 0x00, 0xa6, 0xdb, 0x81, 0x93,
+    0x81, 0xbe, 0x6e, 0x26, 0x9d, 0xcb, 0xf9, 0xbd, 0x2e, 0xd9
+};
+
+constexpr uint8_t FRAME_PADDING = 0x00;
+constexpr uint8_t FRAME_PING = 0x01;
+constexpr uint8_t FRAME_ACK = 0x02;
+constexpr uint8_t FRAME_ACK_ECN = 0x03;
+constexpr uint8_t FRAME_CRYPTO = 0x06;
+constexpr uint8_t FRAME_CONNECTION_CLOSE = 0x1c;
+
+// Flow oriented client -> server, so both directions share one entry
+FlowKey client_flow(const PacketInfo& info) {
+    FlowKey key = FlowKey::from_packet(info);
+    if (info.src_port == PORT_HTTPS && info.dst_port != PORT_HTTPS) {
+        std::swap(key.src_port, key.dst_port);
+        std::swap(key.src_addr, key.dst_addr);
+    }
+    return key;
+}
+
+}  // namespace
+
+bool derive_quic_initial_keys(uint32_t version, const uint8_t* dcid, size_t dcid_len,
+                              bool client, QuicInitialKeys& keys) {
+    const uint8_t* salt = nullptr;
+    std::string prefix;
+    if (version == QUIC_VERSION_1) {
+        salt = QUIC_V1_SALT;
+        prefix = "quic ";
+    } else if (version == QUIC_VERSION_2) {
+        salt = QUIC_V2_SALT;
+        prefix = "quicv2 ";
+    } else {
+        return false;
+    }
+
+    Sha256Digest initial = hkdf_extract(salt, sizeof(QUIC_V1_SALT), dcid, dcid_len);
+    Sha256Digest secret;
+    hkdf_expand_label(initial, client ? "client in" : "server in", secret.data(), secret.size());
+    hkdf_expand_label(secret, prefix + "key", keys.key.data(), keys.key.size());
+    hkdf_expand_label(secret, prefix + "iv", keys.iv.data(), keys.iv.size());
+    hkdf_expand_label(secret, prefix + "hp", keys.hp.data(), keys.hp.size());
+    return true;
+}
+
+bool decrypt_quic_initial(const uint8_t* data, size_t len, const QuicLongHeader& header,
+                          const QuicInitialKeys& keys, std::vector<uint8_t>& frames) {
+    // The header protection sample starts 4 bytes past the packet number
+    size_t pn_offset = header.pn_offset;
+    if (header.type != QuicPacketType::INITIAL || pn_offset > len ||
+        header.length > len - pn_offset || header.length < 4 + 16) {
+        return false;
+    }
+
+    uint8_t mask[16];
+    Aes128(keys.hp.data()).encrypt_block(data + pn_offset + 4, mask);
+    uint8_t first = data[0] ^ (mask[0] & 0x0F);
+    size_t pn_len = (first & 0x03) + 1;
+
+    // Unprotected header is the AAD; Initial packet numbers are small
+    // enough early on that the truncated value is the full one
+    std::vector<uint8_t> aad(data, data + pn_offset + pn_len);
+    aad[0] = first;
+    uint64_t packet_number = 0;
+    for (size_t i = 0; i < pn_len; ++i) {
+        aad[pn_offset + i] ^= mask[1 + i];
+        packet_number = (packet_number << 8) | aad[pn_offset + i];
+    }
+
+    uint8_t nonce[12];
+    std::memcpy(nonce, keys.iv.data(), sizeof(nonce));
+    for (int i = 0; i < 8; ++i) {
+        nonce[11 - i] ^= static_cast<uint8_t>(packet_number >> (8 * i));
+    }
+
+    const uint8_t* payload = data + pn_offset + pn_len;
+    size_t payload_len = header.length - pn_len - 16;
+    frames.resize(payload_len);
+    return aes128_gcm_decrypt(keys.key.data(), nonce, aad.data(), aad.size(),
+                              payload, payload_len, payload + payload_len, frames.data());
+}
+
+bool parse_quic_crypto_frames(const uint8_t* frames, size_t len, std::vector<QuicCryptoFrame>& out) {
+    size_t pos = 0;
+    while (pos < len) {
+        uint64_t type = 0;
+        if (!read_quic_varint(frames, len, pos, type)) return false;
+
+        uint64_t value = 0;
+        switch (type) {
+            case FRAME_PADDING:
+            case FRAME_PING:
+                break;
+            case FRAME_ACK:
+            case FRAME_ACK_ECN: {
+                // Largest, delay, range count, first range, then ranges
+                uint64_t ranges = 0;
+                if (!read_quic_varint(frames, len, pos, value) ||
+                    !read_quic_varint(frames, len, pos, value) ||
+                    !read_quic_varint(frames, len, pos, ranges) ||
+                    !read_quic_varint(frames, len, pos, value)) {
+                    return false;
+                }
+                uint64_t fields = ranges * 2 + (type == FRAME_ACK_ECN ? 3 : 0);
+                for (uint64_t i = 0; i < fields; ++i) {
+                    if (!read_quic_varint(frames, len, pos, value)) return false;
+                }
+                break;
+            }
+            case FRAME_CRYPTO: {
+                QuicCryptoFrame frame;
+                if (!read_quic_varint(frames, len, pos, frame.offset) ||
+                    !read_quic_varint(frames, len, pos, value) || value > len - pos) {
+                    return false;
+                }
+                frame.data = frames + pos;
+                frame.length = static_cast<size_t>(value);
+                pos += frame.length;
+                out.push_back(frame);
+                break;
+            }
+            case FRAME_CONNECTION_CLOSE: {
+                // Error code, frame type, reason phrase
+                if (!read_quic_varint(frames, len, pos, value) ||
+                    !read_quic_varint(frames, len, pos, value) ||
+                    !read_quic_varint(frames, len, pos, value) || value > len - pos) {
+                    return false;
+                }
+                pos += static_cast<size_t>(value);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+QuicDissector::QuicDissector(const QuicConfig& config) : config_(config) {}
+
+void QuicDissector::on_packet(PacketInfo& info) {
+    if (config_.max_flows == 0 || info.protocol != PROTO_UDP || info.app_protocol != "QUIC") {
+        return;
+    }
+
+    // Hot path: the flow's ClientHello was already seen
+    FlowKey flow = client_flow(info);
+    auto known = flows_.find(flow);
+    if (known != flows_.end()) {
+        flow_lru_.splice(flow_lru_.end(), flow_lru_, known->second.lru);
+        if (info.hostname.empty()) {
+            info.hostname = known->second.hostname;
+            stats_.labelled++;
+        }
+        return;
+    }
+
+    // Otherwise only client Initials are of interest
+    if (info.dst_port != PORT_HTTPS || info.payload_offset > info.raw_data.size()) {
+        return;
+    }
+    const uint8_t* data = info.raw_data.data() + info.payload_offset;
+    size_t len = std::min<size_t>(info.payload_length, info.raw_data.size() - info.payload_offset);
+    QuicLongHeader header;
+    if (!parse_quic_long_header(data, len, header) || header.type != QuicPacketType::INITIAL ||
+        (header.version != QUIC_VERSION_1 && header.version != QUIC_VERSION_2)) {
+        return;
+    }
+    stats_.initials++;
+
+    std::string id(reinterpret_cast<const char*>(header.dcid.data()), header.dcid_len);
+    auto it = handshakes_.find(id);
+    if (it == handshakes_.end()) {
+        if (handshakes_.size() >= config_.max_handshakes) {
+            handshakes_.erase(handshake_lru_.front());
+            handshake_lru_.pop_front();
+        }
+        Handshake handshake;
+        derive_quic_initial_keys(header.version, header.dcid.data(), header.dcid_len, true,
+                                 handshake.keys);
+        handshake.lru = handshake_lru_.insert(handshake_lru_.end(), id);
+        it = handshakes_.emplace(std::move(id), std::move(handshake)).first;
+    } else {
+        handshake_lru_.splice(handshake_lru_.end(), handshake_lru_, it->second.lru);
+    }
+
+    // A retransmitted or late Initial of a finished handshake is not reopened
+    Handshake& handshake = it->second;
+    if (handshake.done || ++handshake.packets > config_.max_initial_packets) {
+        handshake.done = true;
+        return;
+    }
+
+    if (!decrypt_quic_initial(data, len, header, handshake.keys, frames_)) {
+        stats_.decrypt_failures++;
+        return;
+    }
+    stats_.decrypted++;
+
+    crypto_frames_.clear();
+    parse_quic_crypto_frames(frames_.data(), frames_.size(), crypto_frames_);
+    for (const QuicCryptoFrame& frame : crypto_frames_) {
+        add_crypto(handshake, frame);
+    }
+    if (try_client_hello(handshake, info)) {
+        handshake.done = true;
+        std::vector<uint8_t>().swap(handshake.crypto);  // Keep only the done marker
+        handshake.ranges.clear();
+    }
+}
+
+void QuicDissector::add_crypto(Handshake& handshake, const QuicCryptoFrame& frame) {
+    if (frame.offset >= config_.max_crypto_bytes || frame.length == 0) {
+        return;
+    }
+    uint32_t begin = static_cast<uint32_t>(frame.offset);
+    uint32_t end = static_cast<uint32_t>(std::min<uint64_t>(frame.offset + frame.length,
+                                                            config_.max_crypto_bytes));
+    if (handshake.crypto.size() < end) {
+        handshake.crypto.resize(end);
+    }
+    std::memcpy(handshake.crypto.data() + begin, frame.data, end - begin);
+
+    // Insert, then merge overlapping and touching ranges
+    auto& ranges = handshake.ranges;
+    auto pos = std::lower_bound(ranges.begin(), ranges.end(), std::make_pair(begin, end));
+    pos = ranges.insert(pos, {begin, end});
+    if (pos != ranges.begin() && (pos - 1)->second >= pos->first) {
+        --pos;
+        pos->second = std::max(pos->second, (pos + 1)->second);
+        ranges.erase(pos + 1);
+    }
+    while (pos + 1 != ranges.end() && pos->second >= (pos + 1)->first) {
+        pos->second = std::max(pos->second, (pos + 1)->second);
+        ranges.erase(pos + 1);
+    }
+}
+
+bool QuicDissector::try_client_hello(Handshake& handshake, PacketInfo& info) {
+    size_t contiguous = !handshake.ranges.empty() && handshake.ranges[0].first == 0
+                        ? handshake.ranges[0].second : 0;
+    if (contiguous < 4) {
+        return false;
+    }
+    const uint8_t* data = handshake.crypto.data();
+    if (data[0] != 0x01) {
+        return true;  // Not a ClientHello; nothing to wait for
+    }
+    size_t needed = 4 + ((static_cast<size_t>(data[1]) << 16) | (data[2] << 8) | data[3]);
+    if (contiguous < needed && contiguous < config_.max_crypto_bytes) {
+        return false;
+    }
+
+    PacketInfo parsed{};
+    parsed.protocol = PROTO_UDP;
+    parse_client_hello(parsed, data, std::min(contiguous, needed));
+    if (!parsed.hostname.empty()) {
+        stats_.client_hellos++;
+        remember(client_flow(info), parsed.hostname);
+        if (info.hostname.empty()) {
+            info.hostname = std::move(parsed.hostname);
+        }
+    }
+    if (!parsed.app_protocol.empty()) {
+        info.app_info += " Client Hello";
+        info.tls_fingerprint = std::move(parsed.tls_fingerprint);
+    }
+    return true;
+}
+
+void QuicDissector::remember(const FlowKey& flow, const std::string& hostname) {
+    if (flows_.size() >= config_.max_flows) {
+        flows_.erase(flow_lru_.front());
+        flow_lru_.pop_front();
+    }
+    Flow entry;
+    entry.hostname = hostname;
+    entry.lru = flow_lru_.insert(flow_lru_.end(), flow);
+    flows_.emplace(flow, std::move(entry));
+}
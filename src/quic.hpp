@@ -0,0 +1,109 @@
+/*
+ * quic.hpp - QUIC Initial packet decryption for SNI extraction
+ *
+ * QUIC hides the TLS ClientHello inside Initial packets, encrypted with keys
+ * that anyone can derive from the client's Destination Connection ID (RFC
+ * 9001 section 5.2; RFC 9369 for v2). QuicDissector derives those keys,
+ * removes header protection, decrypts the payload, gathers CRYPTO frames
+ * (a ClientHello with post-quantum key shares often spans two Initials, in
+ * any order) and hands the complete message to parse_client_hello().
+ *
+ * Only the first few client Initials of each connection are decrypted.
+ * The outcome is cached per connection ID, and the hostname per flow, so
+ * later Initials, the server's packets and short-header 1-RTT packets
+ * are labelled with one hash lookup. Both tables are LRU-bounded. Not
+ * thread-safe: owned by the pipeline thread.
+ */
+
+#pragma once
+
+#include "flow_table.hpp"
+#include "packet.hpp"
+#include <array>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct QuicInitialKeys {
+    std::array<uint8_t, 16> key{};
+    std::array<uint8_t, 12> iv{};
+    std::array<uint8_t, 16> hp{};
+};
+
+// Initial packet keys for one side, from the DCID of the client's first
+// Initial. False for versions other than v1 and v2.
+bool derive_quic_initial_keys(uint32_t version, const uint8_t* dcid, size_t dcid_len,
+                              bool client, QuicInitialKeys& keys);
+
+// Remove header protection from the Initial packet at data (header parsed
+// by parse_quic_long_header) and decrypt it into frames. False if the
+// packet is truncated or fails authentication.
+bool decrypt_quic_initial(const uint8_t* data, size_t len, const QuicLongHeader& header,
+                          const QuicInitialKeys& keys, std::vector<uint8_t>& frames);
+
+struct QuicCryptoFrame {
+    uint64_t offset = 0;
+    const uint8_t* data = nullptr;  // Points into the decrypted frames
+    size_t length = 0;
+};
+
+// CRYPTO frames among the frames allowed in Initial packets (PADDING, PING,
+// ACK, CRYPTO, CONNECTION_CLOSE). False on anything else or malformed input,
+// keeping the frames found before it.
+bool parse_quic_crypto_frames(const uint8_t* frames, size_t len, std::vector<QuicCryptoFrame>& out);
+
+struct QuicConfig {
+    size_t max_flows = 16384;        // Labelled flows; 0 disables decryption
+    size_t max_handshakes = 1024;    // Connection IDs being (or already) dissected
+    size_t max_crypto_bytes = 8192;  // CRYPTO stream kept per connection
+    unsigned max_initial_packets = 4;
+};
+
+struct QuicStats {
+    uint64_t initials = 0;          // Client Initials looked at
+    uint64_t decrypted = 0;
+    uint64_t decrypt_failures = 0;
+    uint64_t client_hellos = 0;     // With a server name
+    uint64_t labelled = 0;          // Later packets named from the cache
+};
+
+class QuicDissector {
+public:
+    explicit QuicDissector(const QuicConfig& config = QuicConfig());
+
+    // Feed a parsed packet; anything but QUIC is ignored
+    void on_packet(PacketInfo& info);
+
+    const QuicStats& stats() const { return stats_; }
+
+private:
+    struct Handshake {
+        QuicInitialKeys keys;
+        std::vector<uint8_t> crypto;                        // CRYPTO bytes at their offsets
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;  // Received [begin, end), merged
+        unsigned packets = 0;
+        bool done = false;
+        std::list<std::string>::iterator lru;
+    };
+
+    struct Flow {
+        std::string hostname;
+        std::list<FlowKey>::iterator lru;
+    };
+
+    void add_crypto(Handshake& handshake, const QuicCryptoFrame& frame);
+    bool try_client_hello(Handshake& handshake, PacketInfo& info);
+    void remember(const FlowKey& flow, const std::string& hostname);
+
+    QuicConfig config_;
+    std::unordered_map<std::string, Handshake> handshakes_;  // By DCID bytes
+    std::list<std::string> handshake_lru_;                   // Front is least recent
+    std::unordered_map<FlowKey, Flow, FlowKeyHash> flows_;
+    std::list<FlowKey> flow_lru_;
+    std::vector<uint8_t> frames_;                            // Scratch, reused
+    std::vector<QuicCryptoFrame> crypto_frames_;
+    QuicStats stats_;
+};
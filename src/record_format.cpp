@@ -0,0 +1,342 @@
+/*
+ * record_format.cpp - NDJSON/CSV record formatting implementation
+ *
+ * Integers are written with a small reverse-digit loop instead of
+ * snprintf; on the export path formatting is the dominant cost, and this
+ * keeps it to a few nanoseconds per field.
+ */
+
+#include "record_format.hpp"
+#include "metrics.hpp"
+#include <cstring>
+
+namespace {
+
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+// Timestamps are split into whole seconds and a 6-digit fraction
+void split_micros(std::chrono::system_clock::time_point tp, int64_t& secs, uint32_t& micros) {
+    int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+        tp.time_since_epoch()).count();
+    secs = us / 1000000;
+    int64_t rem = us % 1000000;
+    if (rem < 0) {
+        rem += 1000000;
+        secs -= 1;
+    }
+    micros = static_cast<uint32_t>(rem);
+}
+
+// Finish a record: on overflow, roll back to where it started
+bool finish(FormatBuffer& out, size_t mark) {
+    if (out.overflowed()) {
+        out.rollback(mark);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+void FormatBuffer::put(char c) {
+    if (size_ >= capacity_) {
+        overflowed_ = true;
+        return;
+    }
+    data_[size_++] = c;
+}
+
+void FormatBuffer::put(std::string_view text) {
+    if (text.size() > capacity_ - size_) {
+        overflowed_ = true;
+        return;
+    }
+    std::memcpy(data_ + size_, text.data(), text.size());
+    size_ += text.size();
+}
+
+void FormatBuffer::put_uint(uint64_t value) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    if (n > capacity_ - size_) {
+        overflowed_ = true;
+        return;
+    }
+    while (n > 0) {
+        data_[size_++] = digits[--n];
+    }
+}
+
+void FormatBuffer::put_int(int64_t value) {
+    if (value < 0) {
+        put('-');
+        put_uint(static_cast<uint64_t>(-(value + 1)) + 1);
+    } else {
+        put_uint(static_cast<uint64_t>(value));
+    }
+}
+
+void FormatBuffer::put_timestamp(std::chrono::system_clock::time_point tp) {
+    int64_t secs;
+    uint32_t micros;
+    split_micros(tp, secs, micros);
+
+    put_int(secs);
+    put('.');
+    char frac[6];
+    for (int i = 5; i >= 0; --i) {
+        frac[i] = static_cast<char>('0' + micros % 10);
+        micros /= 10;
+    }
+    put(std::string_view(frac, sizeof(frac)));
+}
+
+void FormatBuffer::put_json_string(std::string_view text) {
+    put('"');
+    for (char c : text) {
+        unsigned char uc = static_cast<unsigned char>(c);
+        switch (c) {
+            case '"':  put("\\\""); break;
+            case '\\': put("\\\\"); break;
+            case '\n': put("\\n"); break;
+            case '\r': put("\\r"); break;
+            case '\t': put("\\t"); break;
+            default:
+                if (uc < 0x20 || uc == 0x7f) {
+                    char esc[6] = {'\\', 'u', '0', '0', HEX_DIGITS[uc >> 4], HEX_DIGITS[uc & 0xf]};
+                    put(std::string_view(esc, sizeof(esc)));
+                } else {
+                    put(c);
+                }
+                break;
+        }
+    }
+    put('"');
+}
+
+void FormatBuffer::put_csv_field(std::string_view text) {
+    if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+        put(text);
+        return;
+    }
+
+    put('"');
+    for (char c : text) {
+        if (c == '"') put('"');
+        put(c);
+    }
+    put('"');
+}
+
+const char* flow_end_reason_name(FlowEndReason reason) {
+    switch (reason) {
+        case FlowEndReason::IDLE_TIMEOUT:   return "idle";
+        case FlowEndReason::ACTIVE_TIMEOUT: return "active";
+        case FlowEndReason::END_OF_FLOW:    return "end";
+        case FlowEndReason::FORCED:         return "forced";
+    }
+    return "forced";
+}
+
+const char* packet_csv_header() {
+    return "ts,len,ip_version,proto,ip_proto,src,dst,sport,dport,tcp_flags,ttl,"
+           "hostname,app,info,process,pid,alert\n";
+}
+
+const char* flow_csv_header() {
+    return "first,last,ip_version,ip_proto,src,dst,sport,dport,packets,bytes,tcp_flags,"
+           "hostname,app,ja3,ja4,end\n";
+}
+
+bool format_packet_ndjson(FormatBuffer& out, const PacketInfo& pkt) {
+    size_t mark = out.mark();
+
+    out.put("{\"ts\":");
+    out.put_timestamp(pkt.timestamp);
+    out.put(",\"len\":");
+    out.put_uint(pkt.original_length);
+    out.put(",\"ip_version\":");
+    out.put_uint(pkt.ip_version);
+    out.put(",\"proto\":\"");
+    out.put(protocol_class_name(classify_protocol(pkt)));
+    out.put("\",\"ip_proto\":");
+    out.put_uint(pkt.protocol);
+    out.put(",\"src\":");
+    out.put_json_string(pkt.src_ip);
+    out.put(",\"dst\":");
+    out.put_json_string(pkt.dst_ip);
+    out.put(",\"sport\":");
+    out.put_uint(pkt.src_port);
+    out.put(",\"dport\":");
+    out.put_uint(pkt.dst_port);
+    out.put(",\"tcp_flags\":");
+    out.put_uint(pkt.tcp_flags);
+    out.put(",\"ttl\":");
+    out.put_uint(pkt.ttl);
+
+    // Optional fields are omitted when empty to keep lines short
+    if (!pkt.hostname.empty()) {
+        out.put(",\"hostname\":");
+        out.put_json_string(pkt.hostname);
+    }
+    if (!pkt.app_protocol.empty()) {
+        out.put(",\"app\":");
+        out.put_json_string(pkt.app_protocol);
+    }
+    if (!pkt.app_info.empty()) {
+        out.put(",\"info\":");
+        out.put_json_string(pkt.app_info);
+    }
+    if (!pkt.process_name.empty()) {
+        out.put(",\"process\":");
+        out.put_json_string(pkt.process_name);
+        out.put(",\"pid\":");
+        out.put_int(pkt.process_pid);
+    }
+    if (pkt.watchlist_match) {
+        out.put(",\"alert\":");
+        out.put_json_string(pkt.watchlist_label);
+    }
+    out.put("}\n");
+
+    return finish(out, mark);
+}
+
+bool format_packet_csv(FormatBuffer& out, const PacketInfo& pkt) {
+    size_t mark = out.mark();
+
+    out.put_timestamp(pkt.timestamp);
+    out.put(',');
+    out.put_uint(pkt.original_length);
+    out.put(',');
+    out.put_uint(pkt.ip_version);
+    out.put(',');
+    out.put(protocol_class_name(classify_protocol(pkt)));
+    out.put(',');
+    out.put_uint(pkt.protocol);
+    out.put(',');
+    out.put_csv_field(pkt.src_ip);
+    out.put(',');
+    out.put_csv_field(pkt.dst_ip);
+    out.put(',');
+    out.put_uint(pkt.src_port);
+    out.put(',');
+    out.put_uint(pkt.dst_port);
+    out.put(',');
+    out.put_uint(pkt.tcp_flags);
+    out.put(',');
+    out.put_uint(pkt.ttl);
+    out.put(',');
+    out.put_csv_field(pkt.hostname);
+    out.put(',');
+    out.put_csv_field(pkt.app_protocol);
+    out.put(',');
+    out.put_csv_field(pkt.app_info);
+    out.put(',');
+    out.put_csv_field(pkt.process_name);
+    out.put(',');
+    if (pkt.process_pid != 0) {
+        out.put_int(pkt.process_pid);
+    }
+    out.put(',');
+    if (pkt.watchlist_match) {
+        out.put_csv_field(pkt.watchlist_label);
+    }
+    out.put('\n');
+
+    return finish(out, mark);
+}
+
+bool format_flow_ndjson(FormatBuffer& out, const FlowRecord& flow, FlowEndReason reason) {
+    size_t mark = out.mark();
+
+    out.put("{\"first\":");
+    out.put_timestamp(flow.first_seen);
+    out.put(",\"last\":");
+    out.put_timestamp(flow.last_seen);
+    out.put(",\"ip_version\":");
+    out.put_uint(flow.key.ip_version);
+    out.put(",\"ip_proto\":");
+    out.put_uint(flow.key.protocol);
+    out.put(",\"src\":");
+    out.put_json_string(flow.src_ip);
+    out.put(",\"dst\":");
+    out.put_json_string(flow.dst_ip);
+    out.put(",\"sport\":");
+    out.put_uint(flow.key.src_port);
+    out.put(",\"dport\":");
+    out.put_uint(flow.key.dst_port);
+    out.put(",\"packets\":");
+    out.put_uint(flow.packets);
+    out.put(",\"bytes\":");
+    out.put_uint(flow.bytes);
+    out.put(",\"tcp_flags\":");
+    out.put_uint(flow.tcp_flags);
+    if (!flow.hostname.empty()) {
+        out.put(",\"hostname\":");
+        out.put_json_string(flow.hostname);
+    }
+    if (!flow.app_protocol.empty()) {
+        out.put(",\"app\":");
+        out.put_json_string(flow.app_protocol);
+    }
+    if (flow.tls_fingerprint) {
+        out.put(",\"ja3\":");
+        out.put_json_string(flow.tls_fingerprint->ja3);
+        out.put(",\"ja4\":");
+        out.put_json_string(flow.tls_fingerprint->ja4);
+    }
+    out.put(",\"end\":\"");
+    out.put(flow_end_reason_name(reason));
+    out.put("\"}\n");
+
+    return finish(out, mark);
+}
+
+bool format_flow_csv(FormatBuffer& out, const FlowRecord& flow, FlowEndReason reason) {
+    size_t mark = out.mark();
+
+    out.put_timestamp(flow.first_seen);
+    out.put(',');
+    out.put_timestamp(flow.last_seen);
+    out.put(',');
+    out.put_uint(flow.key.ip_version);
+    out.put(',');
+    out.put_uint(flow.key.protocol);
+    out.put(',');
+    out.put_csv_field(flow.src_ip);
+    out.put(',');
+    out.put_csv_field(flow.dst_ip);
+    out.put(',');
+    out.put_uint(flow.key.src_port);
+    out.put(',');
+    out.put_uint(flow.key.dst_port);
+    out.put(',');
+    out.put_uint(flow.packets);
+    out.put(',');
+    out.put_uint(flow.bytes);
+    out.put(',');
+    out.put_uint(flow.tcp_flags);
+    out.put(',');
+    out.put_csv_field(flow.hostname);
+    out.put(',');
+    out.put_csv_field(flow.app_protocol);
+    out.put(',');
+    if (flow.tls_fingerprint) {
+        out.put_csv_field(flow.tls_fingerprint->ja3);
+        out.put(',');
+        out.put_csv_field(flow.tls_fingerprint->ja4);
+    } else {
+        out.put(',');
+    }
+    out.put(',');
+    out.put(flow_end_reason_name(reason));
+    out.put('\n');
+
+    return finish(out, mark);
+}
@@ -0,0 +1,67 @@
+/*
+ * record_format.hpp - Allocation-free NDJSON/CSV record formatting
+ *
+ * FormatBuffer appends text into caller-owned memory with no heap
+ * allocation and no locale or stream machinery. If a record does not fit,
+ * the buffer is marked overflowed and the caller rolls back to the length
+ * it had before the record (see mark()/rollback()).
+ *
+ * Packet and flow records share one field vocabulary across both formats,
+ * so a CSV column and an NDJSON key always carry the same value:
+ *   ts/first/last  seconds since the epoch with microseconds (1700000000.123456)
+ *   proto          protocol class (TCP, UDP, DNS, ...); ip_proto is the raw number
+ *   tcp_flags      numeric OR of the TCP flag bits
+ */
+
+#pragma once
+
+#include "flow_table.hpp"
+#include "packet.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+class FormatBuffer {
+public:
+    FormatBuffer(char* data, size_t capacity) : data_(data), capacity_(capacity) {}
+
+    void put(char c);
+    void put(std::string_view text);
+    void put_uint(uint64_t value);
+    void put_int(int64_t value);
+    void put_timestamp(std::chrono::system_clock::time_point tp);
+
+    // Quoted JSON string with escaping of quotes, backslashes and controls
+    void put_json_string(std::string_view text);
+
+    // CSV field, quoted only when it contains a comma, quote or line break
+    void put_csv_field(std::string_view text);
+
+    size_t size() const { return size_; }
+    bool overflowed() const { return overflowed_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+    // Record boundaries: rollback() discards a partial record
+    size_t mark() const { return size_; }
+    void rollback(size_t mark) { size_ = mark; overflowed_ = false; }
+
+private:
+    char* data_;
+    size_t capacity_;
+    size_t size_ = 0;
+    bool overflowed_ = false;
+};
+
+// One line per record, terminated by '\n'. Return false on overflow,
+// leaving the buffer as it was before the call.
+bool format_packet_ndjson(FormatBuffer& out, const PacketInfo& pkt);
+bool format_packet_csv(FormatBuffer& out, const PacketInfo& pkt);
+bool format_flow_ndjson(FormatBuffer& out, const FlowRecord& flow, FlowEndReason reason);
+bool format_flow_csv(FormatBuffer& out, const FlowRecord& flow, FlowEndReason reason);
+
+// CSV header lines (with trailing newline)
+const char* packet_csv_header();
+const char* flow_csv_header();
+
+const char* flow_end_reason_name(FlowEndReason reason);
@@ -0,0 +1,314 @@
+/*
+ * recorder.cpp - Continuous pcapng recording implementation
+ *
+ * The writer thread swaps the whole pending queue out under the lock and
+ * encodes the batch without holding it, so enqueue() contends only for a
+ * push_back. The write buffer is flushed when it fills, on rotation, and
+ * whenever the queue goes idle so files stay readable while recording.
+ *
+ * Frames count as written only once the write(2) holding them succeeds.
+ * A failed write drops every frame in the buffer, cuts the file back to
+ * its last complete block and closes it; the next frame opens a new file.
+ */
+
+#include "recorder.hpp"
+#include "capture_file.hpp"
+#include "metrics.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr auto IDLE_FLUSH_INTERVAL = std::chrono::milliseconds(500);
+
+uint64_t to_micros(std::chrono::system_clock::time_point tp) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        tp.time_since_epoch()).count());
+}
+
+}  // namespace
+
+PcapngRecorder::~PcapngRecorder() {
+    stop();
+}
+
+bool PcapngRecorder::start(const RecorderConfig& config, const std::string& interface_name,
+                           int linktype, uint32_t snaplen) {
+    if (running_.load()) {
+        return true;
+    }
+
+    config_ = config;
+    interface_name_ = interface_name;
+    linktype_ = linktype;
+    snaplen_ = snaplen;
+    file_sequence_ = 0;
+    open_files_.clear();
+    buffer_.clear();
+    buffer_.reserve(config_.write_buffer_bytes + 65536);
+
+    // Timestamp shared by all files of this run so reruns don't overwrite
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::tm tm_buf;
+    localtime_r(&now, &tm_buf);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm_buf);
+    run_stamp_ = stamp;
+
+    if (!open_next_file()) {
+        return false;
+    }
+
+    running_.store(true);
+    writer_thread_ = std::thread([this]() {
+        writer_loop();
+    });
+
+    return true;
+}
+
+void PcapngRecorder::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        running_.store(false);
+    }
+    queue_cv_.notify_all();
+
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+
+    close_file();
+}
+
+std::string PcapngRecorder::get_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return error_;
+}
+
+bool PcapngRecorder::enqueue(const PacketInfo& pkt) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    // Copy outside the lock so the writer's swap never waits on malloc
+    size_t cost = pkt.raw_data.size() + sizeof(QueuedFrame);
+    QueuedFrame frame;
+    frame.timestamp_us = to_micros(pkt.timestamp);
+    frame.original_length = pkt.original_length;
+    frame.data = pkt.raw_data;
+    if (pkt.watchlist_match) {
+        frame.comment = "ALERT: " + pkt.watchlist_label;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (queued_bytes_ + cost > config_.queue_limit_bytes) {
+            frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+            if (metrics_) {
+                metrics_->record_recording(0, 1);
+            }
+            return false;
+        }
+        queue_.push_back(std::move(frame));
+        queued_bytes_ += cost;
+    }
+
+    queue_cv_.notify_one();
+    return true;
+}
+
+void PcapngRecorder::writer_loop() {
+    std::deque<QueuedFrame> batch;
+
+    while (true) {
+        bool keep_running;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait_for(lock, IDLE_FLUSH_INTERVAL, [this]() {
+                return !queue_.empty() || !running_.load();
+            });
+            batch.swap(queue_);
+            queued_bytes_ = 0;
+            keep_running = running_.load();
+        }
+
+        uint64_t dropped = 0;
+        bool open_failed = false;
+        for (const auto& frame : batch) {
+            size_t padded = (frame.data.size() + 3) & ~size_t{3};
+            size_t block_bytes = 32 + padded +
+                (frame.comment.empty() ? 0 : ((frame.comment.size() + 3) & ~size_t{3}) + 8);
+
+            // Retry a failed open at most once per batch
+            if (!open_failed && needs_rotation(block_bytes)) {
+                flush_buffer();
+                open_failed = !open_next_file();
+            }
+            if (fd_ < 0) {
+                dropped++;
+                continue;
+            }
+
+            file_bytes_ += pcapng_append_packet(buffer_, 0, frame.timestamp_us,
+                                                frame.data.data(),
+                                                static_cast<uint32_t>(frame.data.size()),
+                                                frame.original_length, frame.comment);
+            buffered_frames_++;
+
+            if (buffer_.size() >= config_.write_buffer_bytes) {
+                flush_buffer();
+            }
+        }
+        batch.clear();
+        count_frames(0, dropped);
+
+        // Idle (or shutting down): push buffered blocks to the file
+        bool idle;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            idle = queue_.empty();
+        }
+        if (idle) {
+            flush_buffer();
+
+            // Time-based rotation also applies when no traffic is arriving;
+            // after a write error the next frame reopens instead
+            if (keep_running && fd_ >= 0 && needs_rotation(0)) {
+                open_next_file();
+            }
+        }
+
+        if (!keep_running && idle) {
+            break;
+        }
+    }
+}
+
+bool PcapngRecorder::needs_rotation(size_t next_block_bytes) const {
+    if (fd_ < 0) {
+        return true;
+    }
+
+    if (config_.rotate_bytes > 0 && file_bytes_ > 0 &&
+        file_bytes_ + next_block_bytes > config_.rotate_bytes) {
+        return true;
+    }
+
+    if (config_.rotate_seconds > 0 &&
+        std::chrono::steady_clock::now() - file_opened_at_ >=
+            std::chrono::seconds(config_.rotate_seconds)) {
+        return true;
+    }
+
+    return false;
+}
+
+bool PcapngRecorder::open_next_file() {
+    close_file();
+
+    file_sequence_++;
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), "_%s_%05u.pcapng", run_stamp_.c_str(), file_sequence_);
+    std::string path = config_.path_prefix + suffix;
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_ = "Cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    file_opened_at_ = std::chrono::steady_clock::now();
+    file_synced_bytes_ = 0;
+    buffer_.clear();
+    pcapng_append_section_header(buffer_, "network-monitor");
+    pcapng_append_interface(buffer_, static_cast<uint16_t>(linktype_), snaplen_,
+                            interface_name_);
+    file_bytes_ = buffer_.size();
+
+    // A file that cannot take its header must not push a good one out of the ring
+    if (!flush_buffer()) {
+        ::unlink(path.c_str());
+        return false;
+    }
+
+    files_opened_.fetch_add(1, std::memory_order_relaxed);
+    open_files_.push_back(path);
+
+    // Ring mode: remove the oldest files beyond the limit
+    while (config_.max_files > 0 && open_files_.size() > config_.max_files) {
+        ::unlink(open_files_.front().c_str());
+        open_files_.pop_front();
+    }
+    return true;
+}
+
+void PcapngRecorder::close_file() {
+    if (fd_ < 0) {
+        return;
+    }
+
+    // A failed flush has already closed the file
+    if (flush_buffer()) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool PcapngRecorder::flush_buffer() {
+    uint64_t frames = buffered_frames_;
+    buffered_frames_ = 0;
+    if (fd_ < 0) {
+        buffer_.clear();
+        count_frames(0, frames);
+        return false;
+    }
+
+    size_t written = 0;
+    while (written < buffer_.size()) {
+        ssize_t n = ::write(fd_, buffer_.data() + written, buffer_.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            {
+                std::lock_guard<std::mutex> lock(error_mutex_);
+                error_ = std::string("Recording write failed: ") +
+                         strerror(n < 0 ? errno : ENOSPC);
+            }
+            // Drop a half-written block so the file stays readable, and
+            // stop appending to it
+            int truncated = ::ftruncate(fd_, static_cast<off_t>(file_synced_bytes_));
+            (void)truncated;   // Best effort: the file is closed either way
+            ::close(fd_);
+            fd_ = -1;
+            buffer_.clear();
+            count_frames(0, frames);
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    file_synced_bytes_ += written;
+    buffer_.clear();
+    count_frames(frames, 0);
+    return true;
+}
+
+void PcapngRecorder::count_frames(uint64_t written, uint64_t dropped) {
+    if (written == 0 && dropped == 0) {
+        return;
+    }
+    frames_written_.fetch_add(written, std::memory_order_relaxed);
+    frames_dropped_.fetch_add(dropped, std::memory_order_relaxed);
+    if (metrics_) {
+        metrics_->record_recording(written, dropped);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * recorder.hpp - Continuous pcapng recording on a dedicated I/O thread
+ *
+ * The capture thread hands frames to enqueue(), which only copies the
+ * bytes into a bounded in-memory queue; all encoding and file I/O happens
+ * on the recorder's own thread. When the queue is over its byte budget the
+ * frame is dropped and counted instead of stalling capture.
+ *
+ * The writer batches blocks into a large buffer before each write(2) and
+ * rotates to a new file by size and/or age, deleting the oldest files once
+ * max_files is exceeded (ring-file mode). Frames that matched the
+ * watchlist carry the alert label as a pcapng packet comment.
+ *
+ * Usage: start() once the capture interface and link type are known,
+ * enqueue() from the capture thread, stop() to flush and close.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MetricsRegistry;
+
+struct RecorderConfig {
+    std::string path_prefix;                 // Files are PREFIX_<start time>_NNNNN.pcapng
+    uint64_t rotate_bytes = 0;               // 0 = no size-based rotation
+    uint32_t rotate_seconds = 0;             // 0 = no time-based rotation
+    uint32_t max_files = 0;                  // 0 = keep every file
+    size_t queue_limit_bytes = 64u << 20;    // Frames beyond this are dropped
+    size_t write_buffer_bytes = 1u << 20;    // Batch size per write(2)
+};
+
+class PcapngRecorder {
+public:
+    PcapngRecorder() = default;
+    ~PcapngRecorder();
+
+    // Non-copyable
+    PcapngRecorder(const PcapngRecorder&) = delete;
+    PcapngRecorder& operator=(const PcapngRecorder&) = delete;
+
+    // Open the first file and start the writer thread
+    bool start(const RecorderConfig& config, const std::string& interface_name,
+               int linktype, uint32_t snaplen);
+
+    // Flush queued frames, close the file and join the thread
+    void stop();
+
+    // Capture thread: queue a frame for writing. Never blocks on I/O.
+    // Returns false if the frame was dropped.
+    bool enqueue(const PacketInfo& pkt);
+
+    bool is_running() const { return running_.load(); }
+    std::string get_error() const;
+
+    // Counters
+    uint64_t frames_written() const { return frames_written_.load(); }
+    uint64_t frames_dropped() const { return frames_dropped_.load(); }
+    uint64_t files_opened() const { return files_opened_.load(); }
+
+    void set_metrics(MetricsRegistry* metrics) { metrics_ = metrics; }
+
+private:
+    struct QueuedFrame {
+        uint64_t timestamp_us;
+        uint32_t original_length;
+        std::vector<uint8_t> data;
+        std::string comment;
+    };
+
+    void writer_loop();
+    bool open_next_file();
+    void close_file();
+    bool flush_buffer();
+    void count_frames(uint64_t written, uint64_t dropped);
+    bool needs_rotation(size_t next_block_bytes) const;
+
+    RecorderConfig config_;
+    std::string interface_name_;
+    int linktype_ = 1;
+    uint32_t snaplen_ = 65535;
+    MetricsRegistry* metrics_ = nullptr;
+
+    // Queue shared with the capture thread
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<QueuedFrame> queue_;
+    size_t queued_bytes_ = 0;
+
+    // Writer thread state
+    int fd_ = -1;
+    std::vector<uint8_t> buffer_;
+    uint64_t buffered_frames_ = 0;       // Packet blocks in buffer_
+    uint64_t file_bytes_ = 0;
+    uint64_t file_synced_bytes_ = 0;     // Written in whole blocks
+    uint32_t file_sequence_ = 0;
+    std::string run_stamp_;
+    std::chrono::steady_clock::time_point file_opened_at_{};
+    std::deque<std::string> open_files_;  // Oldest first, for max_files
+
+    mutable std::mutex error_mutex_;
+    std::string error_;
+
+    std::atomic<bool> running_{false};
+    std::thread writer_thread_;
+
+    std::atomic<uint64_t> frames_written_{0};
+    std::atomic<uint64_t> frames_dropped_{0};
+    std::atomic<uint64_t> files_opened_{0};
+};
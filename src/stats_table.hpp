@@ -0,0 +1,83 @@
+/*
+ * stats_table.hpp - Bounded per-label statistics and top-N ranking
+ *
+ * LruStatsTable keeps one statistics record per label (a DNS server, a
+ * question name, an HTTP host), at most `capacity` of them, dropping the
+ * least recently seen label when a new one arrives. Records live in the
+ * recency list itself, so a lookup is one hash probe and a splice.
+ *
+ * top_ranked() picks the best `top` elements of any sized range by a key
+ * computed once per element, highest first with a tie-break, and returns
+ * pointers to the winners so the caller formats only those.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+template <typename Stats, std::string Stats::*Label>
+class LruStatsTable {
+public:
+    using value_type = Stats;
+    using const_iterator = typename std::list<Stats>::const_iterator;
+
+    void set_capacity(size_t capacity) { capacity_ = std::max<size_t>(1, capacity); }
+
+    // The label's record, created (possibly evicting another) if absent
+    Stats& get(const std::string& label) {
+        auto it = index_.find(label);
+        if (it != index_.end()) {
+            entries_.splice(entries_.end(), entries_, it->second);
+            return *it->second;
+        }
+        if (index_.size() >= capacity_) {
+            index_.erase(entries_.front().*Label);
+            entries_.pop_front();
+        }
+        Stats& stats = entries_.emplace_back();
+        stats.*Label = label;
+        index_.emplace(label, std::prev(entries_.end()));
+        return stats;
+    }
+
+    size_t size() const { return index_.size(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+
+private:
+    std::list<Stats> entries_;   // Front is least recently seen
+    std::unordered_map<std::string, typename std::list<Stats>::iterator> index_;
+    size_t capacity_ = 1;
+};
+
+// The `top` elements of range with the highest rank(element), ties going
+// to whichever element before(a, b) puts first
+template <typename Range, typename Rank, typename Before>
+std::vector<const typename Range::value_type*> top_ranked(const Range& range, size_t top,
+                                                          Rank rank, Before before) {
+    using Item = typename Range::value_type;
+    std::vector<std::pair<uint64_t, const Item*>> ranked;
+    ranked.reserve(range.size());
+    for (const Item& item : range) {
+        ranked.emplace_back(rank(item), &item);
+    }
+    size_t count = std::min(top, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                      [&before](const auto& a, const auto& b) {
+                          if (a.first != b.first) return a.first > b.first;
+                          return before(*a.second, *b.second);
+                      });
+
+    std::vector<const Item*> winners;
+    winners.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        winners.push_back(ranked[i].second);
+    }
+    return winners;
+}
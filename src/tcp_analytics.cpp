@@ -0,0 +1,262 @@
+/*
+ * tcp_analytics.cpp - TCP connection performance analysis implementation
+ */
+
+#include "tcp_analytics.hpp"
+#include "stats_table.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+
+namespace {
+
+constexpr int64_t DEFAULT_REORDER_US = 3000;   // Reordering window before an RTT is known
+
+// Sequence number comparisons modulo 2^32 (RFC 793)
+bool seq_before(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+bool seq_after(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+int64_t to_us(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+}
+
+std::string endpoint(const FlowKey& key, int dir) {
+    char text[INET6_ADDRSTRLEN];
+    const auto& addr = dir == 0 ? key.src_addr : key.dst_addr;
+    inet_ntop(key.ip_version == 4 ? AF_INET : AF_INET6, addr.data(), text, sizeof(text));
+    uint16_t port = dir == 0 ? key.src_port : key.dst_port;
+    if (key.ip_version == 6) {
+        return "[" + std::string(text) + "]:" + std::to_string(port);
+    }
+    return std::string(text) + ":" + std::to_string(port);
+}
+
+uint32_t clamp_us(int64_t us) {
+    return static_cast<uint32_t>(std::clamp<int64_t>(us, 1, UINT32_MAX));
+}
+
+}  // namespace
+
+TcpAnalyzer::TcpAnalyzer(const TcpAnalyticsConfig& config) : config_(config) {
+    flows_.reserve(std::min<size_t>(config.max_flows, 4096));
+}
+
+void TcpAnalyzer::on_packet(PacketInfo& info) {
+    if (config_.max_flows == 0 || info.protocol != PROTO_TCP || info.is_fragment() ||
+        info.reassembled_length != 0) {
+        return;
+    }
+
+    bool swapped = false;
+    FlowKey key = FlowKey::canonical(info, swapped);
+    int dir = swapped ? 1 : 0;
+    int64_t now_us = to_us(info.timestamp);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire(now_us);
+
+    auto it = flows_.find(key);
+    if (it == flows_.end()) {
+        if (flows_.size() >= config_.max_flows) {
+            remove_oldest(closed_.empty() ? open_ : closed_);
+            evictions_++;
+        }
+        Entry entry;
+        entry.state.first_us = now_us;
+        // Until a SYN says otherwise, the ephemeral (higher) port connected
+        entry.state.client = key.src_port > key.dst_port ? 0 : 1;
+        it = flows_.emplace(key, entry).first;
+        it->second.age = open_.insert(open_.end(), &*it);
+        totals_.connections++;
+    }
+
+    Entry& entry = it->second;
+    std::list<Node*>& ages = entry.closed ? closed_ : open_;
+    ages.splice(ages.end(), ages, entry.age);
+    analyse(entry.state, dir, info, now_us);
+    if (!entry.closed && entry.state.closed()) {
+        entry.closed = true;
+        closed_.splice(closed_.end(), open_, entry.age);
+    }
+}
+
+void TcpAnalyzer::analyse(TcpFlowState& flow, int dir, PacketInfo& info, int64_t now_us) {
+    TcpDirectionState& self = flow.dir[dir];
+    TcpDirectionState& peer = flow.dir[1 - dir];
+    uint8_t flags = info.tcp_flags;
+    bool syn = flags & TCP_SYN;
+    bool fin = flags & TCP_FIN;
+    bool ack = flags & TCP_ACK;
+    bool rst = flags & TCP_RST;
+
+    flow.packets++;
+    flow.bytes += info.original_length;
+    flow.last_us = now_us;
+
+    // Handshake: SYN, SYN-ACK, then the client's ACK
+    if (syn && !ack) {
+        flow.client = static_cast<uint8_t>(dir);
+        flow.syn_us = now_us;
+        flow.flags |= TcpFlowState::SYN_SEEN;
+    } else if (syn) {
+        flow.client = static_cast<uint8_t>(1 - dir);
+    } else if (ack && dir == flow.client && (flow.flags & TcpFlowState::SYN_SEEN) &&
+               !(flow.flags & TcpFlowState::ESTABLISHED)) {
+        flow.flags |= TcpFlowState::ESTABLISHED;
+        flow.handshake_rtt_us = clamp_us(now_us - flow.syn_us);
+        handshake_rtt_.add(static_cast<uint64_t>(flow.handshake_rtt_us) * 1000);
+        totals_.handshakes++;
+    }
+    if (rst && !(flow.flags & TcpFlowState::RESET)) {
+        flow.flags |= TcpFlowState::RESET;
+        totals_.resets++;
+    }
+    if (fin) {
+        self.flags |= TcpDirectionState::FIN;
+    }
+
+    // Sequence space: SYN and FIN occupy one number each
+    uint32_t seq = info.tcp_seq;
+    uint32_t seg_len = info.payload_length + (syn ? 1 : 0) + (fin ? 1 : 0);
+    if (seg_len > 0 && !rst) {
+        uint32_t end = seq + seg_len;
+        if (info.payload_length > 0) {
+            flow.data_segments++;
+            totals_.data_segments++;
+        }
+        if (!(self.flags & TcpDirectionState::SEQ_VALID) || !seq_before(seq, self.next_seq)) {
+            // New data; a gap means earlier segments were not captured
+            self.flags |= TcpDirectionState::SEQ_VALID;
+            self.next_seq = end;
+            self.advanced_us = now_us;
+            if (!(self.flags & TcpDirectionState::TIMING)) {
+                self.flags |= TcpDirectionState::TIMING;
+                self.timed_seq = end;
+                self.timed_us = now_us;
+            }
+        } else if (info.payload_length <= 1 && !syn && !fin && end == self.next_seq) {
+            // Keep-alive: one byte (or none) just below the next sequence number
+            info.tcp_analysis |= TCP_ANALYSIS_KEEP_ALIVE;
+        } else {
+            int64_t window = flow.srtt_us ? flow.srtt_us : DEFAULT_REORDER_US;
+            if (now_us - self.advanced_us < window) {
+                info.tcp_analysis |= TCP_ANALYSIS_OUT_OF_ORDER;
+                flow.out_of_order++;
+                totals_.out_of_order++;
+            } else {
+                info.tcp_analysis |= TCP_ANALYSIS_RETRANSMISSION;
+                flow.retransmissions++;
+                totals_.retransmissions++;
+                // Karn: an ACK can no longer say which copy it answers
+                if ((self.flags & TcpDirectionState::TIMING) &&
+                    seq_before(seq, self.timed_seq)) {
+                    self.flags &= ~TcpDirectionState::TIMING;
+                }
+            }
+            if (seq_after(end, self.next_seq)) {
+                self.next_seq = end;
+                self.advanced_us = now_us;
+            }
+        }
+    }
+
+    if (ack && !rst) {
+        uint32_t ack_num = info.tcp_ack;
+
+        // Data RTT of the peer's timed segment
+        if ((peer.flags & TcpDirectionState::TIMING) && !seq_before(ack_num, peer.timed_seq)) {
+            peer.flags &= ~TcpDirectionState::TIMING;
+            uint32_t sample = clamp_us(now_us - peer.timed_us);
+            flow.srtt_us = flow.srtt_us ? flow.srtt_us - flow.srtt_us / 8 + sample / 8 : sample;
+            data_rtt_.add(static_cast<uint64_t>(sample) * 1000);
+        }
+
+        // Duplicate ACK: nothing new from this side while the peer has data in flight
+        bool pure_ack = seg_len == 0;
+        if (pure_ack && (self.flags & TcpDirectionState::ACK_VALID) &&
+            ack_num == self.last_ack && info.tcp_window == self.window &&
+            (peer.flags & TcpDirectionState::SEQ_VALID) && seq_after(peer.next_seq, ack_num)) {
+            info.tcp_analysis |= TCP_ANALYSIS_DUP_ACK;
+            flow.dup_acks++;
+            totals_.dup_acks++;
+        }
+        self.flags |= TcpDirectionState::ACK_VALID;
+        self.last_ack = ack_num;
+    }
+
+    // Windows in SYNs are unscaled and RSTs carry none worth reading
+    if (!syn && !rst) {
+        if (info.tcp_window == 0) {
+            info.tcp_analysis |= TCP_ANALYSIS_ZERO_WINDOW;
+            if (!(self.flags & TcpDirectionState::ZERO_WINDOW)) {
+                self.flags |= TcpDirectionState::ZERO_WINDOW;
+                flow.zero_windows++;
+                totals_.zero_windows++;
+            }
+        } else {
+            self.flags &= ~TcpDirectionState::ZERO_WINDOW;
+        }
+    }
+    self.window = info.tcp_window;
+}
+
+void TcpAnalyzer::expire(int64_t now_us) {
+    // Amortised O(1): each entry is removed at most once
+    int64_t linger_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        config_.close_linger).count();
+    int64_t idle_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        config_.idle_timeout).count();
+    while (!closed_.empty() && now_us - closed_.front()->second.state.last_us > linger_us) {
+        remove_oldest(closed_);
+    }
+    while (!open_.empty() && now_us - open_.front()->second.state.last_us > idle_us) {
+        remove_oldest(open_);
+    }
+}
+
+void TcpAnalyzer::remove_oldest(std::list<Node*>& ages) {
+    Node* node = ages.front();
+    ages.pop_front();
+    flows_.erase(node->first);
+}
+
+TcpAnalyticsSnapshot TcpAnalyzer::snapshot(size_t top, TcpOrder order) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TcpAnalyticsSnapshot snap;
+    snap.totals = totals_;
+    snap.handshake_rtt = handshake_rtt_;
+    snap.data_rtt = data_rtt_;
+    snap.active = flows_.size();
+    snap.evictions = evictions_;
+
+    // Format only the winners
+    auto winners = top_ranked(
+        flows_, top,
+        [order](const Node& node) -> uint64_t {
+            const TcpFlowState& flow = node.second.state;
+            if (order == TcpOrder::WORST) {
+                return static_cast<uint64_t>(flow.retransmissions) + flow.out_of_order +
+                       flow.dup_acks + flow.zero_windows;
+            }
+            return std::max(flow.srtt_us, flow.handshake_rtt_us);
+        },
+        [](const Node& a, const Node& b) {
+            return a.second.state.packets > b.second.state.packets;
+        });
+
+    snap.flows.reserve(winners.size());
+    for (const Node* node : winners) {
+        const FlowKey& key = node->first;
+        const TcpFlowState& flow = node->second.state;
+        TcpFlowStats stats;
+        stats.client = endpoint(key, flow.client);
+        stats.server = endpoint(key, 1 - flow.client);
+        stats.state = flow;
+        snap.flows.push_back(std::move(stats));
+    }
+    return snap;
+}
@@ -0,0 +1,171 @@
+/*
+ * tcp_analytics.hpp - TCP connection performance analysis
+ *
+ * Follows the sequence and acknowledgement numbers of both directions of
+ * every TCP connection to estimate round-trip times and spot the usual
+ * causes of slow transfers:
+ *
+ *   - Handshake RTT: SYN to the client's first ACK, as seen from the
+ *     capture point.
+ *   - Data RTT: one segment per direction is timed at a time, from the
+ *     segment to the ACK that covers it; timings spanning a
+ *     retransmission are discarded (Karn's algorithm). Each connection
+ *     keeps a smoothed RTT (1/8 gain, as RFC 6298).
+ *   - Retransmissions and out-of-order segments: a segment starting below
+ *     the highest sequence number already sent is out of order if it
+ *     arrives within one smoothed RTT (3 ms before there is one) of the
+ *     segment that advanced it, and a retransmission otherwise. Keep-alive
+ *     probes are recognised and not counted.
+ *   - Duplicate ACKs: a pure ACK repeating the previous acknowledgement
+ *     and window while data is outstanding.
+ *   - Zero-window events: a receiver advertising a zero window after a
+ *     non-zero one.
+ *
+ * Each connection is one fixed-size, trivially copyable TcpFlowState in a
+ * bounded table keyed by its canonical (address-ordered) 5-tuple, so both
+ * directions share an entry. Entries sit on one of two lists in order of
+ * their last packet: open connections leave after the idle timeout and
+ * closed ones (both FINs, or a RST) after a short linger for the final
+ * ACKs. A new connection in a full table evicts the entry idle longest,
+ * closed ones first. All of it is O(1) per packet. Totals and the RTT
+ * histograms cover the whole capture. One mutex guards everything; the
+ * pipeline thread writes and the TCP panel takes snapshots.
+ */
+
+#pragma once
+
+#include "flow_table.hpp"
+#include "instrumentation.hpp"
+#include "packet.hpp"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+struct TcpAnalyticsConfig {
+    size_t max_flows = 65536;                   // Connections tracked; 0 disables analysis
+    std::chrono::seconds idle_timeout{120};
+    std::chrono::seconds close_linger{5};       // Kept after both FINs or a RST
+};
+
+// One direction of a connection
+struct TcpDirectionState {
+    uint32_t next_seq = 0;        // Highest sequence number sent, plus one
+    uint32_t last_ack = 0;
+    uint32_t timed_seq = 0;       // End of the segment being timed
+    uint16_t window = 0;          // Last window advertised (unscaled)
+    uint8_t flags = 0;            // TcpDirectionState::SEQ_VALID etc.
+    int64_t advanced_us = 0;      // When next_seq last moved forward
+    int64_t timed_us = 0;         // When the timed segment was sent
+
+    static constexpr uint8_t SEQ_VALID = 0x01;
+    static constexpr uint8_t ACK_VALID = 0x02;
+    static constexpr uint8_t TIMING = 0x04;
+    static constexpr uint8_t ZERO_WINDOW = 0x08;
+    static constexpr uint8_t FIN = 0x10;
+};
+
+struct TcpFlowState {
+    TcpDirectionState dir[2];     // Indexed like the canonical key: 0 is its source
+    int64_t first_us = 0;
+    int64_t last_us = 0;
+    int64_t syn_us = 0;
+    uint32_t handshake_rtt_us = 0;  // 0 until the handshake completes
+    uint32_t srtt_us = 0;           // 0 until the first data RTT sample
+    uint32_t packets = 0;
+    uint32_t data_segments = 0;
+    uint32_t retransmissions = 0;
+    uint32_t out_of_order = 0;
+    uint32_t dup_acks = 0;
+    uint32_t zero_windows = 0;
+    uint64_t bytes = 0;
+    uint8_t client = 0;             // Direction index of the connecting side
+    uint8_t flags = 0;              // TcpFlowState::SYN_SEEN etc.
+
+    static constexpr uint8_t SYN_SEEN = 0x01;
+    static constexpr uint8_t ESTABLISHED = 0x02;
+    static constexpr uint8_t RESET = 0x04;
+
+    bool closed() const {
+        return (flags & RESET) ||
+               ((dir[0].flags & TcpDirectionState::FIN) && (dir[1].flags & TcpDirectionState::FIN));
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<TcpFlowState>);
+
+// A connection as shown by the TCP panel
+struct TcpFlowStats {
+    std::string client;           // "address:port"
+    std::string server;
+    TcpFlowState state;
+
+    bool closed() const { return state.closed(); }
+};
+
+struct TcpTotals {
+    uint64_t connections = 0;     // Entries created
+    uint64_t handshakes = 0;      // SYN to ACK seen
+    uint64_t resets = 0;
+    uint64_t data_segments = 0;
+    uint64_t retransmissions = 0;
+    uint64_t out_of_order = 0;
+    uint64_t dup_acks = 0;
+    uint64_t zero_windows = 0;
+};
+
+enum class TcpOrder : uint8_t { WORST, SLOWEST };
+
+struct TcpAnalyticsSnapshot {
+    TcpTotals totals;
+    HistogramSnapshot handshake_rtt;
+    HistogramSnapshot data_rtt;
+    std::vector<TcpFlowStats> flows;
+    uint64_t active = 0;          // Connections in the table
+    uint64_t evictions = 0;       // Connections dropped to make room for new ones
+};
+
+class TcpAnalyzer {
+public:
+    explicit TcpAnalyzer(const TcpAnalyticsConfig& config = TcpAnalyticsConfig());
+
+    // Non-copyable (mutex)
+    TcpAnalyzer(const TcpAnalyzer&) = delete;
+    TcpAnalyzer& operator=(const TcpAnalyzer&) = delete;
+
+    // Feed a parsed packet; sets info.tcp_analysis. Anything but an
+    // unfragmented TCP segment is ignored.
+    void on_packet(PacketInfo& info);
+
+    // Totals plus the top connections in the given order
+    TcpAnalyticsSnapshot snapshot(size_t top, TcpOrder order = TcpOrder::WORST) const;
+
+private:
+    struct Entry;
+    using FlowMap = std::unordered_map<FlowKey, Entry, FlowKeyHash>;
+    using Node = FlowMap::value_type;   // Stable across rehashing
+
+    struct Entry {
+        TcpFlowState state;
+        std::list<Node*>::iterator age;   // In open_ or closed_
+        bool closed = false;
+    };
+
+    void analyse(TcpFlowState& flow, int dir, PacketInfo& info, int64_t now_us);
+    void expire(int64_t now_us);
+    void remove_oldest(std::list<Node*>& ages);
+
+    TcpAnalyticsConfig config_;
+    mutable std::mutex mutex_;
+    FlowMap flows_;
+    TcpTotals totals_;
+    HistogramSnapshot handshake_rtt_;
+    HistogramSnapshot data_rtt_;
+    std::list<Node*> open_;       // Front saw its last packet longest ago
+    std::list<Node*> closed_;     // Likewise, for closed connections
+    uint64_t evictions_ = 0;
+};
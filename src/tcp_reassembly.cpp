@@ -0,0 +1,230 @@
+/*
+ * tcp_reassembly.cpp - TCP stream reassembly implementation
+ */
+
+#include "tcp_reassembly.hpp"
+#include "dissector.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t HTTP_HEAD_LIMIT = 2048;  // parse_http_request() looks no further
+
+bool is_tls(const PacketInfo& info) {
+    return find_app_dissector(info) == AppDissector::TLS;
+}
+
+// True once more bytes cannot change what the parser extracts
+bool message_complete(const PacketInfo& info, const PacketInfo& parsed,
+                      const uint8_t* data, size_t len) {
+    if (!parsed.hostname.empty()) {
+        return true;
+    }
+    if (is_tls(info)) {
+        if (len >= 1 && data[0] != 0x16) return true;       // Not a handshake record
+        if (len >= 6 && data[5] != 0x01) return true;       // Not a ClientHello
+        return len >= 5 && len >= 5 + static_cast<size_t>((data[3] << 8) | data[4]);
+    }
+    if (len < 16) {
+        return false;
+    }
+    if (parsed.app_protocol.empty()) {
+        return true;                                        // Not HTTP
+    }
+    size_t scan = std::min(len, HTTP_HEAD_LIMIT);
+    for (size_t i = 0; i + 4 <= scan; ++i) {
+        i += find_byte(data + i, scan - i, '\r');
+        if (i + 4 <= scan && std::memcmp(data + i, "\r\n\r\n", 4) == 0) return true;
+    }
+    return len >= HTTP_HEAD_LIMIT;
+}
+
+}  // namespace
+
+TcpReassembler::TcpReassembler(const ReassemblyConfig& config) : config_(config) {}
+
+bool TcpReassembler::wants_stream(const PacketInfo& info) {
+    if (info.protocol != PROTO_TCP) {
+        return false;
+    }
+    AppDissector dissector = find_app_dissector(info);
+    return dissector == AppDissector::HTTP || dissector == AppDissector::TLS;
+}
+
+bool TcpReassembler::looks_like_start(const PacketInfo& info, const uint8_t* data, size_t len) {
+    if (is_tls(info)) {
+        return len >= 6 && data[0] == 0x16 && data[1] == 0x03 && data[5] == 0x01;
+    }
+    return !info.app_protocol.empty();  // parse_packet() recognised the HTTP start line
+}
+
+void TcpReassembler::on_packet(PacketInfo& info) {
+    if (config_.max_stream_bytes == 0 || !wants_stream(info)) {
+        return;
+    }
+    expire(info.timestamp);
+
+    FlowKey key = FlowKey::from_packet(info);
+    auto it = streams_.find(key);
+    const uint8_t* payload = info.raw_data.data() + info.payload_offset;
+    size_t len = std::min<size_t>(info.payload_length, info.raw_data.size() - info.payload_offset);
+    bool syn = info.tcp_flags & TCP_SYN;
+    bool closing = info.tcp_flags & (TCP_FIN | TCP_RST);
+
+    if (it == streams_.end()) {
+        if (closing) {
+            return;
+        }
+        uint32_t base = info.tcp_seq + (syn ? 1 : 0);
+        if (!syn) {
+            // Picked up mid-connection: only worth it at a message start
+            // that this segment alone does not finish
+            if (len == 0 || !looks_like_start(info, payload, len)) {
+                return;
+            }
+            if (message_complete(info, info, payload, len)) {
+                return;
+            }
+        }
+        if (streams_.size() >= config_.max_streams) {
+            if (lru_.empty()) return;
+            erase(streams_.find(lru_.front()));
+            stats_.evicted++;
+        }
+        Stream stream;
+        stream.base_seq = base;
+        stream.lru = lru_.insert(lru_.end(), key);
+        it = streams_.emplace(key, std::move(stream)).first;
+        stats_.streams = streams_.size();
+    } else if (syn) {
+        // Retransmitted SYN: restart if nothing was buffered yet
+        if (it->second.data.empty() && it->second.pending.empty()) {
+            it->second.base_seq = info.tcp_seq + 1;
+        }
+        return;
+    }
+
+    Stream& stream = it->second;
+    stream.last_seen = info.timestamp;
+    lru_.splice(lru_.end(), lru_, stream.lru);
+
+    if (len > 0) {
+        uint32_t offset = info.tcp_seq - stream.base_seq;  // Wraps like TCP sequence space
+        size_t contiguous = stream.data.size();
+        // Usual case: the first segment held the whole message
+        if (offset == 0 && contiguous == 0 && stream.pending.empty() &&
+            message_complete(info, info, payload, len)) {
+            erase(it);
+            return;
+        }
+        if (offset < config_.max_stream_bytes) {
+            size_t wanted = std::min(len, config_.max_stream_bytes - offset);
+            if (make_room(wanted, key)) {
+                add_segment(stream, offset, payload, wanted);
+            }
+        }
+        if (stream.data.size() > contiguous && try_parse(stream, info)) {
+            erase(it);
+            return;
+        }
+    }
+
+    if (closing) {
+        erase(it);
+    }
+}
+
+void TcpReassembler::add_segment(Stream& stream, uint32_t offset, const uint8_t* data, size_t len) {
+    size_t before = stream.data.size() + stream.pending_bytes;
+
+    if (offset > stream.data.size()) {
+        // Past a gap: hold it (the first copy of an offset wins)
+        if (stream.pending.emplace(offset, std::vector<uint8_t>(data, data + len)).second) {
+            stream.pending_bytes += len;
+            stats_.out_of_order++;
+        }
+    } else {
+        size_t skip = stream.data.size() - offset;
+        if (len > skip) {
+            stream.data.insert(stream.data.end(), data + skip, data + len);
+        }
+        // Pull in held segments the new bytes reached
+        auto held = stream.pending.begin();
+        while (held != stream.pending.end() && held->first <= stream.data.size()) {
+            size_t held_skip = stream.data.size() - held->first;
+            const std::vector<uint8_t>& bytes = held->second;
+            if (bytes.size() > held_skip) {
+                stream.data.insert(stream.data.end(), bytes.begin() + held_skip, bytes.end());
+            }
+            stream.pending_bytes -= bytes.size();
+            held = stream.pending.erase(held);
+        }
+    }
+
+    size_t after = stream.data.size() + stream.pending_bytes;
+    stats_.buffered_bytes = stats_.buffered_bytes + after - before;
+}
+
+bool TcpReassembler::try_parse(const Stream& stream, PacketInfo& info) {
+    PacketInfo parsed{};
+    parsed.protocol = info.protocol;
+    parsed.src_port = info.src_port;
+    parsed.dst_port = info.dst_port;
+    parse_application(parsed, stream.data.data(), stream.data.size());
+
+    bool done = message_complete(info, parsed, stream.data.data(), stream.data.size()) ||
+                stream.data.size() >= config_.max_stream_bytes;
+
+    // Annotate the segment that completed the message
+    if (info.hostname.empty() && !parsed.app_protocol.empty() &&
+        (done || !parsed.hostname.empty())) {
+        if (!parsed.hostname.empty()) {
+            stats_.recovered++;
+        }
+        info.hostname = std::move(parsed.hostname);
+        info.app_protocol = std::move(parsed.app_protocol);
+        info.app_info = std::move(parsed.app_info);
+        info.user_agent = std::move(parsed.user_agent);
+        info.content_type = std::move(parsed.content_type);
+        info.tls_fingerprint = std::move(parsed.tls_fingerprint);
+    }
+    return done;
+}
+
+bool TcpReassembler::make_room(size_t bytes, const FlowKey& keep) {
+    auto victim = lru_.begin();
+    while (stats_.buffered_bytes + bytes > config_.max_memory_bytes) {
+        if (victim != lru_.end() && *victim == keep) {
+            ++victim;
+        }
+        if (victim == lru_.end()) {
+            return false;
+        }
+        auto next = std::next(victim);
+        erase(streams_.find(*victim));
+        stats_.evicted++;
+        victim = next;
+    }
+    return true;
+}
+
+void TcpReassembler::expire(std::chrono::system_clock::time_point now) {
+    auto cutoff = now - config_.idle_timeout;
+    while (!lru_.empty()) {
+        auto it = streams_.find(lru_.front());
+        if (it->second.last_seen >= cutoff) {
+            break;
+        }
+        erase(it);
+        stats_.expired++;
+    }
+}
+
+TcpReassembler::StreamMap::iterator TcpReassembler::erase(StreamMap::iterator it) {
+    stats_.buffered_bytes -= it->second.data.size() + it->second.pending_bytes;
+    lru_.erase(it->second.lru);
+    auto next = streams_.erase(it);
+    stats_.streams = streams_.size();
+    return next;
+}
@@ -0,0 +1,82 @@
+/*
+ * tcp_reassembly.hpp - Bounded TCP stream reassembly for L7 extraction
+ *
+ * Reassembles the first max_stream_bytes of each direction of HTTP and TLS
+ * connections so a ClientHello or request head split across segments
+ * still yields a hostname. Streams start at the SYN when it was seen, or
+ * at a segment that looks like the start of a ClientHello or HTTP message
+ * when capture began mid-connection. Out-of-order segments are held until
+ * the gap fills; overlapping bytes keep the first copy.
+ *
+ * A stream is dropped as soon as its parser has an answer, the head is
+ * complete without one, the byte limit is reached, or the connection
+ * closes. Buffered bytes are capped globally (least recently used streams
+ * are evicted first) and idle streams expire. Not thread-safe: owned by
+ * the pipeline thread.
+ */
+
+#pragma once
+
+#include "flow_table.hpp"
+#include "packet.hpp"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+struct ReassemblyConfig {
+    size_t max_stream_bytes = 8192;          // Per direction; 0 disables
+    size_t max_memory_bytes = 32u << 20;     // All streams together
+    size_t max_streams = 65536;
+    std::chrono::seconds idle_timeout{30};
+};
+
+struct ReassemblyStats {
+    uint64_t streams = 0;          // Currently tracked
+    uint64_t buffered_bytes = 0;   // Currently held
+    uint64_t recovered = 0;        // Hostnames found only after reassembly
+    uint64_t out_of_order = 0;     // Segments held for a gap
+    uint64_t evicted = 0;          // Streams dropped by the memory or stream cap
+    uint64_t expired = 0;          // Streams dropped as idle
+};
+
+class TcpReassembler {
+public:
+    explicit TcpReassembler(const ReassemblyConfig& config = ReassemblyConfig());
+
+    // Feed a parsed packet (non-TCP is ignored). If reassembly completes
+    // an application message, its fields are written into info.
+    void on_packet(PacketInfo& info);
+
+    // Drop streams idle since before now - idle_timeout
+    void expire(std::chrono::system_clock::time_point now);
+
+    const ReassemblyStats& stats() const { return stats_; }
+
+private:
+    struct Stream {
+        uint32_t base_seq = 0;       // Sequence number of stream byte 0
+        std::vector<uint8_t> data;   // Contiguous bytes from base_seq
+        std::map<uint32_t, std::vector<uint8_t>> pending;  // Offset -> bytes past a gap
+        size_t pending_bytes = 0;
+        std::chrono::system_clock::time_point last_seen;
+        std::list<FlowKey>::iterator lru;
+    };
+
+    using StreamMap = std::unordered_map<FlowKey, Stream, FlowKeyHash>;
+
+    static bool wants_stream(const PacketInfo& info);
+    static bool looks_like_start(const PacketInfo& info, const uint8_t* data, size_t len);
+
+    void add_segment(Stream& stream, uint32_t offset, const uint8_t* data, size_t len);
+    bool try_parse(const Stream& stream, PacketInfo& info);
+    bool make_room(size_t bytes, const FlowKey& keep);
+    StreamMap::iterator erase(StreamMap::iterator it);
+
+    ReassemblyConfig config_;
+    StreamMap streams_;
+    std::list<FlowKey> lru_;         // Front is least recently used
+    ReassemblyStats stats_;
+};
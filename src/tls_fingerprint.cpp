@@ -0,0 +1,233 @@
+/*
+ * tls_fingerprint.cpp - JA3 and JA4 computation and interning
+ *
+ * JA4 follows the FoxIO specification: the version is the highest
+ * supported_versions entry when present, counts are capped at 99, and the
+ * extension hash leaves out SNI and ALPN, whose presence is already in
+ * the readable prefix.
+ */
+
+#include "tls_fingerprint.hpp"
+#include "crypto.hpp"
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint16_t EXT_SERVER_NAME = 0x0000;
+constexpr uint16_t EXT_ALPN = 0x0010;
+constexpr char HEX[] = "0123456789abcdef";
+
+void append_hex(std::string& out, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        out += HEX[data[i] >> 4];
+        out += HEX[data[i] & 0x0f];
+    }
+}
+
+void append_hex16(std::string& out, uint16_t value) {
+    uint8_t bytes[2] = {static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+    append_hex(out, bytes, 2);
+}
+
+template <typename T>
+void append_decimal_list(std::string& out, const std::vector<T>& values, bool skip_grease) {
+    bool first = true;
+    for (T value : values) {
+        if (skip_grease && is_grease(value)) continue;
+        if (!first) out += '-';
+        out += std::to_string(value);
+        first = false;
+    }
+}
+
+void append_two_digits(std::string& out, size_t count) {
+    count = std::min<size_t>(count, 99);
+    out += static_cast<char>('0' + count / 10);
+    out += static_cast<char>('0' + count % 10);
+}
+
+// Hex values joined by commas, first 12 hex digits of their SHA-256
+void append_truncated_hash(std::string& out, const std::string& list) {
+    if (list.empty()) {
+        out += "000000000000";
+        return;
+    }
+    Sha256Digest digest = sha256(reinterpret_cast<const uint8_t*>(list.data()), list.size());
+    append_hex(out, digest.data(), 6);
+}
+
+const char* ja4_version(uint16_t version) {
+    switch (version) {
+        case 0x0304: return "13";
+        case 0x0303: return "12";
+        case 0x0302: return "11";
+        case 0x0301: return "10";
+        case 0x0300: return "s3";
+        case 0x0002: return "s2";
+        case 0xfeff: return "d1";
+        case 0xfefd: return "d2";
+        case 0xfefc: return "d3";
+        default:     return "00";
+    }
+}
+
+std::string ja4(const ClientHelloFields& fields) {
+    std::vector<uint16_t> ciphers;
+    for (uint16_t cipher : fields.ciphers) {
+        if (!is_grease(cipher)) ciphers.push_back(cipher);
+    }
+    std::vector<uint16_t> extensions;
+    size_t extension_count = 0;
+    for (uint16_t ext : fields.extensions) {
+        if (is_grease(ext)) continue;
+        extension_count++;
+        if (ext != EXT_SERVER_NAME && ext != EXT_ALPN) extensions.push_back(ext);
+    }
+    std::sort(ciphers.begin(), ciphers.end());
+    std::sort(extensions.begin(), extensions.end());
+
+    // ja4_a: readable prefix
+    std::string out;
+    out += fields.transport;
+    out += ja4_version(fields.supported_version ? fields.supported_version : fields.version);
+    out += fields.has_sni ? 'd' : 'i';
+    append_two_digits(out, ciphers.size());
+    append_two_digits(out, extension_count);
+    const std::string& alpn = fields.alpn;
+    if (alpn.empty()) {
+        out += "00";
+    } else if (std::isalnum(static_cast<unsigned char>(alpn.front())) &&
+               std::isalnum(static_cast<unsigned char>(alpn.back()))) {
+        out += alpn.front();
+        out += alpn.back();
+    } else {
+        out += HEX[static_cast<uint8_t>(alpn.front()) >> 4];
+        out += HEX[static_cast<uint8_t>(alpn.back()) & 0x0f];
+    }
+
+    // ja4_b: sorted cipher suites
+    std::string list;
+    for (uint16_t cipher : ciphers) {
+        if (!list.empty()) list += ',';
+        append_hex16(list, cipher);
+    }
+    out += '_';
+    append_truncated_hash(out, list);
+
+    // ja4_c: sorted extensions, then signature algorithms in wire order
+    list.clear();
+    for (uint16_t ext : extensions) {
+        if (!list.empty()) list += ',';
+        append_hex16(list, ext);
+    }
+    bool first = true;
+    for (uint16_t algorithm : fields.signature_algorithms) {
+        if (is_grease(algorithm)) continue;
+        list += first ? '_' : ',';
+        append_hex16(list, algorithm);
+        first = false;
+    }
+    out += '_';
+    append_truncated_hash(out, extensions.empty() ? std::string() : list);
+    return out;
+}
+
+// Exact byte image of the fields, used as the intern table key
+void make_key(const ClientHelloFields& fields, std::string& key) {
+    auto put16 = [&key](uint16_t value) {
+        key += static_cast<char>(value >> 8);
+        key += static_cast<char>(value);
+    };
+    auto put_list = [&](const std::vector<uint16_t>& values) {
+        put16(static_cast<uint16_t>(values.size()));
+        for (uint16_t value : values) put16(value);
+    };
+
+    key.clear();
+    key += fields.transport;
+    key += static_cast<char>(fields.has_sni);
+    put16(fields.version);
+    put16(fields.supported_version);
+    put_list(fields.ciphers);
+    put_list(fields.extensions);
+    put_list(fields.groups);
+    put_list(fields.signature_algorithms);
+    put16(static_cast<uint16_t>(fields.point_formats.size()));
+    key.append(fields.point_formats.begin(), fields.point_formats.end());
+    key += fields.alpn;
+}
+
+struct InternTable {
+    std::mutex mutex;
+    std::unordered_map<std::string, TlsFingerprintRef> entries;
+};
+
+InternTable& intern_table() {
+    static InternTable table;
+    return table;
+}
+
+}  // namespace
+
+void ClientHelloFields::clear() {
+    transport = 't';
+    version = 0;
+    supported_version = 0;
+    has_sni = false;
+    ciphers.clear();
+    extensions.clear();
+    groups.clear();
+    point_formats.clear();
+    signature_algorithms.clear();
+    alpn.clear();
+}
+
+TlsFingerprint compute_tls_fingerprint(const ClientHelloFields& fields) {
+    TlsFingerprint fingerprint;
+    std::string& full = fingerprint.ja3_full;
+    full = std::to_string(fields.version);
+    full += ',';
+    append_decimal_list(full, fields.ciphers, true);
+    full += ',';
+    append_decimal_list(full, fields.extensions, true);
+    full += ',';
+    append_decimal_list(full, fields.groups, true);
+    full += ',';
+    append_decimal_list(full, fields.point_formats, false);
+
+    Md5Digest digest = md5(reinterpret_cast<const uint8_t*>(full.data()), full.size());
+    append_hex(fingerprint.ja3, digest.data(), digest.size());
+    fingerprint.ja4 = ja4(fields);
+    return fingerprint;
+}
+
+TlsFingerprintRef intern_tls_fingerprint(const ClientHelloFields& fields) {
+    thread_local std::string key;
+    make_key(fields, key);
+
+    InternTable& table = intern_table();
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto it = table.entries.find(key);
+        if (it != table.entries.end()) {
+            return it->second;
+        }
+    }
+
+    // Hash outside the lock; a racing thread may intern the same fields,
+    // in which case its entry wins
+    auto fingerprint = std::make_shared<const TlsFingerprint>(compute_tls_fingerprint(fields));
+    std::lock_guard<std::mutex> lock(table.mutex);
+    if (table.entries.size() >= MAX_INTERNED_FINGERPRINTS) {
+        return fingerprint;
+    }
+    return table.entries.emplace(key, std::move(fingerprint)).first->second;
+}
+
+size_t interned_tls_fingerprints() {
+    std::lock_guard<std::mutex> lock(intern_table().mutex);
+    return intern_table().entries.size();
+}
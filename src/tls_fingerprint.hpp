@@ -0,0 +1,59 @@
+/*
+ * tls_fingerprint.hpp - JA3 and JA4 TLS client fingerprints
+ *
+ * parse_client_hello() collects the fields both fingerprints are built
+ * from (versions, cipher suites, extensions, groups, point formats,
+ * signature algorithms, ALPN) in the same walk that finds the server name.
+ * JA3 joins them in wire order and hashes with MD5; JA4 (FoxIO) counts,
+ * sorts and hashes with truncated SHA-256 so that extension shuffling
+ * does not change it. GREASE values are ignored by both.
+ *
+ * A client build sends the same ClientHello shape every time, so
+ * fingerprints are interned: identical field sets share one immutable
+ * object and are hashed once. Packets and flows hold a shared pointer.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ClientHello fields in wire order, GREASE included
+struct ClientHelloFields {
+    char transport = 't';                 // 't' TCP, 'q' QUIC
+    uint16_t version = 0;                 // legacy_version
+    uint16_t supported_version = 0;       // Highest non-GREASE supported_versions entry
+    bool has_sni = false;
+    std::vector<uint16_t> ciphers;
+    std::vector<uint16_t> extensions;
+    std::vector<uint16_t> groups;
+    std::vector<uint8_t> point_formats;
+    std::vector<uint16_t> signature_algorithms;
+    std::string alpn;                     // First protocol offered
+
+    void clear();
+};
+
+struct TlsFingerprint {
+    std::string ja3;       // MD5 of ja3_full, lowercase hex
+    std::string ja3_full;  // e.g. "771,4865-4866,0-23-65281,29-23,0"
+    std::string ja4;       // e.g. "t13d1516h2_8daaf6152771_e5627efa2ab1"
+};
+
+using TlsFingerprintRef = std::shared_ptr<const TlsFingerprint>;
+
+// RFC 8701 reserved values (0x0a0a, 0x1a1a, ... 0xfafa)
+inline bool is_grease(uint16_t value) {
+    return (value & 0x0f0f) == 0x0a0a && (value >> 8) == (value & 0xff);
+}
+
+TlsFingerprint compute_tls_fingerprint(const ClientHelloFields& fields);
+
+// Shared fingerprint for these fields. At most MAX_INTERNED distinct
+// fingerprints are kept; past that they are computed per call. Thread-safe.
+constexpr size_t MAX_INTERNED_FINGERPRINTS = 4096;
+TlsFingerprintRef intern_tls_fingerprint(const ClientHelloFields& fields);
+size_t interned_tls_fingerprints();
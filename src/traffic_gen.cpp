@@ -0,0 +1,564 @@
+/*
+ * traffic_gen.cpp - Synthetic frame construction
+ *
+ * Frames are assembled in place in a single reusable buffer: the payload is
+ * written first at the known header offset, then the headers in front of it
+ * once the lengths are known. Nothing is allocated per frame.
+ */
+
+#include "traffic_gen.hpp"
+#include "capture_file.hpp"
+#include "packet.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+constexpr size_t ETH_BYTES = 14;
+constexpr size_t IPV4_BYTES = 20;
+constexpr size_t IPV6_BYTES = 40;
+constexpr size_t TCP_BYTES = 20;
+constexpr size_t UDP_BYTES = 8;
+constexpr size_t HOSTNAME_COUNT = 4096;
+constexpr size_t PCAP_FLUSH_BYTES = 1u << 20;
+
+constexpr uint8_t CLIENT_MAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+constexpr uint8_t SERVER_MAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+
+constexpr const char* DOMAINS[] = {
+    "example.com", "example.net", "example.org", "cdn.example.com",
+    "api.example.net", "static.example.org", "images.example.com", "mail.example.net",
+};
+
+constexpr const char* KIND_NAMES[TRAFFIC_KIND_COUNT] = {"dns", "http", "tls", "tcp", "udp"};
+
+uint8_t* put16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+    return p + 2;
+}
+
+uint8_t* put24(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 16);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v);
+    return p + 3;
+}
+
+uint8_t* put32(uint8_t* p, uint32_t v) {
+    put16(p, static_cast<uint16_t>(v >> 16));
+    put16(p + 2, static_cast<uint16_t>(v));
+    return p + 4;
+}
+
+uint16_t ipv4_checksum(const uint8_t* header) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < IPV4_BYTES; i += 2) {
+        sum += static_cast<uint32_t>((header[i] << 8) | header[i + 1]);
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+size_t header_bytes(bool ipv6, uint8_t protocol) {
+    return ETH_BYTES + (ipv6 ? IPV6_BYTES : IPV4_BYTES) +
+           (protocol == PROTO_TCP ? TCP_BYTES : UDP_BYTES);
+}
+
+bool is_tcp_kind(TrafficKind kind) {
+    return kind == TrafficKind::HTTP || kind == TrafficKind::TLS || kind == TrafficKind::TCP;
+}
+
+}  // namespace
+
+TrafficGenerator::TrafficGenerator(const TrafficProfile& profile) : profile_(profile) {
+    profile_.flows = std::max<uint32_t>(profile_.flows, 1);
+    profile_.rate_pps = std::max<uint64_t>(profile_.rate_pps, 1);
+    profile_.min_frame = std::clamp(profile_.min_frame, TRAFFIC_MIN_FRAME, TRAFFIC_MAX_FRAME);
+    profile_.max_frame = std::clamp(profile_.max_frame, profile_.min_frame, TRAFFIC_MAX_FRAME);
+
+    for (uint32_t w : profile_.weights) {
+        kind_weight_total_ += w;
+    }
+
+    hostnames_.reserve(HOSTNAME_COUNT);
+    for (size_t i = 0; i < HOSTNAME_COUNT; ++i) {
+        hostnames_.push_back("h" + std::to_string(i) + "." + DOMAINS[i % std::size(DOMAINS)]);
+    }
+
+    frame_.resize(TRAFFIC_MAX_FRAME);
+    reset();
+}
+
+void TrafficGenerator::reset() {
+    state_ = profile_.seed;
+    generated_ = 0;
+
+    // Opaque payload bytes are whatever the buffer holds, so fill it from the seed
+    for (size_t i = 0; i + 8 <= frame_.size(); i += 8) {
+        uint64_t r = random();
+        std::memcpy(frame_.data() + i, &r, 8);
+    }
+
+    flows_.assign(profile_.flows, Flow{});
+    for (auto& flow : flows_) {
+        new_flow(flow);
+    }
+}
+
+// splitmix64
+uint64_t TrafficGenerator::random() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint32_t TrafficGenerator::random_below(uint32_t bound) {
+    return static_cast<uint32_t>(((random() >> 32) * bound) >> 32);
+}
+
+void TrafficGenerator::new_flow(Flow& flow) {
+    flow.kind = TrafficKind::TCP;
+    if (kind_weight_total_ > 0) {
+        uint64_t pick = random() % kind_weight_total_;
+        for (size_t k = 0; k < TRAFFIC_KIND_COUNT; ++k) {
+            if (pick < profile_.weights[k]) {
+                flow.kind = static_cast<TrafficKind>(k);
+                break;
+            }
+            pick -= profile_.weights[k];
+        }
+    }
+
+    flow.ipv6 = static_cast<double>(random() >> 11) * 0x1.0p-53 < profile_.ipv6_fraction;
+
+    // Clients in 10/8 or fd00::/8, servers in 198.18/15 (RFC 2544) or 2001:db8::/32
+    uint64_t c = random();
+    uint64_t s = random();
+    std::memset(flow.client_addr, 0, 16);
+    std::memset(flow.server_addr, 0, 16);
+    if (flow.ipv6) {
+        flow.client_addr[0] = 0xFD;
+        std::memcpy(flow.client_addr + 8, &c, 8);
+        flow.server_addr[0] = 0x20;
+        flow.server_addr[1] = 0x01;
+        flow.server_addr[2] = 0x0D;
+        flow.server_addr[3] = 0xB8;
+        std::memcpy(flow.server_addr + 8, &s, 8);
+    } else {
+        flow.client_addr[0] = 10;
+        flow.client_addr[1] = static_cast<uint8_t>(c);
+        flow.client_addr[2] = static_cast<uint8_t>(c >> 8);
+        flow.client_addr[3] = static_cast<uint8_t>(c >> 16);
+        flow.server_addr[0] = 198;
+        flow.server_addr[1] = static_cast<uint8_t>(18 + (s & 1));
+        flow.server_addr[2] = static_cast<uint8_t>(s >> 8);
+        flow.server_addr[3] = static_cast<uint8_t>(s >> 16);
+    }
+
+    flow.client_port = static_cast<uint16_t>(1024 + random_below(65536 - 1024));
+    switch (flow.kind) {
+        case TrafficKind::DNS:  flow.server_port = 53; break;
+        case TrafficKind::HTTP: flow.server_port = 80; break;
+        case TrafficKind::TLS:  flow.server_port = 443; break;
+        default: flow.server_port = static_cast<uint16_t>(1024 + random_below(65536 - 1024)); break;
+    }
+
+    flow.client_seq = static_cast<uint32_t>(random());
+    flow.server_seq = static_cast<uint32_t>(random());
+    flow.packets = 0;
+    flow.lifetime = flow.kind == TrafficKind::DNS ? 2 : 3 + random_below(62);
+    flow.host_id = random_below(HOSTNAME_COUNT);
+    flow.dns_id = static_cast<uint16_t>(random());
+}
+
+uint32_t TrafficGenerator::opaque_frame_size() {
+    switch (profile_.sizes) {
+        case SizeDistribution::FIXED:
+            return profile_.min_frame;
+        case SizeDistribution::UNIFORM:
+            return profile_.min_frame + random_below(profile_.max_frame - profile_.min_frame + 1);
+        case SizeDistribution::IMIX: {
+            uint32_t r = random_below(12);
+            return r < 7 ? 60 : (r < 11 ? 590 : 1514);
+        }
+    }
+    return profile_.min_frame;
+}
+
+GeneratedFrame TrafficGenerator::next() {
+    Flow& flow = flows_[random_below(static_cast<uint32_t>(flows_.size()))];
+
+    GeneratedFrame frame;
+    frame.kind = flow.kind;
+    frame.length = static_cast<uint32_t>(build(flow));
+    frame.data = frame_.data();
+    frame.hostname = frame_hostname_;
+    frame.timestamp_us = profile_.start_time_us + generated_ * 1000000 / profile_.rate_pps;
+    generated_++;
+    return frame;
+}
+
+size_t TrafficGenerator::build(Flow& flow) {
+    uint32_t n = flow.packets++;
+    bool last = n + 1 >= flow.lifetime;
+    size_t length = 0;
+    frame_hostname_ = {};
+
+    if (!is_tcp_kind(flow.kind)) {
+        size_t hdr = header_bytes(flow.ipv6, PROTO_UDP);
+        uint8_t* payload = frame_.data() + hdr;
+        bool from_client = flow.kind == TrafficKind::DNS ? n % 2 == 0 : random_below(2) == 0;
+        size_t payload_len;
+        if (flow.kind == TrafficKind::DNS) {
+            payload_len = dns_payload(flow, !from_client, payload);
+            frame_hostname_ = hostnames_[flow.host_id];
+        } else {
+            payload_len = std::max<size_t>(opaque_frame_size(), hdr) - hdr;
+            uint64_t r = random();
+            std::memcpy(payload, &r, std::min<size_t>(payload_len, 8));
+        }
+        length = write_headers(flow, from_client, PROTO_UDP, payload_len, 0) + payload_len;
+    } else {
+        size_t hdr = header_bytes(flow.ipv6, PROTO_TCP);
+        uint8_t* payload = frame_.data() + hdr;
+        bool from_client = true;
+        uint8_t flags = TCP_ACK;
+        size_t payload_len = 0;
+
+        if (n == 0) {
+            flags = TCP_SYN;
+        } else if (last) {
+            flags = TCP_FIN | TCP_ACK;
+        } else if (n == 1 && flow.kind == TrafficKind::HTTP) {
+            flags = TCP_PSH | TCP_ACK;
+            payload_len = http_payload(flow, payload);
+            frame_hostname_ = hostnames_[flow.host_id];
+        } else if (n == 1 && flow.kind == TrafficKind::TLS) {
+            flags = TCP_PSH | TCP_ACK;
+            payload_len = tls_payload(flow, payload);
+            frame_hostname_ = hostnames_[flow.host_id];
+        } else {
+            // Bulk data, mostly towards the client
+            from_client = random_below(4) == 0;
+            payload_len = std::max<size_t>(opaque_frame_size(), hdr) - hdr;
+            uint64_t r = random();
+            std::memcpy(payload, &r, std::min<size_t>(payload_len, 8));
+            if (flow.kind == TrafficKind::TLS && payload_len >= 5) {
+                payload[0] = 0x17;  // Application data record
+                put16(payload + 1, 0x0303);
+                put16(payload + 3, static_cast<uint16_t>(payload_len - 5));
+            }
+            if (payload_len > 0) flags = TCP_PSH | TCP_ACK;
+        }
+
+        length = write_headers(flow, from_client, PROTO_TCP, payload_len, flags) + payload_len;
+
+        uint32_t advance = static_cast<uint32_t>(payload_len) + ((flags & (TCP_SYN | TCP_FIN)) ? 1 : 0);
+        (from_client ? flow.client_seq : flow.server_seq) += advance;
+    }
+
+    if (last) {
+        new_flow(flow);
+    }
+    return length;
+}
+
+size_t TrafficGenerator::write_headers(const Flow& flow, bool from_client, uint8_t protocol,
+                                       size_t payload_len, uint8_t tcp_flags) {
+    uint8_t* p = frame_.data();
+    const uint8_t* src = from_client ? flow.client_addr : flow.server_addr;
+    const uint8_t* dst = from_client ? flow.server_addr : flow.client_addr;
+    uint16_t src_port = from_client ? flow.client_port : flow.server_port;
+    uint16_t dst_port = from_client ? flow.server_port : flow.client_port;
+    size_t l4_len = (protocol == PROTO_TCP ? TCP_BYTES : UDP_BYTES) + payload_len;
+
+    // Ethernet
+    std::memcpy(p, from_client ? SERVER_MAC : CLIENT_MAC, 6);
+    std::memcpy(p + 6, from_client ? CLIENT_MAC : SERVER_MAC, 6);
+    put16(p + 12, flow.ipv6 ? ETHERTYPE_IPV6 : ETHERTYPE_IPV4);
+    p += ETH_BYTES;
+
+    if (flow.ipv6) {
+        put32(p, 0x60000000);
+        put16(p + 4, static_cast<uint16_t>(l4_len));
+        p[6] = protocol;
+        p[7] = from_client ? 64 : 56;
+        std::memcpy(p + 8, src, 16);
+        std::memcpy(p + 24, dst, 16);
+        p += IPV6_BYTES;
+    } else {
+        p[0] = 0x45;
+        p[1] = 0;
+        put16(p + 2, static_cast<uint16_t>(IPV4_BYTES + l4_len));
+        put16(p + 4, static_cast<uint16_t>(generated_));
+        put16(p + 6, 0x4000);  // Don't fragment
+        p[8] = from_client ? 64 : 56;
+        p[9] = protocol;
+        put16(p + 10, 0);
+        std::memcpy(p + 12, src, 4);
+        std::memcpy(p + 16, dst, 4);
+        put16(p + 10, ipv4_checksum(p));
+        p += IPV4_BYTES;
+    }
+
+    put16(p, src_port);
+    put16(p + 2, dst_port);
+    if (protocol == PROTO_TCP) {
+        uint32_t seq = from_client ? flow.client_seq : flow.server_seq;
+        uint32_t ack = from_client ? flow.server_seq : flow.client_seq;
+        put32(p + 4, seq);
+        put32(p + 8, tcp_flags == TCP_SYN ? 0 : ack);
+        p[12] = 0x50;  // 20-byte header
+        p[13] = tcp_flags;
+        put16(p + 14, 65535);
+        put16(p + 16, 0);
+        put16(p + 18, 0);
+        p += TCP_BYTES;
+    } else {
+        put16(p + 4, static_cast<uint16_t>(l4_len));
+        put16(p + 6, 0);
+        p += UDP_BYTES;
+    }
+
+    return static_cast<size_t>(p - frame_.data());
+}
+
+size_t TrafficGenerator::dns_payload(Flow& flow, bool response, uint8_t* out) {
+    uint8_t* p = out;
+    p = put16(p, flow.dns_id);
+    p = put16(p, response ? 0x8180 : 0x0100);
+    p = put16(p, 1);                    // Questions
+    p = put16(p, response ? 1 : 0);     // Answers
+    p = put16(p, 0);
+    p = put16(p, 0);
+
+    // QNAME as length-prefixed labels
+    const std::string& name = hostnames_[flow.host_id];
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) dot = name.size();
+        *p++ = static_cast<uint8_t>(dot - start);
+        std::memcpy(p, name.data() + start, dot - start);
+        p += dot - start;
+        start = dot + 1;
+    }
+    *p++ = 0;
+
+    uint16_t qtype = flow.ipv6 ? 28 : 1;  // AAAA or A
+    p = put16(p, qtype);
+    p = put16(p, 1);                      // IN
+
+    if (response) {
+        size_t addr_len = flow.ipv6 ? 16 : 4;
+        p = put16(p, 0xC00C);             // Pointer to the question name
+        p = put16(p, qtype);
+        p = put16(p, 1);
+        p = put32(p, 300);                // TTL
+        p = put16(p, static_cast<uint16_t>(addr_len));
+        std::memcpy(p, flow.server_addr, addr_len);
+        p += addr_len;
+    }
+
+    return static_cast<size_t>(p - out);
+}
+
+size_t TrafficGenerator::http_payload(const Flow& flow, uint8_t* out) {
+    const std::string& host = hostnames_[flow.host_id];
+    int n = std::snprintf(reinterpret_cast<char*>(out), 512,
+                          "GET /api/v1/items/%u HTTP/1.1\r\n"
+                          "Host: %s\r\n"
+                          "User-Agent: netmon-gen/1.0\r\n"
+                          "Accept: */*\r\n"
+                          "\r\n",
+                          flow.client_port, host.c_str());
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+size_t TrafficGenerator::tls_payload(const Flow& flow, uint8_t* out) {
+    static constexpr uint16_t CIPHERS[] = {
+        0x1301, 0x1302, 0x1303, 0xC02B, 0xC02F, 0xC02C, 0xC030, 0xCCA9, 0xCCA8,
+    };
+    const std::string& host = hostnames_[flow.host_id];
+
+    uint8_t* p = out + 9;  // Record and handshake headers are filled in last
+    p = put16(p, 0x0303);
+    for (int i = 0; i < 4; ++i) {  // Random (32) then a 32-byte session id
+        uint64_t r = random();
+        std::memcpy(p + i * 8, &r, 8);
+    }
+    p += 32;
+    *p++ = 32;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t r = random();
+        std::memcpy(p + i * 8, &r, 8);
+    }
+    p += 32;
+
+    p = put16(p, static_cast<uint16_t>(sizeof(CIPHERS)));
+    for (uint16_t c : CIPHERS) p = put16(p, c);
+    *p++ = 1;  // Compression: null only
+    *p++ = 0;
+
+    uint8_t* ext_len = p;
+    p += 2;
+
+    // server_name
+    p = put16(p, 0x0000);
+    p = put16(p, static_cast<uint16_t>(host.size() + 5));
+    p = put16(p, static_cast<uint16_t>(host.size() + 3));
+    *p++ = 0;
+    p = put16(p, static_cast<uint16_t>(host.size()));
+    std::memcpy(p, host.data(), host.size());
+    p += host.size();
+
+    // supported_groups: x25519, secp256r1, secp384r1
+    static constexpr uint8_t GROUPS[] = {0x00, 0x0A, 0x00, 0x08, 0x00, 0x06,
+                                         0x00, 0x1D, 0x00, 0x17, 0x00, 0x18};
+    // ec_point_formats: uncompressed
+    static constexpr uint8_t POINT_FORMATS[] = {0x00, 0x0B, 0x00, 0x02, 0x01, 0x00};
+    // signature_algorithms: ecdsa_secp256r1_sha256, rsa_pss_rsae_sha256, rsa_pkcs1_sha256
+    static constexpr uint8_t SIG_ALGS[] = {0x00, 0x0D, 0x00, 0x08, 0x00, 0x06,
+                                           0x04, 0x03, 0x08, 0x04, 0x04, 0x01};
+    // application_layer_protocol_negotiation: h2, http/1.1
+    static constexpr uint8_t ALPN[] = {0x00, 0x10, 0x00, 0x0E, 0x00, 0x0C, 0x02, 'h', '2',
+                                       0x08, 'h', 't', 't', 'p', '/', '1', '.', '1'};
+    // supported_versions: TLS 1.3, TLS 1.2
+    static constexpr uint8_t VERSIONS[] = {0x00, 0x2B, 0x00, 0x05, 0x04,
+                                           0x03, 0x04, 0x03, 0x03};
+    for (const auto& ext : {std::pair(GROUPS, sizeof(GROUPS)),
+                            std::pair(POINT_FORMATS, sizeof(POINT_FORMATS)),
+                            std::pair(SIG_ALGS, sizeof(SIG_ALGS)),
+                            std::pair(ALPN, sizeof(ALPN)),
+                            std::pair(VERSIONS, sizeof(VERSIONS))}) {
+        std::memcpy(p, ext.first, ext.second);
+        p += ext.second;
+    }
+
+    // key_share: one x25519 share
+    p = put16(p, 0x0033);
+    p = put16(p, 38);
+    p = put16(p, 36);
+    p = put16(p, 0x001D);
+    p = put16(p, 32);
+    for (int i = 0; i < 4; ++i) {
+        uint64_t r = random();
+        std::memcpy(p + i * 8, &r, 8);
+    }
+    p += 32;
+
+    size_t total = static_cast<size_t>(p - out);
+    put16(ext_len, static_cast<uint16_t>(p - ext_len - 2));
+
+    out[0] = 0x16;                                   // Handshake record
+    put16(out + 1, 0x0301);
+    put16(out + 3, static_cast<uint16_t>(total - 5));
+    out[5] = 0x01;                                   // ClientHello
+    put24(out + 6, static_cast<uint32_t>(total - 9));
+    return total;
+}
+
+bool TrafficGenerator::write_pcap(const std::string& path, uint64_t count, std::string& error) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "Cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(PCAP_FLUSH_BYTES + TRAFFIC_MAX_FRAME + 16);
+    pcap_append_file_header(buffer, 1, 65535);  // DLT_EN10MB
+
+    auto flush = [&]() {
+        size_t written = 0;
+        while (written < buffer.size()) {
+            ssize_t n = ::write(fd, buffer.data() + written, buffer.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                error = "Write to " + path + " failed: " + strerror(errno);
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        buffer.clear();
+        return true;
+    };
+
+    bool ok = true;
+    for (uint64_t i = 0; i < count && ok; ++i) {
+        GeneratedFrame frame = next();
+        pcap_append_record(buffer, frame.timestamp_us, frame.data, frame.length, frame.length);
+        if (buffer.size() >= PCAP_FLUSH_BYTES) {
+            ok = flush();
+        }
+    }
+    ok = ok && flush();
+
+    ::close(fd);
+    return ok;
+}
+
+bool TrafficGenerator::parse_mix(const std::string& text, TrafficProfile& profile) {
+    uint32_t weights[TRAFFIC_KIND_COUNT] = {};
+    uint64_t total = 0;
+
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        if (comma == std::string::npos) comma = text.size();
+        std::string item = text.substr(start, comma - start);
+        start = comma + 1;
+
+        size_t eq = item.find('=');
+        if (eq == std::string::npos || eq + 1 >= item.size() || item.size() - eq > 7) {
+            return false;
+        }
+        std::string name = item.substr(0, eq);
+        uint32_t value = 0;
+        for (char c : item.substr(eq + 1)) {
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + static_cast<uint32_t>(c - '0');
+        }
+
+        size_t k = 0;
+        while (k < TRAFFIC_KIND_COUNT && name != KIND_NAMES[k]) ++k;
+        if (k == TRAFFIC_KIND_COUNT) {
+            return false;
+        }
+        weights[k] = value;
+        total += value;
+    }
+
+    if (total == 0) {
+        return false;
+    }
+    std::copy(std::begin(weights), std::end(weights), profile.weights);
+    return true;
+}
+
+bool TrafficGenerator::parse_sizes(const std::string& text, SizeDistribution& out) {
+    if (text == "fixed") {
+        out = SizeDistribution::FIXED;
+    } else if (text == "uniform") {
+        out = SizeDistribution::UNIFORM;
+    } else if (text == "imix") {
+        out = SizeDistribution::IMIX;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* TrafficGenerator::kind_name(TrafficKind kind) {
+    size_t k = static_cast<size_t>(kind);
+    return k < TRAFFIC_KIND_COUNT ? KIND_NAMES[k] : "?";
+}
@@ -0,0 +1,125 @@
+/*
+ * traffic_gen.hpp - Deterministic synthetic traffic for load and regression tests
+ *
+ * Builds Ethernet frames carrying IPv4 or IPv6 and TCP or UDP, for a fixed
+ * pool of concurrent flows. Each flow has a kind:
+ *
+ *   DNS   UDP/53 queries and responses for a per-flow hostname
+ *   HTTP  TCP/80: SYN, a GET request with a Host header, then data
+ *   TLS   TCP/443: SYN, a ClientHello with SNI, then data
+ *   TCP   TCP to a random high port with opaque payload
+ *   UDP   UDP to a random high port with opaque payload
+ *
+ * TCP flows end with a FIN after a random number of packets and are replaced
+ * by a new 5-tuple, so flow tables see churn. Opaque payload sizes follow the
+ * configured distribution; DNS/HTTP/TLS frames are as long as their content.
+ * Weights pick the kind of each new flow; DNS flows last two packets, so
+ * they carry a smaller share of packets than of flows.
+ *
+ * Everything is derived from the seed: the same profile always yields the same
+ * frames and timestamps (start_time_us + i / rate_pps), independent of wall
+ * clock or host, so runs are reproducible. IPv4 header checksums are valid;
+ * TCP/UDP checksums are left zero, as seen with checksum offload.
+ *
+ * Usage: construct, then call next() in a loop (in-memory feed) or
+ * write_pcap() to produce a classic pcap file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class TrafficKind : uint8_t { DNS, HTTP, TLS, TCP, UDP, COUNT };
+
+enum class SizeDistribution {
+    FIXED,     // Every opaque frame is min_frame bytes
+    UNIFORM,   // Uniform between min_frame and max_frame
+    IMIX       // Simple IMIX: 7:4:1 of 60, 590 and 1514 byte frames
+};
+
+constexpr size_t TRAFFIC_KIND_COUNT = static_cast<size_t>(TrafficKind::COUNT);
+constexpr uint32_t TRAFFIC_MIN_FRAME = 60;
+constexpr uint32_t TRAFFIC_MAX_FRAME = 9018;  // Jumbo frame
+
+struct TrafficProfile {
+    uint64_t seed = 1;
+    uint32_t flows = 1000;                        // Concurrent flows
+    double ipv6_fraction = 0.2;
+    uint32_t weights[TRAFFIC_KIND_COUNT] = {10, 10, 20, 40, 20};  // New flows: DNS, HTTP, TLS, TCP, UDP
+    SizeDistribution sizes = SizeDistribution::IMIX;
+    uint32_t min_frame = 60;
+    uint32_t max_frame = 1514;
+    uint64_t rate_pps = 100000;                   // Spacing of packet timestamps
+    uint64_t start_time_us = 1700000000000000ULL; // 2023-11-14T22:13:20Z
+};
+
+struct GeneratedFrame {
+    const uint8_t* data = nullptr;   // Valid until the next call to next()
+    uint32_t length = 0;
+    uint64_t timestamp_us = 0;
+    TrafficKind kind = TrafficKind::TCP;
+    std::string_view hostname;       // Set for DNS messages, HTTP requests and ClientHellos
+};
+
+class TrafficGenerator {
+public:
+    explicit TrafficGenerator(const TrafficProfile& profile);
+
+    // Build the next frame
+    GeneratedFrame next();
+
+    // Restart the sequence from the first frame
+    void reset();
+
+    uint64_t generated() const { return generated_; }
+    const TrafficProfile& profile() const { return profile_; }
+
+    // Write count frames as a classic pcap file (Ethernet link type)
+    bool write_pcap(const std::string& path, uint64_t count, std::string& error);
+
+    // Parse "dns=10,http=5,..." into profile.weights; unnamed kinds become 0
+    static bool parse_mix(const std::string& text, TrafficProfile& profile);
+    static bool parse_sizes(const std::string& text, SizeDistribution& out);
+    static const char* kind_name(TrafficKind kind);
+
+private:
+    struct Flow {
+        TrafficKind kind = TrafficKind::TCP;
+        bool ipv6 = false;
+        uint8_t client_addr[16] = {};
+        uint8_t server_addr[16] = {};
+        uint16_t client_port = 0;
+        uint16_t server_port = 0;
+        uint32_t client_seq = 0;
+        uint32_t server_seq = 0;
+        uint32_t packets = 0;        // Sent so far
+        uint32_t lifetime = 0;       // Packets before FIN (TCP kinds)
+        uint32_t host_id = 0;        // Index into hostnames_
+        uint16_t dns_id = 0;
+    };
+
+    uint64_t random();
+    uint32_t random_below(uint32_t bound);
+    void new_flow(Flow& flow);
+    uint32_t opaque_frame_size();
+
+    // Frame assembly into frame_; return the frame length
+    size_t build(Flow& flow);
+    size_t write_headers(const Flow& flow, bool from_client, uint8_t protocol,
+                         size_t payload_len, uint8_t tcp_flags);
+    size_t dns_payload(Flow& flow, bool response, uint8_t* out);
+    size_t http_payload(const Flow& flow, uint8_t* out);
+    size_t tls_payload(const Flow& flow, uint8_t* out);
+
+    TrafficProfile profile_;
+    uint64_t state_ = 0;
+    uint64_t generated_ = 0;
+    uint64_t kind_weight_total_ = 0;
+    std::vector<std::string> hostnames_;
+    std::vector<Flow> flows_;
+    std::vector<uint8_t> frame_;
+    std::string_view frame_hostname_;
+};
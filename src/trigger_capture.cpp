@@ -0,0 +1,336 @@
+/*
+ * trigger_capture.cpp - Alert-triggered capture implementation
+ *
+ * Window boundaries use packet capture timestamps, so the written file
+ * covers exactly [alert - pre, alert + post] of captured traffic. tick()
+ * adds the steady-clock time since the last packet to that packet's
+ * timestamp, so windows still close when traffic stops, and close on time
+ * for replayed or delayed captures too.
+ */
+
+#include "trigger_capture.hpp"
+#include "capture_file.hpp"
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t PCAP_FILE_HEADER_BYTES = 24;
+constexpr size_t PCAP_RECORD_HEADER_BYTES = 16;
+constexpr size_t WRITE_CHUNK_BYTES = 64 * 1024;
+
+uint64_t to_micros(std::chrono::system_clock::time_point tp) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        tp.time_since_epoch()).count());
+}
+
+bool write_all(int fd, const std::vector<uint8_t>& buffer) {
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t n = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+TriggerCapture::~TriggerCapture() {
+    stop();
+}
+
+bool TriggerCapture::start(const TriggerConfig& config, int linktype, uint32_t snaplen) {
+    if (running_.load()) {
+        return true;
+    }
+
+    config_ = config;
+    linktype_ = linktype;
+    snaplen_ = snaplen;
+
+    struct stat st;
+    if (stat(config_.output_dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_ = "Trigger directory not found: " + config_.output_dir;
+        return false;
+    }
+
+    pre_buffer_.clear();
+    pre_buffer_bytes_ = 0;
+    open_windows_.clear();
+    open_bytes_ = 0;
+    queued_bytes_.store(0);
+    last_packet_us_ = 0;
+    bytes_written_ = 0;
+
+    running_.store(true);
+    writer_thread_ = std::thread([this]() {
+        writer_loop();
+    });
+
+    return true;
+}
+
+void TriggerCapture::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    // Flush partially filled windows so nothing captured is lost
+    for (auto& window : open_windows_) {
+        finish_window(std::move(window));
+    }
+    open_windows_.clear();
+    open_bytes_ = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        running_.store(false);
+    }
+    jobs_cv_.notify_all();
+
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+
+    pre_buffer_.clear();
+    pre_buffer_bytes_ = 0;
+}
+
+std::string TriggerCapture::get_error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return error_;
+}
+
+void TriggerCapture::on_packet(const PacketInfo& pkt) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    auto frame = std::make_shared<StoredFrame>();
+    frame->timestamp_us = to_micros(pkt.timestamp);
+    frame->original_length = pkt.original_length;
+    frame->data = pkt.raw_data;
+    last_packet_us_ = frame->timestamp_us;
+    last_packet_seen_ = std::chrono::steady_clock::now();
+
+    // Close windows this packet falls after, then extend the rest
+    size_t record_bytes = PCAP_RECORD_HEADER_BYTES + frame->data.size();
+    for (size_t i = 0; i < open_windows_.size();) {
+        Window& window = open_windows_[i];
+        if (frame->timestamp_us > window.end_us) {
+            close_window(i);
+        } else if (window.bytes + record_bytes > config_.window_limit_bytes ||
+                   held_bytes() + record_bytes > config_.open_limit_bytes) {
+            windows_truncated_.fetch_add(1, std::memory_order_relaxed);
+            close_window(i);
+        } else {
+            add_frame(window, frame);
+            ++i;
+        }
+    }
+
+    pre_buffer_bytes_ += frame->data.size();
+    pre_buffer_.push_back(std::move(frame));
+
+    // Age out of the pre-trigger buffer by time and by size
+    uint64_t horizon_us = static_cast<uint64_t>(config_.pre_seconds) * 1000000;
+    while (!pre_buffer_.empty() &&
+           (pre_buffer_.front()->timestamp_us + horizon_us < last_packet_us_ ||
+            pre_buffer_bytes_ > config_.pre_buffer_limit_bytes)) {
+        pre_buffer_bytes_ -= pre_buffer_.front()->data.size();
+        pre_buffer_.pop_front();
+    }
+}
+
+void TriggerCapture::on_alert(const std::string& label,
+                              std::chrono::system_clock::time_point when) {
+    if (!running_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    if (open_windows_.size() >= config_.max_open_windows ||
+        held_bytes() + PCAP_FILE_HEADER_BYTES > config_.open_limit_bytes) {
+        windows_skipped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t alert_us = to_micros(when);
+    uint64_t pre_us = static_cast<uint64_t>(config_.pre_seconds) * 1000000;
+    uint64_t start_us = alert_us > pre_us ? alert_us - pre_us : 0;
+
+    Window window;
+    window.filename = config_.output_dir + "/" + make_filename(label, when);
+    window.end_us = alert_us + static_cast<uint64_t>(config_.post_seconds) * 1000000;
+    window.bytes = PCAP_FILE_HEADER_BYTES;
+    open_bytes_ += window.bytes;
+    window.frames.reserve(pre_buffer_.size());
+    // Keep the newest pre-trigger frames that fit the caps
+    auto first = pre_buffer_.end();
+    size_t pre_bytes = 0;
+    while (first != pre_buffer_.begin()) {
+        const FramePtr& frame = *(first - 1);
+        size_t record_bytes = PCAP_RECORD_HEADER_BYTES + frame->data.size();
+        if (frame->timestamp_us < start_us) {
+            break;
+        }
+        if (window.bytes + pre_bytes + record_bytes > config_.window_limit_bytes ||
+            held_bytes() + pre_bytes + record_bytes > config_.open_limit_bytes) {
+            windows_truncated_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        pre_bytes += record_bytes;
+        --first;
+    }
+    for (auto it = first; it != pre_buffer_.end(); ++it) {
+        add_frame(window, *it);
+    }
+
+    open_windows_.push_back(std::move(window));
+}
+
+void TriggerCapture::tick() {
+    if (open_windows_.empty()) {
+        return;
+    }
+
+    // Advance capture time by however long the link has been quiet
+    auto quiet = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - last_packet_seen_);
+    uint64_t now_us = last_packet_us_ + static_cast<uint64_t>(quiet.count());
+    for (size_t i = 0; i < open_windows_.size();) {
+        if (now_us > open_windows_[i].end_us) {
+            close_window(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+size_t TriggerCapture::held_bytes() const {
+    return open_bytes_ + queued_bytes_.load(std::memory_order_relaxed);
+}
+
+void TriggerCapture::add_frame(Window& window, const FramePtr& frame) {
+    size_t record_bytes = PCAP_RECORD_HEADER_BYTES + frame->data.size();
+    window.frames.push_back(frame);
+    window.bytes += record_bytes;
+    open_bytes_ += record_bytes;
+}
+
+void TriggerCapture::close_window(size_t index) {
+    open_bytes_ -= open_windows_[index].bytes;
+    finish_window(std::move(open_windows_[index]));
+    open_windows_.erase(open_windows_.begin() + static_cast<long>(index));
+}
+
+std::string TriggerCapture::make_filename(const std::string& label,
+                                          std::chrono::system_clock::time_point when) {
+    char stamp[32];
+    std::time_t t = std::chrono::system_clock::to_time_t(when);
+    std::tm tm_buf;
+    localtime_r(&t, &tm_buf);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm_buf);
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        when.time_since_epoch()).count() % 1000;
+
+    // Keep labels filesystem-safe and short
+    std::string safe;
+    for (char c : label) {
+        if (safe.size() >= 40) break;
+        unsigned char uc = static_cast<unsigned char>(c);
+        safe += (std::isalnum(uc) || c == '-' || c == '_') ? c : '_';
+    }
+    if (safe.empty()) safe = "alert";
+
+    char ms_buf[8];
+    snprintf(ms_buf, sizeof(ms_buf), "%03lld", static_cast<long long>(ms));
+    return "alert_" + std::string(stamp) + "." + ms_buf + "_" + safe + ".pcap";
+}
+
+void TriggerCapture::finish_window(Window&& window) {
+    // Still in memory until the writer is done with it
+    queued_bytes_.fetch_add(window.bytes, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        jobs_.push_back(std::move(window));
+    }
+    jobs_cv_.notify_one();
+}
+
+void TriggerCapture::writer_loop() {
+    while (true) {
+        Window job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex_);
+            jobs_cv_.wait(lock, [this]() {
+                return !jobs_.empty() || !running_.load();
+            });
+            if (jobs_.empty()) {
+                break;  // Stopped and drained
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        write_window(job);
+        job.frames.clear();
+        queued_bytes_.fetch_sub(job.bytes, std::memory_order_relaxed);
+    }
+}
+
+void TriggerCapture::write_window(const Window& window) {
+    // The size is known up front, so an over-budget window costs nothing
+    if (bytes_written_ + window.bytes > config_.disk_budget_bytes) {
+        windows_skipped_.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_ = "Trigger capture disk budget exhausted";
+        return;
+    }
+
+    int fd = ::open(window.filename.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        windows_skipped_.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_ = "Cannot create " + window.filename + ": " + strerror(errno);
+        return;
+    }
+
+    // Stream the file out in chunks
+    std::vector<uint8_t> buffer;
+    buffer.reserve(WRITE_CHUNK_BYTES + snaplen_ + PCAP_RECORD_HEADER_BYTES);
+    pcap_append_file_header(buffer, static_cast<uint32_t>(linktype_), snaplen_);
+    size_t written = 0;
+    bool ok = true;
+    for (const auto& frame : window.frames) {
+        pcap_append_record(buffer, frame->timestamp_us, frame->data.data(),
+                           static_cast<uint32_t>(frame->data.size()), frame->original_length);
+        if (buffer.size() >= WRITE_CHUNK_BYTES) {
+            ok = write_all(fd, buffer);
+            if (!ok) break;
+            written += buffer.size();
+            buffer.clear();
+        }
+    }
+    if (ok && !buffer.empty()) {
+        ok = write_all(fd, buffer);
+        if (ok) written += buffer.size();
+    }
+    ::close(fd);
+
+    bytes_written_ += written;
+    if (ok) {
+        files_written_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_ = "Short write to " + window.filename;
+    }
+}
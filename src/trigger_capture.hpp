@@ -0,0 +1,126 @@
+/*
+ * trigger_capture.hpp - Alert-triggered capture with pre/post windows
+ *
+ * Keeps a rolling pre-trigger buffer of the last N seconds of frames. When
+ * an alert fires, the frames from N seconds before it are captured along
+ * with every frame for M seconds after it, and the window is written to a
+ * pcap file named after the alert.
+ *
+ * Frames are shared (shared_ptr) between the rolling buffer and any open
+ * windows, so overlapping alerts don't duplicate bytes. A window is closed
+ * early, and counted as truncated, when it reaches window_limit_bytes or
+ * when the open windows and those still waiting to be written together
+ * reach open_limit_bytes; at that limit new alerts are skipped, so a burst
+ * at line rate or a slow disk cannot hold more than that in memory.
+ * on_packet(), on_alert() and tick() run on the capture thread; finished
+ * windows are handed to a writer thread, which enforces a total disk
+ * budget and streams each file out without building it in memory.
+ */
+
+#pragma once
+
+#include "packet.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct TriggerConfig {
+    std::string output_dir;                        // Where alert captures are written
+    uint32_t pre_seconds = 10;                     // Window before the alert
+    uint32_t post_seconds = 10;                    // Window after the alert
+    uint64_t disk_budget_bytes = 500ULL * 1000000; // Total bytes written per run
+    size_t pre_buffer_limit_bytes = 64u << 20;     // Cap on the rolling buffer
+    size_t max_open_windows = 8;                   // Concurrent post-trigger windows
+    size_t window_limit_bytes = 128u << 20;        // One window's file, pre frames included
+    size_t open_limit_bytes = 256u << 20;          // Open and unwritten windows together
+};
+
+class TriggerCapture {
+public:
+    TriggerCapture() = default;
+    ~TriggerCapture();
+
+    // Non-copyable
+    TriggerCapture(const TriggerCapture&) = delete;
+    TriggerCapture& operator=(const TriggerCapture&) = delete;
+
+    bool start(const TriggerConfig& config, int linktype, uint32_t snaplen);
+    void stop();  // Writes any open windows, then joins the writer
+
+    // Capture thread
+    void on_packet(const PacketInfo& pkt);
+    void on_alert(const std::string& label, std::chrono::system_clock::time_point when);
+    // Closes windows whose post period has elapsed with no traffic, in
+    // packet time advanced by how long the link has been quiet
+    void tick();
+
+    bool is_running() const { return running_.load(); }
+    std::string get_error() const;
+
+    // Counters
+    uint64_t files_written() const { return files_written_.load(); }
+    uint64_t windows_skipped() const { return windows_skipped_.load(); }
+    uint64_t windows_truncated() const { return windows_truncated_.load(); }
+
+    // Build a file name for an alert (exposed for tests)
+    static std::string make_filename(const std::string& label,
+                                     std::chrono::system_clock::time_point when);
+
+private:
+    struct StoredFrame {
+        uint64_t timestamp_us;
+        uint32_t original_length;
+        std::vector<uint8_t> data;
+    };
+    using FramePtr = std::shared_ptr<const StoredFrame>;
+
+    struct Window {
+        std::string filename;
+        uint64_t end_us;
+        std::vector<FramePtr> frames;
+        size_t bytes = 0;         // Size of the pcap file, header included
+    };
+
+    size_t held_bytes() const;
+    void add_frame(Window& window, const FramePtr& frame);
+    void close_window(size_t index);
+    void finish_window(Window&& window);
+    void writer_loop();
+    void write_window(const Window& window);
+
+    TriggerConfig config_;
+    int linktype_ = 1;
+    uint32_t snaplen_ = 65535;
+
+    // Capture-thread state
+    std::deque<FramePtr> pre_buffer_;
+    size_t pre_buffer_bytes_ = 0;
+    std::vector<Window> open_windows_;
+    size_t open_bytes_ = 0;
+    uint64_t last_packet_us_ = 0;
+    std::chrono::steady_clock::time_point last_packet_seen_{};
+
+    // Writer thread
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_cv_;
+    std::deque<Window> jobs_;
+    std::atomic<size_t> queued_bytes_{0};  // Windows not yet written
+    uint64_t bytes_written_ = 0;  // Writer thread only
+
+    mutable std::mutex error_mutex_;
+    std::string error_;
+
+    std::atomic<bool> running_{false};
+    std::thread writer_thread_;
+
+    std::atomic<uint64_t> files_written_{0};
+    std::atomic<uint64_t> windows_skipped_{0};
+    std::atomic<uint64_t> windows_truncated_{0};
+};
@@ -17,6 +17,11 @@
 // WatchlistEntry implementation
 
 bool WatchlistEntry::matches(const PacketInfo& pkt) const {
+    // Fingerprint entries only look at the ClientHello fingerprint
+    if (type == MatchType::JA3 || type == MatchType::JA4) {
+        return pkt.tls_fingerprint && matches_fingerprint(*pkt.tls_fingerprint);
+    }
+
     // Check hostname first (if available)
     if (!pkt.hostname.empty() && matches_hostname(pkt.hostname)) {
         return true;
@@ -68,6 +73,8 @@ bool WatchlistEntry::matches_hostname(const std::string& hostname) const {
 
         case MatchType::IP:
         case MatchType::CIDR:
+        case MatchType::JA3:
+        case MatchType::JA4:
             // These don't match hostnames
             return false;
     }
@@ -75,6 +82,36 @@ bool WatchlistEntry::matches_hostname(const std::string& hostname) const {
     return false;
 }
 
+bool WatchlistEntry::matches_fingerprint(const TlsFingerprint& fingerprint) const {
+    if (type == MatchType::JA3) {
+        return fingerprint.ja3 == pattern;
+    }
+    if (type == MatchType::JA4) {
+        if (!compiled_regex) {
+            return fingerprint.ja4 == pattern;
+        }
+        try {
+            return std::regex_match(fingerprint.ja4, *compiled_regex);
+        } catch (...) {
+            return false;
+        }
+    }
+    return false;
+}
+
+std::string WatchlistEntry::matched_value(const PacketInfo& pkt) const {
+    if (pkt.tls_fingerprint && type == MatchType::JA3) {
+        return "JA3 " + pkt.tls_fingerprint->ja3;
+    }
+    if (pkt.tls_fingerprint && type == MatchType::JA4) {
+        return "JA4 " + pkt.tls_fingerprint->ja4;
+    }
+    if (!pkt.hostname.empty()) {
+        return pkt.hostname;
+    }
+    return pkt.dst_ip.empty() ? pkt.src_ip : pkt.dst_ip;
+}
+
 bool WatchlistEntry::matches_ip(const std::string& ip) const {
     if (ip.empty()) {
         return false;
@@ -109,6 +146,10 @@ bool WatchlistEntry::matches_ip(const std::string& ip) const {
                 }
             }
             return false;
+
+        case MatchType::JA3:
+        case MatchType::JA4:
+            return false;
     }
 
     return false;
@@ -214,6 +255,28 @@ std::optional<WatchlistEntry> WatchlistEntry::from_fields(
         } else {
             entry.netmask = 0xFFFFFFFF << (32 - prefix);
         }
+    } else if (type_str == "ja3") {
+        // 32 hex digits, compared in lowercase
+        entry.type = MatchType::JA3;
+        std::transform(entry.pattern.begin(), entry.pattern.end(), entry.pattern.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        if (entry.pattern.size() != 32 ||
+            entry.pattern.find_first_not_of("0123456789abcdef") != std::string::npos) {
+            return std::nullopt;
+        }
+    } else if (type_str == "ja4") {
+        // Exact, or a glob such as t13d*_8daaf6152771_*
+        entry.type = MatchType::JA4;
+        std::transform(entry.pattern.begin(), entry.pattern.end(), entry.pattern.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        if (entry.pattern.find_first_of("*?") != std::string::npos) {
+            try {
+                entry.compiled_regex = std::regex(Watchlist::wildcard_to_regex(entry.pattern),
+                                                  std::regex::optimize);
+            } catch (...) {
+                return std::nullopt;
+            }
+        }
     } else {
         return std::nullopt;  // Unknown type
     }
@@ -2,7 +2,8 @@
  * watchlist.hpp - Watchlist and alert system
  *
  * Monitors network traffic for matches against user-defined patterns.
- * Supports exact hostname/IP matching, wildcard patterns, regex, and CIDR ranges.
+ * Supports exact hostname/IP matching, wildcard patterns, regex, CIDR ranges,
+ * and JA3/JA4 TLS client fingerprints.
  * Generates alerts when matches are detected and logs them to file.
  */
 
@@ -19,7 +20,7 @@
 #include <atomic>
 
 struct WatchlistEntry {
-    enum class MatchType { EXACT, WILDCARD, REGEX, IP, CIDR };
+    enum class MatchType { EXACT, WILDCARD, REGEX, IP, CIDR, JA3, JA4 };
 
     MatchType type;
     std::string pattern;        // Original pattern string
@@ -41,6 +42,12 @@ struct WatchlistEntry {
     // Check IP match
     bool matches_ip(const std::string& ip) const;
 
+    // Check JA3/JA4 match (JA4 patterns may use * and ?)
+    bool matches_fingerprint(const TlsFingerprint& fingerprint) const;
+
+    // The packet field this entry matched, for alerts
+    std::string matched_value(const PacketInfo& pkt) const;
+
     // Create entry from parsed fields
     static std::optional<WatchlistEntry> from_fields(const std::vector<std::string>& fields);
 
@@ -0,0 +1,482 @@
+/*
+ * parser_bench.cpp - Microbenchmarks for parse_packet() and the L7 parsers
+ *
+ * Times parse_packet() over fixed, hand-built corpora (small UDP, DNS, HTTP
+ * with many headers, TLS with a large extension list, IPv6 and VLAN-tagged
+ * frames), and parse_dns_query(), parse_http_request() and
+ * parse_tls_client_hello() directly on the same application payloads.
+ * tcp_mtu and tcp_mtu_checksum parse the same full-size TCP segments, the
+ * second also verifying their checksums, so the difference is the cost of
+ * verify_checksums().
+ * Reports the median ns per packet over several runs and bytes per cycle
+ * (TSC cycles on x86, so reference rather than core clocks).
+ *
+ * Every sample is checked for the hostname it was built with before timing;
+ * a mismatch fails the run, so a parser regression cannot pass as a speedup.
+ *
+ * Examples:
+ *   parser-bench
+ *   parser-bench --case tls --min-time 2 --json
+ */
+
+#include "../src/checksum.hpp"
+#include "../src/packet.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+namespace {
+
+constexpr int RUNS = 7;          // Median of this many timed runs
+constexpr int SAMPLES = 16;      // Frames per corpus, each with its own hostname
+
+enum class Target { PACKET, CHECKSUM, DNS, HTTP, TLS };
+
+struct Sample {
+    std::vector<uint8_t> frame;
+    size_t payload_offset = 0;   // Start of the application payload
+    std::string hostname;
+};
+
+struct Case {
+    const char* name;
+    Target target;
+    std::vector<Sample> samples;
+};
+
+struct Result {
+    const char* name;
+    double ns_per_packet = 0;
+    double bytes_per_packet = 0;
+    double bytes_per_cycle = 0;   // 0 when no cycle counter is available
+};
+
+volatile uint64_t sink;  // Keeps the parsers' results observable
+
+uint64_t cycles() {
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Big-endian frame builder
+class Builder {
+public:
+    void u8(uint8_t v) { bytes.push_back(v); }
+    void u16(uint16_t v) { u8(v >> 8); u8(v & 0xFF); }
+    void u24(uint32_t v) { u8((v >> 16) & 0xFF); u16(v & 0xFFFF); }
+    void u32(uint32_t v) { u16(v >> 16); u16(v & 0xFFFF); }
+    void fill(size_t n, uint8_t v) { bytes.insert(bytes.end(), n, v); }
+    void text(const std::string& s) { bytes.insert(bytes.end(), s.begin(), s.end()); }
+    void put16(size_t at, uint16_t v) { bytes[at] = v >> 8; bytes[at + 1] = v & 0xFF; }
+    void put24(size_t at, uint32_t v) { bytes[at] = (v >> 16) & 0xFF; put16(at + 1, v & 0xFFFF); }
+    size_t size() const { return bytes.size(); }
+
+    void ethernet(uint16_t ether_type, bool vlan) {
+        for (uint8_t b : {0x02, 0x00, 0x00, 0x00, 0x00, 0x01}) u8(b);
+        for (uint8_t b : {0x02, 0x00, 0x00, 0x00, 0x00, 0x02}) u8(b);
+        if (vlan) {
+            u16(0x8100);
+            u16(100);   // PCP 0, VID 100
+        }
+        u16(ether_type);
+    }
+
+    void ipv4(uint8_t protocol, size_t l4_length) {
+        u8(0x45); u8(0);
+        u16(static_cast<uint16_t>(20 + l4_length));
+        u16(0x1234); u16(0x4000);
+        u8(64); u8(protocol); u16(0);
+        u32(0x0A000001); u32(0x5DB8D822);   // 10.0.0.1 -> 93.184.216.34
+    }
+
+    void ipv6(uint8_t next_header, size_t l4_length) {
+        u32(0x60000000);
+        u16(static_cast<uint16_t>(l4_length));
+        u8(next_header); u8(64);
+        for (int i = 0; i < 2; ++i) {
+            u32(0x20010DB8); u32(0); u32(0); u32(i + 1);
+        }
+    }
+
+    void udp(uint16_t src, uint16_t dst, size_t payload) {
+        u16(src); u16(dst); u16(static_cast<uint16_t>(8 + payload)); u16(0);
+    }
+
+    void tcp(uint16_t src, uint16_t dst, uint8_t flags) {
+        u16(src); u16(dst); u32(1000); u32(2000);
+        u8(5 << 4); u8(flags); u16(65535); u16(0); u16(0);
+    }
+
+    std::vector<uint8_t> bytes;
+};
+
+std::vector<uint8_t> dns_query(const std::string& name) {
+    Builder b;
+    b.u16(0xBEEF); b.u16(0x0100); b.u16(1); b.u16(0); b.u16(0); b.u16(0);
+    size_t start = 0;
+    while (start <= name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) dot = name.size();
+        b.u8(static_cast<uint8_t>(dot - start));
+        b.text(name.substr(start, dot - start));
+        start = dot + 1;
+    }
+    b.u8(0);
+    b.u16(28); b.u16(1);   // AAAA IN
+    return b.bytes;
+}
+
+// Browser-like request with the Host header after a long run of others
+std::vector<uint8_t> http_request(const std::string& host) {
+    std::string req = "GET /assets/app/bundle.min.js?v=20240101 HTTP/1.1\r\n";
+    req += "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n";
+    req += "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n";
+    req += "Accept-Language: en-GB,en;q=0.7,de;q=0.3\r\n";
+    req += "Accept-Encoding: gzip, deflate, br, zstd\r\n";
+    req += "Referer: https://www.example.org/section/page.html\r\n";
+    req += "Connection: keep-alive\r\n";
+    req += "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark; consent=1\r\n";
+    req += "Upgrade-Insecure-Requests: 1\r\n";
+    req += "Sec-Fetch-Dest: document\r\n";
+    req += "Sec-Fetch-Mode: navigate\r\n";
+    req += "Sec-Fetch-Site: same-origin\r\n";
+    req += "Sec-Fetch-User: ?1\r\n";
+    req += "Priority: u=0, i\r\n";
+    req += "Cache-Control: max-age=0\r\n";
+    req += "If-None-Match: \"5f3a9c7e-1b2d\"\r\n";
+    req += "If-Modified-Since: Mon, 01 Jan 2024 00:00:00 GMT\r\n";
+    req += "Host: " + host + "\r\n\r\n";
+    return std::vector<uint8_t>(req.begin(), req.end());
+}
+
+// ClientHello with a modern extension list; SNI comes late, as in Chrome
+std::vector<uint8_t> tls_client_hello(const std::string& sni) {
+    Builder b;
+    b.u8(0x16); b.u16(0x0301); b.u16(0);        // Record, length patched below
+    b.u8(0x01); b.u24(0);                       // ClientHello, length patched below
+    b.u16(0x0303);
+    b.fill(32, 0xA5);                           // Random
+    b.u8(32); b.fill(32, 0x5A);                 // Session ID
+    b.u16(32);
+    for (uint16_t suite = 0; suite < 16; ++suite) b.u16(0x1301 + suite);
+    b.u8(1); b.u8(0);                           // Null compression
+
+    size_t ext_len_at = b.size();
+    b.u16(0);
+    auto ext = [&](uint16_t type, size_t len, uint8_t fill) {
+        b.u16(type); b.u16(static_cast<uint16_t>(len)); b.fill(len, fill);
+    };
+    ext(0x0A0A, 0, 0);          // GREASE
+    ext(0x0017, 0, 0);          // extended_master_secret
+    ext(0xFF01, 1, 0);          // renegotiation_info
+    ext(0x000A, 12, 0x1D);      // supported_groups
+    ext(0x000B, 2, 0x01);       // ec_point_formats
+    ext(0x0023, 0, 0);          // session_ticket
+    ext(0x0010, 14, 0x68);      // ALPN
+    ext(0x0005, 5, 0x01);       // status_request
+    ext(0x000D, 18, 0x04);      // signature_algorithms
+    ext(0x0012, 0, 0);          // signed_certificate_timestamp
+    ext(0x0033, 1263, 0x42);    // key_share with a post-quantum share
+    ext(0x002D, 2, 0x01);       // psk_key_exchange_modes
+    ext(0x002B, 7, 0x03);       // supported_versions
+    ext(0x001B, 3, 0x02);       // compress_certificate
+    ext(0x4469, 5, 0x02);       // application_settings
+    ext(0xFE0D, 250, 0x77);     // encrypted_client_hello
+    b.u16(0x0000);              // server_name
+    b.u16(static_cast<uint16_t>(sni.size() + 5));
+    b.u16(static_cast<uint16_t>(sni.size() + 3));
+    b.u8(0);
+    b.u16(static_cast<uint16_t>(sni.size()));
+    b.text(sni);
+    ext(0x1A1A, 1, 0);          // GREASE
+
+    b.put16(ext_len_at, static_cast<uint16_t>(b.size() - ext_len_at - 2));
+    b.put24(6, static_cast<uint32_t>(b.size() - 9));
+    b.put16(3, static_cast<uint16_t>(b.size() - 5));
+    return b.bytes;
+}
+
+std::string host_for(int i) {
+    return "cdn" + std::to_string(i) + ".static.assets.example-content-delivery.net";
+}
+
+enum class L3 { IPV4, IPV6, VLAN_IPV4 };
+
+// Wrap an application payload in Ethernet/IP/UDP or TCP
+Sample make_sample(L3 l3, uint8_t protocol, uint16_t src, uint16_t dst,
+                   const std::vector<uint8_t>& payload, const std::string& hostname) {
+    size_t l4 = (protocol == PROTO_UDP ? 8 : 20) + payload.size();
+    Builder b;
+    b.ethernet(l3 == L3::IPV6 ? ETHERTYPE_IPV6 : ETHERTYPE_IPV4, l3 == L3::VLAN_IPV4);
+    if (l3 == L3::IPV6) {
+        b.ipv6(protocol, l4);
+    } else {
+        b.ipv4(protocol, l4);
+    }
+    if (protocol == PROTO_UDP) {
+        b.udp(src, dst, payload.size());
+    } else {
+        b.tcp(src, dst, TCP_PSH | TCP_ACK);
+    }
+    Sample sample;
+    sample.payload_offset = b.size();
+    b.bytes.insert(b.bytes.end(), payload.begin(), payload.end());
+    sample.frame = std::move(b.bytes);
+    sample.hostname = hostname;
+    return sample;
+}
+
+// Fill in the IPv4 header and TCP checksums of an untagged IPv4/TCP sample
+void set_checksums(Sample& sample) {
+    std::vector<uint8_t>& frame = sample.frame;
+    const size_t ip = 14;
+    const size_t tcp = ip + 20;
+    uint16_t ip_sum = static_cast<uint16_t>(~ones_complement_sum(frame.data() + ip, 20));
+    frame[ip + 10] = ip_sum >> 8;
+    frame[ip + 11] = ip_sum & 0xFF;
+
+    size_t length = frame.size() - tcp;
+    uint8_t pseudo[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, PROTO_TCP,
+                          static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length & 0xFF)};
+    std::memcpy(pseudo, frame.data() + ip + 12, 8);
+    uint32_t sum = ones_complement_sum(pseudo, sizeof(pseudo)) +
+                   ones_complement_sum(frame.data() + tcp, length);
+    uint16_t tcp_sum = static_cast<uint16_t>(~((sum & 0xFFFF) + (sum >> 16)));
+    frame[tcp + 16] = tcp_sum >> 8;
+    frame[tcp + 17] = tcp_sum & 0xFF;
+}
+
+std::vector<Case> build_cases() {
+    std::vector<Case> cases = {
+        {"udp_small", Target::PACKET, {}},
+        {"dns", Target::PACKET, {}},
+        {"http", Target::PACKET, {}},
+        {"tls", Target::PACKET, {}},
+        {"ipv6", Target::PACKET, {}},
+        {"vlan", Target::PACKET, {}},
+        {"tcp_mtu", Target::PACKET, {}},
+        {"tcp_mtu_checksum", Target::CHECKSUM, {}},
+        {"dns_query", Target::DNS, {}},
+        {"http_request", Target::HTTP, {}},
+        {"tls_client_hello", Target::TLS, {}},
+    };
+
+    for (int i = 0; i < SAMPLES; ++i) {
+        uint16_t port = static_cast<uint16_t>(40000 + i);
+        std::string host = host_for(i);
+        Sample dns = make_sample(L3::IPV4, PROTO_UDP, port, PORT_DNS, dns_query(host), host);
+        Sample http = make_sample(L3::IPV4, PROTO_TCP, port, PORT_HTTP, http_request(host), host);
+        Sample tls = make_sample(L3::IPV4, PROTO_TCP, port, PORT_HTTPS, tls_client_hello(host), host);
+
+        cases[0].samples.push_back(make_sample(L3::IPV4, PROTO_UDP, port, 5000,
+                                               std::vector<uint8_t>(18, 0x11), ""));
+        cases[1].samples.push_back(dns);
+        cases[2].samples.push_back(http);
+        cases[3].samples.push_back(tls);
+        cases[4].samples.push_back(make_sample(L3::IPV6, PROTO_TCP, port, PORT_HTTPS,
+                                               tls_client_hello(host), host));
+        cases[5].samples.push_back(make_sample(L3::VLAN_IPV4, PROTO_UDP, port, PORT_DNS,
+                                               dns_query(host), host));
+        // 1460 bytes of payload on an unregistered port: 1514-byte frames
+        Sample mtu = make_sample(L3::IPV4, PROTO_TCP, port, 5001,
+                                 std::vector<uint8_t>(1460, static_cast<uint8_t>(0x30 + i)), "");
+        set_checksums(mtu);
+        cases[6].samples.push_back(mtu);
+        cases[7].samples.push_back(mtu);
+        cases[8].samples.push_back(dns);
+        cases[9].samples.push_back(http);
+        cases[10].samples.push_back(tls);
+    }
+    return cases;
+}
+
+PacketInfo run_one(Target target, const Sample& sample) {
+    const uint8_t* data = sample.frame.data();
+    uint32_t length = static_cast<uint32_t>(sample.frame.size());
+    if (target == Target::PACKET) {
+        return parse_packet(data, length, length);
+    }
+    if (target == Target::CHECKSUM) {
+        PacketInfo info = parse_packet(data, length, length);
+        verify_checksums(info);
+        if (info.ip_checksum != ChecksumStatus::GOOD || info.l4_checksum != ChecksumStatus::GOOD) {
+            info.hostname = "(bad checksum)";
+        }
+        return info;
+    }
+
+    PacketInfo info{};
+    const uint8_t* payload = data + sample.payload_offset;
+    size_t payload_len = length - sample.payload_offset;
+    switch (target) {
+        case Target::DNS:  parse_dns_query(info, payload, payload_len); break;
+        case Target::HTTP: parse_http_request(info, payload, payload_len); break;
+        case Target::TLS:  parse_tls_client_hello(info, payload, payload_len); break;
+        case Target::PACKET:
+        case Target::CHECKSUM: break;
+    }
+    return info;
+}
+
+size_t bytes_seen(Target target, const Sample& sample) {
+    bool whole_frame = target == Target::PACKET || target == Target::CHECKSUM;
+    return sample.frame.size() - (whole_frame ? 0 : sample.payload_offset);
+}
+
+Result measure(const Case& c, double min_seconds) {
+    Result result;
+    result.name = c.name;
+    size_t corpus_bytes = 0;
+    for (const Sample& s : c.samples) {
+        corpus_bytes += bytes_seen(c.target, s);
+    }
+    result.bytes_per_packet = static_cast<double>(corpus_bytes) / c.samples.size();
+
+    // Calibrate laps so each run lasts about min_seconds / RUNS
+    uint64_t laps = 1;
+    double run_seconds = min_seconds / RUNS;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t lap = 0; lap < laps; ++lap) {
+            for (const Sample& s : c.samples) sink = run_one(c.target, s).hostname.size();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= run_seconds / 4 || laps >= (1ull << 40)) {
+            laps = std::max<uint64_t>(1, static_cast<uint64_t>(laps * run_seconds / std::max(elapsed, 1e-9)));
+            break;
+        }
+        laps *= 4;
+    }
+
+    std::vector<double> ns(RUNS);
+    std::vector<double> bpc(RUNS);
+    uint64_t packets = laps * c.samples.size();
+    for (int run = 0; run < RUNS; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t start_cycles = cycles();
+        for (uint64_t lap = 0; lap < laps; ++lap) {
+            for (const Sample& s : c.samples) sink = run_one(c.target, s).hostname.size();
+        }
+        uint64_t elapsed_cycles = cycles() - start_cycles;
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ns[run] = elapsed * 1e9 / packets;
+        bpc[run] = elapsed_cycles ? static_cast<double>(corpus_bytes) * laps / elapsed_cycles : 0;
+    }
+    std::sort(ns.begin(), ns.end());
+    std::sort(bpc.begin(), bpc.end());
+    result.ns_per_packet = ns[RUNS / 2];
+    result.bytes_per_cycle = bpc[RUNS / 2];
+    return result;
+}
+
+// Every sample must yield its hostname, or the timings mean nothing
+bool verify(const Case& c) {
+    for (const Sample& s : c.samples) {
+        PacketInfo info = run_one(c.target, s);
+        if (info.hostname != s.hostname) {
+            std::fprintf(stderr, "%s: expected hostname \"%s\", parsed \"%s\"\n",
+                         c.name, s.hostname.c_str(), info.hostname.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+void usage(const char* prog) {
+    std::printf(
+        "Usage: %s [options]\n"
+        "\n"
+        "  --case NAME      Only run cases whose name contains NAME\n"
+        "  --min-time SECS  Timed seconds per case (default 1)\n"
+        "  --json           Print results as JSON\n"
+        "  --list           List cases and exit\n",
+        prog);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double min_seconds = 1.0;
+    bool json = false;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else if (arg == "--case" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            char* end = nullptr;
+            min_seconds = std::strtod(argv[++i], &end);
+            if (*end != '\0' || min_seconds <= 0) {
+                std::fprintf(stderr, "Invalid --min-time: %s\n", argv[i]);
+                return 2;
+            }
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            std::fprintf(stderr, "Unknown option: %s\n\n", arg.c_str());
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Case> cases = build_cases();
+    std::vector<Result> results;
+    for (const Case& c : cases) {
+        if (!filter.empty() && std::string(c.name).find(filter) == std::string::npos) {
+            continue;
+        }
+        if (list) {
+            std::printf("%s\n", c.name);
+            continue;
+        }
+        if (!verify(c)) {
+            return 1;
+        }
+        results.push_back(measure(c, min_seconds));
+    }
+    if (list) {
+        return 0;
+    }
+    if (results.empty()) {
+        std::fprintf(stderr, "No case matches \"%s\"\n", filter.c_str());
+        return 2;
+    }
+
+    if (json) {
+        std::printf("{\n  \"format_version\": 1,\n  \"cases\": {");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            std::printf("%s\n    \"%s\": {\"ns_per_packet\": %.1f, \"bytes_per_packet\": %.1f, "
+                        "\"bytes_per_cycle\": %.3f}",
+                        i ? "," : "", r.name, r.ns_per_packet, r.bytes_per_packet, r.bytes_per_cycle);
+        }
+        std::printf("\n  }\n}\n");
+        return 0;
+    }
+
+    std::printf("%-18s %10s %10s %12s\n", "case", "ns/pkt", "bytes/pkt", "bytes/cycle");
+    for (const Result& r : results) {
+        std::printf("%-18s %10.1f %10.1f %12.3f\n",
+                    r.name, r.ns_per_packet, r.bytes_per_packet, r.bytes_per_cycle);
+    }
+    return 0;
+}
@@ -8,16 +8,48 @@
 #define ATTEST_IMPLEMENTATION
 #include "attest.h"
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 #include <cstring>
 #include <arpa/inet.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Include project headers
 #include "../src/packet.hpp"
 #include "../src/config.hpp"
 #include "../src/descriptions.hpp"
 #include "../src/watchlist.hpp"
+#include "../src/options.hpp"
+#include "../src/metrics.hpp"
+#include "../src/instrumentation.hpp"
+#include "../src/capture_file.hpp"
+#include "../src/trigger_capture.hpp"
+#include "../src/flow_table.hpp"
+#include "../src/record_format.hpp"
+#include "../src/exporter.hpp"
+#include "../src/columnar.hpp"
+#include "../src/flow_export.hpp"
+#include "../src/traffic_gen.hpp"
+#include "../src/pipeline.hpp"
+#include "../src/bench.hpp"
+#include "../src/alloc_counter.hpp"
+#include "../src/tcp_reassembly.hpp"
+#include "../src/ip_reassembly.hpp"
+#include "../src/dns_cache.hpp"
+#include "../src/dns_tracker.hpp"
+#include "../src/crypto.hpp"
+#include "../src/quic.hpp"
+#include "../src/checksum.hpp"
+#include "../src/tcp_analytics.hpp"
+#include "../src/http_tracker.hpp"
+#include "../src/attack_detector.hpp"
+#include "../src/baseline.hpp"
+#include "../src/tls_fingerprint.hpp"
+#include "../src/dissector.hpp"
 
 // =============================================================================
 // Config::parse_fields Tests
@@ -418,7 +450,7 @@ REGISTER_TEST(parse_dns_name_simple)
     std::string name = parse_dns_name(data, sizeof(data), offset);
     ATTEST_EQUAL(name, "www.google.com");
     // Offset should point past the parsed name (after the null terminator)
-    ATTEST_TRUE(offset > 0);
+    ATTEST_EQUAL(offset, sizeof(data));
 }
 
 REGISTER_TEST(parse_dns_name_single_label)
@@ -492,6 +524,52 @@ REGISTER_TEST(parse_packet_ethernet_only)
     ATTEST_TRUE(pkt.src_mac == expected_src);
 }
 
+REGISTER_TEST(parse_http_request_headers)
+{
+    std::string req = "POST /api/v1/upload HTTP/1.1\r\n"
+                      "user-agent:  curl/8.5.0 \r\n"
+                      "X-Note: a\rb\r\n"
+                      "HOST: example.com:8080\r\n"
+                      "Content-Type: application/json\r\n"
+                      "\r\n{}";
+    PacketInfo info{};
+    parse_http_request(info, reinterpret_cast<const uint8_t*>(req.data()), req.size());
+    ATTEST_EQUAL(info.app_protocol, "HTTP");
+    ATTEST_EQUAL(info.app_info, "POST /api/v1/upload");
+    ATTEST_EQUAL(info.hostname, "example.com");
+    ATTEST_EQUAL(info.user_agent, "curl/8.5.0");
+    ATTEST_EQUAL(info.content_type, "application/json");
+
+    std::string resp = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n\r\n";
+    PacketInfo rinfo{};
+    parse_http_request(rinfo, reinterpret_cast<const uint8_t*>(resp.data()), resp.size());
+    ATTEST_EQUAL(rinfo.app_info, "Response 200 OK");
+    ATTEST_EQUAL(rinfo.http_status, 200);
+    ATTEST_EQUAL(rinfo.http_content_length, -1);
+    ATTEST_EQUAL(rinfo.content_type, "text/html");
+    ATTEST_TRUE(rinfo.hostname.empty());
+
+    // Unknown methods and lowercase methods are not HTTP
+    std::string other = "get / HTTP/1.1\r\nHost: a\r\n\r\n";
+    PacketInfo oinfo{};
+    parse_http_request(oinfo, reinterpret_cast<const uint8_t*>(other.data()), other.size());
+    ATTEST_TRUE(oinfo.app_protocol.empty());
+}
+
+REGISTER_TEST(find_byte_matches_scalar_search)
+{
+    std::vector<uint8_t> buf(100, 'a');
+    for (size_t len = 0; len <= buf.size(); ++len) {
+        ATTEST_EQUAL(find_byte(buf.data(), len, ':'), len);
+    }
+    for (size_t at = 0; at < buf.size(); ++at) {
+        buf[at] = ':';
+        ATTEST_EQUAL(find_byte(buf.data(), buf.size(), ':'), at);
+        ATTEST_EQUAL(find_byte(buf.data(), at, ':'), at);
+        buf[at] = 'a';
+    }
+}
+
 // =============================================================================
 // Alert Formatting Tests
 // =============================================================================
@@ -551,3 +629,2889 @@ REGISTER_TEST(watchlist_entry_no_match)
 
     ATTEST_FALSE(entry->matches(pkt));
 }
+
+// =============================================================================
+// Options::parse Tests
+// =============================================================================
+
+REGISTER_TEST(options_parse_defaults)
+{
+    char prog[] = "network-monitor";
+    char* argv[] = {prog};
+    std::string error;
+    auto opts = Options::parse(1, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->metrics_port, 0);
+    ATTEST_EQUAL(opts->metrics_bind, "127.0.0.1");
+}
+
+REGISTER_TEST(options_parse_metrics_port_forms)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "--metrics-port";
+    char a2[] = "9100";
+    char a3[] = "--metrics-bind=0.0.0.0";
+    char* argv[] = {prog, a1, a2, a3};
+    std::string error;
+    auto opts = Options::parse(4, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->metrics_port, 9100);
+    ATTEST_EQUAL(opts->metrics_bind, "0.0.0.0");
+}
+
+REGISTER_TEST(options_parse_rejects_bad_input)
+{
+    char prog[] = "network-monitor";
+    char bad_port[] = "--metrics-port=70000";
+    char unknown[] = "--bogus";
+    char missing[] = "--metrics-port";
+    std::string error;
+
+    char* argv1[] = {prog, bad_port};
+    ATTEST_FALSE(Options::parse(2, argv1, error).has_value());
+
+    char* argv2[] = {prog, unknown};
+    ATTEST_FALSE(Options::parse(2, argv2, error).has_value());
+
+    char* argv3[] = {prog, missing};
+    ATTEST_FALSE(Options::parse(2, argv3, error).has_value());
+    ATTEST_FALSE(error.empty());
+}
+
+REGISTER_TEST(options_parse_recording)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "--record=/tmp/cap";
+    char a2[] = "--record-rotate-mb=100";
+    char a3[] = "--record-max-files";
+    char a4[] = "5";
+    char* argv[] = {prog, a1, a2, a3, a4};
+    std::string error;
+    auto opts = Options::parse(5, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->record_prefix, "/tmp/cap");
+    ATTEST_EQUAL(opts->record_rotate_mb, 100u);
+    ATTEST_EQUAL(opts->record_max_files, 5u);
+    ATTEST_EQUAL(opts->record_rotate_secs, 0u);
+}
+
+REGISTER_TEST(options_parse_export)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "-i";
+    char a2[] = "eth0";
+    char a3[] = "--no-ui";
+    char a4[] = "--export";
+    char a5[] = "-";
+    char a6[] = "--export-format=csv";
+    char a7[] = "--export-records=flows";
+    char a8[] = "--export-policy=drop";
+    char* argv[] = {prog, a1, a2, a3, a4, a5, a6, a7, a8};
+    std::string error;
+    auto opts = Options::parse(9, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->interface_name, "eth0");
+    ATTEST_TRUE(opts->headless);
+    ATTEST_EQUAL(opts->export_path, "-");
+    ATTEST_TRUE(opts->export_format == ExportFormat::CSV);
+    ATTEST_TRUE(opts->export_records == ExportRecords::FLOWS);
+    ATTEST_TRUE(opts->export_policy == ExportPolicy::DROP);
+}
+
+REGISTER_TEST(options_parse_export_rejects_bad_combinations)
+{
+    char prog[] = "network-monitor";
+    char to_stdout[] = "--export=-";
+    char headless[] = "--no-ui";
+    char bad_format[] = "--export-format=xml";
+    std::string error;
+
+    // stdout would collide with the curses UI
+    char* argv1[] = {prog, to_stdout};
+    ATTEST_FALSE(Options::parse(2, argv1, error).has_value());
+
+    // Headless mode needs an interface
+    char* argv2[] = {prog, headless};
+    ATTEST_FALSE(Options::parse(2, argv2, error).has_value());
+
+    char* argv3[] = {prog, bad_format};
+    ATTEST_FALSE(Options::parse(2, argv3, error).has_value());
+
+    // Columnar files hold packets only
+    char columnar[] = "--export-format=columnar";
+    char flows[] = "--export-records=flows";
+    char* argv4[] = {prog, columnar, flows};
+    ATTEST_FALSE(Options::parse(3, argv4, error).has_value());
+}
+
+REGISTER_TEST(options_parse_replay)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "--no-ui";
+    char a2[] = "--replay=day.ncol";
+    char a3[] = "--export=out.ndjson";
+    char* argv[] = {prog, a1, a2, a3};
+    std::string error;
+    auto opts = Options::parse(4, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->replay_path, "day.ncol");
+
+    char a4[] = "-i";
+    char a5[] = "eth0";
+    char* argv2[] = {prog, a2, a4, a5};
+    ATTEST_FALSE(Options::parse(4, argv2, error).has_value());
+}
+
+REGISTER_TEST(options_parse_flow_export)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "--flow-export=[::1]:2055";
+    char a2[] = "--flow-protocol=v9";
+    char a3[] = "--flow-idle-timeout=5";
+    char* argv[] = {prog, a1, a2, a3};
+    std::string error;
+    auto opts = Options::parse(4, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->flow_collector_host, "::1");
+    ATTEST_EQUAL(opts->flow_collector_port, 2055);
+    ATTEST_TRUE(opts->flow_protocol == FlowExportProtocol::NETFLOW_V9);
+    ATTEST_EQUAL(opts->flow_idle_timeout, 5u);
+    ATTEST_EQUAL(opts->flow_active_timeout, 60u);
+
+    char bad[] = "--flow-export=collector";
+    char* argv2[] = {prog, bad};
+    ATTEST_FALSE(Options::parse(2, argv2, error).has_value());
+}
+
+REGISTER_TEST(options_parse_bench)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "--bench=gen";
+    char a2[] = "--bench-packets=5000";
+    char a3[] = "--bench-seed=7";
+    char a4[] = "--bench-process";
+    char* argv[] = {prog, a1, a2, a3, a4};
+    std::string error;
+    auto opts = Options::parse(5, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->bench_source, "gen");
+    ATTEST_EQUAL(opts->bench_packets, 5000u);
+    ATTEST_EQUAL(opts->bench_seed, 7u);
+    ATTEST_TRUE(opts->bench_process);
+    ATTEST_TRUE(opts->headless);
+
+    // The benchmark never captures live
+    char iface[] = "-i";
+    char eth[] = "eth0";
+    char* argv2[] = {prog, a1, iface, eth};
+    ATTEST_FALSE(Options::parse(4, argv2, error).has_value());
+}
+
+REGISTER_TEST(options_parse_dns)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "--dns-cache-size=0";
+    char a2[] = "--dns-pending=500";
+    char* argv[] = {prog, a1, a2};
+    std::string error;
+    auto opts = Options::parse(3, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->dns_cache_size, 0u);
+    ATTEST_EQUAL(opts->dns_pending, 500u);
+
+    char bad[] = "--dns-pending=2000000";
+    char* argv2[] = {prog, bad};
+    ATTEST_FALSE(Options::parse(2, argv2, error).has_value());
+}
+
+REGISTER_TEST(options_parse_detect_window)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "--detect-window";
+    char a2[] = "30";
+    char* argv[] = {prog, a1, a2};
+    std::string error;
+    auto opts = Options::parse(3, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->detect_window_secs, 30u);
+
+    char bad[] = "--detect-window=7200";
+    char* argv2[] = {prog, bad};
+    ATTEST_FALSE(Options::parse(2, argv2, error).has_value());
+}
+
+REGISTER_TEST(options_parse_anomaly_sigma)
+{
+    char prog[] = "network-monitor";
+    char a1[] = "--anomaly-sigma=0";
+    char* argv[] = {prog, a1};
+    std::string error;
+    auto opts = Options::parse(2, argv, error);
+    ATTEST_TRUE(opts.has_value());
+    ATTEST_EQUAL(opts->anomaly_sigma, 0u);
+
+    char bad[] = "--anomaly-sigma=500";
+    char* argv2[] = {prog, bad};
+    ATTEST_FALSE(Options::parse(2, argv2, error).has_value());
+}
+
+// =============================================================================
+// Metrics Tests
+// =============================================================================
+
+REGISTER_TEST(metrics_classify_protocol)
+{
+    PacketInfo pkt{};
+    pkt.ip_version = 4;
+    pkt.protocol = PROTO_TCP;
+    ATTEST_TRUE(classify_protocol(pkt) == ProtocolClass::TCP);
+
+    pkt.app_protocol = "TLS";
+    ATTEST_TRUE(classify_protocol(pkt) == ProtocolClass::TLS);
+
+    pkt.app_protocol = "QUIC";
+    ATTEST_TRUE(classify_protocol(pkt) == ProtocolClass::QUIC);
+
+    PacketInfo arp{};
+    arp.ether_type = ETHERTYPE_ARP;
+    ATTEST_TRUE(classify_protocol(arp) == ProtocolClass::ARP);
+}
+
+REGISTER_TEST(metrics_registry_snapshot)
+{
+    MetricsRegistry registry;
+    PacketInfo pkt{};
+    pkt.ip_version = 4;
+    pkt.protocol = PROTO_UDP;
+    pkt.original_length = 120;
+
+    registry.record_packet(pkt);
+    registry.record_packet(pkt);
+    registry.record_alert();
+    registry.add_capture_drops(3, 1);
+
+    MetricsSnapshot snap = registry.snapshot();
+    ATTEST_EQUAL(snap.packets, 2u);
+    ATTEST_EQUAL(snap.bytes, 240u);
+    ATTEST_EQUAL(snap.protocol_packets[static_cast<size_t>(ProtocolClass::UDP)], 2u);
+    ATTEST_EQUAL(snap.alerts, 1u);
+    ATTEST_EQUAL(snap.kernel_drops, 3u);
+    ATTEST_EQUAL(snap.interface_drops, 1u);
+}
+
+REGISTER_TEST(metrics_format_openmetrics)
+{
+    MetricsSnapshot snap;
+    snap.interface_name = "eth\"0";
+    snap.packets = 42;
+
+    std::string text = format_openmetrics(snap);
+    ATTEST_TRUE(text.find("# TYPE netmon_packets counter") != std::string::npos);
+    ATTEST_TRUE(text.find("netmon_packets_total{interface=\"eth\\\"0\"} 42\n")
+                != std::string::npos);
+    ATTEST_TRUE(text.size() >= 6);
+    ATTEST_EQUAL(text.substr(text.size() - 6), "# EOF\n");
+    ATTEST_TRUE(text.find("netmon_stage_latency_seconds_count{stage=\"parse\"} 0")
+                != std::string::npos);
+}
+
+// =============================================================================
+// LatencyHistogram Tests
+// =============================================================================
+
+REGISTER_TEST(histogram_bucket_bounds)
+{
+    // Exact buckets below 16ns
+    ATTEST_EQUAL(HistogramSnapshot::bucket_index(7), 7u);
+    ATTEST_EQUAL(HistogramSnapshot::bucket_upper_bound(7), 7u);
+
+    // Every value lies at or below its bucket's upper bound, within ~6%
+    for (uint64_t v : {16ull, 17ull, 100ull, 1000ull, 123456ull, 987654321ull}) {
+        size_t idx = HistogramSnapshot::bucket_index(v);
+        uint64_t upper = HistogramSnapshot::bucket_upper_bound(idx);
+        ATTEST_TRUE(upper >= v);
+        ATTEST_TRUE(upper <= v + v / 16 + 1);
+    }
+}
+
+REGISTER_TEST(histogram_percentiles)
+{
+    LatencyHistogram hist;
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        hist.record(i * 10);  // 10ns .. 10us
+    }
+
+    HistogramSnapshot snap = hist.snapshot();
+    ATTEST_EQUAL(snap.count, 1000u);
+    ATTEST_EQUAL(snap.max_ns, 10000u);
+
+    uint64_t p50 = snap.percentile(0.5);
+    uint64_t p99 = snap.percentile(0.99);
+    ATTEST_TRUE(p50 >= 5000 && p50 <= 5400);
+    ATTEST_TRUE(p99 >= 9900 && p99 <= 10000);
+    ATTEST_EQUAL(snap.percentile(1.0), 10000u);
+}
+
+REGISTER_TEST(histogram_empty)
+{
+    LatencyHistogram hist;
+    HistogramSnapshot snap = hist.snapshot();
+    ATTEST_EQUAL(snap.percentile(0.99), 0u);
+    ATTEST_TRUE(snap.mean_ns() == 0.0);
+}
+
+// =============================================================================
+// pcapng Encoding Tests
+// =============================================================================
+
+static uint32_t read_u32(const std::vector<uint8_t>& buf, size_t offset)
+{
+    uint32_t value;
+    memcpy(&value, buf.data() + offset, sizeof(value));
+    return value;
+}
+
+REGISTER_TEST(pcapng_section_header_layout)
+{
+    std::vector<uint8_t> buf;
+    pcapng_append_section_header(buf, "network-monitor");
+
+    ATTEST_EQUAL(read_u32(buf, 0), PCAPNG_SECTION_HEADER);
+    ATTEST_EQUAL(read_u32(buf, 8), PCAPNG_BYTE_ORDER_MAGIC);
+    ATTEST_EQUAL(buf.size() % 4, 0u);
+    // Leading and trailing block lengths match the block size
+    ATTEST_EQUAL(read_u32(buf, 4), buf.size());
+    ATTEST_EQUAL(read_u32(buf, buf.size() - 4), buf.size());
+}
+
+REGISTER_TEST(pcapng_packet_block_padding)
+{
+    std::vector<uint8_t> buf;
+    uint8_t frame[5] = {1, 2, 3, 4, 5};
+    size_t len = pcapng_append_packet(buf, 0, 0x0000000100000002ULL, frame, 5, 60);
+
+    // 28 bytes of header fields + 8 padded data bytes + trailing length
+    ATTEST_EQUAL(len, 40u);
+    ATTEST_EQUAL(read_u32(buf, 0), PCAPNG_ENHANCED_PACKET);
+    ATTEST_EQUAL(read_u32(buf, 12), 1u);   // Timestamp high
+    ATTEST_EQUAL(read_u32(buf, 16), 2u);   // Timestamp low
+    ATTEST_EQUAL(read_u32(buf, 20), 5u);   // Captured length
+    ATTEST_EQUAL(read_u32(buf, 24), 60u);  // Original length
+    ATTEST_EQUAL(buf[28 + 5], 0);          // Padding is zeroed
+}
+
+REGISTER_TEST(pcapng_packet_block_comment)
+{
+    std::vector<uint8_t> buf;
+    uint8_t frame[4] = {0};
+    size_t len = pcapng_append_packet(buf, 0, 0, frame, 4, 4, "ALERT: x");
+
+    // Comment option (4 + 8) and end-of-options (4) follow the data
+    ATTEST_EQUAL(len, 32u + 4u + 12u + 4u);
+    ATTEST_EQUAL(read_u32(buf, 4), len);
+    ATTEST_EQUAL(read_u32(buf, len - 4), len);
+}
+
+REGISTER_TEST(pcap_classic_record_layout)
+{
+    std::vector<uint8_t> buf;
+    pcap_append_file_header(buf, 1, 65535);
+    ATTEST_EQUAL(buf.size(), 24u);
+    ATTEST_EQUAL(read_u32(buf, 0), PCAP_MAGIC_MICROS);
+    ATTEST_EQUAL(read_u32(buf, 20), 1u);  // Link type
+
+    uint8_t frame[3] = {7, 8, 9};
+    size_t len = pcap_append_record(buf, 5000001ULL, frame, 3, 64);
+    ATTEST_EQUAL(len, 19u);
+    ATTEST_EQUAL(read_u32(buf, 24), 5u);  // Seconds
+    ATTEST_EQUAL(read_u32(buf, 28), 1u);  // Microseconds
+    ATTEST_EQUAL(read_u32(buf, 36), 64u); // Original length
+}
+
+REGISTER_TEST(trigger_capture_filename_sanitised)
+{
+    auto when = std::chrono::system_clock::now();
+    std::string name = TriggerCapture::make_filename("Bad host: evil/x", when);
+    ATTEST_TRUE(name.rfind("alert_", 0) == 0);
+    ATTEST_TRUE(name.find("_Bad_host__evil_x.pcap") != std::string::npos);
+    ATTEST_TRUE(name.find('/') == std::string::npos);
+}
+
+static PacketInfo make_trigger_packet(int64_t ms)
+{
+    PacketInfo pkt{};
+    pkt.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+    pkt.raw_data.assign(100, 0xab);
+    pkt.original_length = 100;
+    return pkt;
+}
+
+// Sizes of the pcap files written to dir
+static std::vector<off_t> trigger_file_sizes(const std::string& dir)
+{
+    std::vector<off_t> sizes;
+    DIR* d = opendir(dir.c_str());
+    while (dirent* entry = d ? readdir(d) : nullptr) {
+        std::string path = dir + "/" + entry->d_name;
+        struct stat st;
+        if (entry->d_name[0] != '.' && stat(path.c_str(), &st) == 0) {
+            sizes.push_back(st.st_size);
+            unlink(path.c_str());
+        }
+    }
+    if (d) closedir(d);
+    return sizes;
+}
+
+REGISTER_TEST(trigger_capture_caps_windows_in_packet_time)
+{
+    char dir[] = "/tmp/netmon-trigger-XXXXXX";
+    ATTEST_TRUE(mkdtemp(dir) != nullptr);
+    const size_t record = 16 + 100;
+
+    TriggerConfig config;
+    config.output_dir = dir;
+    config.window_limit_bytes = 24 + 5 * record;
+    TriggerCapture trigger;
+    ATTEST_TRUE(trigger.start(config, 1, 65535));
+    for (int64_t i = 0; i < 3; ++i) {
+        trigger.on_packet(make_trigger_packet(1000000 + i));
+    }
+    trigger.on_alert("burst", make_trigger_packet(1000002).timestamp);
+
+    // Packet time, not the wall clock, decides when the window ends
+    trigger.tick();
+    for (int64_t i = 3; i < 10; ++i) {
+        trigger.on_packet(make_trigger_packet(1000000 + i));
+    }
+    trigger.stop();
+    ATTEST_EQUAL(trigger.windows_truncated(), 1u);
+    ATTEST_EQUAL(trigger.files_written(), 1u);
+    std::vector<off_t> sizes = trigger_file_sizes(dir);
+    ATTEST_EQUAL(sizes.size(), 1u);
+    ATTEST_EQUAL(static_cast<size_t>(sizes[0]), 24 + 5 * record);
+
+    // A window over the disk budget is skipped without writing anything
+    config.disk_budget_bytes = 100;
+    TriggerCapture small;
+    ATTEST_TRUE(small.start(config, 1, 65535));
+    small.on_packet(make_trigger_packet(2000000));
+    small.on_alert("burst", make_trigger_packet(2000000).timestamp);
+    small.stop();
+    ATTEST_EQUAL(small.files_written(), 0u);
+    ATTEST_EQUAL(small.windows_skipped(), 1u);
+    ATTEST_TRUE(trigger_file_sizes(dir).empty());
+
+    // An alert while held windows fill the memory limit is skipped
+    config.disk_budget_bytes = 1000000;
+    config.open_limit_bytes = 24 + record;
+    TriggerCapture full;
+    ATTEST_TRUE(full.start(config, 1, 65535));
+    full.on_packet(make_trigger_packet(3000000));
+    full.on_alert("first", make_trigger_packet(3000000).timestamp);
+    full.on_alert("second", make_trigger_packet(3000001).timestamp);
+    full.stop();
+    ATTEST_EQUAL(full.windows_skipped(), 1u);
+    ATTEST_EQUAL(full.files_written(), 1u);
+    sizes = trigger_file_sizes(dir);
+    ATTEST_EQUAL(sizes.size(), 1u);
+    ATTEST_EQUAL(static_cast<size_t>(sizes[0]), 24 + record);
+    rmdir(dir);
+}
+
+REGISTER_TEST(record_exporter_appends_on_restart)
+{
+    char path[] = "/tmp/netmon-export-XXXXXX";
+    int fd = mkstemp(path);
+    ATTEST_TRUE(fd >= 0);
+    close(fd);
+
+    ExportConfig config;
+    config.path = path;
+    config.format = ExportFormat::CSV;
+    RecordExporter exporter;
+    for (int run = 0; run < 2; ++run) {
+        config.append = run > 0;
+        ATTEST_TRUE(exporter.start(config));
+        exporter.on_packet(make_trigger_packet(1000000 + run));
+        exporter.stop();
+        ATTEST_TRUE(exporter.get_error().empty());
+    }
+
+    // One header, then both captures' rows
+    std::string text;
+    if (FILE* file = fopen(path, "r")) {
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            text.append(buffer, n);
+        }
+        fclose(file);
+    }
+    unlink(path);
+    ATTEST_EQUAL(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')), 3u);
+    ATTEST_EQUAL(text.rfind(packet_csv_header(), 0), 0u);
+    ATTEST_EQUAL(text.find(packet_csv_header(), 1), std::string::npos);
+}
+
+// =============================================================================
+// Flow Table Tests
+// =============================================================================
+
+static PacketInfo make_flow_packet(uint16_t sport, uint8_t flags, int64_t usec) {
+    PacketInfo pkt{};
+    pkt.timestamp = std::chrono::system_clock::time_point(std::chrono::microseconds(usec));
+    pkt.original_length = 100;
+    pkt.ip_version = 4;
+    pkt.protocol = PROTO_TCP;
+    pkt.src_ip = "10.0.0.1";
+    pkt.dst_ip = "10.0.0.2";
+    pkt.src_addr[0] = 10; pkt.src_addr[3] = 1;
+    pkt.dst_addr[0] = 10; pkt.dst_addr[3] = 2;
+    pkt.src_port = sport;
+    pkt.dst_port = 443;
+    pkt.tcp_flags = flags;
+    return pkt;
+}
+
+REGISTER_TEST(flow_table_aggregates_packets)
+{
+    FlowTable table;
+    ATTEST_TRUE(table.update(make_flow_packet(5000, TCP_SYN, 1000000)));
+    ATTEST_TRUE(table.update(make_flow_packet(5000, TCP_ACK, 2000000)));
+    ATTEST_TRUE(table.update(make_flow_packet(5001, TCP_SYN, 2000000)));
+    ATTEST_EQUAL(table.size(), 2u);
+
+    const FlowRecord* flow = table.find(FlowKey::from_packet(make_flow_packet(5000, 0, 0)));
+    ATTEST_TRUE(flow != nullptr);
+    ATTEST_EQUAL(flow->packets, 2u);
+    ATTEST_EQUAL(flow->bytes, 200u);
+    ATTEST_EQUAL(flow->tcp_flags, TCP_SYN | TCP_ACK);
+
+    // Non-IP traffic is not a flow
+    PacketInfo arp{};
+    ATTEST_FALSE(table.update(arp));
+}
+
+REGISTER_TEST(flow_table_expiry)
+{
+    FlowTable table;
+    table.update(make_flow_packet(1, TCP_ACK, 0));            // Idle
+    table.update(make_flow_packet(2, TCP_ACK, 0));            // Long-lived
+    table.update(make_flow_packet(2, TCP_ACK, 95000000));
+    table.update(make_flow_packet(3, TCP_FIN, 99000000));     // Finished
+    table.update(make_flow_packet(4, TCP_ACK, 99000000));     // Active
+
+    std::vector<std::pair<uint16_t, FlowEndReason>> expired;
+    auto now = std::chrono::system_clock::time_point(std::chrono::seconds(100));
+    table.expire(now, std::chrono::seconds(15), std::chrono::seconds(60),
+                 [&](const FlowRecord& flow, FlowEndReason reason) {
+                     expired.emplace_back(flow.key.src_port, reason);
+                 });
+
+    ATTEST_EQUAL(expired.size(), 3u);
+    ATTEST_EQUAL(table.size(), 1u);
+    for (const auto& [port, reason] : expired) {
+        if (port == 1) ATTEST_TRUE(reason == FlowEndReason::IDLE_TIMEOUT);
+        if (port == 2) ATTEST_TRUE(reason == FlowEndReason::ACTIVE_TIMEOUT);
+        if (port == 3) ATTEST_TRUE(reason == FlowEndReason::END_OF_FLOW);
+        ATTEST_TRUE(port != 4);
+    }
+}
+
+REGISTER_TEST(flow_table_expiry_in_time_order)
+{
+    // Expiry stops at the first flow that is still current
+    FlowTable table(200000);
+    for (uint32_t i = 0; i < 100000; ++i) {
+        PacketInfo pkt = make_flow_packet(static_cast<uint16_t>(i), TCP_ACK, i * 1000);
+        pkt.dst_port = static_cast<uint16_t>(i >> 16);
+        table.update(pkt);
+    }
+    PacketInfo late = make_flow_packet(0, TCP_ACK, 100000000);   // The first flow, again
+    late.dst_port = 0;
+    table.update(late);
+    size_t calls = 0;
+    auto count = [&](const FlowRecord&, FlowEndReason) { calls++; };
+    auto at = [](int64_t ms) {
+        return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+    };
+
+    ATTEST_EQUAL(table.expire(at(15000), std::chrono::seconds(15), std::chrono::seconds(600),
+                              count), 0u);
+    ATTEST_EQUAL(table.expire(at(65000), std::chrono::seconds(15), std::chrono::seconds(600),
+                              count), 50000u);
+    ATTEST_EQUAL(table.size(), 50000u);
+    ATTEST_TRUE(table.find(FlowKey::from_packet(late)) != nullptr);
+
+    // Active timeout goes by creation, however recent the last packet
+    ATTEST_EQUAL(table.expire(at(100000), std::chrono::seconds(600), std::chrono::seconds(60),
+                              count), 1u);
+    ATTEST_TRUE(table.find(FlowKey::from_packet(late)) == nullptr);
+    ATTEST_EQUAL(table.size(), 49999u);
+    ATTEST_EQUAL(calls, 50001u);
+}
+
+REGISTER_TEST(flow_table_bounded)
+{
+    FlowTable table(2);
+    ATTEST_TRUE(table.update(make_flow_packet(1, 0, 0)));
+    ATTEST_TRUE(table.update(make_flow_packet(2, 0, 0)));
+    ATTEST_FALSE(table.update(make_flow_packet(3, 0, 0)));
+    ATTEST_TRUE(table.update(make_flow_packet(1, 0, 0)));  // Existing flows still update
+    ATTEST_EQUAL(table.overflow_count(), 1u);
+}
+
+// =============================================================================
+// Record Format Tests
+// =============================================================================
+
+REGISTER_TEST(format_buffer_numbers_and_timestamps)
+{
+    char storage[64];
+    FormatBuffer out(storage, sizeof(storage));
+    out.put_uint(0);
+    out.put(' ');
+    out.put_uint(18446744073709551615ULL);
+    out.put(' ');
+    out.put_int(-42);
+    out.put(' ');
+    out.put_timestamp(std::chrono::system_clock::time_point(std::chrono::microseconds(1700000000000042LL)));
+    ATTEST_EQUAL(std::string(out.view()), "0 18446744073709551615 -42 1700000000.000042");
+}
+
+REGISTER_TEST(format_buffer_escaping)
+{
+    char storage[64];
+    FormatBuffer json(storage, sizeof(storage));
+    json.put_json_string("a\"b\\c\n\x01");
+    ATTEST_EQUAL(std::string(json.view()), "\"a\\\"b\\\\c\\n\\u0001\"");
+
+    char csv_storage[64];
+    FormatBuffer csv(csv_storage, sizeof(csv_storage));
+    csv.put_csv_field("plain");
+    csv.put(',');
+    csv.put_csv_field("a,\"b\"");
+    ATTEST_EQUAL(std::string(csv.view()), "plain,\"a,\"\"b\"\"\"");
+}
+
+REGISTER_TEST(format_packet_records)
+{
+    PacketInfo pkt = make_flow_packet(5000, TCP_SYN, 1500000);
+    pkt.hostname = "example.com";
+
+    char storage[512];
+    FormatBuffer out(storage, sizeof(storage));
+    ATTEST_TRUE(format_packet_ndjson(out, pkt));
+    std::string line(out.view());
+    ATTEST_TRUE(line.rfind("{\"ts\":1.500000,\"len\":100,", 0) == 0);
+    ATTEST_TRUE(line.find("\"proto\":\"TCP\"") != std::string::npos);
+    ATTEST_TRUE(line.find("\"hostname\":\"example.com\"") != std::string::npos);
+    ATTEST_EQUAL(line.back(), '\n');
+
+    FormatBuffer csv(storage, sizeof(storage));
+    ATTEST_TRUE(format_packet_csv(csv, pkt));
+    ATTEST_EQUAL(std::string(csv.view()),
+                 "1.500000,100,4,TCP,6,10.0.0.1,10.0.0.2,5000,443,2,0,example.com,,,,,\n");
+
+    // The CSV header has one column per field
+    std::string header = packet_csv_header();
+    std::string row(csv.view());
+    ATTEST_EQUAL(std::count(header.begin(), header.end(), ','),
+                 std::count(row.begin(), row.end(), ','));
+}
+
+REGISTER_TEST(format_record_overflow_rolls_back)
+{
+    PacketInfo pkt = make_flow_packet(5000, TCP_SYN, 0);
+    char storage[40];
+    FormatBuffer out(storage, sizeof(storage));
+    out.put("keep");
+    ATTEST_FALSE(format_packet_ndjson(out, pkt));
+    ATTEST_FALSE(out.overflowed());
+    ATTEST_EQUAL(std::string(out.view()), "keep");
+}
+
+REGISTER_TEST(format_flow_records)
+{
+    FlowTable table;
+    table.update(make_flow_packet(5000, TCP_SYN, 1000000));
+    table.update(make_flow_packet(5000, TCP_FIN, 3000000));
+
+    std::string ndjson;
+    std::string csv;
+    table.drain([&](const FlowRecord& flow, FlowEndReason reason) {
+        char storage[512];
+        FormatBuffer out(storage, sizeof(storage));
+        ATTEST_TRUE(format_flow_ndjson(out, flow, reason));
+        ndjson = std::string(out.view());
+        FormatBuffer out_csv(storage, sizeof(storage));
+        ATTEST_TRUE(format_flow_csv(out_csv, flow, reason));
+        csv = std::string(out_csv.view());
+    });
+
+    ATTEST_TRUE(ndjson.find("\"packets\":2,\"bytes\":200,\"tcp_flags\":3") != std::string::npos);
+    ATTEST_TRUE(ndjson.find("\"end\":\"forced\"") != std::string::npos);
+    ATTEST_EQUAL(csv, "1.000000,3.000000,4,6,10.0.0.1,10.0.0.2,5000,443,2,200,3,,,,,forced\n");
+}
+
+// =============================================================================
+// Columnar Format Tests
+// =============================================================================
+
+static std::vector<uint8_t> build_columnar_file(const std::vector<RowGroupBuilder>& groups,
+                                                StringDictionary& dict) {
+    std::vector<uint8_t> file;
+    columnar_encode_header(2, file);
+    std::vector<uint64_t> offsets;
+    uint64_t rows = 0;
+    for (const auto& group : groups) {
+        offsets.push_back(file.size());
+        columnar_encode_row_group(group, file);
+        rows += group.rows();
+    }
+    uint64_t footer = file.size();
+    columnar_encode_footer(dict, offsets, footer, rows, file);
+    return file;
+}
+
+static void add_columnar_row(RowGroupBuilder& g, StringDictionary& dict, int64_t ts,
+                             uint16_t sport, const std::string& host) {
+    g.timestamp_us.push_back(ts);
+    g.src_addr.push_back({10, 0, 0, 1});
+    g.dst_addr.push_back({10, 0, 0, 2});
+    g.src_port.push_back(sport);
+    g.dst_port.push_back(443);
+    g.ip_version.push_back(4);
+    g.ip_protocol.push_back(PROTO_TCP);
+    g.tcp_flags.push_back(TCP_SYN);
+    g.ttl.push_back(64);
+    g.length.push_back(60);
+    g.ether_type.push_back(ETHERTYPE_IPV4);
+    g.hostname.push_back(dict.intern(host));
+    g.app_protocol.push_back(dict.intern(host.empty() ? "" : "TLS"));
+}
+
+REGISTER_TEST(columnar_dictionary_interning)
+{
+    StringDictionary dict;
+    ATTEST_EQUAL(dict.intern(""), 0u);
+    uint32_t a = dict.intern("example.com");
+    ATTEST_EQUAL(a, 1u);
+    ATTEST_EQUAL(dict.intern("other.org"), 2u);
+    ATTEST_EQUAL(dict.intern("example.com"), a);
+    ATTEST_EQUAL(dict.size(), 3u);
+}
+
+REGISTER_TEST(columnar_round_trip)
+{
+    StringDictionary dict;
+    std::vector<RowGroupBuilder> groups(2);
+    add_columnar_row(groups[0], dict, 3000000, 5001, "example.com");
+    add_columnar_row(groups[0], dict, 1000000, 5000, "");
+    add_columnar_row(groups[1], dict, 7000000, 6000, "example.com");
+
+    std::vector<uint8_t> file = build_columnar_file(groups, dict);
+    ATTEST_EQUAL(file.size() % 8, 0u);
+
+    ColumnarReader reader;
+    ATTEST_TRUE(reader.open_memory(file.data(), file.size()));
+    ATTEST_EQUAL(reader.total_rows(), 3u);
+    ATTEST_EQUAL(reader.row_group_count(), 2u);
+
+    const RowGroupView& first = reader.row_group(0);
+    ATTEST_EQUAL(first.rows(), 2u);
+    ATTEST_EQUAL(first.src_port()[1], 5000);
+    ATTEST_EQUAL(reader.dictionary(first.hostname()[0]), "example.com");
+
+    // Per-chunk statistics
+    ColumnStats ts = first.stats(Column::TIMESTAMP_US);
+    ATTEST_TRUE(ts.valid);
+    ATTEST_EQUAL(ts.min, 1000000u);
+    ATTEST_EQUAL(ts.max, 3000000u);
+    ATTEST_FALSE(first.stats(Column::SRC_ADDR).valid);
+
+    PacketInfo pkt = reader.to_packet(reader.row_group(1), 0);
+    ATTEST_EQUAL(pkt.src_ip, "10.0.0.1");
+    ATTEST_EQUAL(pkt.dst_port, 443);
+    ATTEST_EQUAL(pkt.hostname, "example.com");
+    ATTEST_EQUAL(pkt.app_protocol, "TLS");
+    ATTEST_EQUAL(pkt.original_length, 60u);
+}
+
+REGISTER_TEST(columnar_rejects_corrupt_files)
+{
+    StringDictionary dict;
+    std::vector<RowGroupBuilder> groups(1);
+    add_columnar_row(groups[0], dict, 1, 1, "a");
+    std::vector<uint8_t> file = build_columnar_file(groups, dict);
+
+    ColumnarReader reader;
+
+    // Truncated: the trailer is missing
+    ATTEST_FALSE(reader.open_memory(file.data(), file.size() - 8));
+    ATTEST_FALSE(reader.get_error().empty());
+
+    // Row count in a group no longer matches its column sizes
+    std::vector<uint8_t> bad = file;
+    bad[32 + 4] = 9;
+    ATTEST_FALSE(reader.open_memory(bad.data(), bad.size()));
+
+    ATTEST_TRUE(reader.open_memory(file.data(), file.size()));
+}
+
+// =============================================================================
+// Flow Export Tests
+// =============================================================================
+
+static uint16_t read_be16(const std::vector<uint8_t>& b, size_t pos)
+{
+    return static_cast<uint16_t>((b[pos] << 8) | b[pos + 1]);
+}
+
+static uint32_t read_be32(const std::vector<uint8_t>& b, size_t pos)
+{
+    return (static_cast<uint32_t>(read_be16(b, pos)) << 16) | read_be16(b, pos + 2);
+}
+
+static FlowRecord make_export_flow(uint8_t last_octet)
+{
+    FlowRecord flow;
+    flow.key.ip_version = 4;
+    flow.key.protocol = 6;
+    flow.key.src_port = 40000;
+    flow.key.dst_port = 443;
+    flow.key.src_addr = {10, 0, 0, last_octet};
+    flow.key.dst_addr = {93, 184, 216, 34};
+    flow.first_seen = std::chrono::system_clock::time_point(std::chrono::seconds(1000));
+    flow.last_seen = flow.first_seen + std::chrono::milliseconds(250);
+    flow.packets = 3;
+    flow.bytes = 180;
+    flow.tcp_flags = 0x12;
+    return flow;
+}
+
+REGISTER_TEST(flow_export_ipfix_message)
+{
+    FlowMessageEncoder encoder(FlowExportProtocol::IPFIX, 7, 1400);
+    encoder.begin(1700000000, 0, true);
+    ATTEST_TRUE(encoder.add(make_export_flow(1), FlowEndReason::IDLE_TIMEOUT, 0));
+    ATTEST_TRUE(encoder.add(make_export_flow(2), FlowEndReason::END_OF_FLOW, 0));
+    std::vector<uint8_t> msg = encoder.finish();
+
+    // Header: version, length, export time, sequence, domain
+    ATTEST_EQUAL(read_be16(msg, 0), 10);
+    ATTEST_EQUAL(read_be16(msg, 2), msg.size());
+    ATTEST_EQUAL(read_be32(msg, 4), 1700000000u);
+    ATTEST_EQUAL(read_be32(msg, 8), 0u);
+    ATTEST_EQUAL(read_be32(msg, 12), 7u);
+
+    // Template set, then one data set with both IPv4 records (48 bytes each)
+    ATTEST_EQUAL(read_be16(msg, 16), 2);
+    size_t data = 16 + read_be16(msg, 18);
+    ATTEST_EQUAL(read_be16(msg, data), FLOW_TEMPLATE_IPV4);
+    ATTEST_EQUAL(read_be16(msg, data + 2), 4 + 2 * 48);
+    ATTEST_EQUAL(data + 4 + 2 * 48, msg.size());
+    ATTEST_EQUAL(msg[data + 4 + 3], 1);
+    ATTEST_EQUAL(msg[data + 4 + 15], 1);        // flowEndReason idle
+    ATTEST_EQUAL(msg[data + 4 + 48 + 15], 3);   // end of flow
+
+    // Sequence counts data records
+    encoder.begin(1700000001, 0, false);
+    ATTEST_TRUE(encoder.add(make_export_flow(3), FlowEndReason::FORCED, 0));
+    msg = encoder.finish();
+    ATTEST_EQUAL(read_be32(msg, 8), 2u);
+    ATTEST_EQUAL(read_be16(msg, 16), FLOW_TEMPLATE_IPV4);
+}
+
+REGISTER_TEST(flow_export_netflow_v9_message)
+{
+    FlowMessageEncoder encoder(FlowExportProtocol::NETFLOW_V9, 1, 1400);
+    encoder.begin(1700000000, 5000, true);
+    uint64_t boot_ms = 999000;
+    ATTEST_TRUE(encoder.add(make_export_flow(1), FlowEndReason::IDLE_TIMEOUT, boot_ms));
+    std::vector<uint8_t> msg = encoder.finish();
+
+    // Count covers both templates and the data record
+    ATTEST_EQUAL(read_be16(msg, 0), 9);
+    ATTEST_EQUAL(read_be16(msg, 2), 3);
+    ATTEST_EQUAL(read_be32(msg, 4), 5000u);
+    ATTEST_EQUAL(read_be32(msg, 12), 0u);
+    ATTEST_EQUAL(read_be16(msg, 20), 0);
+
+    // 38-byte record padded to a 4-byte FlowSet
+    size_t data = 20 + read_be16(msg, 22);
+    ATTEST_EQUAL(read_be16(msg, data), FLOW_TEMPLATE_IPV4);
+    ATTEST_EQUAL(read_be16(msg, data + 2), 44);
+    ATTEST_EQUAL(data + 44, msg.size());
+    ATTEST_EQUAL(read_be32(msg, data + 4 + 30), 1000u);  // FIRST_SWITCHED
+    ATTEST_EQUAL(read_be32(msg, data + 4 + 34), 1250u);  // LAST_SWITCHED
+
+    // Sequence counts export packets
+    encoder.begin(1700000001, 6000, false);
+    ATTEST_TRUE(encoder.add(make_export_flow(2), FlowEndReason::IDLE_TIMEOUT, boot_ms));
+    ATTEST_TRUE(encoder.add(make_export_flow(3), FlowEndReason::IDLE_TIMEOUT, boot_ms));
+    msg = encoder.finish();
+    ATTEST_EQUAL(read_be32(msg, 12), 1u);
+    ATTEST_EQUAL(read_be16(msg, 2), 2);
+}
+
+REGISTER_TEST(flow_export_message_size_limit)
+{
+    FlowMessageEncoder encoder(FlowExportProtocol::IPFIX, 1, 128);
+    encoder.begin(0, 0, false);
+    ATTEST_TRUE(encoder.add(make_export_flow(1), FlowEndReason::IDLE_TIMEOUT, 0));
+    ATTEST_TRUE(encoder.add(make_export_flow(2), FlowEndReason::IDLE_TIMEOUT, 0));
+    ATTEST_FALSE(encoder.add(make_export_flow(3), FlowEndReason::IDLE_TIMEOUT, 0));
+    ATTEST_EQUAL(encoder.record_count(), 2u);
+    ATTEST_TRUE(encoder.finish().size() <= 128u);
+}
+
+REGISTER_TEST(flow_export_parse_collector)
+{
+    std::string host;
+    uint16_t port = 0;
+    ATTEST_TRUE(FlowExporter::parse_collector("127.0.0.1:4739", host, port));
+    ATTEST_EQUAL(host, "127.0.0.1");
+    ATTEST_EQUAL(port, 4739);
+    ATTEST_TRUE(FlowExporter::parse_collector("[fe80::1]:2055", host, port));
+    ATTEST_EQUAL(host, "fe80::1");
+    ATTEST_EQUAL(port, 2055);
+
+    ATTEST_FALSE(FlowExporter::parse_collector("localhost", host, port));
+    ATTEST_FALSE(FlowExporter::parse_collector("::1:4739", host, port));
+    ATTEST_FALSE(FlowExporter::parse_collector("host:0", host, port));
+    ATTEST_FALSE(FlowExporter::parse_collector("host:65536", host, port));
+    ATTEST_FALSE(FlowExporter::parse_collector(":4739", host, port));
+}
+
+// =============================================================================
+// Traffic Generator Tests
+// =============================================================================
+
+REGISTER_TEST(traffic_gen_deterministic)
+{
+    TrafficProfile profile;
+    profile.seed = 42;
+    profile.flows = 50;
+    TrafficGenerator a(profile);
+    TrafficGenerator b(profile);
+
+    std::vector<uint8_t> first;
+    for (int i = 0; i < 1000; ++i) {
+        GeneratedFrame fa = a.next();
+        GeneratedFrame fb = b.next();
+        ATTEST_EQUAL(fa.length, fb.length);
+        ATTEST_EQUAL(fa.timestamp_us, fb.timestamp_us);
+        ATTEST_TRUE(std::memcmp(fa.data, fb.data, fa.length) == 0);
+        if (i == 0) first.assign(fa.data, fa.data + fa.length);
+    }
+    ATTEST_EQUAL(a.generated(), 1000u);
+
+    // reset() replays the sequence; 100k pps spaces timestamps 10 us apart
+    a.reset();
+    GeneratedFrame f0 = a.next();
+    ATTEST_TRUE(std::vector<uint8_t>(f0.data, f0.data + f0.length) == first);
+    GeneratedFrame f1 = a.next();
+    ATTEST_EQUAL(f1.timestamp_us - f0.timestamp_us, 10u);
+}
+
+REGISTER_TEST(traffic_gen_frames_parse)
+{
+    TrafficProfile profile;
+    profile.flows = 200;
+    profile.ipv6_fraction = 0.5;
+    TrafficGenerator generator(profile);
+
+    int with_hostname = 0;
+    for (int i = 0; i < 20000; ++i) {
+        GeneratedFrame frame = generator.next();
+        PacketInfo info = parse_packet(frame.data, frame.length, frame.length);
+        ATTEST_TRUE(info.ip_version == 4 || info.ip_version == 6);
+        ATTEST_EQUAL(info.hostname, std::string(frame.hostname));
+        if (!frame.hostname.empty()) with_hostname++;
+    }
+    ATTEST_TRUE(with_hostname > 0);
+}
+
+REGISTER_TEST(traffic_gen_mix_and_sizes)
+{
+    TrafficProfile profile;
+    ATTEST_TRUE(TrafficGenerator::parse_mix("tls=1", profile));
+    ATTEST_EQUAL(profile.weights[static_cast<size_t>(TrafficKind::TLS)], 1u);
+    ATTEST_EQUAL(profile.weights[static_cast<size_t>(TrafficKind::DNS)], 0u);
+    ATTEST_FALSE(TrafficGenerator::parse_mix("tls=0", profile));
+    ATTEST_FALSE(TrafficGenerator::parse_mix("quic=1", profile));
+    ATTEST_FALSE(TrafficGenerator::parse_mix("dns=1,", profile));
+
+    // Fixed-size UDP: every frame is exactly min_frame bytes
+    ATTEST_TRUE(TrafficGenerator::parse_mix("udp=1", profile));
+    profile.sizes = SizeDistribution::FIXED;
+    profile.min_frame = 128;
+    profile.ipv6_fraction = 0;
+    TrafficGenerator generator(profile);
+    for (int i = 0; i < 100; ++i) {
+        GeneratedFrame frame = generator.next();
+        ATTEST_EQUAL(frame.length, 128u);
+        ATTEST_TRUE(frame.kind == TrafficKind::UDP);
+    }
+}
+
+// =============================================================================
+// Pipeline Benchmark Tests
+// =============================================================================
+
+// Volatile so the optimizer cannot elide the allocations it receives
+static void* volatile allocation_sink;
+
+REGISTER_TEST(bench_counts_allocations)
+{
+    uint64_t before = thread_allocation_count();
+    allocation_sink = new int(42);
+    delete static_cast<int*>(allocation_sink);
+    std::vector<int> values(16);
+    allocation_sink = values.data();
+    ATTEST_TRUE(thread_allocation_count() - before >= 2);
+}
+
+REGISTER_TEST(bench_runs_pipeline)
+{
+    BenchConfig config;
+    config.packets = 3000;
+    config.flows = 50;
+    FrameBuffer frames;
+    bench_generate_frames(config, frames);
+    ATTEST_EQUAL(frames.size(), 3000u);
+
+    // Replaying a shorter buffer wraps with later timestamps
+    FrameBuffer half;
+    for (size_t i = 0; i < 1500; ++i) {
+        const auto& f = frames.frame(i);
+        half.add(f.timestamp_us, frames.data(f), f.caplen, f.len);
+    }
+
+    PacketStore store;
+    MetricsRegistry metrics;
+    PacketPipeline pipeline(store);
+    pipeline.set_metrics(&metrics);
+    BenchResult result = run_benchmark(config, half, pipeline, metrics.profiler());
+
+    ATTEST_EQUAL(result.packets, 3000u);
+    ATTEST_EQUAL(result.frames_loaded, 1500u);
+    ATTEST_EQUAL(metrics.snapshot().packets, 3000u);
+    ATTEST_TRUE(result.packets_per_second() > 0);
+    ATTEST_EQUAL(result.stages.size(), 2u);  // Parse and store only
+    ATTEST_TRUE(result.stages[0].stage == Stage::PARSE);
+    ATTEST_EQUAL(result.stages[0].calls, 3000u);
+
+    std::string json = format_bench_json(result);
+    ATTEST_TRUE(json.find("\"format_version\": 1") != std::string::npos);
+    ATTEST_TRUE(json.find("\"packets\": 3000") != std::string::npos);
+    ATTEST_TRUE(json.find("\"parse\": {\"calls\": 3000") != std::string::npos);
+}
+
+// =============================================================================
+// TCP Reassembly Tests
+// =============================================================================
+
+// Ethernet/IPv4/TCP frame 10.0.0.1:sport -> 10.0.0.2:dport, parsed
+static PacketInfo make_tcp_segment(uint16_t sport, uint16_t dport, uint32_t seq, uint8_t flags,
+                                   const std::string& payload, int64_t usec = 0)
+{
+    std::vector<uint8_t> f(54, 0);
+    f[12] = 0x08;
+    uint16_t total = static_cast<uint16_t>(40 + payload.size());
+    f[14] = 0x45; f[16] = total >> 8; f[17] = total & 0xFF; f[22] = 64; f[23] = PROTO_TCP;
+    f[26] = 10; f[29] = 1; f[30] = 10; f[33] = 2;
+    f[34] = sport >> 8; f[35] = sport & 0xFF; f[36] = dport >> 8; f[37] = dport & 0xFF;
+    for (int i = 0; i < 4; ++i) f[38 + i] = (seq >> (24 - 8 * i)) & 0xFF;
+    f[46] = 5 << 4; f[47] = flags;
+    f.insert(f.end(), payload.begin(), payload.end());
+    while (f.size() < 60) f.push_back(0);  // Ethernet padding
+    PacketInfo info = parse_packet(f.data(), f.size(), f.size());
+    info.timestamp = std::chrono::system_clock::time_point(std::chrono::microseconds(usec));
+    return info;
+}
+
+// TLS ClientHello whose SNI follows a large padding extension
+static std::string make_client_hello(const std::string& sni, size_t padding)
+{
+    std::string ext;
+    auto u16 = [](std::string& out, size_t v) { out += char(v >> 8); out += char(v & 0xFF); };
+    u16(ext, 0x0015); u16(ext, padding); ext.append(padding, '\0');
+    u16(ext, 0x0000); u16(ext, sni.size() + 5); u16(ext, sni.size() + 3);
+    ext += '\0'; u16(ext, sni.size()); ext += sni;
+
+    std::string body = "\x03\x03" + std::string(32, 'r') + std::string(1, '\0');
+    u16(body, 2); body += "\x13\x01"; body += "\x01"; body += '\0';
+    u16(body, ext.size()); body += ext;
+
+    std::string hs = "\x01"; hs += '\0'; u16(hs, body.size()); hs += body;
+    std::string rec = "\x16\x03\x01"; u16(rec, hs.size()); rec += hs;
+    return rec;
+}
+
+REGISTER_TEST(parse_packet_ignores_ethernet_padding)
+{
+    PacketInfo info = make_tcp_segment(40000, 443, 1, TCP_ACK, "");
+    ATTEST_EQUAL(info.length, 60u);
+    ATTEST_EQUAL(info.payload_length, 0u);
+    ATTEST_EQUAL(info.tcp_seq, 1u);
+}
+
+REGISTER_TEST(tcp_reassembly_split_client_hello_out_of_order)
+{
+    std::string hello = make_client_hello("split.example.com", 2000);
+    std::string a = hello.substr(0, 1000), b = hello.substr(1000, 1000), c = hello.substr(2000);
+    const uint32_t isn = 0xFFFFFF00;  // Sequence numbers wrap inside the hello
+
+    TcpReassembler reassembler;
+    PacketInfo syn = make_tcp_segment(40000, 443, isn, TCP_SYN, "");
+    reassembler.on_packet(syn);
+    PacketInfo p3 = make_tcp_segment(40000, 443, isn + 2001, TCP_ACK, c);
+    reassembler.on_packet(p3);
+    PacketInfo p1 = make_tcp_segment(40000, 443, isn + 1, TCP_ACK, a);
+    ATTEST_TRUE(p1.hostname.empty());
+    reassembler.on_packet(p1);
+    ATTEST_TRUE(p1.hostname.empty());
+    ATTEST_EQUAL(reassembler.stats().out_of_order, 1u);
+
+    // The segment that fills the gap carries the hostname
+    PacketInfo p2 = make_tcp_segment(40000, 443, isn + 1001, TCP_ACK, b);
+    reassembler.on_packet(p2);
+    ATTEST_EQUAL(p2.hostname, "split.example.com");
+    ATTEST_EQUAL(p2.app_protocol, "TLS");
+    ATTEST_EQUAL(reassembler.stats().recovered, 1u);
+    ATTEST_EQUAL(reassembler.stats().streams, 0u);
+    ATTEST_EQUAL(reassembler.stats().buffered_bytes, 0u);
+}
+
+REGISTER_TEST(tcp_reassembly_http_head_mid_stream)
+{
+    TcpReassembler reassembler;
+    PacketInfo p1 = make_tcp_segment(40001, 80, 5000, TCP_ACK,
+                                     "GET /index.html HTTP/1.1\r\nUser-Agent: test/1.0\r\n");
+    reassembler.on_packet(p1);
+    ATTEST_EQUAL(reassembler.stats().streams, 1u);
+    PacketInfo p2 = make_tcp_segment(40001, 80, 5000 + 48, TCP_ACK,
+                                     "Host: www.example.org\r\n\r\n");
+    reassembler.on_packet(p2);
+    ATTEST_EQUAL(p2.hostname, "www.example.org");
+    ATTEST_EQUAL(p2.user_agent, "test/1.0");
+    ATTEST_EQUAL(p2.app_info, "GET /index.html");
+    ATTEST_EQUAL(reassembler.stats().streams, 0u);
+
+    // A complete head in one segment is never buffered
+    PacketInfo whole = make_tcp_segment(40002, 80, 1, TCP_ACK, "GET / HTTP/1.1\r\nHost: a.example\r\n\r\n");
+    reassembler.on_packet(whole);
+    ATTEST_EQUAL(reassembler.stats().streams, 0u);
+}
+
+REGISTER_TEST(tcp_reassembly_memory_cap_and_expiry)
+{
+    ReassemblyConfig config;
+    config.max_memory_bytes = 2500;
+    config.idle_timeout = std::chrono::seconds(30);
+    TcpReassembler reassembler(config);
+    std::string part = make_client_hello("cap.example.com", 3000).substr(0, 1000);
+
+    for (uint16_t port = 41000; port < 41005; ++port) {
+        PacketInfo p = make_tcp_segment(port, 443, 1, TCP_ACK, part, port * 1000);
+        reassembler.on_packet(p);
+        ATTEST_TRUE(reassembler.stats().buffered_bytes <= 2500);
+    }
+    ATTEST_EQUAL(reassembler.stats().streams, 2u);
+    ATTEST_EQUAL(reassembler.stats().evicted, 3u);
+
+    reassembler.expire(std::chrono::system_clock::time_point(std::chrono::seconds(100)));
+    ATTEST_EQUAL(reassembler.stats().streams, 0u);
+    ATTEST_EQUAL(reassembler.stats().expired, 2u);
+    ATTEST_EQUAL(reassembler.stats().buffered_bytes, 0u);
+
+    // Disabled reassembler ignores everything
+    config.max_stream_bytes = 0;
+    TcpReassembler off(config);
+    PacketInfo p = make_tcp_segment(42000, 443, 1, TCP_ACK, part);
+    off.on_packet(p);
+    ATTEST_EQUAL(off.stats().streams, 0u);
+}
+
+// =============================================================================
+// IPv6 Extension Header and Fragment Reassembly Tests
+// =============================================================================
+
+// UDP datagram (header + DNS query for name) from port 53
+static std::vector<uint8_t> make_dns_datagram(const std::string& name, size_t padding)
+{
+    std::vector<uint8_t> dns = {0x12, 0x34, 0x81, 0x80, 0, 1, 0, 0, 0, 0, 0, 0};
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = std::min(name.find('.', start), name.size());
+        dns.push_back(static_cast<uint8_t>(dot - start));
+        dns.insert(dns.end(), name.begin() + start, name.begin() + dot);
+        start = dot + 1;
+    }
+    dns.insert(dns.end(), {0, 0, 1, 0, 1});
+    dns.insert(dns.end(), padding, 0xAB);  // Stands in for a large answer section
+
+    std::vector<uint8_t> udp = {0, 53, 0xC0, 0x00, 0, 0, 0, 0};
+    udp[4] = static_cast<uint8_t>((8 + dns.size()) >> 8);
+    udp[5] = static_cast<uint8_t>(8 + dns.size());
+    udp.insert(udp.end(), dns.begin(), dns.end());
+    return udp;
+}
+
+static PacketInfo make_ipv4_fragment(uint16_t id, const std::vector<uint8_t>& datagram,
+                                     size_t offset, size_t len, bool more)
+{
+    std::vector<uint8_t> f(34, 0);
+    f[12] = 0x08;
+    f[14] = 0x45;
+    f[16] = static_cast<uint8_t>((20 + len) >> 8); f[17] = static_cast<uint8_t>(20 + len);
+    f[18] = id >> 8; f[19] = id & 0xFF;
+    uint16_t frag = static_cast<uint16_t>((offset / 8) | (more ? 0x2000 : 0));
+    f[20] = frag >> 8; f[21] = frag & 0xFF;
+    f[22] = 64; f[23] = PROTO_UDP;
+    f[26] = 192; f[27] = 0; f[28] = 2; f[29] = 53;
+    f[30] = 10; f[33] = 7;
+    f.insert(f.end(), datagram.begin() + offset, datagram.begin() + offset + len);
+    return parse_packet(f.data(), f.size(), f.size());
+}
+
+// IPv6 frame whose payload is preceded by the given extension header bytes
+static PacketInfo make_ipv6_packet(uint8_t first_header, const std::vector<uint8_t>& headers,
+                                   const std::vector<uint8_t>& payload)
+{
+    std::vector<uint8_t> f(54, 0);
+    f[12] = 0x86; f[13] = 0xDD;
+    f[14] = 0x60;
+    size_t plen = headers.size() + payload.size();
+    f[18] = static_cast<uint8_t>(plen >> 8); f[19] = static_cast<uint8_t>(plen);
+    f[20] = first_header; f[21] = 64;
+    f[22] = 0x20; f[23] = 0x01; f[37] = 1;
+    f[38] = 0x20; f[39] = 0x01; f[53] = 2;
+    f.insert(f.end(), headers.begin(), headers.end());
+    f.insert(f.end(), payload.begin(), payload.end());
+    return parse_packet(f.data(), f.size(), f.size());
+}
+
+REGISTER_TEST(parse_packet_ipv6_extension_headers)
+{
+    std::vector<uint8_t> udp = make_dns_datagram("ext.example.net", 0);
+    // Hop-by-hop (8 bytes) -> destination options (16 bytes) -> UDP
+    std::vector<uint8_t> headers(24, 0);
+    headers[0] = IPV6_EXT_DEST_OPTS; headers[1] = 0;
+    headers[8] = PROTO_UDP; headers[9] = 1;
+    PacketInfo info = make_ipv6_packet(IPV6_EXT_HOP_BY_HOP, headers, udp);
+    ATTEST_EQUAL(info.protocol, PROTO_UDP);
+    ATTEST_EQUAL(info.src_port, 53);
+    ATTEST_EQUAL(info.hostname, "ext.example.net");
+    ATTEST_FALSE(info.is_fragment());
+
+    // Truncated extension header: no transport parsed
+    std::vector<uint8_t> bad(8, 0);
+    bad[0] = PROTO_UDP; bad[1] = 4;  // Claims 40 bytes
+    PacketInfo trunc = make_ipv6_packet(IPV6_EXT_ROUTING, bad, {});
+    ATTEST_EQUAL(trunc.src_port, 0);
+}
+
+REGISTER_TEST(ip_reassembly_ipv4_out_of_order)
+{
+    std::vector<uint8_t> datagram = make_dns_datagram("big.example.org", 3000);
+    size_t total = datagram.size();
+    IpReassembler reassembler;
+
+    PacketInfo last = make_ipv4_fragment(77, datagram, 2960, total - 2960, false);
+    PacketInfo middle = make_ipv4_fragment(77, datagram, 1480, 1480, true);
+    PacketInfo first = make_ipv4_fragment(77, datagram, 0, 1480, true);
+    ATTEST_TRUE(last.is_fragment());
+    ATTEST_EQUAL(last.src_port, 0);
+    ATTEST_EQUAL(first.src_port, 53);
+
+    reassembler.on_packet(last);
+    reassembler.on_packet(first);
+    reassembler.on_packet(first);  // Duplicate is harmless
+    ATTEST_EQUAL(reassembler.stats().datagrams, 1u);
+    reassembler.on_packet(middle);
+
+    ATTEST_EQUAL(middle.reassembled_length, static_cast<uint32_t>(total));
+    ATTEST_EQUAL(middle.src_port, 53);
+    ATTEST_EQUAL(middle.hostname, "big.example.org");
+    ATTEST_EQUAL(reassembler.stats().reassembled, 1u);
+    ATTEST_EQUAL(reassembler.stats().datagrams, 0u);
+    ATTEST_EQUAL(reassembler.stats().buffered_bytes, 0u);
+}
+
+REGISTER_TEST(ip_reassembly_ipv6_fragments_and_overlap)
+{
+    std::vector<uint8_t> datagram = make_dns_datagram("v6.example.org", 2000);
+    auto fragment = [&](size_t offset, size_t len, bool more, uint32_t id) {
+        std::vector<uint8_t> header = {PROTO_UDP, 0, 0, 0, 0, 0, 0, 0};
+        uint16_t field = static_cast<uint16_t>(offset | (more ? 1 : 0));
+        header[2] = field >> 8; header[3] = field & 0xFF;
+        header[4] = id >> 24; header[5] = (id >> 16) & 0xFF; header[6] = (id >> 8) & 0xFF; header[7] = id & 0xFF;
+        std::vector<uint8_t> part(datagram.begin() + offset, datagram.begin() + offset + len);
+        return make_ipv6_packet(IPV6_EXT_FRAGMENT, header, part);
+    };
+
+    IpReassembler reassembler;
+    PacketInfo a = fragment(0, 1232, true, 9);
+    ATTEST_EQUAL(a.fragment_id, 9u);
+    ATTEST_EQUAL(a.protocol, PROTO_UDP);
+    reassembler.on_packet(a);
+    PacketInfo b = fragment(1232, datagram.size() - 1232, false, 9);
+    reassembler.on_packet(b);
+    ATTEST_EQUAL(b.hostname, "v6.example.org");
+    ATTEST_EQUAL(b.dst_port, 0xC000);
+
+    // Overlapping fragments drop the datagram
+    PacketInfo c = fragment(0, 1232, true, 10);
+    PacketInfo d = fragment(1224, datagram.size() - 1224, false, 10);
+    reassembler.on_packet(c);
+    reassembler.on_packet(d);
+    ATTEST_EQUAL(d.reassembled_length, 0u);
+    ATTEST_EQUAL(reassembler.stats().overlaps, 1u);
+    ATTEST_EQUAL(reassembler.stats().datagrams, 0u);
+}
+
+REGISTER_TEST(ip_reassembly_memory_cap_and_timeout)
+{
+    FragmentConfig config;
+    config.max_memory_bytes = 4000;
+    IpReassembler reassembler(config);
+    std::vector<uint8_t> datagram = make_dns_datagram("cap.example.org", 3000);
+
+    for (uint16_t id = 1; id <= 4; ++id) {
+        PacketInfo first = make_ipv4_fragment(id, datagram, 0, 1480, true);
+        first.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(id));
+        reassembler.on_packet(first);
+        ATTEST_TRUE(reassembler.stats().buffered_bytes <= 4000);
+    }
+    ATTEST_EQUAL(reassembler.stats().datagrams, 2u);
+    ATTEST_EQUAL(reassembler.stats().evicted, 2u);
+
+    reassembler.expire(std::chrono::system_clock::time_point(std::chrono::seconds(60)));
+    ATTEST_EQUAL(reassembler.stats().timed_out, 2u);
+    ATTEST_EQUAL(reassembler.stats().buffered_bytes, 0u);
+}
+
+// =============================================================================
+// Passive DNS Tests
+// =============================================================================
+
+// Response for www.example.com: CNAME edge.cdn.net, then A and AAAA for the
+// CNAME target, all names after the question compressed
+static std::vector<uint8_t> make_dns_response()
+{
+    std::vector<uint8_t> dns = {0xAB, 0xCD, 0x81, 0x80, 0, 1, 0, 3, 0, 0, 0, 0,
+                                3, 'w', 'w', 'w', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e',
+                                3, 'c', 'o', 'm', 0, 0, 1, 0, 1};
+    // www.example.com CNAME edge.cdn.net (TTL 300)
+    dns.insert(dns.end(), {0xC0, 12, 0, 5, 0, 1, 0, 0, 1, 0x2C, 0, 14,
+                           4, 'e', 'd', 'g', 'e', 3, 'c', 'd', 'n', 3, 'n', 'e', 't', 0});
+    uint8_t target = 45;  // Offset of "edge.cdn.net"
+    // edge.cdn.net A 192.0.2.7 (TTL 20, below the clamp)
+    dns.insert(dns.end(), {0xC0, target, 0, 1, 0, 1, 0, 0, 0, 20, 0, 4, 192, 0, 2, 7});
+    // edge.cdn.net AAAA 2001:db8::7
+    dns.insert(dns.end(), {0xC0, target, 0, 28, 0, 1, 0, 0, 1, 0x2C, 0, 16,
+                           0x20, 0x01, 0x0D, 0xB8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7});
+    return dns;
+}
+
+REGISTER_TEST(parse_dns_answers_cname_chain)
+{
+    std::vector<uint8_t> dns = make_dns_response();
+    std::vector<DnsAnswer> answers;
+    ATTEST_EQUAL(parse_dns_answers(dns.data(), dns.size(), answers), 3u);
+    ATTEST_EQUAL(answers[0].type, DNS_TYPE_CNAME);
+    ATTEST_EQUAL(answers[0].name, "www.example.com");
+    ATTEST_EQUAL(answers[0].target, "edge.cdn.net");
+    ATTEST_EQUAL(answers[1].name, "edge.cdn.net");
+    ATTEST_EQUAL(answers[1].ttl, 20u);
+    ATTEST_EQUAL(answers[1].addr[3], 7);
+    ATTEST_EQUAL(answers[2].type, DNS_TYPE_AAAA);
+    ATTEST_EQUAL(answers[2].addr[15], 7);
+
+    // Whole packet: the summary names the first address
+    std::vector<uint8_t> udp = {0, 53, 0xC0, 0x00, 0, 0, 0, 0};
+    udp[5] = static_cast<uint8_t>(8 + dns.size());
+    udp.insert(udp.end(), dns.begin(), dns.end());
+    PacketInfo info = make_ipv6_packet(PROTO_UDP, {}, udp);
+    ATTEST_EQUAL(info.hostname, "www.example.com");
+    ATTEST_EQUAL(info.app_info, "Response A 192.0.2.7 (+1)");
+    ATTEST_EQUAL(info.dns_answers.size(), 3u);
+
+    // Truncated answer section keeps what parsed
+    answers.clear();
+    ATTEST_EQUAL(parse_dns_answers(dns.data(), dns.size() - 20, answers), 2u);
+}
+
+REGISTER_TEST(dns_cache_maps_addresses_to_question)
+{
+    std::vector<uint8_t> dns = make_dns_response();
+    std::vector<DnsAnswer> answers;
+    parse_dns_answers(dns.data(), dns.size(), answers);
+    auto t0 = std::chrono::system_clock::time_point(std::chrono::seconds(1000));
+
+    DnsCache cache;
+    cache.learn("www.example.com", answers, t0);
+    ATTEST_EQUAL(cache.stats().entries, 2u);
+    std::array<uint8_t, 16> v4{192, 0, 2, 7};
+    ATTEST_EQUAL(cache.lookup(4, v4, t0).value_or(""), "www.example.com");
+    ATTEST_EQUAL(cache.lookup(6, answers[2].addr, t0).value_or(""), "www.example.com");
+
+    // TTL 20 is clamped up to 60 s
+    ATTEST_TRUE(cache.lookup(4, v4, t0 + std::chrono::seconds(59)).has_value());
+    ATTEST_FALSE(cache.lookup(4, v4, t0 + std::chrono::seconds(61)).has_value());
+    ATTEST_EQUAL(cache.stats().entries, 1u);
+
+    // A packet to the AAAA address without a hostname is labelled
+    PacketInfo quic = make_ipv6_packet(PROTO_UDP, {}, {0xC0, 0x00, 0x01, 0xBB, 0, 8, 0, 0});
+    quic.dst_addr = answers[2].addr;
+    quic.timestamp = t0;
+    cache.on_packet(quic);
+    ATTEST_EQUAL(quic.hostname, "www.example.com");
+    ATTEST_TRUE(quic.hostname_from_dns);
+    ATTEST_EQUAL(cache.stats().hits, 1u);
+}
+
+REGISTER_TEST(dns_cache_bounded_by_max_entries)
+{
+    DnsCacheConfig config;
+    config.max_entries = 64;
+    DnsCache cache(config);
+    auto now = std::chrono::system_clock::time_point(std::chrono::seconds(1));
+
+    for (int i = 0; i < 1000; ++i) {
+        DnsAnswer answer;
+        answer.name = "host" + std::to_string(i) + ".example";
+        answer.type = DNS_TYPE_A;
+        answer.ttl = 3600;
+        answer.addr = {10, static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i), 1};
+        cache.learn(answer.name, {answer}, now);
+    }
+    ATTEST_TRUE(cache.stats().entries <= 64);
+    ATTEST_EQUAL(cache.stats().inserts, 1000u);
+    ATTEST_EQUAL(cache.stats().entries + cache.stats().evictions, 1000u);
+
+    // The most recent entry survives; a disabled cache learns nothing
+    std::array<uint8_t, 16> last{10, 3, 231, 1};
+    ATTEST_EQUAL(cache.lookup(4, last, now).value_or(""), "host999.example");
+    DnsCacheConfig off;
+    off.max_entries = 0;
+    DnsCache disabled(off);
+    DnsAnswer answer;
+    answer.name = "a.example";
+    answer.type = DNS_TYPE_A;
+    disabled.learn("a.example", {answer}, now);
+    ATTEST_EQUAL(disabled.stats().entries, 0u);
+}
+
+// =============================================================================
+// DNS Transaction Tests
+// =============================================================================
+
+static PacketInfo make_dns_packet(bool response, uint16_t id, const std::string& name,
+                                  uint8_t server, uint16_t client_port, int64_t ms,
+                                  uint8_t rcode = 0)
+{
+    PacketInfo info{};
+    info.ip_version = 4;
+    info.protocol = PROTO_UDP;
+    std::array<uint8_t, 16> client{10, 0, 0, 1};
+    std::array<uint8_t, 16> resolver{192, 0, 2, server};
+    std::string resolver_ip = "192.0.2." + std::to_string(server);
+    info.src_addr = response ? resolver : client;
+    info.dst_addr = response ? client : resolver;
+    info.src_ip = response ? resolver_ip : "10.0.0.1";
+    info.dst_ip = response ? "10.0.0.1" : resolver_ip;
+    info.src_port = response ? 53 : client_port;
+    info.dst_port = response ? client_port : 53;
+    info.hostname = name;
+    info.app_protocol = "DNS";
+    info.dns_id = id;
+    info.dns_flags = static_cast<uint16_t>((response ? 0x8180 : 0x0100) | rcode);
+    info.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+    return info;
+}
+
+REGISTER_TEST(dns_tracker_matches_responses)
+{
+    std::vector<uint8_t> dns = make_dns_response();
+    std::vector<uint8_t> udp = {0, 53, 0xC0, 0x00, 0, 0, 0, 0};
+    udp[5] = static_cast<uint8_t>(8 + dns.size());
+    udp.insert(udp.end(), dns.begin(), dns.end());
+    PacketInfo parsed = make_ipv6_packet(PROTO_UDP, {}, udp);
+    ATTEST_EQUAL(parsed.dns_id, 0xABCD);
+    ATTEST_EQUAL(parsed.dns_flags, 0x8180);
+
+    DnsTracker tracker;
+    tracker.on_packet(make_dns_packet(false, 1, "a.example", 53, 40000, 0));
+    tracker.on_packet(make_dns_packet(false, 2, "b.example", 53, 40001, 0));
+    tracker.on_packet(make_dns_packet(false, 3, "a.example", 54, 40002, 0));
+    // Same id and port but another name does not match
+    tracker.on_packet(make_dns_packet(true, 1, "other.example", 53, 40000, 5));
+    tracker.on_packet(make_dns_packet(true, 1, "A.Example", 53, 40000, 20));
+    tracker.on_packet(make_dns_packet(true, 2, "b.example", 53, 40001, 40, 3));
+    tracker.on_packet(make_dns_packet(true, 3, "a.example", 54, 40002, 300, 2));
+
+    DnsTrackerSnapshot snap = tracker.snapshot(10);
+    ATTEST_EQUAL(snap.total.queries, 3u);
+    ATTEST_EQUAL(snap.total.responses, 3u);
+    ATTEST_EQUAL(snap.total.nxdomain, 1u);
+    ATTEST_EQUAL(snap.total.servfail, 1u);
+    ATTEST_EQUAL(snap.unmatched, 1u);
+    ATTEST_EQUAL(snap.pending, 0u);
+    ATTEST_EQUAL(snap.total.latency.max_ns, 300000000u);
+
+    ATTEST_EQUAL(snap.servers.size(), 2u);
+    ATTEST_EQUAL(snap.servers[0].label, "192.0.2.53");
+    ATTEST_EQUAL(snap.servers[0].queries, 2u);
+    ATTEST_EQUAL(snap.names[0].label, "a.example");
+    ATTEST_EQUAL(snap.names[0].servfail, 1u);
+
+    // Slowest first puts the 300 ms server on top
+    snap = tracker.snapshot(1, DnsOrder::SLOWEST);
+    ATTEST_EQUAL(snap.servers.size(), 1u);
+    ATTEST_EQUAL(snap.servers[0].label, "192.0.2.54");
+}
+
+REGISTER_TEST(dns_tracker_unanswered_and_flood)
+{
+    DnsTrackerConfig config;
+    config.max_pending = 100;
+    config.max_names = 50;
+    DnsTracker tracker(config);
+
+    // A flood of unanswered queries stays within max_pending
+    for (int i = 0; i < 1000; ++i) {
+        tracker.on_packet(make_dns_packet(false, static_cast<uint16_t>(i),
+                                          "flood" + std::to_string(i) + ".example", 53,
+                                          static_cast<uint16_t>(1024 + i), i));
+    }
+    DnsTrackerSnapshot snap = tracker.snapshot(1000);
+    ATTEST_EQUAL(snap.pending, 100u);
+    ATTEST_EQUAL(snap.overflows, 900u);
+    ATTEST_EQUAL(snap.total.unanswered, 900u);
+    ATTEST_EQUAL(snap.names.size(), 50u);
+
+    // The rest time out
+    tracker.expire(std::chrono::system_clock::time_point(std::chrono::seconds(10)));
+    snap = tracker.snapshot(1);
+    ATTEST_EQUAL(snap.pending, 0u);
+    ATTEST_EQUAL(snap.total.unanswered, 1000u);
+    ATTEST_EQUAL(snap.servers[0].unanswered, 1000u);
+
+    // Disabled tracker ignores everything
+    DnsTrackerConfig off;
+    off.max_pending = 0;
+    DnsTracker disabled(off);
+    disabled.on_packet(make_dns_packet(false, 1, "a.example", 53, 40000, 0));
+    ATTEST_EQUAL(disabled.snapshot(1).total.queries, 0u);
+}
+
+// =============================================================================
+// QUIC Initial Tests
+// =============================================================================
+
+static std::vector<uint8_t> from_hex(const std::string& hex)
+{
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes.push_back(static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+}
+
+REGISTER_TEST(crypto_known_answers)
+{
+    Sha256Digest digest = sha256(reinterpret_cast<const uint8_t*>("abc"), 3);
+    ATTEST_TRUE(std::vector<uint8_t>(digest.begin(), digest.end()) ==
+                from_hex("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+
+    // FIPS-197 appendix B
+    std::vector<uint8_t> key = from_hex("2b7e151628aed2a6abf7158809cf4f3c");
+    std::vector<uint8_t> block = from_hex("3243f6a8885a308d313198a2e0370734");
+    uint8_t out[16];
+    Aes128(key.data()).encrypt_block(block.data(), out);
+    ATTEST_TRUE(std::vector<uint8_t>(out, out + 16) == from_hex("3925841d02dc09fbdc118597196a0b32"));
+
+    // GCM spec test case 4: AAD and a partial final block
+    std::vector<uint8_t> k = from_hex("feffe9928665731c6d6a8f9467308308");
+    std::vector<uint8_t> iv = from_hex("cafebabefacedbaddecaf888");
+    std::vector<uint8_t> aad = from_hex("feedfacedeadbeeffeedfacedeadbeefabaddad2");
+    std::vector<uint8_t> plain = from_hex(
+        "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+        "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+    std::vector<uint8_t> cipher(plain.size());
+    uint8_t tag[16];
+    aes128_gcm_encrypt(k.data(), iv.data(), aad.data(), aad.size(), plain.data(), plain.size(),
+                       cipher.data(), tag);
+    ATTEST_TRUE(cipher == from_hex(
+        "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+        "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091"));
+    ATTEST_TRUE(std::vector<uint8_t>(tag, tag + 16) == from_hex("5bc94fbc3221a5db94fae95ae7121a47"));
+
+    std::vector<uint8_t> back(plain.size());
+    ATTEST_TRUE(aes128_gcm_decrypt(k.data(), iv.data(), aad.data(), aad.size(), cipher.data(),
+                                   cipher.size(), tag, back.data()));
+    ATTEST_TRUE(back == plain);
+    tag[0] ^= 1;
+    ATTEST_FALSE(aes128_gcm_decrypt(k.data(), iv.data(), aad.data(), aad.size(), cipher.data(),
+                                    cipher.size(), tag, back.data()));
+}
+
+REGISTER_TEST(quic_initial_keys_rfc9001)
+{
+    // RFC 9001 appendix A.1 and the A.2 header protection sample
+    std::vector<uint8_t> dcid = from_hex("8394c8f03e515708");
+    QuicInitialKeys keys;
+    ATTEST_TRUE(derive_quic_initial_keys(QUIC_VERSION_1, dcid.data(), dcid.size(), true, keys));
+    ATTEST_TRUE(std::vector<uint8_t>(keys.key.begin(), keys.key.end()) ==
+                from_hex("1f369613dd76d5467730efcbe3b1a22d"));
+    ATTEST_TRUE(std::vector<uint8_t>(keys.iv.begin(), keys.iv.end()) ==
+                from_hex("fa044b2f42a3fd3b46fb255c"));
+    ATTEST_TRUE(std::vector<uint8_t>(keys.hp.begin(), keys.hp.end()) ==
+                from_hex("9f50449e04a0e810283a1e9933adedd2"));
+
+    std::vector<uint8_t> sample = from_hex("d1b1c98dd7689fb8ec11d242b123dc9b");
+    uint8_t mask[16];
+    Aes128(keys.hp.data()).encrypt_block(sample.data(), mask);
+    ATTEST_TRUE(std::vector<uint8_t>(mask, mask + 5) == from_hex("437b9aec36"));
+
+    ATTEST_FALSE(derive_quic_initial_keys(0xff00001d, dcid.data(), dcid.size(), true, keys));
+}
+
+// Protected client Initial (pn_len 2, no token) carrying the given frames,
+// padded to the 1200-byte minimum
+static std::vector<uint8_t> make_quic_initial(uint32_t version, const std::vector<uint8_t>& dcid,
+                                              uint16_t pn, std::vector<uint8_t> frames)
+{
+    frames.resize(std::max<size_t>(frames.size(), 1150), 0);  // PADDING
+    uint8_t type = version == QUIC_VERSION_2 ? 1 : 0;
+    std::vector<uint8_t> packet = {static_cast<uint8_t>(0xC1 | (type << 4)),
+                                   static_cast<uint8_t>(version >> 24), static_cast<uint8_t>(version >> 16),
+                                   static_cast<uint8_t>(version >> 8), static_cast<uint8_t>(version)};
+    packet.push_back(static_cast<uint8_t>(dcid.size()));
+    packet.insert(packet.end(), dcid.begin(), dcid.end());
+    packet.push_back(0);  // SCID length
+    packet.push_back(0);  // Token length
+    size_t length = 2 + frames.size() + 16;
+    packet.push_back(static_cast<uint8_t>(0x40 | (length >> 8)));
+    packet.push_back(static_cast<uint8_t>(length));
+    size_t pn_offset = packet.size();
+    packet.push_back(static_cast<uint8_t>(pn >> 8));
+    packet.push_back(static_cast<uint8_t>(pn));
+
+    QuicInitialKeys keys;
+    derive_quic_initial_keys(version, dcid.data(), dcid.size(), true, keys);
+    uint8_t nonce[12];
+    std::memcpy(nonce, keys.iv.data(), 12);
+    nonce[10] ^= static_cast<uint8_t>(pn >> 8);
+    nonce[11] ^= static_cast<uint8_t>(pn);
+    size_t header_len = packet.size();
+    packet.resize(header_len + frames.size() + 16);
+    aes128_gcm_encrypt(keys.key.data(), nonce, packet.data(), header_len, frames.data(),
+                       frames.size(), packet.data() + header_len,
+                       packet.data() + header_len + frames.size());
+
+    uint8_t mask[16];
+    Aes128(keys.hp.data()).encrypt_block(packet.data() + pn_offset + 4, mask);
+    packet[0] ^= mask[0] & 0x0F;
+    packet[pn_offset] ^= mask[1];
+    packet[pn_offset + 1] ^= mask[2];
+    return packet;
+}
+
+static std::vector<uint8_t> quic_crypto_frame(size_t offset, const std::string& data)
+{
+    std::vector<uint8_t> frame = {0x06, static_cast<uint8_t>(0x40 | (offset >> 8)),
+                                  static_cast<uint8_t>(offset),
+                                  static_cast<uint8_t>(0x40 | (data.size() >> 8)),
+                                  static_cast<uint8_t>(data.size())};
+    frame.insert(frame.end(), data.begin(), data.end());
+    return frame;
+}
+
+// Ethernet/IPv4/UDP between 10.0.0.1:client_port and 10.0.0.2:443, parsed
+static PacketInfo make_quic_packet(bool to_server, const std::vector<uint8_t>& payload,
+                                   uint16_t client_port = 50000)
+{
+    std::vector<uint8_t> f(42, 0);
+    f[12] = 0x08;
+    uint16_t total = static_cast<uint16_t>(28 + payload.size());
+    f[14] = 0x45; f[16] = total >> 8; f[17] = total & 0xFF; f[22] = 64; f[23] = PROTO_UDP;
+    f[26] = 10; f[29] = to_server ? 1 : 2; f[30] = 10; f[33] = to_server ? 2 : 1;
+    uint16_t sport = to_server ? client_port : 443;
+    uint16_t dport = to_server ? 443 : client_port;
+    f[34] = sport >> 8; f[35] = sport & 0xFF; f[36] = dport >> 8; f[37] = dport & 0xFF;
+    f[38] = static_cast<uint8_t>((8 + payload.size()) >> 8);
+    f[39] = static_cast<uint8_t>(8 + payload.size());
+    f.insert(f.end(), payload.begin(), payload.end());
+    return parse_packet(f.data(), f.size(), f.size());
+}
+
+REGISTER_TEST(quic_initial_split_client_hello)
+{
+    std::string hello = make_client_hello("h3.example.com", 1500).substr(5);  // No record header
+    std::vector<uint8_t> dcid = from_hex("0011223344556677");
+    std::string first = hello.substr(0, 1000);
+    std::string second = hello.substr(1000);
+
+    // Second half first, with an ACK and PING ahead of the CRYPTO frame
+    std::vector<uint8_t> frames2 = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+    std::vector<uint8_t> crypto2 = quic_crypto_frame(1000, second);
+    frames2.insert(frames2.end(), crypto2.begin(), crypto2.end());
+    PacketInfo p2 = make_quic_packet(true, make_quic_initial(QUIC_VERSION_1, dcid, 1, frames2));
+    ATTEST_EQUAL(p2.app_protocol, "QUIC");
+    ATTEST_EQUAL(p2.app_info, "Initial v1");
+
+    QuicDissector quic;
+    quic.on_packet(p2);
+    ATTEST_TRUE(p2.hostname.empty());
+    ATTEST_EQUAL(quic.stats().decrypted, 1u);
+
+    PacketInfo p1 = make_quic_packet(true, make_quic_initial(QUIC_VERSION_1, dcid, 0,
+                                                             quic_crypto_frame(0, first)));
+    quic.on_packet(p1);
+    ATTEST_EQUAL(p1.hostname, "h3.example.com");
+    ATTEST_EQUAL(p1.app_info, "Initial v1 Client Hello");
+    ATTEST_EQUAL(quic.stats().client_hellos, 1u);
+
+    // Later packets either way are named without decrypting
+    PacketInfo reply = make_quic_packet(false, {0x41, 1, 2, 3, 4, 5, 6, 7, 8});
+    ATTEST_EQUAL(reply.app_info, "1-RTT");
+    quic.on_packet(reply);
+    ATTEST_EQUAL(reply.hostname, "h3.example.com");
+    ATTEST_EQUAL(quic.stats().labelled, 1u);
+    ATTEST_EQUAL(quic.stats().decrypted, 2u);
+
+    // A corrupted Initial fails authentication
+    std::vector<uint8_t> bad = make_quic_initial(QUIC_VERSION_1, from_hex("0102030405060708"), 0,
+                                                 quic_crypto_frame(0, first));
+    bad[bad.size() - 1] ^= 0x80;
+    PacketInfo corrupt = make_quic_packet(true, bad, 50001);
+    quic.on_packet(corrupt);
+    ATTEST_EQUAL(quic.stats().decrypt_failures, 1u);
+    ATTEST_TRUE(corrupt.hostname.empty());
+}
+
+REGISTER_TEST(quic_v2_initial_and_limits)
+{
+    std::string hello = make_client_hello("v2.example.org", 0).substr(5);
+    std::vector<uint8_t> dcid = from_hex("a1a2a3a4a5a6a7a8a9");
+    PacketInfo p = make_quic_packet(true, make_quic_initial(QUIC_VERSION_2, dcid, 0,
+                                                            quic_crypto_frame(0, hello)));
+    ATTEST_EQUAL(p.app_info, "Initial v2");
+
+    QuicConfig config;
+    config.max_initial_packets = 2;
+    QuicDissector quic(config);
+    quic.on_packet(p);
+    ATTEST_EQUAL(p.hostname, "v2.example.org");
+
+    // A connection that never completes its ClientHello stops being decrypted
+    std::vector<uint8_t> other = from_hex("b1b2b3b4b5b6b7b8");
+    for (uint16_t pn = 0; pn < 5; ++pn) {
+        PacketInfo part = make_quic_packet(true, make_quic_initial(QUIC_VERSION_1, other, pn,
+                                           quic_crypto_frame(0, hello.substr(0, 50))), 50002);
+        quic.on_packet(part);
+    }
+    ATTEST_EQUAL(quic.stats().initials, 6u);
+    ATTEST_EQUAL(quic.stats().decrypted, 3u);
+
+    // Disabled dissector leaves packets alone
+    QuicConfig off;
+    off.max_flows = 0;
+    QuicDissector disabled(off);
+    PacketInfo q = make_quic_packet(true, make_quic_initial(QUIC_VERSION_2, dcid, 0,
+                                                            quic_crypto_frame(0, hello)));
+    disabled.on_packet(q);
+    ATTEST_TRUE(q.hostname.empty());
+}
+
+// =============================================================================
+// TLS Fingerprint Tests
+// =============================================================================
+
+// Chrome-style ClientHello: GREASE cipher, extensions and versions, with
+// the 15 cipher suites of the JA4 specification's example
+static std::string make_fingerprint_hello(const std::vector<uint16_t>& order)
+{
+    auto u16 = [](std::string& out, size_t v) { out += char(v >> 8); out += char(v & 0xFF); };
+    auto ext_body = [&](uint16_t type) {
+        std::string body;
+        switch (type) {
+            case 0x0000:
+                u16(body, 17); body += '\0'; u16(body, 14); body += "fp.example.com";
+                break;
+            case 0x000a:
+                u16(body, 8); for (uint16_t g : {0x4a4a, 0x001d, 0x0017, 0x0018}) u16(body, g);
+                break;
+            case 0x000b:
+                body += "\x01"; body += '\0';
+                break;
+            case 0x000d:
+                u16(body, 16);
+                for (uint16_t s : {0x0403, 0x0804, 0x0401, 0x0503, 0x0805, 0x0501, 0x0806, 0x0601}) {
+                    u16(body, s);
+                }
+                break;
+            case 0x0010:
+                u16(body, 12); body += "\x02h2\x08http/1.1";
+                break;
+            case 0x002b:
+                body += "\x06"; for (uint16_t v : {0x6a6a, 0x0304, 0x0303}) u16(body, v);
+                break;
+        }
+        return body;
+    };
+
+    std::string ext;
+    for (uint16_t type : order) {
+        std::string body = ext_body(type);
+        u16(ext, type); u16(ext, body.size()); ext += body;
+    }
+
+    std::string body = "\x03\x03" + std::string(32, 'r') + std::string(1, '\0');
+    const uint16_t ciphers[] = {0x2a2a, 0x1301, 0x1302, 0x1303, 0xc02b, 0xc02f, 0xc02c, 0xc030,
+                                0xcca9, 0xcca8, 0xc013, 0xc014, 0x009c, 0x009d, 0x002f, 0x0035};
+    u16(body, sizeof(ciphers));
+    for (uint16_t cipher : ciphers) u16(body, cipher);
+    body += "\x01"; body += '\0';
+    u16(body, ext.size()); body += ext;
+
+    std::string hs = "\x01"; hs += '\0'; u16(hs, body.size()); hs += body;
+    std::string rec = "\x16\x03\x01"; u16(rec, hs.size()); rec += hs;
+    return rec;
+}
+
+static const std::vector<uint16_t> FINGERPRINT_ORDER = {
+    0x3a3a, 0x0033, 0x0000, 0x002b, 0x000d, 0x0010, 0xff01, 0x000a, 0x0017,
+    0x0005, 0x000b, 0x0023, 0x4469, 0x0012, 0xfe0d, 0x001b, 0x002d, 0x9a9a
+};
+
+static PacketInfo parse_hello(const std::string& record, uint8_t protocol = PROTO_TCP)
+{
+    PacketInfo info{};
+    info.protocol = protocol;
+    parse_tls_client_hello(info, reinterpret_cast<const uint8_t*>(record.data()), record.size());
+    return info;
+}
+
+REGISTER_TEST(tls_fingerprint_ja3_ja4)
+{
+    PacketInfo info = parse_hello(make_fingerprint_hello(FINGERPRINT_ORDER));
+    ATTEST_EQUAL(info.hostname, "fp.example.com");
+    ATTEST_TRUE(info.tls_fingerprint != nullptr);
+    const TlsFingerprint& fp = *info.tls_fingerprint;
+    ATTEST_EQUAL(fp.ja3_full, "771,4865-4866-4867-49195-49199-49196-49200-52393-52392-49171-"
+                              "49172-156-157-47-53,51-0-43-13-16-65281-10-23-5-11-35-17513-18-"
+                              "65037-27-45,29-23-24,0");
+    ATTEST_EQUAL(fp.ja3, "1c365541218d50b670724a0d9218195f");
+    ATTEST_EQUAL(fp.ja4, "t13d1516h2_8daaf6152771_02713d6af862");
+
+    // Shuffled extensions change JA3 but not JA4; identical hellos share one object
+    std::vector<uint16_t> shuffled = FINGERPRINT_ORDER;
+    std::swap(shuffled[1], shuffled[2]);
+    PacketInfo other = parse_hello(make_fingerprint_hello(shuffled));
+    ATTEST_EQUAL(other.tls_fingerprint->ja3, "d690fc82bc52fce8a0ae6efe69be66d8");
+    ATTEST_EQUAL(other.tls_fingerprint->ja4, fp.ja4);
+    PacketInfo again = parse_hello(make_fingerprint_hello(FINGERPRINT_ORDER));
+    ATTEST_TRUE(again.tls_fingerprint.get() == info.tls_fingerprint.get());
+
+    // QUIC transport, and a truncated hello yields no fingerprint
+    PacketInfo quic = parse_hello(make_fingerprint_hello(FINGERPRINT_ORDER), PROTO_UDP);
+    ATTEST_EQUAL(quic.tls_fingerprint->ja4.substr(0, 11), "q13d1516h2_");
+    std::string record = make_fingerprint_hello(FINGERPRINT_ORDER);
+    PacketInfo partial = parse_hello(record.substr(0, record.size() - 10));
+    ATTEST_EQUAL(partial.hostname, "fp.example.com");
+    ATTEST_TRUE(partial.tls_fingerprint == nullptr);
+}
+
+REGISTER_TEST(tls_fingerprint_watchlist_and_flows)
+{
+    PacketInfo info = make_tcp_segment(40100, 443, 1, TCP_ACK,
+                                       make_fingerprint_hello(FINGERPRINT_ORDER));
+    ATTEST_TRUE(info.tls_fingerprint != nullptr);
+
+    auto ja3 = WatchlistEntry::from_fields({"ja3", "1C365541218D50B670724A0D9218195F", "Bot"});
+    ATTEST_TRUE(ja3.has_value());
+    ATTEST_TRUE(ja3->matches(info));
+    ATTEST_EQUAL(ja3->matched_value(info), "JA3 1c365541218d50b670724a0d9218195f");
+    auto ja4 = WatchlistEntry::from_fields({"ja4", "t13d*_8daaf6152771_*", "Chromium"});
+    ATTEST_TRUE(ja4.has_value());
+    ATTEST_TRUE(ja4->matches(info));
+    auto miss = WatchlistEntry::from_fields({"ja4", "t12d1516h2_8daaf6152771_02713d6af862", "x"});
+    ATTEST_FALSE(miss->matches(info));
+    ATTEST_FALSE(WatchlistEntry::from_fields({"ja3", "not-a-hash", "x"}).has_value());
+
+    // A fingerprint entry never matches on hostname or address
+    PacketInfo plain = make_tcp_segment(40101, 443, 1, TCP_ACK, "");
+    ATTEST_FALSE(ja4->matches(plain));
+
+    FlowTable table;
+    table.update(info);
+    const FlowRecord* flow = table.find(FlowKey::from_packet(info));
+    ATTEST_TRUE(flow != nullptr && flow->tls_fingerprint != nullptr);
+    char storage[512];
+    FormatBuffer out(storage, sizeof(storage));
+    ATTEST_TRUE(format_flow_ndjson(out, *flow, FlowEndReason::FORCED));
+    ATTEST_TRUE(std::string(out.view()).find(
+        "\"ja4\":\"t13d1516h2_8daaf6152771_02713d6af862\"") != std::string::npos);
+}
+
+// =============================================================================
+// Dissector Registry Tests
+// =============================================================================
+
+REGISTER_TEST(dissector_port_dispatch_and_heuristics)
+{
+    const std::string request = "GET /index.html HTTP/1.1\r\nHost: proxy.example.com\r\n\r\n";
+
+    // Registered ports: TLS only towards the server, DNS outranks HTTP
+    PacketInfo tls = make_tcp_segment(40000, 443, 1, TCP_ACK, make_client_hello("a.example", 0));
+    ATTEST_TRUE(find_app_dissector(tls) == AppDissector::TLS);
+    ATTEST_EQUAL(tls.hostname, "a.example");
+    PacketInfo reply = make_tcp_segment(443, 40000, 1, TCP_ACK, "");
+    ATTEST_TRUE(find_app_dissector(reply) == AppDissector::NONE);
+    PacketInfo both = make_tcp_segment(53, 80, 1, TCP_ACK, "");
+    ATTEST_TRUE(find_app_dissector(both) == AppDissector::DNS);
+    PacketInfo http = make_tcp_segment(80, 40000, 1, TCP_ACK, "");
+    ATTEST_TRUE(find_app_dissector(http) == AppDissector::HTTP);
+
+    // Unregistered ports fall back to the heuristics
+    PacketInfo alt_tls = make_tcp_segment(40001, 8443, 1, TCP_ACK,
+                                          make_client_hello("b.example", 0));
+    ATTEST_EQUAL(alt_tls.app_protocol, "TLS");
+    ATTEST_EQUAL(alt_tls.hostname, "b.example");
+    PacketInfo alt_http = make_tcp_segment(40002, 8080, 1, TCP_ACK, request);
+    ATTEST_EQUAL(alt_http.app_protocol, "HTTP");
+    ATTEST_EQUAL(alt_http.hostname, "proxy.example.com");
+    PacketInfo opaque = make_tcp_segment(40003, 5432, 1, TCP_ACK, std::string(32, 'x'));
+    ATTEST_TRUE(opaque.app_protocol.empty());
+
+    // A registered port is never second-guessed by the heuristics
+    PacketInfo tls_on_http = make_tcp_segment(40004, 80, 1, TCP_ACK,
+                                              make_client_hello("c.example", 0));
+    ATTEST_TRUE(tls_on_http.hostname.empty());
+}
+
+// =============================================================================
+// Datalink Tests
+// =============================================================================
+
+// IPv4 packet 10.0.0.1 -> 10.0.0.2 carrying make_dns_datagram(), after a link header
+static PacketInfo parse_with_link(LinkType link, const std::vector<uint8_t>& header)
+{
+    std::vector<uint8_t> udp = make_dns_datagram("link.example", 0);
+    std::vector<uint8_t> f = header;
+    std::vector<uint8_t> ip(20, 0);
+    ip[0] = 0x45; ip[2] = static_cast<uint8_t>((20 + udp.size()) >> 8);
+    ip[3] = static_cast<uint8_t>(20 + udp.size()); ip[8] = 64; ip[9] = PROTO_UDP;
+    ip[12] = 10; ip[15] = 1; ip[16] = 10; ip[19] = 2;
+    f.insert(f.end(), ip.begin(), ip.end());
+    f.insert(f.end(), udp.begin(), udp.end());
+    return packet_parser(link)(f.data(), f.size(), f.size());
+}
+
+REGISTER_TEST(parse_packet_link_types)
+{
+    const std::vector<std::pair<LinkType, std::vector<uint8_t>>> cases = {
+        {LinkType::LINUX_SLL, {0, 0, 0, 1, 0, 6, 1, 2, 3, 4, 5, 6, 0, 0, 0x08, 0x00}},
+        {LinkType::LINUX_SLL2, {0x08, 0x00, 0, 0, 0, 0, 0, 3, 0, 1, 0, 6, 1, 2, 3, 4, 5, 6, 0, 0}},
+        {LinkType::LOOPBACK, {2, 0, 0, 0}},           // DLT_NULL from a little-endian host
+        {LinkType::LOOPBACK, {0, 0, 0, 2}},           // DLT_LOOP
+        {LinkType::PPP, {0xFF, 0x03, 0x00, 0x21}},
+        {LinkType::PPP, {0x21}},                      // Compressed protocol field
+        {LinkType::RAW, {}},
+    };
+    for (const auto& [link, header] : cases) {
+        PacketInfo info = parse_with_link(link, header);
+        ATTEST_TRUE(info.link_type == link);
+        ATTEST_EQUAL(info.ether_type, ETHERTYPE_IPV4);
+        ATTEST_EQUAL(info.dst_ip, "10.0.0.2");
+        ATTEST_EQUAL(info.src_port, 53);
+        ATTEST_EQUAL(info.hostname, "link.example");
+        ATTEST_EQUAL(info.payload_offset, header.size() + 28);
+    }
+
+    PacketInfo cooked = parse_with_link(LinkType::LINUX_SLL, cases[0].second);
+    ATTEST_EQUAL(cooked.format_mac(cooked.src_mac), "01:02:03:04:05:06");
+
+    ATTEST_TRUE(link_type_from_dlt(113) == LinkType::LINUX_SLL);
+    ATTEST_TRUE(link_type_from_dlt(276) == LinkType::LINUX_SLL2);
+    ATTEST_TRUE(link_type_from_dlt(12) == LinkType::RAW);
+    ATTEST_TRUE(link_type_from_dlt(147) == LinkType::UNSUPPORTED);
+    PacketInfo unknown = parse_with_link(LinkType::UNSUPPORTED, {});
+    ATTEST_EQUAL(unknown.ip_version, 0);
+    ATTEST_EQUAL(unknown.raw_data.size(), unknown.length);
+}
+
+// =============================================================================
+// Tunnel Decapsulation Tests
+// =============================================================================
+
+// IPv4 header for a payload of the given size and protocol
+static std::vector<uint8_t> make_ipv4_header(uint8_t protocol, size_t payload, uint8_t src,
+                                             uint8_t dst, uint16_t flags_fragment = 0)
+{
+    std::vector<uint8_t> ip(20, 0);
+    ip[0] = 0x45; ip[2] = static_cast<uint8_t>((20 + payload) >> 8);
+    ip[3] = static_cast<uint8_t>(20 + payload); ip[6] = flags_fragment >> 8;
+    ip[7] = flags_fragment & 0xFF; ip[8] = 64; ip[9] = protocol;
+    ip[12] = 10; ip[15] = src; ip[16] = 10; ip[19] = dst;
+    return ip;
+}
+
+// Inner IPv4 DNS packet 10.0.0.1 -> 10.0.0.2 (see make_dns_datagram)
+static std::vector<uint8_t> make_inner_dns()
+{
+    std::vector<uint8_t> udp = make_dns_datagram("inner.example", 0);
+    std::vector<uint8_t> ip = make_ipv4_header(PROTO_UDP, udp.size(), 1, 2);
+    ip.insert(ip.end(), udp.begin(), udp.end());
+    return ip;
+}
+
+// Ethernet + outer IPv4 (10.0.0.101 -> 10.0.0.102) + protocol payload
+static PacketInfo parse_outer(uint8_t protocol, const std::vector<uint8_t>& payload)
+{
+    std::vector<uint8_t> f(14, 0);
+    f[12] = 0x08;
+    std::vector<uint8_t> ip = make_ipv4_header(protocol, payload.size(), 101, 102);
+    f.insert(f.end(), ip.begin(), ip.end());
+    f.insert(f.end(), payload.begin(), payload.end());
+    return parse_packet(f.data(), f.size(), f.size());
+}
+
+// UDP header to dport followed by a tunnel header and the inner packet
+static std::vector<uint8_t> udp_tunnel(uint16_t dport, std::vector<uint8_t> header,
+                                       const std::vector<uint8_t>& inner)
+{
+    std::vector<uint8_t> udp = {0xC3, 0x50, static_cast<uint8_t>(dport >> 8),
+                                static_cast<uint8_t>(dport), 0, 0, 0, 0};
+    udp.insert(udp.end(), header.begin(), header.end());
+    udp.insert(udp.end(), inner.begin(), inner.end());
+    udp[4] = static_cast<uint8_t>(udp.size() >> 8); udp[5] = static_cast<uint8_t>(udp.size());
+    return udp;
+}
+
+REGISTER_TEST(tunnel_vxlan_geneve_gre_ipip)
+{
+    std::vector<uint8_t> inner = make_inner_dns();
+    std::vector<uint8_t> inner_eth(14, 0);
+    inner_eth[5] = 0xAA; inner_eth[12] = 0x08;
+    inner_eth.insert(inner_eth.end(), inner.begin(), inner.end());
+
+    PacketInfo vxlan = parse_outer(PROTO_UDP, udp_tunnel(PORT_VXLAN,
+        {0x08, 0, 0, 0, 0x00, 0x13, 0x89, 0}, inner_eth));
+    ATTEST_EQUAL(vxlan.tunnel.depth, 1);
+    ATTEST_EQUAL(vxlan.tunnel.encapsulation, "VXLAN 5001");
+    ATTEST_EQUAL(vxlan.tunnel.src_ip, "10.0.0.101");
+    ATTEST_EQUAL(vxlan.tunnel.dst_port, PORT_VXLAN);
+    ATTEST_EQUAL(vxlan.src_ip, "10.0.0.1");
+    ATTEST_EQUAL(vxlan.dst_ip, "10.0.0.2");
+    ATTEST_EQUAL(vxlan.src_port, 53);
+    ATTEST_EQUAL(vxlan.hostname, "inner.example");
+    ATTEST_EQUAL(vxlan.format_mac(vxlan.dst_mac), "00:00:00:00:00:aa");
+
+    // GENEVE with one 8-byte option, IPv4 inside
+    PacketInfo geneve = parse_outer(PROTO_UDP, udp_tunnel(PORT_GENEVE,
+        {0x02, 0, 0x08, 0x00, 0, 0, 7, 0, 1, 2, 3, 1, 0, 0, 0, 0}, inner));
+    ATTEST_EQUAL(geneve.tunnel.encapsulation, "GENEVE 7");
+    ATTEST_EQUAL(geneve.hostname, "inner.example");
+
+    // GRE with a key, carrying MPLS over IP-in-IP: three layers
+    std::vector<uint8_t> ipip = make_ipv4_header(PROTO_IPIP, inner.size(), 201, 202);
+    ipip.insert(ipip.end(), inner.begin(), inner.end());
+    std::vector<uint8_t> gre = {0x20, 0, 0x88, 0x47, 0, 0, 0, 42,
+                                0x00, 0x01, 0x01, 0x40};  // Label 16, bottom of stack
+    gre.insert(gre.end(), ipip.begin(), ipip.end());
+    PacketInfo nested = parse_outer(PROTO_GRE, gre);
+    ATTEST_EQUAL(nested.tunnel.depth, 3);
+    ATTEST_EQUAL(nested.tunnel.encapsulation, "GRE 42 / MPLS 16 / IP-in-IP");
+    ATTEST_EQUAL(nested.tunnel.dst_ip, "10.0.0.102");
+    ATTEST_EQUAL(nested.src_ip, "10.0.0.1");
+    ATTEST_EQUAL(nested.hostname, "inner.example");
+
+    // Flows key on the inner 5-tuple
+    FlowTable table;
+    table.update(vxlan);
+    ATTEST_TRUE(table.find(FlowKey::from_packet(vxlan)) != nullptr);
+    ATTEST_EQUAL(FlowKey::from_packet(vxlan).src_port, 53);
+}
+
+REGISTER_TEST(tunnel_depth_limit_and_unknown_payload)
+{
+    // Five IP-in-IP layers: four are removed, the fifth stays encapsulated
+    std::vector<uint8_t> packet = make_inner_dns();
+    for (int i = 0; i < 4; ++i) {
+        std::vector<uint8_t> outer = make_ipv4_header(PROTO_IPIP, packet.size(), 50 + i, 60 + i);
+        outer.insert(outer.end(), packet.begin(), packet.end());
+        packet = outer;
+    }
+    PacketInfo deep = parse_outer(PROTO_IPIP, packet);
+    ATTEST_EQUAL(deep.tunnel.depth, MAX_TUNNEL_DEPTH);
+    ATTEST_EQUAL(deep.tunnel.src_ip, "10.0.0.101");
+    ATTEST_EQUAL(deep.protocol, PROTO_IPIP);
+    ATTEST_EQUAL(deep.src_ip, "10.0.0.50");
+    ATTEST_EQUAL(deep.tunnel.encapsulation,
+                 "IP-in-IP / IP-in-IP / IP-in-IP / IP-in-IP");
+
+    // GRE carrying ERSPAN is left as the outer packet
+    PacketInfo erspan = parse_outer(PROTO_GRE, {0, 0, 0x88, 0xBE, 1, 2, 3, 4});
+    ATTEST_EQUAL(erspan.tunnel.depth, 0);
+    ATTEST_TRUE(erspan.tunnel.encapsulation.empty());
+    ATTEST_EQUAL(erspan.src_ip, "10.0.0.101");
+    ATTEST_EQUAL(erspan.protocol, PROTO_GRE);
+
+    // UDP/4789 without the VNI flag is plain UDP
+    PacketInfo plain = parse_outer(PROTO_UDP, udp_tunnel(PORT_VXLAN, {0, 0, 0, 0, 0, 0, 0, 0}, {}));
+    ATTEST_EQUAL(plain.tunnel.depth, 0);
+    ATTEST_EQUAL(plain.dst_port, PORT_VXLAN);
+}
+
+// =============================================================================
+// Checksum Tests
+// =============================================================================
+
+// Straightforward RFC 1071 sum to compare the vectorised one against
+static uint16_t reference_sum(const std::vector<uint8_t>& data)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i < data.size(); i += 2) {
+        sum += (data[i] << 8) | (i + 1 < data.size() ? data[i + 1] : 0);
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(sum);
+}
+
+// Ethernet/IPv4/TCP or UDP frame 10.0.0.1:40000 -> 10.0.0.2:5001 with
+// correct checksums
+static std::vector<uint8_t> make_checksummed_frame(uint8_t protocol, const std::string& payload)
+{
+    size_t l4_len = (protocol == PROTO_TCP ? 20 : 8) + payload.size();
+    std::vector<uint8_t> f(34, 0);
+    f[12] = 0x08;
+    uint16_t total = static_cast<uint16_t>(20 + l4_len);
+    f[14] = 0x45; f[16] = total >> 8; f[17] = total & 0xFF; f[22] = 64; f[23] = protocol;
+    f[26] = 10; f[29] = 1; f[30] = 10; f[33] = 2;
+    std::vector<uint8_t> l4(l4_len - payload.size(), 0);
+    l4[0] = 40000 >> 8; l4[1] = 40000 & 0xFF; l4[2] = 5001 >> 8; l4[3] = 5001 & 0xFF;
+    if (protocol == PROTO_TCP) {
+        l4[12] = 5 << 4; l4[13] = TCP_ACK;
+    } else {
+        l4[4] = l4_len >> 8; l4[5] = l4_len & 0xFF;
+    }
+    l4.insert(l4.end(), payload.begin(), payload.end());
+
+    uint16_t ip_sum = ~reference_sum(std::vector<uint8_t>(f.begin() + 14, f.end()));
+    f[24] = ip_sum >> 8; f[25] = ip_sum & 0xFF;
+
+    std::vector<uint8_t> pseudo(f.begin() + 26, f.begin() + 34);
+    pseudo.insert(pseudo.end(), {0, protocol, static_cast<uint8_t>(l4_len >> 8),
+                                 static_cast<uint8_t>(l4_len & 0xFF)});
+    pseudo.insert(pseudo.end(), l4.begin(), l4.end());
+    uint16_t l4_sum = ~reference_sum(pseudo);
+    size_t field = protocol == PROTO_TCP ? 16 : 6;
+    l4[field] = l4_sum >> 8; l4[field + 1] = l4_sum & 0xFF;
+
+    f.insert(f.end(), l4.begin(), l4.end());
+    return f;
+}
+
+static PacketInfo parse_and_verify(const std::vector<uint8_t>& frame, uint32_t wire_len = 0)
+{
+    PacketInfo info = parse_packet(frame.data(), frame.size(), wire_len ? wire_len : frame.size());
+    verify_checksums(info);
+    return info;
+}
+
+REGISTER_TEST(ones_complement_sum_matches_reference)
+{
+    // RFC 1071 section 3 example
+    std::vector<uint8_t> rfc = {0x00, 0x01, 0xF2, 0x03, 0xF4, 0xF5, 0xF6, 0xF7};
+    ATTEST_EQUAL(ones_complement_sum(rfc.data(), rfc.size()), 0xDDF2);
+
+    // Every length through the vector, 32-bit and odd-byte tails
+    uint32_t state = 12345;
+    std::vector<uint8_t> data(9001);
+    for (uint8_t& b : data) {
+        state = state * 1103515245 + 12345;
+        b = static_cast<uint8_t>(state >> 16);
+    }
+    for (size_t len : {0, 1, 2, 3, 5, 15, 16, 17, 31, 32, 33, 63, 95, 1480, 1500, 9001}) {
+        std::vector<uint8_t> part(data.begin(), data.begin() + len);
+        ATTEST_EQUAL(ones_complement_sum(data.data(), len), reference_sum(part));
+    }
+
+    // Lanes must not overflow on all-ones input
+    std::vector<uint8_t> ones(65535, 0xFF);
+    ATTEST_EQUAL(ones_complement_sum(ones.data(), ones.size()), reference_sum(ones));
+}
+
+REGISTER_TEST(verify_checksums_good_bad_and_unchecked)
+{
+    std::string payload(1001, 'x');
+    PacketInfo tcp = parse_and_verify(make_checksummed_frame(PROTO_TCP, payload));
+    ATTEST_TRUE(tcp.ip_checksum == ChecksumStatus::GOOD);
+    ATTEST_TRUE(tcp.l4_checksum == ChecksumStatus::GOOD);
+
+    PacketInfo udp = parse_and_verify(make_checksummed_frame(PROTO_UDP, payload));
+    ATTEST_TRUE(udp.l4_checksum == ChecksumStatus::GOOD);
+
+    // A flipped payload bit fails TCP only; a changed TTL fails the header only
+    std::vector<uint8_t> corrupt = make_checksummed_frame(PROTO_TCP, payload);
+    corrupt.back() ^= 0x01;
+    PacketInfo bad_tcp = parse_and_verify(corrupt);
+    ATTEST_TRUE(bad_tcp.ip_checksum == ChecksumStatus::GOOD);
+    ATTEST_TRUE(bad_tcp.l4_checksum == ChecksumStatus::BAD);
+
+    std::vector<uint8_t> ttl = make_checksummed_frame(PROTO_UDP, payload);
+    ttl[22] = 63;
+    PacketInfo bad_ip = parse_and_verify(ttl);
+    ATTEST_TRUE(bad_ip.ip_checksum == ChecksumStatus::BAD);
+    ATTEST_TRUE(bad_ip.l4_checksum == ChecksumStatus::GOOD);
+
+    // UDP over IPv4 may carry no checksum at all
+    std::vector<uint8_t> none = make_checksummed_frame(PROTO_UDP, payload);
+    none[40] = 0; none[41] = 0;
+    ATTEST_TRUE(parse_and_verify(none).l4_checksum == ChecksumStatus::UNCHECKED);
+
+    // A frame cut short by the snap length cannot be verified
+    std::vector<uint8_t> full = make_checksummed_frame(PROTO_TCP, payload);
+    std::vector<uint8_t> cut(full.begin(), full.begin() + 200);
+    PacketInfo truncated = parse_and_verify(cut, static_cast<uint32_t>(full.size()));
+    ATTEST_TRUE(truncated.ip_checksum == ChecksumStatus::GOOD);
+    ATTEST_TRUE(truncated.l4_checksum == ChecksumStatus::UNCHECKED);
+
+    // Fragments are left for the reassembled datagram
+    std::vector<uint8_t> frag = make_checksummed_frame(PROTO_UDP, payload);
+    frag[20] = 0x20;   // More fragments
+    PacketInfo first = parse_and_verify(frag);
+    ATTEST_TRUE(first.l4_checksum == ChecksumStatus::UNCHECKED);
+}
+
+REGISTER_TEST(verify_checksums_offloaded_and_counted)
+{
+    // Outbound TSO frame: zero IP checksum and total length, pseudo-header
+    // sum in the TCP field
+    std::vector<uint8_t> tso = make_checksummed_frame(PROTO_TCP, std::string(3000, 'y'));
+    tso[16] = 0; tso[17] = 0; tso[24] = 0; tso[25] = 0;
+    PacketInfo offloaded = parse_and_verify(tso);
+    ATTEST_TRUE(offloaded.ip_checksum == ChecksumStatus::OFFLOADED);
+    ATTEST_TRUE(offloaded.l4_checksum == ChecksumStatus::OFFLOADED);
+
+    // CHECKSUM_PARTIAL with a correct IP header
+    std::string payload = "partial";
+    std::vector<uint8_t> partial = make_checksummed_frame(PROTO_UDP, payload);
+    uint16_t udp_len = static_cast<uint16_t>(8 + payload.size());
+    std::vector<uint8_t> pseudo(partial.begin() + 26, partial.begin() + 34);
+    pseudo.insert(pseudo.end(), {0, PROTO_UDP, static_cast<uint8_t>(udp_len >> 8),
+                                 static_cast<uint8_t>(udp_len & 0xFF)});
+    uint16_t pseudo_sum = reference_sum(pseudo);
+    partial[40] = pseudo_sum >> 8; partial[41] = pseudo_sum & 0xFF;
+    PacketInfo udp = parse_and_verify(partial);
+    ATTEST_TRUE(udp.ip_checksum == ChecksumStatus::GOOD);
+    ATTEST_TRUE(udp.l4_checksum == ChecksumStatus::OFFLOADED);
+
+    // Stats count bad checksums per protocol, offloads separately, and
+    // ignore packets that were never verified
+    std::vector<uint8_t> bad = make_checksummed_frame(PROTO_TCP, "payload");
+    bad.back() ^= 0xFF;
+    PacketStore store;
+    store.push(parse_and_verify(bad));
+    store.push(offloaded);
+    store.push(udp);
+    store.push(parse_and_verify(make_checksummed_frame(PROTO_UDP, "fine")));
+    store.push(parse_packet(bad.data(), bad.size(), bad.size()));
+    InterfaceStats stats = store.get_stats();
+    ATTEST_EQUAL(stats.checksums_verified, 4u);
+    ATTEST_EQUAL(stats.bad_tcp_checksums, 1u);
+    ATTEST_EQUAL(stats.bad_udp_checksums, 0u);
+    ATTEST_EQUAL(stats.bad_ipv4_checksums, 0u);
+    ATTEST_EQUAL(stats.offloaded_checksums, 2u);
+}
+
+// =============================================================================
+// TCP Analytics Tests
+// =============================================================================
+
+// Segment of the connection 10.0.0.1:40000 (client) <-> 10.0.0.2:server_port
+// at the given millisecond
+static PacketInfo make_connection_segment(uint16_t server_port, bool from_client, uint32_t seq,
+                                          uint32_t ack, uint8_t flags, const std::string& payload,
+                                          double ms, uint16_t window = 65535)
+{
+    std::vector<uint8_t> f(54, 0);
+    f[12] = 0x08;
+    uint16_t total = static_cast<uint16_t>(40 + payload.size());
+    f[14] = 0x45; f[16] = total >> 8; f[17] = total & 0xFF; f[22] = 64; f[23] = PROTO_TCP;
+    f[26] = 10; f[29] = from_client ? 1 : 2; f[30] = 10; f[33] = from_client ? 2 : 1;
+    uint16_t sport = from_client ? 40000 : server_port;
+    uint16_t dport = from_client ? server_port : 40000;
+    f[34] = sport >> 8; f[35] = sport & 0xFF; f[36] = dport >> 8; f[37] = dport & 0xFF;
+    for (int i = 0; i < 4; ++i) {
+        f[38 + i] = (seq >> (24 - 8 * i)) & 0xFF;
+        f[42 + i] = (ack >> (24 - 8 * i)) & 0xFF;
+    }
+    f[46] = 5 << 4; f[47] = flags; f[48] = window >> 8; f[49] = window & 0xFF;
+    f.insert(f.end(), payload.begin(), payload.end());
+    PacketInfo info = parse_packet(f.data(), f.size(), f.size());
+    info.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::microseconds(static_cast<int64_t>(ms * 1000)));
+    return info;
+}
+
+static PacketInfo make_tcp_packet(bool from_client, uint32_t seq, uint32_t ack, uint8_t flags,
+                                  size_t payload_len, double ms, uint16_t window = 65535)
+{
+    return make_connection_segment(443, from_client, seq, ack, flags,
+                                   std::string(payload_len, 'd'), ms, window);
+}
+
+REGISTER_TEST(tcp_analytics_handshake_and_data_rtt)
+{
+    TcpAnalyzer analyzer;
+    auto feed = [&analyzer](PacketInfo info) { analyzer.on_packet(info); return info; };
+
+    PacketInfo syn = make_tcp_packet(true, 1000, 0, TCP_SYN, 0, 0);
+    ATTEST_EQUAL(syn.tcp_seq, 1000u);
+    ATTEST_EQUAL(syn.tcp_window, 65535);
+    feed(syn);
+    feed(make_tcp_packet(false, 5000, 1001, TCP_SYN | TCP_ACK, 0, 10));
+    feed(make_tcp_packet(true, 1001, 5001, TCP_ACK, 0, 20));
+    feed(make_tcp_packet(true, 1001, 5001, TCP_ACK | TCP_PSH, 100, 30));
+    feed(make_tcp_packet(false, 5001, 1101, TCP_ACK, 0, 45));
+
+    TcpAnalyticsSnapshot snap = analyzer.snapshot(10);
+    ATTEST_EQUAL(snap.totals.connections, 1u);
+    ATTEST_EQUAL(snap.totals.handshakes, 1u);
+    ATTEST_EQUAL(snap.totals.retransmissions, 0u);
+    ATTEST_EQUAL(snap.handshake_rtt.count, 1u);
+    ATTEST_EQUAL(snap.flows.size(), 1u);
+    const TcpFlowStats& flow = snap.flows[0];
+    ATTEST_EQUAL(flow.client, "10.0.0.1:40000");
+    ATTEST_EQUAL(flow.server, "10.0.0.2:443");
+    ATTEST_EQUAL(flow.state.handshake_rtt_us, 20000u);
+    // SYN to SYN-ACK and SYN-ACK to ACK (10 ms each), then the data (15 ms)
+    ATTEST_EQUAL(snap.data_rtt.count, 3u);
+    ATTEST_EQUAL(flow.state.srtt_us, 10000u - 10000u / 8 + 15000u / 8);
+    ATTEST_EQUAL(flow.state.packets, 5u);
+    ATTEST_FALSE(flow.closed());
+
+    feed(make_tcp_packet(true, 1101, 5001, TCP_ACK | TCP_FIN, 0, 50));
+    feed(make_tcp_packet(false, 5001, 1102, TCP_ACK | TCP_FIN, 0, 60));
+    ATTEST_TRUE(analyzer.snapshot(10).flows[0].closed());
+}
+
+REGISTER_TEST(tcp_analytics_retransmission_reordering_and_windows)
+{
+    TcpAnalyzer analyzer;
+    auto feed = [&analyzer](PacketInfo info) { analyzer.on_packet(info); return info; };
+
+    // Mid-stream: the higher port is taken to be the client
+    feed(make_tcp_packet(true, 1, 1, TCP_ACK, 100, 0));
+    feed(make_tcp_packet(true, 101, 1, TCP_ACK, 100, 1));
+    feed(make_tcp_packet(true, 301, 1, TCP_ACK, 100, 2));      // 201..301 late
+    PacketInfo late = feed(make_tcp_packet(true, 201, 1, TCP_ACK, 100, 3));
+    ATTEST_TRUE(late.tcp_analysis & TCP_ANALYSIS_OUT_OF_ORDER);
+
+    PacketInfo again = feed(make_tcp_packet(true, 1, 1, TCP_ACK, 100, 400));
+    ATTEST_TRUE(again.tcp_analysis & TCP_ANALYSIS_RETRANSMISSION);
+
+    // Repeated ACKs with client data outstanding
+    feed(make_tcp_packet(false, 1, 101, TCP_ACK, 0, 401));
+    PacketInfo dup = feed(make_tcp_packet(false, 1, 101, TCP_ACK, 0, 402));
+    ATTEST_TRUE(dup.tcp_analysis & TCP_ANALYSIS_DUP_ACK);
+    feed(make_tcp_packet(false, 1, 101, TCP_ACK, 0, 403));
+
+    // Two zero-window episodes, however many packets each lasts
+    feed(make_tcp_packet(false, 1, 401, TCP_ACK, 0, 500, 0));
+    PacketInfo still = feed(make_tcp_packet(false, 1, 401, TCP_ACK, 0, 600, 0));
+    ATTEST_TRUE(still.tcp_analysis & TCP_ANALYSIS_ZERO_WINDOW);
+    feed(make_tcp_packet(false, 1, 401, TCP_ACK, 0, 700, 1024));
+    feed(make_tcp_packet(false, 1, 401, TCP_ACK, 0, 800, 0));
+
+    PacketInfo probe = feed(make_tcp_packet(true, 400, 1, TCP_ACK, 1, 900));
+    ATTEST_EQUAL(probe.tcp_analysis, TCP_ANALYSIS_KEEP_ALIVE);
+
+    TcpAnalyticsSnapshot snap = analyzer.snapshot(10);
+    ATTEST_EQUAL(snap.flows[0].client, "10.0.0.1:40000");
+    ATTEST_EQUAL(snap.totals.out_of_order, 1u);
+    ATTEST_EQUAL(snap.totals.retransmissions, 1u);
+    ATTEST_EQUAL(snap.totals.dup_acks, 2u);
+    ATTEST_EQUAL(snap.totals.zero_windows, 2u);
+    ATTEST_EQUAL(snap.totals.data_segments, 6u);
+}
+
+REGISTER_TEST(tcp_analytics_bounded_and_expired)
+{
+    TcpAnalyticsConfig config;
+    config.max_flows = 2;
+    config.idle_timeout = std::chrono::seconds(60);
+    config.close_linger = std::chrono::seconds(5);
+    TcpAnalyzer analyzer(config);
+    auto connect = [&analyzer](uint16_t port, uint8_t flags, double ms) {
+        PacketInfo info = make_tcp_packet(true, 1, 0, flags, 0, ms);
+        info.src_port = port;
+        analyzer.on_packet(info);
+    };
+
+    // A new connection in a full table evicts the one idle longest
+    connect(40000, TCP_SYN, 0);
+    connect(40001, TCP_SYN, 1);
+    connect(40000, TCP_ACK, 2);
+    connect(40002, TCP_SYN, 3);
+    TcpAnalyticsSnapshot full = analyzer.snapshot(10);
+    ATTEST_EQUAL(full.active, 2u);
+    ATTEST_EQUAL(full.evictions, 1u);
+    ATTEST_EQUAL(full.totals.connections, 3u);
+    for (const TcpFlowStats& flow : full.flows) {
+        ATTEST_TRUE(flow.client != "10.0.0.1:40001");
+    }
+
+    // A reset connection lingers briefly; an open one stays until idle
+    connect(40002, TCP_RST, 10);
+    connect(40000, TCP_ACK, 4000);
+    ATTEST_EQUAL(analyzer.snapshot(10).active, 2u);
+    connect(40000, TCP_ACK, 6000);
+    TcpAnalyticsSnapshot later = analyzer.snapshot(10);
+    ATTEST_EQUAL(later.active, 1u);
+    ATTEST_EQUAL(later.flows[0].client, "10.0.0.1:40000");
+    ATTEST_FALSE(later.flows[0].closed());
+    connect(40003, TCP_SYN, 70000);
+    later = analyzer.snapshot(10);
+    ATTEST_EQUAL(later.active, 1u);
+    ATTEST_EQUAL(later.evictions, 1u);
+    ATTEST_EQUAL(later.flows[0].client, "10.0.0.1:40003");
+}
+
+// =============================================================================
+// HTTP Tracker Tests
+// =============================================================================
+
+static HttpHead parse_head(const std::string& text)
+{
+    HttpHead head;
+    head.length = 12345;
+    if (!parse_http_head(reinterpret_cast<const uint8_t*>(text.data()), text.size(), head)) {
+        head.method = "";
+    }
+    return head;
+}
+
+// Client (true) or server data on 10.0.0.1:40000 <-> 10.0.0.2:80
+static PacketInfo make_http_segment(bool from_client, uint32_t seq, const std::string& payload,
+                                    double ms, uint8_t flags = TCP_ACK | TCP_PSH)
+{
+    return make_connection_segment(PORT_HTTP, from_client, seq, 1, flags, payload, ms);
+}
+
+REGISTER_TEST(parse_http_head_lengths)
+{
+    // The views point into the text, which must outlive them
+    std::string request = "HEAD /a HTTP/1.1\r\nHost: b.example\r\n\r\n";
+    std::string text = request + "GET /next";
+    HttpHead head = parse_head(text);
+    ATTEST_EQUAL(head.method, "HEAD");
+    ATTEST_TRUE(head.head_request);
+    ATTEST_FALSE(head.response);
+    ATTEST_EQUAL(head.target, "/a");
+    ATTEST_EQUAL(head.host, "b.example");
+    ATTEST_EQUAL(head.length, request.size());
+    ATTEST_EQUAL(head.content_length, -1);
+
+    text = "HTTP/1.1 503 Service Unavailable\r\ncontent-length: 42\r\n\r\n";
+    head = parse_head(text);
+    ATTEST_TRUE(head.response);
+    ATTEST_EQUAL(head.status, 503);
+    ATTEST_EQUAL(head.target, "503 Service Unavailable");
+    ATTEST_EQUAL(head.content_length, 42);
+
+    head = parse_head("HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, Chunked\r\n\r\n");
+    ATTEST_TRUE(head.chunked);
+    head = parse_head("HTTP/1.1 200 OK\r\nContent-Length: 4x\r\n\r\n");
+    ATTEST_EQUAL(head.content_length, -1);
+
+    // A head cut short by the end of the segment has no length yet
+    head = parse_head("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n");
+    ATTEST_EQUAL(head.status, 200);
+    ATTEST_EQUAL(head.length, 0u);
+    ATTEST_EQUAL(parse_head("SSH-2.0-OpenSSH_9.6\r\n\r\n").method, "");
+}
+
+REGISTER_TEST(http_tracker_pipelined_requests)
+{
+    HttpTracker tracker;
+    std::string requests = "GET /1 HTTP/1.1\r\nHost: www.example.com\r\n\r\n"
+                           "HEAD /2 HTTP/1.1\r\nHost: www.example.com:80\r\n\r\n"
+                           "GET /3 HTTP/1.1\r\nHost: api.example.com\r\n\r\n";
+    PacketInfo out = make_http_segment(true, 1, requests, 0);
+    ATTEST_EQUAL(out.app_protocol, "HTTP");
+    tracker.on_packet(out);
+
+    // First response, then the HEAD response (no body despite its length)
+    // and the start of the third, whose body ends in the next segment
+    std::string first = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+    std::string second = "HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n";
+    std::string third = "HTTP/1.1 404 Not Found\r\nContent-Length: 7\r\n\r\nmis";
+    PacketInfo in = make_http_segment(false, 1, first + second + third, 30);
+    tracker.on_packet(in);
+    ATTEST_EQUAL(in.http_status, 200);
+    ATTEST_EQUAL(in.http_content_length, 5);
+    ATTEST_EQUAL(in.http_ttfb_us, 30000u);
+
+    uint32_t next = static_cast<uint32_t>(1 + first.size() + second.size() + third.size());
+    PacketInfo rest = make_http_segment(false, next, "singHTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n", 45);
+    tracker.on_packet(rest);
+    ATTEST_EQUAL(rest.http_ttfb_us, 0u);   // Not a response at the start of the segment
+
+    HttpTrackerSnapshot snap = tracker.snapshot(10);
+    ATTEST_EQUAL(snap.total.requests, 3u);
+    ATTEST_EQUAL(snap.total.responses, 3u);
+    ATTEST_EQUAL(snap.total.status[1], 2u);
+    ATTEST_EQUAL(snap.total.status[3], 1u);
+    ATTEST_EQUAL(snap.total.body_bytes, 5u + 1000u + 7u);
+    ATTEST_EQUAL(snap.total.ttfb.count, 3u);
+    // The final status line has no request left to answer
+    ATTEST_EQUAL(snap.unmatched, 1u);
+    ATTEST_EQUAL(snap.lost_sync, 0u);
+
+    ATTEST_EQUAL(snap.hosts.size(), 2u);
+    ATTEST_EQUAL(snap.hosts[0].host, "www.example.com");
+    ATTEST_EQUAL(snap.hosts[0].requests, 2u);
+    ATTEST_EQUAL(snap.hosts[1].host, "api.example.com");
+    ATTEST_EQUAL(snap.hosts[1].errors(), 1u);
+    ATTEST_EQUAL(tracker.snapshot(1, HttpOrder::ERRORS).hosts[0].host, "api.example.com");
+}
+
+REGISTER_TEST(http_tracker_resync_and_bounds)
+{
+    HttpTracker tracker;
+    std::string request = "GET / HTTP/1.1\r\nHost: a.example\r\n\r\n";
+    uint32_t client_seq = 1;
+    auto send = [&](double ms) {
+        PacketInfo info = make_http_segment(true, client_seq, request, ms);
+        tracker.on_packet(info);
+        client_seq += static_cast<uint32_t>(request.size());
+    };
+
+    // A chunked body loses the boundary; the next status line restores it
+    send(0);
+    std::string chunked = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n";
+    PacketInfo in = make_http_segment(false, 1, chunked, 10);
+    tracker.on_packet(in);
+    PacketInfo body = make_http_segment(false, 1 + static_cast<uint32_t>(chunked.size()),
+                                        "0\r\n\r\n", 11);
+    tracker.on_packet(body);
+    send(20);
+    PacketInfo again = make_http_segment(false, 200, "HTTP/1.1 500 Oops\r\nContent-Length: 0\r\n\r\n", 35);
+    tracker.on_packet(again);
+    ATTEST_EQUAL(again.http_ttfb_us, 15000u);
+
+    HttpTrackerSnapshot snap = tracker.snapshot(10);
+    ATTEST_EQUAL(snap.total.responses, 2u);
+    ATTEST_EQUAL(snap.total.status[4], 1u);
+    ATTEST_EQUAL(snap.lost_sync, 1u);
+
+    // Requests beyond the pipeline depth push out the oldest
+    for (size_t i = 0; i < HttpTracker::PIPELINE_DEPTH + 2; ++i) {
+        send(40);
+    }
+    ATTEST_EQUAL(tracker.snapshot(10).total.unanswered, 2u);
+
+    // A reset ends the connection with the rest unanswered
+    PacketInfo reset = make_http_segment(false, 500, "", 50, TCP_RST);
+    tracker.on_packet(reset);
+    snap = tracker.snapshot(10);
+    ATTEST_EQUAL(snap.total.unanswered, HttpTracker::PIPELINE_DEPTH + 2);
+    ATTEST_EQUAL(snap.connections, 0u);
+
+    HttpTrackerConfig config;
+    config.max_flows = 1;
+    HttpTracker small(config);
+    PacketInfo one = make_http_segment(true, 1, request, 0);
+    small.on_packet(one);
+    PacketInfo other = make_connection_segment(8080, true, 1, 1, TCP_ACK, request, 1);
+    ATTEST_EQUAL(other.app_protocol, "HTTP");
+    small.on_packet(other);
+    ATTEST_EQUAL(small.snapshot(10).overflows, 1u);
+
+    // Idle past the timeout, the first makes room with its request unanswered
+    PacketInfo later = make_connection_segment(8080, true, 1, 1, TCP_ACK, request, 31000);
+    small.on_packet(later);
+    snap = small.snapshot(10);
+    ATTEST_EQUAL(snap.overflows, 1u);
+    ATTEST_EQUAL(snap.connections, 1u);
+    ATTEST_EQUAL(snap.total.unanswered, 1u);
+}
+
+// =============================================================================
+// Attack Detector Tests
+// =============================================================================
+
+// IPv4 TCP segment between two host-order addresses, parsed fields only
+static PacketInfo make_attack_segment(uint32_t src, uint32_t dst, uint16_t dport, uint8_t flags,
+                                      int64_t ms)
+{
+    PacketInfo pkt{};
+    pkt.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+    pkt.ip_version = 4;
+    pkt.protocol = PROTO_TCP;
+    for (int i = 0; i < 4; ++i) {
+        pkt.src_addr[i] = static_cast<uint8_t>(src >> (24 - 8 * i));
+        pkt.dst_addr[i] = static_cast<uint8_t>(dst >> (24 - 8 * i));
+    }
+    auto text = [](const std::array<uint8_t, 16>& a) {
+        return std::to_string(a[0]) + "." + std::to_string(a[1]) + "." + std::to_string(a[2]) +
+               "." + std::to_string(a[3]);
+    };
+    pkt.src_ip = text(pkt.src_addr);
+    pkt.dst_ip = text(pkt.dst_addr);
+    pkt.src_port = 40000;
+    pkt.dst_port = dport;
+    pkt.tcp_flags = flags;
+    return pkt;
+}
+
+constexpr uint32_t SCANNER = 0x0a000001;   // 10.0.0.1
+constexpr uint32_t TARGET = 0xc0a80101;    // 192.168.1.1
+
+REGISTER_TEST(attack_detector_port_scan_alerts_once)
+{
+    AttackDetector detector;
+    std::vector<DetectionEvent> events;
+    for (uint16_t port = 1; port <= 150; ++port) {
+        auto event = detector.on_packet(make_attack_segment(SCANNER, TARGET, port, TCP_SYN, port));
+        if (event) events.push_back(*event);
+    }
+    ATTEST_EQUAL(events.size(), 1u);
+    ATTEST_TRUE(events[0].kind == DetectionKind::PORT_SCAN);
+    ATTEST_EQUAL(events[0].address, "10.0.0.1");
+    ATTEST_EQUAL(events[0].count, 100u);
+    ATTEST_EQUAL(events[0].describe(std::chrono::seconds(10)),
+                 "Port scan: 100 ports in 10s, 0% answered");
+    ATTEST_EQUAL(std::string(detection_name(events[0].kind)), "port-scan");
+
+    // The same port again is not a new one
+    AttackDetector repeat;
+    for (int i = 0; i < 150; ++i) {
+        ATTEST_FALSE(repeat.on_packet(make_attack_segment(SCANNER, TARGET, 22, TCP_SYN, i)));
+    }
+    ATTEST_EQUAL(repeat.stats().packets, 150u);
+
+    // Nor are ports probed again in the next epoch, while the previous one
+    // still counts in full
+    AttackDetector rescan;
+    for (int64_t round = 0; round < 2; ++round) {
+        for (uint16_t port = 1; port <= 60; ++port) {
+            ATTEST_FALSE(rescan.on_packet(make_attack_segment(SCANNER, TARGET, port, TCP_SYN,
+                                                              1 + round * 10000 + port)));
+        }
+    }
+}
+
+REGISTER_TEST(attack_detector_sweep_flood_and_rst_storm)
+{
+    AttackDetector detector;
+    size_t sweeps = 0;
+    for (uint32_t host = 1; host <= 60; ++host) {
+        auto event = detector.on_packet(make_attack_segment(SCANNER, TARGET + host, 22, TCP_SYN, 0));
+        if (event) {
+            ATTEST_TRUE(event->kind == DetectionKind::HOST_SWEEP);
+            ATTEST_EQUAL(event->count, 50u);
+            sweeps++;
+        }
+    }
+    ATTEST_EQUAL(sweeps, 1u);
+
+    // Spoofed sources, one SYN each, all at one server
+    std::vector<DetectionEvent> floods;
+    for (uint32_t i = 0; i < 600; ++i) {
+        auto event = detector.on_packet(make_attack_segment(0x0b000000 + i * 7919, TARGET, 80,
+                                                            TCP_SYN, 10));
+        if (event) floods.push_back(*event);
+    }
+    ATTEST_EQUAL(floods.size(), 1u);
+    ATTEST_TRUE(floods[0].kind == DetectionKind::SYN_FLOOD_TARGET);
+    ATTEST_EQUAL(floods[0].address, "192.168.1.1");
+    ATTEST_EQUAL(floods[0].count, 500u);
+
+    // Refused connections reset back at one host
+    size_t storms = 0;
+    for (uint32_t i = 0; i < 250; ++i) {
+        auto event = detector.on_packet(make_attack_segment(TARGET + i, SCANNER, 40000,
+                                                            TCP_RST | TCP_ACK, 20));
+        if (event) {
+            ATTEST_TRUE(event->kind == DetectionKind::RST_STORM);
+            ATTEST_EQUAL(event->address, "10.0.0.1");
+            storms++;
+        }
+    }
+    ATTEST_EQUAL(storms, 1u);
+    ATTEST_EQUAL(detector.stats().alerts[static_cast<size_t>(DetectionKind::RST_STORM)], 1u);
+}
+
+REGISTER_TEST(attack_detector_answered_window_and_disabled)
+{
+    // A busy client whose connections are accepted is not scanning
+    AttackDetector detector;
+    for (uint16_t port = 1; port <= 150; ++port) {
+        ATTEST_FALSE(detector.on_packet(make_attack_segment(SCANNER, TARGET, port, TCP_SYN, port)));
+        ATTEST_FALSE(detector.on_packet(make_attack_segment(TARGET, SCANNER, 40000,
+                                                            TCP_SYN | TCP_ACK, port)));
+    }
+
+    // Half a scan per window never adds up, but a full one alerts again
+    // once the previous alert has aged out
+    AttackDetector windowed;
+    for (uint16_t port = 1; port <= 80; ++port) {
+        ATTEST_FALSE(windowed.on_packet(make_attack_segment(SCANNER, TARGET, port, TCP_SYN, 0)));
+    }
+    for (uint16_t port = 1; port <= 80; ++port) {
+        ATTEST_FALSE(windowed.on_packet(make_attack_segment(SCANNER, TARGET, port + 1000, TCP_SYN,
+                                                            25000)));
+    }
+    size_t alerts = 0;
+    for (int round = 0; round < 2; ++round) {
+        for (uint16_t port = 1; port <= 120; ++port) {
+            int64_t ms = 60000 + round * 30000;
+            if (windowed.on_packet(make_attack_segment(SCANNER, TARGET, port, TCP_SYN, ms))) {
+                alerts++;
+            }
+        }
+    }
+    ATTEST_EQUAL(alerts, 2u);
+
+    // Counts from the previous window still weigh in while it overlaps
+    AttackDetector sliding;
+    sliding.on_packet(make_attack_segment(TARGET, SCANNER, 40000, TCP_SYN | TCP_ACK, 0));
+    for (uint16_t port = 1; port <= 80; ++port) {
+        sliding.on_packet(make_attack_segment(SCANNER, TARGET, port, TCP_SYN, 9000));
+    }
+    bool alerted = false;
+    for (uint16_t port = 1; port <= 40; ++port) {
+        if (sliding.on_packet(make_attack_segment(SCANNER, TARGET, port + 1000, TCP_SYN, 10500))) {
+            alerted = true;
+        }
+    }
+    ATTEST_TRUE(alerted);
+
+    DetectionConfig config;
+    config.window = std::chrono::seconds(0);
+    AttackDetector off(config);
+    for (uint16_t port = 1; port <= 150; ++port) {
+        ATTEST_FALSE(off.on_packet(make_attack_segment(SCANNER, TARGET, port, TCP_SYN, port)));
+    }
+    ATTEST_EQUAL(off.stats().packets, 0u);
+}
+
+// =============================================================================
+// Baseline Tests
+// =============================================================================
+
+REGISTER_TEST(baseline_series_flags_spikes_and_learns_shifts)
+{
+    BaselineConfig config;
+    RateSeries series;
+    for (int i = 0; i < 60; ++i) {
+        ATTEST_FALSE(series.update(i % 2 ? 95.0 : 105.0, 25.0, config));
+    }
+    ATTEST_TRUE(std::fabs(series.forecast() - 100.0) < 5.0);
+    ATTEST_TRUE(series.sigma() > 1.0);
+
+    // A spike is flagged but barely moves the baseline
+    ATTEST_TRUE(series.update(400.0, 25.0, config));
+    ATTEST_TRUE(series.anomalous());
+    ATTEST_TRUE(series.forecast() < 130.0);
+    ATTEST_FALSE(series.update(100.0, 25.0, config));
+
+    // Small departures stay under the floor however steady the series
+    RateSeries steady;
+    for (int i = 0; i < 60; ++i) {
+        steady.update(100.0, 25.0, config);
+    }
+    ATTEST_FALSE(steady.update(120.0, 25.0, config));
+    ATTEST_TRUE(steady.update(200.0, 25.0, config));
+
+    // A lasting change becomes the new normal
+    size_t flagged = 0;
+    for (int i = 0; i < 120; ++i) {
+        if (series.update(i % 2 ? 295.0 : 305.0, 75.0, config)) flagged++;
+    }
+    ATTEST_TRUE(flagged > 0);
+    ATTEST_FALSE(series.anomalous());
+
+    // Nothing is flagged while warming up
+    RateSeries fresh;
+    ATTEST_FALSE(fresh.update(100.0, 25.0, config));
+    ATTEST_FALSE(fresh.update(1000.0, 25.0, config));
+    ATTEST_EQUAL(fresh.samples(), 2u);
+}
+
+REGISTER_TEST(baseline_monitor_reports_protocols_and_hosts)
+{
+    BaselineConfig config;
+    config.max_hosts = 4;
+    BaselineMonitor monitor(config);
+    std::map<std::string, uint64_t> protocols;
+    PacketInfo pkt{};
+    pkt.src_ip = "10.0.0.1";
+    pkt.dst_ip = "10.0.0.2";
+    pkt.original_length = 1000;
+
+    std::vector<BaselineAnomaly> found;
+    auto tick = [&](uint64_t packets) {
+        protocols["TCP"] += packets;
+        for (uint64_t i = 0; i < packets; ++i) {
+            monitor.count(pkt);
+        }
+        return monitor.tick(static_cast<double>(packets), packets * 1000.0, protocols, 1.0,
+                            found);
+    };
+    for (int i = 0; i < 40; ++i) {
+        ATTEST_EQUAL(tick(100), 0);
+    }
+    ATTEST_TRUE(found.empty());
+
+    // Every series jumps tenfold: reported once, flagged while it lasts
+    ATTEST_EQUAL(tick(1000), ANOMALY_PACKETS | ANOMALY_BYTES);
+    ATTEST_EQUAL(found.size(), 5u);   // Total pkt/s and B/s, TCP, both hosts
+    auto tcp = std::find_if(found.begin(), found.end(),
+                            [](const BaselineAnomaly& a) { return a.series == "TCP"; });
+    ATTEST_TRUE(tcp != found.end());
+    ATTEST_EQUAL(tcp->describe(),
+                 "Rate anomaly: TCP 1000 pkt/s, expected 100 pkt/s (steady until now)");
+    found.clear();
+    ATTEST_EQUAL(tick(1000), ANOMALY_PACKETS | ANOMALY_BYTES);
+    ATTEST_TRUE(found.empty());
+
+    // The host table is bounded, and one-off hosts do not push out heavy ones
+    for (int i = 0; i < 10; ++i) {
+        PacketInfo other{};
+        other.src_ip = "192.168.0." + std::to_string(i);
+        other.original_length = 60;
+        monitor.count(other);
+    }
+    ATTEST_EQUAL(monitor.series_count(), 2u + 1u + 4u);
+    ATTEST_TRUE(monitor.has_host("10.0.0.1"));
+    ATTEST_TRUE(monitor.has_host("10.0.0.2"));
+    ATTEST_TRUE(monitor.has_host("192.168.0.9"));
+    ATTEST_FALSE(monitor.has_host("192.168.0.0"));
+
+    BaselineAnomaly host;
+    host.series = "10.0.0.1";
+    host.bytes = true;
+    host.value = 2500000.0;
+    host.expected = 100000.0;
+    host.sigma = 20000.0;
+    ATTEST_EQUAL(host.describe(),
+                 "Rate anomaly: 10.0.0.1 2.5 MB/s, expected 100.0 KB/s (+120.0 sigma)");
+
+    config.sigmas = 0;
+    monitor.set_config(config);
+    monitor.count(pkt);
+    ATTEST_EQUAL(monitor.tick(1000.0, 1.0e6, protocols, 1.0, found), 0);
+    ATTEST_EQUAL(monitor.series_count(), 2u);
+}